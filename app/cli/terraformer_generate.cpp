@@ -0,0 +1,493 @@
+//@	{"target":{"name":"terraformer_generate.o"}}
+
+// Generates heightmaps from a serialized heightmap_descriptor, without a display server. Many
+// variants of the same descriptor can be generated in one run, by sweeping fields over a list of
+// values, and by deriving new rng seeds. All variants share one computation_context, so FFT plans
+// are shared between them, and generator outputs are shared through the persistent image cache.
+
+#include "lib/common/cfile_owner.hpp"
+#include "lib/common/fnv1a_hash.hpp"
+#include "lib/common/input_error.hpp"
+#include "lib/common/string_converter.hpp"
+#include "lib/descriptor_io/descriptor_serializer.hpp"
+#include "lib/filters/isolines.hpp"
+#include "lib/generators/heightmap/heightmap.hpp"
+#include "lib/math_utils/computation_context.hpp"
+#include "lib/pixel_store/image_io.hpp"
+#include "lib/pixel_store/persistent_image_cache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	void print_usage()
+	{
+		puts(
+			"Usage: terraformer-generate [options] descriptor output_directory\n"
+			"\n"
+			"descriptor is a text file with one `path = value` pair per line. Fields that are not\n"
+			"in the file keep their default values. To get all fields with their default values, run\n"
+			"terraformer-generate --print-descriptor /dev/null\n"
+			"\n"
+			"Options:\n"
+			"  --set path=value              Set a field in all variants\n"
+			"  --sweep path=value            Add a value to the sweep of a field. Sweeps over\n"
+			"                                different fields are combined.\n"
+			"  --linspace path=first:last:n  Sweep a field over n evenly spaced values\n"
+			"  --seeds n                     Derive n sets of rng seeds from the descriptor\n"
+			"  --jobs n                      Generate n variants concurrently (default 2)\n"
+			"  --isolines interval           Also write the isolines of each variant, with the given\n"
+			"                                elevation interval, as an SVG file\n"
+			"  --no-cache                    Do not use the persistent image cache\n"
+			"  --print-descriptor            Print the descriptor, and exit without generating\n"
+			"                                anything"
+		);
+	}
+
+	/**
+	 * A field, together with the values it takes in different variants
+	 */
+	struct sweep_axis
+	{
+		std::string path;
+		std::vector<std::string> values;
+	};
+
+	struct generator_options
+	{
+		std::filesystem::path descriptor_file;
+		std::filesystem::path output_directory;
+		terraformer::descriptor_field_map overrides;
+		std::vector<sweep_axis> sweeps;
+		size_t seed_count = 0;
+		size_t job_count = 2;
+		std::optional<float> isoline_interval;
+		bool use_cache = true;
+		bool print_descriptor = false;
+	};
+
+	std::pair<std::string, std::string> split_assignment(std::string_view str)
+	{
+		auto const separator = str.find('=');
+		if(separator == std::string_view::npos)
+		{ throw terraformer::input_error{std::string{"Expected `path=value`, got `"}.append(str).append("`")}; }
+
+		return std::pair{std::string{str.substr(0, separator)}, std::string{str.substr(separator + 1)}};
+	}
+
+	size_t parse_count(std::string_view str)
+	{
+		auto const ret = terraformer::num_string_converter<size_t>::convert(str);
+		if(ret == 0)
+		{ throw terraformer::input_error{"Expected a positive number"}; }
+		return ret;
+	}
+
+	float parse_interval(std::string_view str)
+	{
+		auto const ret = terraformer::deserialize_field_value(std::type_identity<float>{}, str);
+		if(!(ret > 0.0f))
+		{ throw terraformer::input_error{"Expected a positive number"}; }
+		return ret;
+	}
+
+	sweep_axis& get_sweep_axis(std::vector<sweep_axis>& sweeps, std::string const& path)
+	{
+		auto const i = std::ranges::find(sweeps, path, &sweep_axis::path);
+		if(i != std::end(sweeps))
+		{ return *i; }
+		return sweeps.emplace_back(sweep_axis{.path = path, .values = std::vector<std::string>{}});
+	}
+
+	void add_linspace(std::vector<sweep_axis>& sweeps, std::string_view arg)
+	{
+		auto const [path, range] = split_assignment(arg);
+		auto const count_separator = range.rfind(':');
+		auto const last_separator = count_separator == std::string::npos || count_separator == 0?
+			std::string::npos :
+			range.rfind(':', count_separator - 1);
+		if(last_separator == std::string::npos)
+		{ throw terraformer::input_error{std::string{"Expected `path=first:last:n`, got `"}.append(arg).append("`")}; }
+
+		auto const range_view = std::string_view{range};
+		auto const first = terraformer::deserialize_field_value(
+			std::type_identity<float>{},
+			range_view.substr(0, last_separator)
+		);
+		auto const last = terraformer::deserialize_field_value(
+			std::type_identity<float>{},
+			range_view.substr(last_separator + 1, count_separator - last_separator - 1)
+		);
+		auto const count = parse_count(range_view.substr(count_separator + 1));
+
+		auto& axis = get_sweep_axis(sweeps, path);
+		for(size_t k = 0; k != count; ++k)
+		{
+			auto const t = count == 1? 0.0f : static_cast<float>(k)/static_cast<float>(count - 1);
+			axis.values.push_back(terraformer::serialize_field_value(first + t*(last - first)));
+		}
+	}
+
+	std::optional<generator_options> parse_command_line(int argc, char** argv)
+	{
+		generator_options ret;
+		std::vector<std::string_view> positional_args;
+		for(int k = 1; k != argc; ++k)
+		{
+			std::string_view const arg{argv[k]};
+			auto const get_value = [&k, argc, argv, arg]() {
+				if(k + 1 == argc)
+				{ throw terraformer::input_error{std::string{arg}.append(" requires a value")}; }
+				++k;
+				return std::string_view{argv[k]};
+			};
+
+			if(arg == "--set")
+			{
+				auto [path, value] = split_assignment(get_value());
+				ret.overrides.insert_or_assign(std::move(path), std::move(value));
+			}
+			else
+			if(arg == "--sweep")
+			{
+				auto [path, value] = split_assignment(get_value());
+				get_sweep_axis(ret.sweeps, path).values.push_back(std::move(value));
+			}
+			else
+			if(arg == "--linspace")
+			{ add_linspace(ret.sweeps, get_value()); }
+			else
+			if(arg == "--seeds")
+			{ ret.seed_count = parse_count(get_value()); }
+			else
+			if(arg == "--jobs")
+			{ ret.job_count = parse_count(get_value()); }
+			else
+			if(arg == "--isolines")
+			{ ret.isoline_interval = parse_interval(get_value()); }
+			else
+			if(arg == "--no-cache")
+			{ ret.use_cache = false; }
+			else
+			if(arg == "--print-descriptor")
+			{ ret.print_descriptor = true; }
+			else
+			if(arg.starts_with("--"))
+			{ throw terraformer::input_error{std::string{"Unknown option "}.append(arg)}; }
+			else
+			{ positional_args.push_back(arg); }
+		}
+
+		if(std::size(positional_args) != (ret.print_descriptor? 1 : 2))
+		{ return std::nullopt; }
+
+		ret.descriptor_file = positional_args[0];
+		if(!ret.print_descriptor)
+		{ ret.output_directory = positional_args[1]; }
+		return ret;
+	}
+
+	std::string read_text_file(std::filesystem::path const& path)
+	{
+		std::unique_ptr<FILE, terraformer::cfile_deleter> src{fopen(path.c_str(), "rb")};
+		if(src == nullptr)
+		{ throw std::runtime_error{std::string{"Failed to open "}.append(path.string())}; }
+
+		std::string ret;
+		std::array<char, 4096> buffer;
+		while(true)
+		{
+			auto const n = fread(std::data(buffer), 1, std::size(buffer), src.get());
+			ret.append(std::data(buffer), n);
+			if(n != std::size(buffer))
+			{ return ret; }
+		}
+	}
+
+	void write_text_file(std::filesystem::path const& path, std::string_view text)
+	{
+		auto const dest = terraformer::make_output_file(path.c_str());
+		if(fwrite(std::data(text), 1, std::size(text), dest.get()) != std::size(text))
+		{ throw std::runtime_error{std::string{"Failed to write "}.append(path.string())}; }
+	}
+
+	/**
+	 * Writes isolines as an SVG image with one path per polyline. The image has the same size as
+	 * the heightmap, and each path holds its level in a data-level attribute.
+	 */
+	void write_isolines_svg(
+		std::filesystem::path const& path,
+		terraformer::polyline_store const& isolines,
+		terraformer::span_2d_extents heightmap_size
+	)
+	{
+		auto const dest = terraformer::make_output_file(path.c_str());
+		fprintf(
+			dest.get(),
+			"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%u\" height=\"%u\" viewBox=\"0 0 %u %u\">\n"
+			"<g fill=\"none\" stroke=\"black\" stroke-width=\"0.5\">\n",
+			heightmap_size.width,
+			heightmap_size.height,
+			heightmap_size.width,
+			heightmap_size.height
+		);
+
+		for(size_t k = 0; k != isolines.size(); ++k)
+		{
+			auto const polyline = isolines[k];
+			if(std::size(polyline.points) < 2)
+			{ continue; }
+
+			fprintf(dest.get(), "<path data-level=\"%.8g\" d=\"", static_cast<double>(polyline.values[0]));
+			for(size_t l = 0; l != std::size(polyline.points); ++l)
+			{
+				// NOTE: Pixel coordinates refer to pixel centers
+				auto const point = polyline.points[l];
+				fprintf(
+					dest.get(),
+					"%c%.3f %.3f",
+					l == 0? 'M' : 'L',
+					static_cast<double>(point[0]) + 0.5,
+					static_cast<double>(point[1]) + 0.5
+				);
+			}
+			fputs("\"/>\n", dest.get());
+		}
+
+		fputs("</g>\n</svg>\n", dest.get());
+		if(ferror(dest.get()))
+		{ throw std::runtime_error{std::string{"Failed to write "}.append(path.string())}; }
+	}
+
+	/**
+	 * Replaces every rng seed in fields with a seed derived from the original seed, its path, and
+	 * seed_index. The path is included so that seeds that happen to be equal diverge.
+	 */
+	void derive_rng_seeds(
+		terraformer::descriptor_field_map& fields,
+		std::vector<std::string> const& rng_seed_fields,
+		size_t seed_index
+	)
+	{
+		for(auto const& path : rng_seed_fields)
+		{
+			auto& value = fields.at(path);
+			auto const seed = terraformer::deserialize_field_value(
+				std::type_identity<std::array<std::byte, 16>>{},
+				value
+			);
+			terraformer::fnv1a_128 hash;
+			hash.update(std::span{seed});
+			hash.update(std::string_view{path});
+			hash.update(static_cast<uint64_t>(seed_index));
+			value = terraformer::serialize_field_value(hash.digest());
+		}
+	}
+
+	/**
+	 * Computes the fields of all variants. The first sweep varies fastest, and the derived rng
+	 * seeds vary slowest.
+	 */
+	std::vector<terraformer::descriptor_field_map> make_variants(
+		terraformer::descriptor_field_map const& base,
+		std::vector<sweep_axis> const& sweeps,
+		std::vector<std::string> const& rng_seed_fields,
+		size_t seed_count
+	)
+	{
+		size_t variant_count = std::max(seed_count, size_t{1});
+		for(auto const& axis : sweeps)
+		{
+			if(!base.contains(axis.path))
+			{ throw terraformer::input_error{std::string{"Unknown field `"}.append(axis.path).append("`")}; }
+			variant_count *= std::size(axis.values);
+		}
+
+		std::vector<terraformer::descriptor_field_map> ret;
+		ret.reserve(variant_count);
+		for(size_t variant = 0; variant != variant_count; ++variant)
+		{
+			auto fields = base;
+			auto index = variant;
+			for(auto const& axis : sweeps)
+			{
+				fields.at(axis.path) = axis.values[index%std::size(axis.values)];
+				index /= std::size(axis.values);
+			}
+
+			if(seed_count != 0)
+			{ derive_rng_seeds(fields, rng_seed_fields, index); }
+
+			ret.push_back(std::move(fields));
+		}
+		return ret;
+	}
+
+	std::string make_variant_name(size_t variant)
+	{
+		std::array<char, 32> buffer{};
+		snprintf(std::data(buffer), std::size(buffer), "variant_%06zu", variant);
+		return std::string{std::data(buffer)};
+	}
+
+	int run(generator_options const& options)
+	{
+		terraformer::descriptor_field_map fields =
+			terraformer::parse_descriptor_fields(read_text_file(options.descriptor_file));
+		for(auto const& item : options.overrides)
+		{ fields.insert_or_assign(item.first, item.second); }
+
+		// Serialize the descriptor again, to get the value of all fields, including those that were
+		// not in the file
+		terraformer::descriptor_serializer serializer;
+		{
+			terraformer::heightmap_descriptor descriptor;
+			terraformer::deserialize_descriptor(descriptor, fields);
+			descriptor.bind(serializer.get_editor());
+		}
+
+		if(options.print_descriptor)
+		{
+			fputs(serializer.text().c_str(), stdout);
+			return 0;
+		}
+
+		auto const variants = make_variants(
+			terraformer::parse_descriptor_fields(serializer.text()),
+			options.sweeps,
+			serializer.rng_seed_fields(),
+			options.seed_count
+		);
+
+		// Check all variants before spending time on generating any of them
+		for(auto const& variant : variants)
+		{
+			terraformer::heightmap_descriptor descriptor;
+			terraformer::deserialize_descriptor(descriptor, variant);
+		}
+
+		std::filesystem::create_directories(options.output_directory);
+
+		terraformer::computation_context comp_ctxt{
+			.workers = terraformer::thread_pool<terraformer::move_only_function<void()>>{
+				std::thread::hardware_concurrency()
+			},
+			.dft_engine = terraformer::dft_engine{}
+		};
+		terraformer::dft_engine::enable_multithreading(comp_ctxt.workers);
+
+		std::optional<terraformer::persistent_image_cache> output_cache;
+		if(options.use_cache)
+		{
+			output_cache.emplace(
+				terraformer::get_default_image_cache_directory(),
+				static_cast<size_t>(1024)*1024*1024
+			);
+		}
+
+		std::atomic<size_t> next_variant{0};
+		std::atomic<size_t> failure_count{0};
+		std::mutex output_mutex;
+		auto const t_start = std::chrono::steady_clock::now();
+		{
+			// NOTE: Variants run on their own threads, rather than on comp_ctxt.workers, since the
+			//       generators wait for tasks they submit to comp_ctxt.workers
+			std::vector<std::jthread> jobs;
+			for(size_t k = 0; k != std::min(options.job_count, std::size(variants)); ++k)
+			{
+				jobs.push_back(std::jthread{[&](){
+					while(true)
+					{
+						auto const variant = next_variant.fetch_add(1);
+						if(variant >= std::size(variants))
+						{ return; }
+
+						auto const name = make_variant_name(variant);
+						try
+						{
+							auto const t_variant_start = std::chrono::steady_clock::now();
+							terraformer::heightmap_descriptor descriptor;
+							terraformer::deserialize_descriptor(descriptor, variants[variant]);
+							auto const result = generate(
+								comp_ctxt,
+								descriptor,
+								std::stop_token{},
+								output_cache.has_value()? &*output_cache : nullptr
+							);
+							store(result, (options.output_directory/(name + ".exr")).c_str());
+							write_text_file(
+								options.output_directory/(name + ".txt"),
+								terraformer::serialize_descriptor(descriptor)
+							);
+							if(options.isoline_interval.has_value())
+							{
+								write_isolines_svg(
+									options.output_directory/(name + "_isolines.svg"),
+									extract_isolines(result.pixels(), *options.isoline_interval, comp_ctxt.workers),
+									result.pixels().extents()
+								);
+							}
+							auto const t_variant_end = std::chrono::steady_clock::now();
+
+							std::lock_guard lock{output_mutex};
+							printf(
+								"%s: %.3f s\n",
+								name.c_str(),
+								std::chrono::duration<double>(t_variant_end - t_variant_start).count()
+							);
+							fflush(stdout);
+						}
+						catch(std::exception const& error)
+						{
+							++failure_count;
+							std::lock_guard lock{output_mutex};
+							fprintf(stderr, "%s: %s\n", name.c_str(), error.what());
+						}
+					}
+				}});
+			}
+		}
+		auto const t_end = std::chrono::steady_clock::now();
+
+		auto const elapsed_time = std::chrono::duration<double>(t_end - t_start).count();
+		auto const completed_count = std::size(variants) - failure_count.load();
+		printf(
+			"%zu of %zu variants generated in %.1f s (%.1f variants/hour)\n",
+			completed_count,
+			std::size(variants),
+			elapsed_time,
+			3600.0*static_cast<double>(completed_count)/elapsed_time
+		);
+
+		return failure_count.load() == 0? 0 : 1;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	try
+	{
+		auto const options = parse_command_line(argc, argv);
+		if(!options.has_value())
+		{
+			print_usage();
+			return 1;
+		}
+
+		return run(*options);
+	}
+	catch(std::exception const& error)
+	{
+		fprintf(stderr, "terraformer-generate: %s\n", error.what());
+		return 1;
+	}
+}
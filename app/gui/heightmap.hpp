@@ -25,7 +25,7 @@ namespace terraformer::app
 	struct heightmap_part_form_field
 	{
 		std::u8string_view label;
-		std::reference_wrapper<grayscale_image const> value_reference;
+		std::reference_wrapper<std::shared_ptr<grayscale_image const> const> value_reference;
 		bool expand_layout_cell;
 		bool maximize_widget;
 
@@ -111,7 +111,7 @@ namespace terraformer::app
 
 	struct heightmap_view_descriptor
 	{
-		std::reference_wrapper<grayscale_image const> data;
+		std::reference_wrapper<std::shared_ptr<grayscale_image const> const> data;
 		std::reference_wrapper<domain_size_descriptor const> domain_size;
 		heatmap_view_attributes heatmap_presentation_attributes;
 		xsection_view_attributes xsection_presentation_attributes;
@@ -145,7 +145,7 @@ namespace terraformer::app
 			presentation_attributes{main_view.heatmap_presentation_attributes}
 		{}
 
-		std::reference_wrapper<grayscale_image const> data;
+		std::reference_wrapper<std::shared_ptr<grayscale_image const> const> data;
 		std::reference_wrapper<heatmap_view_attributes> presentation_attributes;
 	};
 
@@ -180,7 +180,7 @@ namespace terraformer::app
 		});
 
 		parent.set_refresh_function([image = field_value.data, &imgview](){
-			imgview.show_image(image.get().pixels());
+			imgview.show_image(image.get()->pixels());
 		});
 	}
 
@@ -206,7 +206,7 @@ namespace terraformer::app
 			presentation_attributes{main_view.xsection_presentation_attributes}
 		{}
 
-		std::reference_wrapper<grayscale_image const> data;
+		std::reference_wrapper<std::shared_ptr<grayscale_image const> const> data;
 		std::reference_wrapper<domain_size_descriptor const> domain_size;
 		std::reference_wrapper<xsection_view_attributes> presentation_attributes;
 	};
@@ -276,7 +276,7 @@ namespace terraformer::app
 			box_size const dom_size{fv.domain_size.get().width, fv.domain_size.get().height, 0.0f};
 			imgview.set_physical_dimensions(dom_size);
 			imgview.set_orientation(fv.presentation_attributes.get().orientation);
-			imgview.show_image(fv.data.get().pixels());
+			imgview.show_image(fv.data.get());
 		});
 	}
 
@@ -312,7 +312,7 @@ namespace terraformer::app
 				field_value.domain_size.get().height,
 				0.0f
 			};
-			stats.show_image(field_value.data.get().pixels(), dom_size);
+			stats.show_image(field_value.data.get()->pixels(), dom_size);
 			heatmap.refresh();
 			xsection.refresh();
 		});
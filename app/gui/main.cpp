@@ -6,6 +6,7 @@
 #include "./heightmap.hpp"
 #include "./elevation_color_map.hpp"
 
+#include "lib/generators/heightmap/heightmap_preview.hpp"
 #include "lib/math_utils/computation_context.hpp"
 #include "lib/descriptor_io/descriptor_editor_ref.hpp"
 #include "ui/drawing_api/gl_surface_configuration.hpp"
@@ -21,6 +22,7 @@
 #include "ui/widgets/colorbar.hpp"
 
 #include "lib/pixel_store/image_io.hpp"
+#include "lib/pixel_store/persistent_image_cache.hpp"
 #include "lib/execution/task_receiver.hpp"
 #include "lib/execution/notifying_task.hpp"
 
@@ -135,7 +137,15 @@ int main(int, char**)
 	};
 	terraformer::dft_engine::enable_multithreading(comp_ctxt.workers);
 
-	auto output = generate(comp_ctxt, heightmap);
+	terraformer::persistent_image_cache output_cache{
+		terraformer::get_default_image_cache_directory(),
+		static_cast<size_t>(1024)*1024*1024
+	};
+
+	// NOTE: The output is shared with the views, so new results are presented without a copy
+	auto output = std::make_shared<terraformer::grayscale_image const>(
+		generate(comp_ctxt, heightmap, std::stop_token{}, &output_cache)
+	);
 
 	terraformer::app::heightmap_view_descriptor heightmap_view_info{
 		.data = std::ref(output),
@@ -158,18 +168,39 @@ int main(int, char**)
 
 	terraformer::app::bind(heightmap_view_info, heightmap_view);
 
-	terraformer::task_receiver<terraformer::move_only_function<void()>> task_receiver;
+	terraformer::task_receiver<terraformer::move_only_function<void(std::stop_token)>> task_receiver;
 
-	heightmap_form.on_content_updated([&task_receiver, &heightmap_view, &gui_ctxt, &heightmap, &heightmap_img = output, &comp_ctxt](auto&&...){
+	heightmap_form.on_content_updated([&task_receiver, &heightmap_view, &event_dispatcher, &gui_ctxt, &heightmap, &heightmap_img = output, &comp_ctxt, &output_cache](auto&&...){
 		task_receiver.replace_pending_task(
-			[heightmap, &heightmap_img, &heightmap_view, &gui_ctxt, &comp_ctxt]() {
-				auto result = generate(comp_ctxt, heightmap);
-				gui_ctxt
-					.post_event([&heightmap_img, hm = result, &heightmap_view]() mutable {
-						heightmap_img = std::move(hm);
-						heightmap_view.refresh();
-					})
-					.notify_main_loop();
+			[heightmap, &heightmap_img, &heightmap_view, &event_dispatcher, &gui_ctxt, &comp_ctxt, &output_cache](std::stop_token stop_token) {
+				auto show_stage = [&heightmap_img, &heightmap_view, &event_dispatcher, &gui_ctxt](
+					terraformer::heightmap_preview_stage,
+					terraformer::span_2d<float const> pixels
+				){
+					gui_ctxt
+						.post_event([
+							&heightmap_img,
+							hm = std::make_shared<terraformer::grayscale_image const>(pixels),
+							&heightmap_view,
+							&event_dispatcher
+						]() mutable {
+							heightmap_img = std::move(hm);
+							heightmap_view.refresh();
+							event_dispatcher.request_full_redraw();
+						})
+						.notify_main_loop();
+				};
+
+				// NOTE: The heightmap view always shows the entire heightmap, so there is no need to
+				//       set a viewport
+				auto const result = generate_progressively(
+					comp_ctxt,
+					heightmap,
+					terraformer::heightmap_preview_descriptor{},
+					std::ref(show_stage),
+					stop_token,
+					&output_cache
+				);
 				store(result, "/dev/shm/slask.exr");
 			}
 		);
@@ -0,0 +1,50 @@
+//@	{"target":{"name":"hydraulic_erosion_benchmark.o"}}
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/execution/thread_pool.hpp"
+#include "lib/filters/hydraulic_erosion.hpp"
+#include "lib/pixel_store/image.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+int main()
+{
+	constexpr uint32_t size = 4096;
+	terraformer::grayscale_image heightmap{size, size};
+	for(uint32_t y = 0; y != size; ++y)
+	{
+		for(uint32_t x = 0; x != size; ++x)
+		{
+			auto const xi = static_cast<float>(x);
+			auto const eta = static_cast<float>(y);
+			heightmap(x, y) = 512.0f*(std::sin(0.013f*xi)*std::cos(0.017f*eta) + 1.0f)
+				+ 32.0f*std::sin(0.11f*xi + 0.07f*eta);
+		}
+	}
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{
+		std::thread::hardware_concurrency()
+	};
+
+	terraformer::hydraulic_erosion_descriptor const params{
+		.droplet_count = 4*1024*1024
+	};
+
+	auto const t_start = std::chrono::steady_clock::now();
+	erode_hydraulic(heightmap.pixels(), params, workers);
+	auto const t_end = std::chrono::steady_clock::now();
+
+	auto const duration = std::chrono::duration<double>(t_end - t_start).count();
+	printf(
+		"%zu droplets on %ux%u pixels using %zu workers: %.3f s (%.0f droplets/s)\n",
+		params.droplet_count,
+		size,
+		size,
+		workers.max_concurrency(),
+		duration,
+		static_cast<double>(params.droplet_count)/duration
+	);
+}
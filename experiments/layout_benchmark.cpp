@@ -0,0 +1,158 @@
+//@	{"target":{"name":"layout_benchmark.o"}}
+
+// Measures the time it takes to update the layout of a form with N cells, after the content of
+// a single cell has been edited. The form consists of sections, with one label and one input
+// field per row, like the descriptor editor.
+//
+// Usage: layout_benchmark [cell count] [edit count]
+
+#include "ui/layouts/table.hpp"
+#include "ui/widgets/widget_group.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct null_iterator_invalidation_handler
+	{
+		void iterators_invalidated(terraformer::ui::main::widget_collection const&){}
+	};
+
+	size_t compute_size_count = 0;
+
+	/**
+	 * A cell that is as wide as its text, like a label or a text input
+	 */
+	struct text_cell:terraformer::ui::main::widget_with_default_actions
+	{
+		size_t text_length;
+
+		terraformer::box_size compute_size(terraformer::ui::main::widget_width_request)
+		{
+			++compute_size_count;
+			return terraformer::box_size{8.0f*static_cast<float>(text_length) + 4.0f, 20.0f, 1.0f};
+		}
+
+		terraformer::box_size compute_size(terraformer::ui::main::widget_height_request req)
+		{ return compute_size(terraformer::ui::main::widget_width_request{req.width}); }
+	};
+
+	using section = terraformer::ui::widgets::widget_group<terraformer::ui::layouts::table>;
+
+	struct form
+	{
+		explicit form(size_t cell_count, size_t cells_per_section, std::mt19937& rng):
+			root{
+				terraformer::ui::main::widget_collection::iterator_invalidation_handler_ref{std::ref(iihr)},
+				terraformer::ui::layouts::table::column_count{1}
+			},
+			root_collection{terraformer::ui::main::widget_collection::iterator_invalidation_handler_ref{std::ref(iihr)}},
+			cells(cell_count)
+		{
+			std::uniform_int_distribution<size_t> text_length{4, 24};
+			for(size_t k = 0; k != cell_count; ++k)
+			{
+				if(k%cells_per_section == 0)
+				{
+					sections.push_back(
+						std::make_unique<section>(
+							terraformer::ui::main::widget_collection::iterator_invalidation_handler_ref{std::ref(iihr)},
+							terraformer::ui::layouts::table::column_count{2}
+						)
+					);
+					root.append(std::ref(*sections.back()), terraformer::ui::main::widget_geometry{});
+				}
+
+				cells[k].text_length = text_length(rng);
+				sections.back()->append(std::ref(cells[k]), terraformer::ui::main::widget_geometry{});
+			}
+			root_collection.append(std::ref(root), terraformer::ui::main::widget_geometry{});
+		}
+
+		terraformer::box_size update_layout()
+		{
+			return terraformer::ui::main::update_layout(
+				root_collection.get_attributes(),
+				root_collection.element_indices().front(),
+				terraformer::box_size{1024.0f, 768.0f, 0.0f}
+			);
+		}
+
+		null_iterator_invalidation_handler iihr;
+		section root;
+		terraformer::ui::main::widget_collection root_collection;
+		std::vector<std::unique_ptr<section>> sections;
+		std::vector<text_cell> cells;
+	};
+
+	struct benchmark_result
+	{
+		double time_per_edit;
+		double compute_size_calls_per_edit;
+	};
+
+	/**
+	 * Edits a random cell, and updates the layout, edit_count times. If relayout_everything is
+	 * true, the size requests of all widgets are invalidated after each edit, which is how the
+	 * layout was updated before size requests were cached.
+	 */
+	benchmark_result run_benchmark(form& f, size_t edit_count, bool relayout_everything, std::mt19937& rng)
+	{
+		std::uniform_int_distribution<size_t> cell_index{0, std::size(f.cells) - 1};
+		std::uniform_int_distribution<size_t> text_length{4, 24};
+
+		// Size requests are computed for all widgets the first time
+		f.update_layout();
+
+		compute_size_count = 0;
+		auto checksum = 0.0f;
+		auto const t_start = std::chrono::steady_clock::now();
+		for(size_t k = 0; k != edit_count; ++k)
+		{
+			auto& cell = f.cells[cell_index(rng)];
+			cell.text_length = text_length(rng);
+			if(relayout_everything)
+			{ terraformer::ui::main::invalidate_size_requests(f.root_collection.get_attributes()); }
+			else
+			{ terraformer::ui::main::invalidate_size_request(f.root_collection.get_attributes(), &cell); }
+			checksum += f.update_layout()[0];
+		}
+		auto const t_end = std::chrono::steady_clock::now();
+
+		// Prevent the compiler from removing the layout updates
+		if(checksum < 0.0f)
+		{ puts(""); }
+
+		return benchmark_result{
+			.time_per_edit = std::chrono::duration<double>(t_end - t_start).count()/static_cast<double>(edit_count),
+			.compute_size_calls_per_edit = static_cast<double>(compute_size_count)/static_cast<double>(edit_count)
+		};
+	}
+}
+
+int main(int argc, char** argv)
+{
+	auto const cell_count = argc > 1? static_cast<size_t>(std::stoull(argv[1])) : size_t{5000};
+	auto const edit_count = argc > 2? static_cast<size_t>(std::stoull(argv[2])) : size_t{1000};
+
+	std::mt19937 rng;
+	form f{cell_count, 100, rng};
+
+	auto const report = [cell_count](char const* mode, benchmark_result const& result) {
+		printf(
+			"%zu cells, %s: %.3f ms/edit (%.0f size requests/edit)\n",
+			cell_count,
+			mode,
+			1.0e3*result.time_per_edit,
+			result.compute_size_calls_per_edit
+		);
+	};
+
+	report("relayout everything", run_benchmark(f, edit_count, true, rng));
+	report("relayout dirty path", run_benchmark(f, edit_count, false, rng));
+}
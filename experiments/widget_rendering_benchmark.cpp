@@ -0,0 +1,246 @@
+//@	{"target":{"name":"widget_rendering_benchmark.o"}}
+
+// Measures the time it takes to draw a frame with N widgets, using gl_widget_layer_stack_renderer.
+//
+// Usage: widget_rendering_benchmark [widget count] [frame count]
+//
+// To run it on llvmpipe, which only reports OpenGL 4.5, use
+//
+//     LIBGL_ALWAYS_SOFTWARE=1 MESA_GL_VERSION_OVERRIDE=4.6 MESA_GLSL_VERSION_OVERRIDE=460
+
+#include "ui/drawing_api/gl_surface_configuration.hpp"
+#include "ui/drawing_api/gl_resource_factory.hpp"
+#include "ui/drawing_api/gl_widget_stack_renderer.hpp"
+#include "ui/wsapi/native_window.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct widget_instance
+	{
+		terraformer::location where;
+		terraformer::scaling scale;
+		terraformer::ui::main::widget_layer_stack layers;
+	};
+
+	terraformer::image make_texture(std::mt19937& rng, uint32_t width, uint32_t height)
+	{
+		std::uniform_real_distribution<float> intensity{0.0f, 1.0f};
+		terraformer::image ret{width, height};
+		for(uint32_t y = 0; y != height; ++y)
+		{
+			for(uint32_t x = 0; x != width; ++x)
+			{
+				auto const alpha = intensity(rng);
+				ret(x, y) = terraformer::rgba_pixel{
+					alpha*intensity(rng),
+					alpha*intensity(rng),
+					alpha*intensity(rng),
+					alpha
+				};
+			}
+		}
+		return ret;
+	}
+
+	/**
+	 * Widgets are laid out in a grid that covers the window. Each widget has its own background,
+	 * foreground, and frame, and shares the remaining layers, like most widgets in a form.
+	 */
+	std::vector<widget_instance> make_widgets(
+		size_t count,
+		terraformer::ui::main::fb_size size,
+		std::span<terraformer::ui::main::texture> textures,
+		terraformer::ui::main::texture_ref null_texture
+	)
+	{
+		using terraformer::rgba_pixel;
+		using terraformer::displacement;
+		using terraformer::ui::main::widget_layer;
+
+		auto const cols = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+		auto const rows = (count + cols - 1)/cols;
+		auto const cell_width = static_cast<float>(size.width)/static_cast<float>(cols);
+		auto const cell_height = static_cast<float>(size.height)/static_cast<float>(rows);
+
+		auto const tint = rgba_pixel{1.0f, 1.0f, 1.0f, 1.0f};
+		auto const tints = std::array{tint, tint, tint, tint};
+		std::vector<widget_instance> ret;
+		for(size_t k = 0; k != count; ++k)
+		{
+			auto const texture = [&textures, k](size_t layer) {
+				return textures[(3*k + layer)%std::size(textures)].get();
+			};
+
+			ret.push_back(widget_instance{
+				.where = terraformer::location{
+					static_cast<float>(k%cols)*cell_width,
+					-static_cast<float>(k/cols)*cell_height,
+					0.0f
+				},
+				.scale = terraformer::scaling{cell_width - 1.0f, cell_height - 1.0f, 1.0f},
+				.layers{
+					.background = widget_layer{
+						.offset = displacement{},
+						.rotation = geosimd::turn_angle{},
+						.texture = texture(0),
+						.tints = tints
+					},
+					.sel_bg_mask{
+						.offset = displacement{},
+						.texture = null_texture
+					},
+					.selection_background = widget_layer{
+						.offset = displacement{},
+						.rotation = geosimd::turn_angle{},
+						.texture = null_texture,
+						.tints = std::array<rgba_pixel, 4>{}
+					},
+					.foreground = widget_layer{
+						.offset = displacement{2.0f, 2.0f, 0.0f},
+						.rotation = geosimd::turn_angle{},
+						.texture = texture(1),
+						.tints = tints
+					},
+					.frame = widget_layer{
+						.offset = displacement{},
+						.rotation = geosimd::turn_angle{},
+						.texture = texture(2),
+						.tints = tints
+					},
+					.input_marker = widget_layer{
+						.offset = displacement{},
+						.rotation = geosimd::turn_angle{},
+						.texture = null_texture,
+						.tints = std::array<rgba_pixel, 4>{}
+					},
+					.background_color_mapping{},
+					.text{}
+				}
+			});
+		}
+		return ret;
+	}
+
+	/**
+	 * Returns the average frame time in seconds. If flush_every_widget is true, every widget is
+	 * drawn by a separate draw call, which is close to how widgets were drawn before batching.
+	 */
+	double run_benchmark(
+		terraformer::ui::wsapi::native_window<terraformer::ui::drawing_api::gl_surface_configuration>& window,
+		terraformer::ui::drawing_api::gl_widget_layer_stack_renderer& renderer,
+		std::span<widget_instance const> widgets,
+		size_t frame_count,
+		bool flush_every_widget
+	)
+	{
+		auto const size = window.get_fb_size();
+		renderer.set_viewport(0, 0, size.width, size.height)
+			.set_world_transform(terraformer::location{-1.0f, 1.0f, 0.0f}, size);
+
+		auto const draw_frame = [&]() {
+			renderer.clear_buffers();
+			for(auto const& item : widgets)
+			{
+				renderer.render(item.where, terraformer::location{-1.0f, 1.0f, 0.0f}, item.scale, item.layers);
+				if(flush_every_widget)
+				{ renderer.flush(); }
+			}
+			renderer.flush();
+			window.swap_buffers();
+			glFinish();
+		};
+
+		// Let the driver compile shaders and allocate buffers before measuring
+		draw_frame();
+
+		auto const t_start = std::chrono::steady_clock::now();
+		for(size_t k = 0; k != frame_count; ++k)
+		{ draw_frame(); }
+		auto const t_end = std::chrono::steady_clock::now();
+
+		return std::chrono::duration<double>(t_end - t_start).count()/static_cast<double>(frame_count);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	auto const widget_count = argc > 1? static_cast<size_t>(std::stoull(argv[1])) : size_t{4096};
+	auto const frame_count = argc > 2? static_cast<size_t>(std::stoull(argv[2])) : size_t{100};
+
+	auto& gui_ctxt = terraformer::ui::wsapi::context::get_instance();
+	terraformer::ui::wsapi::native_window mainwin{
+		gui_ctxt,
+		"Widget rendering benchmark",
+		terraformer::ui::drawing_api::gl_surface_configuration{
+			.api_version{
+				.major = 4,
+				.minor = 6
+			},
+			.multisampling = 0,
+			.buffer_swap_interval = 0
+		},
+		terraformer::ui::wsapi::window_configuration{
+			.geometry{
+				.width = 1024,
+				.height = 768
+			}
+		}
+	};
+
+	glEnable(GL_CULL_FACE);
+	glEnable(GL_BLEND);
+	glBlendEquationSeparate(GL_FUNC_ADD, GL_FUNC_ADD);
+	glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+	using terraformer::ui::drawing_api::gl_resource_factory;
+	std::mt19937 rng;
+	auto null_texture = gl_resource_factory::create(
+		std::type_identity<terraformer::ui::main::texture>{},
+		0,
+		terraformer::image{1, 1}
+	);
+	std::vector<terraformer::ui::main::texture> textures;
+	for(size_t k = 0; k != 256; ++k)
+	{
+		textures.push_back(
+			gl_resource_factory::create(
+				std::type_identity<terraformer::ui::main::texture>{},
+				0,
+				make_texture(rng, 16, 16)
+			)
+		);
+	}
+
+	auto const widgets = make_widgets(widget_count, mainwin.get_fb_size(), textures, null_texture.get());
+
+	auto const report = [widget_count](char const* mode, double frame_time) {
+		printf(
+			"%zu widgets, %s: %.3f ms/frame (%.0f widgets/s)\n",
+			widget_count,
+			mode,
+			1.0e3*frame_time,
+			static_cast<double>(widget_count)/frame_time
+		);
+	};
+
+	{
+		terraformer::ui::drawing_api::gl_widget_layer_stack_renderer renderer{false};
+		report("one draw per widget", run_benchmark(mainwin, renderer, widgets, frame_count, true));
+		report("batched, texture units", run_benchmark(mainwin, renderer, widgets, frame_count, false));
+	}
+
+	if(GLEW_ARB_bindless_texture)
+	{
+		terraformer::ui::drawing_api::gl_widget_layer_stack_renderer renderer{true};
+		report("batched, bindless textures", run_benchmark(mainwin, renderer, widgets, frame_count, false));
+	}
+	else
+	{ printf("GL_ARB_bindless_texture is not supported\n"); }
+}
@@ -0,0 +1,90 @@
+#ifndef TERRAFORMER_FNV1A_HASH_HPP
+#define TERRAFORMER_FNV1A_HASH_HPP
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace terraformer
+{
+	/**
+	 * Incremental 128-bit FNV-1a hash. The digest only depends on the bytes fed to the hasher, so
+	 * it is stable between runs. Multi-byte values are fed in little-endian order, so the digest
+	 * is the same on all platforms.
+	 *
+	 * \note This is not a cryptographic hash
+	 */
+	class fnv1a_128
+	{
+	public:
+		using digest_type = std::array<std::byte, 16>;
+
+		void update(std::span<std::byte const> bytes)
+		{
+			for(auto const item : bytes)
+			{
+				m_state ^= static_cast<uint8_t>(item);
+				m_state *= prime;
+			}
+		}
+
+		template<class T>
+		requires(std::is_arithmetic_v<T>)
+		void update(T value)
+		{
+			auto bytes = std::bit_cast<std::array<std::byte, sizeof(T)>>(value);
+			if constexpr(std::endian::native == std::endian::big)
+			{ std::ranges::reverse(bytes); }
+			update(std::span<std::byte const>{bytes});
+		}
+
+		template<class CharType>
+		void update(std::basic_string_view<CharType> str)
+		{
+			// Prefix with length, so that the boundary between consecutive strings is part of
+			// the digest
+			update(static_cast<uint64_t>(std::size(str)));
+			for(auto const item : str)
+			{ update(item); }
+		}
+
+		digest_type digest() const
+		{
+			digest_type ret;
+			auto state = m_state;
+			for(size_t k = 0; k != std::size(ret); ++k)
+			{
+				ret[k] = static_cast<std::byte>(state & 0xff);
+				state >>= 8;
+			}
+			return ret;
+		}
+
+	private:
+		static constexpr unsigned __int128 prime = (static_cast<unsigned __int128>(1) << 88) + 0x13b;
+		unsigned __int128 m_state =
+			(static_cast<unsigned __int128>(0x6c62272e07bb0142ull) << 64) | 0x62b821756295c58dull;
+	};
+
+	inline std::string to_hex_string(std::span<std::byte const> bytes)
+	{
+		constexpr std::string_view digits{"0123456789abcdef"};
+		std::string ret;
+		ret.reserve(2*std::size(bytes));
+		for(auto const item : bytes)
+		{
+			auto const val = static_cast<uint8_t>(item);
+			ret.push_back(digits[val >> 4]);
+			ret.push_back(digits[val & 0xf]);
+		}
+		return ret;
+	}
+}
+
+#endif
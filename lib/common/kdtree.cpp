@@ -2,53 +2,236 @@
 
 #include "./kdtree.hpp"
 
+#include "lib/execution/batch_result.hpp"
+
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
-terraformer::kdtree_2d_node::kdtree_2d_node(std::span<location> locs, size_t level)
+namespace
 {
-	std::ranges::nth_element(locs, locs.begin() + std::size(locs)/2, [dim = level % 2](auto a, auto b){
-		return a[dim] < b[dim];
-	});
-	loc = locs[std::size(locs)/2];
-	auto const left_span = locs.subspan(0, std::size(locs)/2);
-	auto const right_span = locs.subspan(std::size(locs)/2 + 1);
-	if(std::size(left_span) != 0)
-	{ left = std::make_unique<kdtree_2d_node>(left_span, level + 1); }
-
-	if(std::size(right_span) != 0)
-	{ right = std::make_unique<kdtree_2d_node>(right_span, level + 1); }
-}
+	struct subtree
+	{
+		std::span<terraformer::location> points;
+		size_t level;
+	};
 
+	void partition(subtree item)
+	{
+		auto const locs = item.points;
+		std::ranges::nth_element(locs, locs.begin() + std::size(locs)/2, [dim = item.level % 2](auto a, auto b){
+			return a[dim] < b[dim];
+		});
+	}
 
-terraformer::point_and_distance terraformer::kdtree_2d_node::closest_point(location target, size_t level) const
-{
-	point_and_distance current_best{
-		.loc = loc,
-		.distance = distance_xy(loc, target)
+	void build(subtree item)
+	{
+		if(std::size(item.points) <= 1)
+		{ return; }
+
+		partition(item);
+		auto const mid = std::size(item.points)/2;
+		build(subtree{item.points.subspan(0, mid), item.level + 1});
+		build(subtree{item.points.subspan(mid + 1), item.level + 1});
+	}
+
+	auto distance_xy_squared(terraformer::location a, terraformer::location b)
+	{
+		auto const dx = a[0] - b[0];
+		auto const dy = a[1] - b[1];
+		return dx*dx + dy*dy;
+	}
+
+	template<class Visitor>
+	void search(std::span<terraformer::location const> points, size_t level, terraformer::location target, Visitor& visitor)
+	{
+		if(points.empty())
+		{ return; }
+
+		auto const mid = std::size(points)/2;
+		auto const loc = points[mid];
+		visitor.visit(loc, distance_xy_squared(loc, target));
+
+		auto const dim = level % 2;
+		auto const delta = target[dim] - loc[dim];
+		auto const left = points.subspan(0, mid);
+		auto const right = points.subspan(mid + 1);
+
+		search(delta < 0.0f? left : right, level + 1, target, visitor);
+		if(delta*delta <= visitor.squared_search_radius())
+		{ search(delta < 0.0f? right : left, level + 1, target, visitor); }
+	}
+
+	struct closest_point_visitor
+	{
+		terraformer::location loc{};
+		float distance_squared = std::numeric_limits<float>::infinity();
+
+		void visit(terraformer::location candidate, float d2)
+		{
+			if(d2 < distance_squared)
+			{
+				loc = candidate;
+				distance_squared = d2;
+			}
+		}
+
+		float squared_search_radius() const
+		{ return distance_squared; }
 	};
 
-	auto const dim = level % 2;
-	auto const recursion = target[dim] < loc[dim]?
-		 std::pair{left.get(), right.get()}:
-		 std::pair{right.get(), left.get()};
+	struct closest_points_visitor
+	{
+		// NOTE: Max-heap ordered by distance, so the worst candidate is the first element
+		std::vector<terraformer::point_and_distance> candidates;
+		size_t k;
+
+		static bool compare(terraformer::point_and_distance const& a, terraformer::point_and_distance const& b)
+		{ return a.distance < b.distance; }
+
+		void visit(terraformer::location candidate, float d2)
+		{
+			if(std::size(candidates) < k)
+			{
+				candidates.push_back(terraformer::point_and_distance{candidate, d2});
+				std::ranges::push_heap(candidates, compare);
+				return;
+			}
+
+			if(d2 < candidates.front().distance)
+			{
+				std::ranges::pop_heap(candidates, compare);
+				candidates.back() = terraformer::point_and_distance{candidate, d2};
+				std::ranges::push_heap(candidates, compare);
+			}
+		}
 
+		float squared_search_radius() const
+		{
+			return std::size(candidates) < k?
+				std::numeric_limits<float>::infinity() :
+				candidates.front().distance;
+		}
+	};
+
+	struct points_within_visitor
 	{
-		auto const new_best = recursion.first != nullptr?
-			recursion.first->closest_point(target, level + 1):
-			current_best;
+		std::vector<terraformer::point_and_distance> points;
+		float radius_squared;
+
+		void visit(terraformer::location candidate, float d2)
+		{
+			if(d2 <= radius_squared)
+			{ points.push_back(terraformer::point_and_distance{candidate, d2}); }
+		}
 
-		if(new_best.distance < current_best.distance)
-		{ current_best = new_best; }
+		float squared_search_radius() const
+		{ return radius_squared; }
+	};
+}
+
+terraformer::kdtree_2d::kdtree_2d(std::vector<location>&& locs):
+	m_points{std::move(locs)}
+{ build(subtree{m_points, 0}); }
+
+terraformer::kdtree_2d::kdtree_2d(
+	std::vector<location>&& locs,
+	thread_pool<move_only_function<void()>>& workers
+):
+	m_points{std::move(locs)}
+{
+	std::vector<subtree> subtrees{subtree{m_points, 0}};
+	while(std::size(subtrees) < workers.max_concurrency())
+	{
+		std::vector<subtree> next;
+		for(auto item : subtrees)
+		{
+			if(std::size(item.points) <= 1)
+			{ continue; }
+
+			partition(item);
+			auto const mid = std::size(item.points)/2;
+			next.push_back(subtree{item.points.subspan(0, mid), item.level + 1});
+			next.push_back(subtree{item.points.subspan(mid + 1), item.level + 1});
+		}
+
+		if(next.empty())
+		{ return; }
+
+		subtrees = std::move(next);
 	}
 
-	if(std::abs(target[dim] - loc[dim]) < current_best.distance)
+	batch_result<void> pending_subtrees{std::size(subtrees)};
+	for(auto item : subtrees)
 	{
-		auto const new_best = recursion.second != nullptr?
-			recursion.second->closest_point(target, level + 1):
-			current_best;
-		if(new_best.distance < current_best.distance)
-		{ current_best = new_best; }
+		workers.submit([item, &state = pending_subtrees.get_state()](){
+			build(item);
+			state.mark_batch_as_completed();
+		});
 	}
+	pending_subtrees.wait();
+}
 
-	return current_best;
-}
\ No newline at end of file
+terraformer::point_and_distance terraformer::kdtree_2d::closest_point(location loc) const
+{
+	closest_point_visitor visitor{};
+	search(std::span{m_points}, 0, loc, visitor);
+	return point_and_distance{
+		.loc = visitor.loc,
+		.distance = std::sqrt(visitor.distance_squared)
+	};
+}
+
+std::vector<terraformer::point_and_distance>
+terraformer::kdtree_2d::closest_points(location loc, size_t k) const
+{
+	closest_points_visitor visitor{};
+	visitor.k = k;
+	visitor.candidates.reserve(k);
+	if(k != 0)
+	{ search(std::span{m_points}, 0, loc, visitor); }
+
+	std::ranges::sort_heap(visitor.candidates, closest_points_visitor::compare);
+	for(auto& item : visitor.candidates)
+	{ item.distance = std::sqrt(item.distance); }
+
+	return std::move(visitor.candidates);
+}
+
+std::vector<terraformer::point_and_distance>
+terraformer::kdtree_2d::points_within(location loc, float radius) const
+{
+	points_within_visitor visitor{};
+	visitor.radius_squared = radius*radius;
+	search(std::span{m_points}, 0, loc, visitor);
+
+	for(auto& item : visitor.points)
+	{ item.distance = std::sqrt(item.distance); }
+
+	return std::move(visitor.points);
+}
+
+void terraformer::compute_closest_point_distances(
+	scanline_processing_job_info const& jobinfo,
+	span_2d<float> output,
+	kdtree_2d const& tree,
+	float pixel_size
+)
+{
+	auto const w = output.width();
+	auto const h = output.height();
+	auto const input_y_offset = jobinfo.input_y_offset;
+
+	for(uint32_t y = 0; y != h; ++y)
+	{
+		for(uint32_t x = 0; x != w; ++x)
+		{
+			location const loc{
+				pixel_size*static_cast<float>(x),
+				pixel_size*static_cast<float>(y + input_y_offset),
+				0.0f
+			};
+			output(x, y) = tree.closest_point(loc).distance;
+		}
+	}
+}
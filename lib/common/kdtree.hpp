@@ -4,8 +4,12 @@
 #define TERRAFORMER_KDTREE_HPP
 
 #include "./spaces.hpp"
+#include "./span_2d.hpp"
+#include "./move_only_function.hpp"
 
-#include <memory>
+#include "lib/execution/thread_pool.hpp"
+
+#include <span>
 #include <vector>
 
 namespace terraformer
@@ -16,45 +20,86 @@ namespace terraformer
 		float distance;
 	};
 
-	struct kdtree_2d_node
+	/**
+	 * A 2d tree stored implicitly in a single array. The node of a subtree [begin, end) is the
+	 * element at begin + (end - begin)/2. Elements before the node belong to the left subtree, and
+	 * elements after the node belong to the right subtree.
+	 */
+	class kdtree_2d
 	{
-		explicit kdtree_2d_node(std::span<location> locs, size_t level);
+	public:
+		explicit kdtree_2d(std::vector<location>&& locs);
 
-		location loc;
-		std::unique_ptr<kdtree_2d_node> left;
-		std::unique_ptr<kdtree_2d_node> right;
+		/**
+		 * Builds the tree using workers. The top levels are partitioned on the calling thread,
+		 * until there is one subtree per worker. The remaining subtrees are built concurrently.
+		 */
+		explicit kdtree_2d(std::vector<location>&& locs, thread_pool<move_only_function<void()>>& workers);
 
 		template<class Callable>
 		void visit_nodes(Callable const& cb) const
-		{
-			cb(loc);
-			if(left != nullptr)
-			{ left->visit_nodes(cb); }
-			if(right != nullptr)
-			{ right->visit_nodes(cb); }
-		}
+		{ visit_nodes(std::span{m_points}, cb); }
 
-		point_and_distance closest_point(location target, size_t level) const;
-	};
+		point_and_distance closest_point(location loc) const;
 
+		/**
+		 * Returns the k closest points, sorted by distance
+		 */
+		std::vector<point_and_distance> closest_points(location loc, size_t k) const;
 
-	class kdtree_2d
-	{
-	public:
-		explicit kdtree_2d(std::vector<location>&& locs):
-			m_root{locs, 0}
-		{}
+		/**
+		 * Returns all points within radius from loc, in no particular order
+		 */
+		std::vector<point_and_distance> points_within(location loc, float radius) const;
 
-		template<class Callable>
-		void visit_nodes(Callable const& cb) const
-		{ m_root.visit_nodes(cb); }
-
-		point_and_distance closest_point(location loc) const
-		{ return m_root.closest_point(loc, 0); }
+		std::span<location const> points() const
+		{ return m_points; }
 
 	private:
-		kdtree_2d_node m_root;
+		std::vector<location> m_points;
+
+		template<class Callable>
+		static void visit_nodes(std::span<location const> points, Callable const& cb)
+		{
+			if(points.empty())
+			{ return; }
+
+			auto const mid = std::size(points)/2;
+			cb(points[mid]);
+			visit_nodes(points.subspan(0, mid), cb);
+			visit_nodes(points.subspan(mid + 1), cb);
+		}
 	};
+
+	void compute_closest_point_distances(
+		scanline_processing_job_info const& jobinfo,
+		span_2d<float> output,
+		kdtree_2d const& tree,
+		float pixel_size
+	);
+
+	/**
+	 * Stores the distance to the closest point in tree for every pixel in output. The pixel (x, y)
+	 * is located at (x*pixel_size, y*pixel_size).
+	 */
+	[[nodiscard]] inline auto compute_closest_point_distances(
+		span_2d<float> output,
+		thread_pool<move_only_function<void()>>& workers,
+		kdtree_2d const& tree,
+		float pixel_size
+	)
+	{
+		return process_scanlines(
+			output,
+			workers,
+			std::stop_token{},
+			[]<class ... Args>(Args&&... args){
+				compute_closest_point_distances(std::forward<Args>(args)...);
+			},
+			std::cref(tree),
+			pixel_size
+		);
+	}
 }
 
-#endif
\ No newline at end of file
+#endif
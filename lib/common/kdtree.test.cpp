@@ -2,8 +2,13 @@
 
 #include "./kdtree.hpp"
 
+#include "lib/pixel_store/image.hpp"
+
 #include <testfwk/testfwk.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 TESTCASE(terraformer_kdtree_2d_build_from_one_point)
 {
 	std::vector const points{
@@ -78,4 +83,100 @@ TESTCASE(terraformer_kdtree_2d_build_and_search)
 		auto const res = tree.closest_point(terraformer::location{6.9f, 7.0f, 0.0f});
 		EXPECT_EQ(res.loc, (terraformer::location{9.0f, 6.0f, 0.0f}));
 	}
-}
\ No newline at end of file
+}
+
+namespace
+{
+	auto make_test_points()
+	{
+		std::vector<terraformer::location> ret;
+		for(int k = 0; k != 257; ++k)
+		{
+			auto const t = static_cast<float>(k);
+			ret.push_back(terraformer::location{std::fmod(37.0f*t, 101.0f), std::fmod(53.0f*t, 89.0f), 0.0f});
+		}
+		return ret;
+	}
+
+	auto brute_force_distances(std::vector<terraformer::location> const& points, terraformer::location loc)
+	{
+		std::vector<float> ret;
+		for(auto const& item : points)
+		{ ret.push_back(terraformer::distance_xy(item, loc)); }
+		std::ranges::sort(ret);
+		return ret;
+	}
+}
+
+TESTCASE(terraformer_kdtree_2d_closest_points)
+{
+	auto const points = make_test_points();
+	terraformer::kdtree_2d tree{std::vector{points}};
+
+	for(int k = 0; k != 16; ++k)
+	{
+		terraformer::location const loc{7.0f*static_cast<float>(k), 5.5f*static_cast<float>(k), 0.0f};
+		auto const expected = brute_force_distances(points, loc);
+
+		EXPECT_EQ(tree.closest_point(loc).distance, expected[0]);
+
+		auto const res = tree.closest_points(loc, 5);
+		EXPECT_EQ(std::size(res), 5);
+		for(size_t l = 0; l != std::size(res); ++l)
+		{
+			EXPECT_EQ(res[l].distance, expected[l]);
+			EXPECT_EQ(terraformer::distance_xy(res[l].loc, loc), res[l].distance);
+		}
+	}
+
+	EXPECT_EQ(std::size(tree.closest_points(terraformer::location{}, 1024)), std::size(points));
+	EXPECT_EQ(std::size(tree.closest_points(terraformer::location{}, 0)), 0);
+}
+
+TESTCASE(terraformer_kdtree_2d_points_within)
+{
+	auto const points = make_test_points();
+	terraformer::kdtree_2d tree{std::vector{points}};
+
+	terraformer::location const loc{50.0f, 40.0f, 0.0f};
+	auto const expected = brute_force_distances(points, loc);
+	auto res = tree.points_within(loc, 20.0f);
+	std::ranges::sort(res, [](auto const& a, auto const& b){ return a.distance < b.distance; });
+
+	auto const expected_count = static_cast<size_t>(
+		std::ranges::upper_bound(expected, 20.0f) - std::begin(expected)
+	);
+	EXPECT_EQ(std::size(res), expected_count);
+	for(size_t k = 0; k != std::size(res); ++k)
+	{ EXPECT_EQ(res[k].distance, expected[k]); }
+}
+
+TESTCASE(terraformer_kdtree_2d_parallel_build_same_as_serial_build)
+{
+	auto const points = make_test_points();
+	terraformer::kdtree_2d const serial{std::vector{points}};
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	terraformer::kdtree_2d const parallel{std::vector{points}, workers};
+
+	EXPECT_EQ(std::ranges::equal(serial.points(), parallel.points()), true);
+}
+
+TESTCASE(terraformer_kdtree_2d_compute_closest_point_distances_fewer_scanlines_than_workers)
+{
+	auto const points = make_test_points();
+	terraformer::kdtree_2d const tree{std::vector{points}};
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{8};
+	terraformer::grayscale_image output{16, 3};
+	compute_closest_point_distances(output.pixels(), workers, tree, 4.0f).wait();
+
+	for(uint32_t y = 0; y != output.height(); ++y)
+	{
+		for(uint32_t x = 0; x != output.width(); ++x)
+		{
+			terraformer::location const loc{4.0f*static_cast<float>(x), 4.0f*static_cast<float>(y), 0.0f};
+			EXPECT_EQ(output(x, y), tree.closest_point(loc).distance);
+		}
+	}
+}
@@ -0,0 +1,82 @@
+#ifndef TERRAFORMER_POLYLINE_STORE_HPP
+#define TERRAFORMER_POLYLINE_STORE_HPP
+
+#include "./spaces.hpp"
+
+#include <cassert>
+#include <span>
+#include <vector>
+
+namespace terraformer
+{
+	/**
+	 * Stores many polylines in one contiguous array of points. Each point has an associated value,
+	 * such as the slope at that point. Polylines can only be appended, either one at a time, or
+	 * as a whole store.
+	 */
+	class polyline_store
+	{
+	public:
+		struct polyline
+		{
+			std::span<location const> points;
+			std::span<float const> values;
+		};
+
+		polyline_store():m_offsets{0}
+		{}
+
+		void push_back(location point, float value)
+		{
+			m_points.push_back(point);
+			m_values.push_back(value);
+		}
+
+		/**
+		 * Ends the current polyline. All points pushed since the previous call belong to the
+		 * ended polyline.
+		 */
+		void end_polyline()
+		{ m_offsets.push_back(std::size(m_points)); }
+
+		void append(polyline_store const& other)
+		{
+			assert(m_offsets.back() == std::size(m_points));
+			auto const offset = std::size(m_points);
+			m_points.insert(std::end(m_points), std::begin(other.m_points), std::end(other.m_points));
+			m_values.insert(std::end(m_values), std::begin(other.m_values), std::end(other.m_values));
+			for(size_t k = 1; k != std::size(other.m_offsets); ++k)
+			{ m_offsets.push_back(offset + other.m_offsets[k]); }
+		}
+
+		void reserve(size_t polyline_count, size_t point_count)
+		{
+			m_offsets.reserve(polyline_count + 1);
+			m_points.reserve(point_count);
+			m_values.reserve(point_count);
+		}
+
+		size_t size() const
+		{ return std::size(m_offsets) - 1; }
+
+		size_t point_count() const
+		{ return std::size(m_points); }
+
+		polyline operator[](size_t k) const
+		{
+			auto const begin = m_offsets[k];
+			auto const length = m_offsets[k + 1] - begin;
+			return polyline{
+				.points = std::span{m_points}.subspan(begin, length),
+				.values = std::span{m_values}.subspan(begin, length)
+			};
+		}
+
+	private:
+		std::vector<size_t> m_offsets;
+		std::vector<location> m_points;
+		std::vector<float> m_values;
+	};
+}
+
+#endif
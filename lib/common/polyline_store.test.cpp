@@ -0,0 +1,27 @@
+//@	{"target":{"name":"polyline_store.test"}}
+
+#include "./polyline_store.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+TESTCASE(terraformer_polyline_store_append)
+{
+	terraformer::polyline_store a;
+	a.push_back(terraformer::location{1.0f, 2.0f, 3.0f}, 1.0f);
+	a.end_polyline();
+	a.end_polyline();
+
+	terraformer::polyline_store b;
+	b.push_back(terraformer::location{4.0f, 5.0f, 6.0f}, 2.0f);
+	b.push_back(terraformer::location{7.0f, 8.0f, 9.0f}, 3.0f);
+	b.end_polyline();
+
+	a.append(b);
+	EXPECT_EQ(a.size(), 3);
+	EXPECT_EQ(a.point_count(), 3);
+	EXPECT_EQ(std::size(a[0].points), 1);
+	EXPECT_EQ(std::size(a[1].points), 0);
+	EXPECT_EQ(std::size(a[2].points), 2);
+	EXPECT_EQ(a[2].points[1][0], 7.0f);
+	EXPECT_EQ(a[2].values[1], 3.0f);
+}
@@ -15,6 +15,7 @@
 #include <algorithm>
 #include <ranges>
 #include <cassert>
+#include <stop_token>
 
 namespace terraformer
 {
@@ -56,6 +57,26 @@ namespace terraformer
 		return std::sqrt(w*w + h*h);
 	}
 
+	/**
+	 * A rectangular set of pixels. The end coordinates are not included.
+	 */
+	struct pixel_region
+	{
+		uint32_t x_begin;
+		uint32_t y_begin;
+		uint32_t x_end;
+		uint32_t y_end;
+
+		constexpr bool operator==(pixel_region const&) const = default;
+		constexpr bool operator!=(pixel_region const&) const = default;
+	};
+
+	constexpr uint32_t width(pixel_region region)
+	{ return region.x_end - region.x_begin; }
+
+	constexpr uint32_t height(pixel_region region)
+	{ return region.y_end - region.y_begin; }
+
 	template<class T>
 	class span_2d
 	{
@@ -343,6 +364,7 @@ namespace terraformer
 	};
 
 	template<class Span2dExtents, class ThreadPool, class Callback, class ... Args>
+	requires(!std::is_same_v<std::remove_cvref_t<Callback>, std::stop_token>)
 	[[nodiscard]] auto process_scanlines(
 		Span2dExtents domain,
 		ThreadPool& workers,
@@ -387,6 +409,58 @@ namespace terraformer
 		return ret;
 	}
 
+	/**
+	 * Cancellable version of process_scanlines. The domain is split into more chunks than there
+	 * are workers, and chunks that have not started when a stop is requested are skipped. Unlike
+	 * the non-cancellable version, it works for domains with fewer scanlines than workers. Callers
+	 * must check stop_token after waiting for the result, since the output is incomplete if a stop
+	 * was requested.
+	 */
+	template<class Span2dExtents, class ThreadPool, class Callback, class ... Args>
+	[[nodiscard]] auto process_scanlines(
+		Span2dExtents domain,
+		ThreadPool& workers,
+		std::stop_token stop_token,
+		Callback&& cb,
+		Args&&... args
+	)
+	{
+		using callback_ret_type = decltype(cb(scanline_processing_job_info{}, domain, args...));
+		static_assert(std::is_same_v<callback_ret_type, void>);
+
+		auto const n_chunks = std::min(static_cast<size_t>(height(domain)), 4*workers.max_concurrency());
+		batch_result<void> ret{n_chunks};
+		if(n_chunks == 0)
+		{ return ret; }
+
+		for(auto chunk: chunk_by_chunk_count_view{std::ranges::iota_view{0u, height(domain)}, n_chunks})
+		{
+			workers.submit(
+				[
+					cb,
+					stop_token,
+					jobinfo = scanline_processing_job_info{
+						.input_y_offset = chunk.front(),
+						.total_height = height(domain)
+					},
+					subdomain = domain.scanlines(
+						scanline_range{
+							.begin = chunk.front(),
+							.end = chunk.back() + 1
+						}
+					),
+					... args = args,
+					&ret = ret.get_state()
+				]() mutable {
+					if(!stop_token.stop_requested())
+					{ cb(jobinfo, subdomain, std::move(args)...); }
+					ret.mark_batch_as_completed();
+				}
+			);
+		}
+		return ret;
+	}
+
 	template<class JobInfo, class OutputType, class InputType>
 	void multiply_assign(
 		JobInfo const& jobinfo,
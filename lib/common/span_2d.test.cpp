@@ -2,7 +2,63 @@
 
 #include "./span_2d.hpp"
 #include "./utils.hpp"
+#include "./move_only_function.hpp"
+#include "lib/execution/thread_pool.hpp"
 
 #include "testfwk/testfwk.hpp"
 
-static_assert(terraformer::map_2d<terraformer::span_2d<float const>, float>);
\ No newline at end of file
+#include <vector>
+
+static_assert(terraformer::map_2d<terraformer::span_2d<float const>, float>);
+
+TESTCASE(terraformer_span_2d_process_scanlines_with_stop_token)
+{
+	std::vector<float> buffer(37*23);
+	terraformer::span_2d<float> pixels{37, 23, buffer.data()};
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const fill = [](terraformer::scanline_processing_job_info const& jobinfo, terraformer::span_2d<float> output){
+		for(uint32_t y = 0; y != output.height(); ++y)
+		{
+			for(uint32_t x = 0; x != output.width(); ++x)
+			{ output(x, y) = static_cast<float>(y + jobinfo.input_y_offset); }
+		}
+	};
+
+	std::stop_source stop_source;
+	process_scanlines(pixels, workers, stop_source.get_token(), fill).wait();
+	for(uint32_t y = 0; y != pixels.height(); ++y)
+	{
+		for(uint32_t x = 0; x != pixels.width(); ++x)
+		{ EXPECT_EQ(pixels(x, y), static_cast<float>(y)); }
+	}
+
+	std::ranges::fill(buffer, -1.0f);
+	stop_source.request_stop();
+	process_scanlines(pixels, workers, stop_source.get_token(), fill).wait();
+	EXPECT_EQ(std::ranges::all_of(buffer, [](auto val){ return val == -1.0f; }), true);
+}
+
+TESTCASE(terraformer_span_2d_process_scanlines_with_stop_token_fewer_scanlines_than_workers)
+{
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{8};
+	auto const fill = [](terraformer::scanline_processing_job_info const& jobinfo, terraformer::span_2d<float> output){
+		for(uint32_t y = 0; y != output.height(); ++y)
+		{
+			for(uint32_t x = 0; x != output.width(); ++x)
+			{ output(x, y) = static_cast<float>(y + jobinfo.input_y_offset); }
+		}
+	};
+
+	std::vector<float> buffer(16*4);
+	terraformer::span_2d<float> pixels{16, 4, buffer.data()};
+	process_scanlines(pixels, workers, std::stop_token{}, fill).wait();
+	for(uint32_t y = 0; y != pixels.height(); ++y)
+	{
+		for(uint32_t x = 0; x != pixels.width(); ++x)
+		{ EXPECT_EQ(pixels(x, y), static_cast<float>(y)); }
+	}
+
+	// Must not wait for any chunk
+	terraformer::span_2d<float> empty{16, 0, buffer.data()};
+	process_scanlines(empty, workers, std::stop_token{}, fill).wait();
+}
@@ -3,6 +3,9 @@
 
 #include "lib/common/unique_resource.hpp"
 
+#include <cassert>
+#include <span>
+
 namespace terraformer
 {
 	struct value_map_vtable
@@ -14,11 +17,24 @@ namespace terraformer
 			}},
 			to_value{[](void const* obj, float value){
 				return static_cast<ValueMap const*>(obj)->to_value(value);
+			}},
+			from_values{[](void const* obj, std::span<float const> input, std::span<float> output){
+				assert(std::size(input) == std::size(output));
+				// NOTE: The loop is compiled for the concrete ValueMap, so from_value can be inlined
+				//       and vectorized
+				auto const& map = *static_cast<ValueMap const*>(obj);
+				for(size_t k = 0; k != std::size(input); ++k)
+				{ output[k] = map.from_value(input[k]); }
 			}}
 		{}
 
 		float (*from_value)(void const*, float);
 		float (*to_value)(void const*, float);
+
+		/**
+		 * Maps all values in input, paying for only one indirect call
+		 */
+		void (*from_values)(void const*, std::span<float const> input, std::span<float> output);
 	};
 
 	using type_erased_value_map = unique_resource<value_map_vtable>;
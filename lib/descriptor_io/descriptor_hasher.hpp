@@ -0,0 +1,142 @@
+#ifndef TERRAFORMER_DESCRIPTOR_HASHER_HPP
+#define TERRAFORMER_DESCRIPTOR_HASHER_HPP
+
+#include "./descriptor_editor_ref.hpp"
+
+#include "lib/common/fnv1a_hash.hpp"
+
+#include <functional>
+
+namespace terraformer
+{
+	/**
+	 * A descriptor editor that feeds the labels and values of all fields into a hash, instead of
+	 * creating widgets. Since bind visits the fields in a fixed order, two descriptors with equal
+	 * fields give the same digest.
+	 *
+	 * \note Fields that are not exposed through bind are not part of the digest
+	 */
+	class descriptor_hasher
+	{
+	public:
+		struct traits
+		{
+			static descriptor_table_editor_ref create_table(
+				descriptor_hasher& hasher,
+				descriptor_editor_ref::field_descriptor const& field_info,
+				descriptor_editor_ref::table_descriptor&&
+			)
+			{
+				hasher.update_label(u8"table", field_info.label);
+				return descriptor_table_editor_ref{hasher, std::type_identity<traits>{}};
+			}
+
+			static descriptor_editor_ref add_record(descriptor_hasher& hasher, std::u8string_view label)
+			{
+				hasher.update_label(u8"record", label);
+				return descriptor_editor_ref{hasher, std::type_identity<traits>{}};
+			}
+
+			static descriptor_editor_ref create_form(
+				descriptor_hasher& hasher,
+				descriptor_editor_ref::field_descriptor const& field_info,
+				descriptor_editor_ref::form_descriptor&&
+			)
+			{
+				hasher.update_label(u8"form", field_info.label);
+				return descriptor_editor_ref{hasher, std::type_identity<traits>{}};
+			}
+
+			template<class FloatWrapper>
+			static void create_float_input(
+				descriptor_hasher& hasher,
+				std::u8string_view label,
+				FloatWrapper value,
+				descriptor_editor_ref::knob_descriptor&&
+			)
+			{
+				hasher.update_label(u8"float", label);
+				hasher.m_state.update(static_cast<float>(value.get()));
+			}
+
+			template<class FloatWrapper>
+			static void create_float_input(
+				descriptor_hasher& hasher,
+				descriptor_editor_ref::field_descriptor const& field_info,
+				FloatWrapper value,
+				descriptor_editor_ref::slider_descriptor&&
+			)
+			{
+				hasher.update_label(u8"float", field_info.label);
+				hasher.m_state.update(static_cast<float>(value.get()));
+			}
+
+			static void create_string_input(
+				descriptor_hasher& hasher,
+				std::u8string_view label,
+				std::reference_wrapper<std::u8string> value,
+				descriptor_editor_ref::single_line_text_input_descriptor&&
+			)
+			{
+				hasher.update_label(u8"string", label);
+				hasher.m_state.update(std::u8string_view{value.get()});
+			}
+
+			static void create_rng_seed_input(
+				descriptor_hasher& hasher,
+				std::u8string_view label,
+				std::array<std::byte, 16> const& value
+			)
+			{
+				hasher.update_label(u8"rng_seed", label);
+				hasher.m_state.update(std::span{value});
+			}
+
+			static void create_range_input(
+				descriptor_hasher& hasher,
+				std::u8string_view label,
+				closed_closed_interval<float> const& value,
+				descriptor_editor_ref::range_input_descriptor&&
+			)
+			{
+				hasher.update_label(u8"range", label);
+				hasher.m_state.update(value.min());
+				hasher.m_state.update(value.max());
+			}
+
+			static void append_pending_widgets(descriptor_hasher&)
+			{}
+		};
+
+		descriptor_editor_ref get_editor()
+		{ return descriptor_editor_ref{*this, std::type_identity<traits>{}}; }
+
+		fnv1a_128& state()
+		{ return m_state; }
+
+		auto digest() const
+		{ return m_state.digest(); }
+
+	private:
+		void update_label(std::u8string_view kind, std::u8string_view label)
+		{
+			m_state.update(kind);
+			m_state.update(label);
+		}
+
+		fnv1a_128 m_state;
+	};
+
+	/**
+	 * Computes a stable digest of all fields that descriptor exposes through bind
+	 */
+	template<class Descriptor>
+	auto hash_descriptor(Descriptor descriptor)
+	{
+		descriptor_hasher hasher;
+		descriptor.bind(hasher.get_editor());
+		return hasher.digest();
+	}
+}
+
+#endif
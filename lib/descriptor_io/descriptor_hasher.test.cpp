@@ -0,0 +1,96 @@
+//@	{"target":{"name":"descriptor_hasher.test"}}
+
+#include "./descriptor_hasher.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+namespace
+{
+	struct test_descriptor
+	{
+		std::array<std::byte, 16> rng_seed{};
+		std::u8string name = u8"Foo";
+		float amplitude = 1.0f;
+		size_t iteration_count = 4;
+		terraformer::closed_closed_interval<float> range{0.0f, 1.0f};
+
+		void bind(terraformer::descriptor_editor_ref editor)
+		{
+			editor.create_rng_seed_input(u8"Seed", rng_seed);
+			auto form = editor.create_form(
+				terraformer::descriptor_editor_ref::field_descriptor{.label = u8"Form"},
+				terraformer::descriptor_editor_ref::form_descriptor{}
+			);
+			form.create_string_input(
+				u8"Name",
+				name,
+				terraformer::descriptor_editor_ref::single_line_text_input_descriptor{}
+			);
+			form.create_float_input(
+				u8"Amplitude",
+				amplitude,
+				terraformer::descriptor_editor_ref::knob_descriptor{}
+			);
+			form.create_float_input(
+				u8"Iteration count",
+				terraformer::descriptor_editor_ref::assigner<float>{iteration_count},
+				terraformer::descriptor_editor_ref::knob_descriptor{}
+			);
+			form.create_range_input(
+				u8"Range",
+				range,
+				terraformer::descriptor_editor_ref::range_input_descriptor{}
+			);
+		}
+	};
+}
+
+TESTCASE(terraformer_descriptor_hasher_equal_descriptors_give_equal_digests)
+{
+	test_descriptor const a{};
+	test_descriptor const b{};
+	EXPECT_EQ(terraformer::hash_descriptor(a) == terraformer::hash_descriptor(b), true);
+}
+
+TESTCASE(terraformer_descriptor_hasher_every_field_contributes)
+{
+	test_descriptor const ref{};
+	auto const ref_digest = terraformer::hash_descriptor(ref);
+
+	{
+		auto other = ref;
+		other.rng_seed[3] = std::byte{1};
+		EXPECT_EQ(terraformer::hash_descriptor(other) == ref_digest, false);
+	}
+
+	{
+		auto other = ref;
+		other.name = u8"Bar";
+		EXPECT_EQ(terraformer::hash_descriptor(other) == ref_digest, false);
+	}
+
+	{
+		auto other = ref;
+		other.amplitude = std::nextafter(1.0f, 2.0f);
+		EXPECT_EQ(terraformer::hash_descriptor(other) == ref_digest, false);
+	}
+
+	{
+		auto other = ref;
+		other.iteration_count = 5;
+		EXPECT_EQ(terraformer::hash_descriptor(other) == ref_digest, false);
+	}
+
+	{
+		auto other = ref;
+		other.range = terraformer::closed_closed_interval<float>{0.0f, 2.0f};
+		EXPECT_EQ(terraformer::hash_descriptor(other) == ref_digest, false);
+	}
+}
+
+TESTCASE(terraformer_fnv1a_128_known_value)
+{
+	// Reference value for the empty input is the offset basis
+	terraformer::fnv1a_128 hasher;
+	EXPECT_EQ(terraformer::to_hex_string(hasher.digest()), "8dc595627521b8624201bb072e27626c");
+}
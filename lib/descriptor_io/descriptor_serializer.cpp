@@ -0,0 +1,138 @@
+//@	{"target":{"name":"descriptor_serializer.o"}}
+
+#include "./descriptor_serializer.hpp"
+
+#include "lib/common/string_converter.hpp"
+#include "lib/common/utils.hpp"
+
+namespace
+{
+	std::string_view trim(std::string_view str)
+	{
+		auto const first = str.find_first_not_of(" \t\r");
+		if(first == std::string_view::npos)
+		{ return std::string_view{}; }
+
+		auto const last = str.find_last_not_of(" \t\r");
+		return str.substr(first, last - first + 1);
+	}
+
+	std::string_view to_string_view(std::u8string_view str)
+	{ return std::string_view{reinterpret_cast<char const*>(std::data(str)), std::size(str)}; }
+}
+
+terraformer::descriptor_field_map terraformer::parse_descriptor_fields(std::string_view text)
+{
+	descriptor_field_map ret;
+	size_t line_number = 0;
+	while(!text.empty())
+	{
+		++line_number;
+		auto const line_end = text.find('\n');
+		auto const line = trim(text.substr(0, line_end));
+		text = line_end == std::string_view::npos? std::string_view{} : text.substr(line_end + 1);
+
+		if(line.empty() || line.front() == '#')
+		{ continue; }
+
+		auto const separator = line.find('=');
+		if(separator == std::string_view::npos)
+		{
+			throw input_error{
+				std::string{"Line "}.append(std::to_string(line_number)).append(": Expected `path = value`")
+			};
+		}
+
+		auto const path = trim(line.substr(0, separator));
+		auto const value = trim(line.substr(separator + 1));
+		if(!ret.emplace(path, value).second)
+		{
+			throw input_error{
+				std::string{"Line "}.append(std::to_string(line_number))
+					.append(": Field `").append(path).append("` has already been set")
+			};
+		}
+	}
+	return ret;
+}
+
+std::string terraformer::serialize_field_value(float value)
+{ return num_string_converter<float>::convert(value); }
+
+std::string terraformer::serialize_field_value(std::u8string_view value)
+{ return std::string{to_string_view(value)}; }
+
+std::string terraformer::serialize_field_value(std::array<std::byte, 16> const& value)
+{ return bytes_to_hex(std::data(value), std::size(value)); }
+
+std::string terraformer::serialize_field_value(closed_closed_interval<float> const& value)
+{ return to_string(value); }
+
+float terraformer::deserialize_field_value(std::type_identity<float>, std::string_view str)
+{ return num_string_converter<float>::convert(str); }
+
+std::u8string terraformer::deserialize_field_value(std::type_identity<std::u8string>, std::string_view str)
+{ return std::u8string{reinterpret_cast<char8_t const*>(std::data(str)), std::size(str)}; }
+
+std::array<std::byte, 16>
+terraformer::deserialize_field_value(std::type_identity<std::array<std::byte, 16>>, std::string_view str)
+{
+	std::array<std::byte, 16> ret;
+	if(std::size(str) != 2*std::size(ret))
+	{ throw input_error{"Expected 32 hexadecimal digits"}; }
+
+	auto const res = hex_to_bytes(std::data(ret), std::data(str), std::size(ret));
+	if(res.ptr != std::data(str) + std::size(str))
+	{ throw input_error{"Expected 32 hexadecimal digits"}; }
+
+	return ret;
+}
+
+terraformer::closed_closed_interval<float>
+terraformer::deserialize_field_value(std::type_identity<closed_closed_interval<float>>, std::string_view str)
+{
+	using interval_type = closed_closed_interval<float>;
+	if(
+		std::size(str) < 2 ||
+		str.front() != interval_type::lower_bound_char ||
+		str.back() != interval_type::upper_bound_char
+	)
+	{ throw input_error{"Expected an interval, such as [0, 1]"}; }
+
+	str = str.substr(1, std::size(str) - 2);
+	auto const separator = str.find(',');
+	if(separator == std::string_view::npos)
+	{ throw input_error{"Expected an interval, such as [0, 1]"}; }
+
+	return interval_type{
+		num_string_converter<float>::convert(trim(str.substr(0, separator))),
+		num_string_converter<float>::convert(trim(str.substr(separator + 1)))
+	};
+}
+
+std::string terraformer::descriptor_field_paths::make_path(std::string_view parent, std::u8string_view label)
+{
+	auto ret = std::string{parent}.append(to_string_view(label));
+	auto const use_count = ++m_use_count[ret];
+	if(use_count != 1)
+	{ ret.append("#").append(std::to_string(use_count)); }
+	return ret;
+}
+
+terraformer::descriptor_deserializer::descriptor_deserializer(descriptor_field_map const& fields):
+	m_scopes{scope{.deserializer = this, .path = std::string{}}}
+{
+	for(auto const& item : fields)
+	{ m_fields.emplace(item.first, field{.value = item.second, .used = false}); }
+}
+
+std::vector<std::string> terraformer::descriptor_deserializer::unused_fields() const
+{
+	std::vector<std::string> ret;
+	for(auto const& item : m_fields)
+	{
+		if(!item.second.used)
+		{ ret.push_back(item.first); }
+	}
+	return ret;
+}
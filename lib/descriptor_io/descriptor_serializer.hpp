@@ -0,0 +1,340 @@
+//@	{"dependencies_extra":[{"ref":"./descriptor_serializer.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_DESCRIPTOR_SERIALIZER_HPP
+#define TERRAFORMER_DESCRIPTOR_SERIALIZER_HPP
+
+#include "./descriptor_editor_ref.hpp"
+
+#include "lib/common/input_error.hpp"
+
+#include <array>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace terraformer
+{
+	/**
+	 * Maps the path of a field, such as "Generators/Rolling hills/Seed", to its value
+	 */
+	using descriptor_field_map = std::map<std::string, std::string, std::less<>>;
+
+	/**
+	 * Parses text with one `path = value` pair per line. Empty lines, and lines starting with #,
+	 * are ignored. Leading and trailing whitespace is removed from both the path and the value.
+	 */
+	descriptor_field_map parse_descriptor_fields(std::string_view text);
+
+	std::string serialize_field_value(float value);
+	std::string serialize_field_value(std::u8string_view value);
+	std::string serialize_field_value(std::array<std::byte, 16> const& value);
+	std::string serialize_field_value(closed_closed_interval<float> const& value);
+
+	float deserialize_field_value(std::type_identity<float>, std::string_view str);
+	std::u8string deserialize_field_value(std::type_identity<std::u8string>, std::string_view str);
+	std::array<std::byte, 16> deserialize_field_value(std::type_identity<std::array<std::byte, 16>>, std::string_view str);
+	closed_closed_interval<float> deserialize_field_value(std::type_identity<closed_closed_interval<float>>, std::string_view str);
+
+	/**
+	 * Builds the path of a field from the path of its parent and its label. Since labels are not
+	 * necessarily unique, the n:th use of a path gets the suffix #n. Because bind visits the
+	 * fields in a fixed order, the same field gets the same path every time.
+	 */
+	class descriptor_field_paths
+	{
+	public:
+		std::string make_path(std::string_view parent, std::u8string_view label);
+
+	private:
+		std::map<std::string, size_t, std::less<>> m_use_count;
+	};
+
+	/**
+	 * A descriptor editor that writes the path and value of all fields as text, in the format
+	 * accepted by parse_descriptor_fields
+	 */
+	class descriptor_serializer
+	{
+	public:
+		struct scope
+		{
+			descriptor_serializer* serializer;
+			std::string path;
+		};
+
+		struct traits
+		{
+			static descriptor_table_editor_ref create_table(
+				scope& parent,
+				descriptor_editor_ref::field_descriptor const& field_info,
+				descriptor_editor_ref::table_descriptor&&
+			)
+			{ return descriptor_table_editor_ref{parent.serializer->enter(parent, field_info.label), std::type_identity<traits>{}}; }
+
+			static descriptor_editor_ref add_record(scope& parent, std::u8string_view label)
+			{ return descriptor_editor_ref{parent.serializer->enter(parent, label), std::type_identity<traits>{}}; }
+
+			static descriptor_editor_ref create_form(
+				scope& parent,
+				descriptor_editor_ref::field_descriptor const& field_info,
+				descriptor_editor_ref::form_descriptor&&
+			)
+			{ return descriptor_editor_ref{parent.serializer->enter(parent, field_info.label), std::type_identity<traits>{}}; }
+
+			template<class FloatWrapper>
+			static void create_float_input(
+				scope& parent,
+				std::u8string_view label,
+				FloatWrapper value,
+				descriptor_editor_ref::knob_descriptor&&
+			)
+			{ parent.serializer->write(parent, label, serialize_field_value(static_cast<float>(value.get()))); }
+
+			template<class FloatWrapper>
+			static void create_float_input(
+				scope& parent,
+				descriptor_editor_ref::field_descriptor const& field_info,
+				FloatWrapper value,
+				descriptor_editor_ref::slider_descriptor&&
+			)
+			{ parent.serializer->write(parent, field_info.label, serialize_field_value(static_cast<float>(value.get()))); }
+
+			static void create_string_input(
+				scope& parent,
+				std::u8string_view label,
+				std::reference_wrapper<std::u8string> value,
+				descriptor_editor_ref::single_line_text_input_descriptor&&
+			)
+			{ parent.serializer->write(parent, label, serialize_field_value(std::u8string_view{value.get()})); }
+
+			static void create_rng_seed_input(
+				scope& parent,
+				std::u8string_view label,
+				std::array<std::byte, 16> const& value
+			)
+			{
+				auto const path = parent.serializer->write(parent, label, serialize_field_value(value));
+				parent.serializer->m_rng_seed_fields.push_back(path);
+			}
+
+			static void create_range_input(
+				scope& parent,
+				std::u8string_view label,
+				closed_closed_interval<float> const& value,
+				descriptor_editor_ref::range_input_descriptor&&
+			)
+			{ parent.serializer->write(parent, label, serialize_field_value(value)); }
+
+			static void append_pending_widgets(scope&)
+			{}
+		};
+
+		descriptor_serializer():
+			m_scopes{scope{.serializer = this, .path = std::string{}}}
+		{}
+
+		descriptor_serializer(descriptor_serializer const&) = delete;
+		descriptor_serializer& operator=(descriptor_serializer const&) = delete;
+
+		descriptor_editor_ref get_editor()
+		{ return descriptor_editor_ref{m_scopes.front(), std::type_identity<traits>{}}; }
+
+		std::string const& text() const
+		{ return m_text; }
+
+		/**
+		 * The paths of all rng seeds, so that new seeds can be generated for a descriptor without
+		 * knowing its type
+		 */
+		std::vector<std::string> const& rng_seed_fields() const
+		{ return m_rng_seed_fields; }
+
+	private:
+		scope& enter(scope const& parent, std::u8string_view label)
+		{
+			return m_scopes.emplace_back(
+				scope{
+					.serializer = this,
+					.path = m_paths.make_path(parent.path, label).append("/")
+				}
+			);
+		}
+
+		std::string write(scope const& parent, std::u8string_view label, std::string_view value)
+		{
+			auto path = m_paths.make_path(parent.path, label);
+			m_text.append(path).append(" = ").append(value).append("\n");
+			return path;
+		}
+
+		// NOTE: A deque is used so that references to scopes stay valid when new scopes are added
+		std::deque<scope> m_scopes;
+		descriptor_field_paths m_paths;
+		std::string m_text;
+		std::vector<std::string> m_rng_seed_fields;
+	};
+
+	/**
+	 * A descriptor editor that assigns the values in a descriptor_field_map to the fields with
+	 * matching paths. Fields without a value in the map are left unchanged.
+	 */
+	class descriptor_deserializer
+	{
+	public:
+		struct scope
+		{
+			descriptor_deserializer* deserializer;
+			std::string path;
+		};
+
+		struct traits
+		{
+			static descriptor_table_editor_ref create_table(
+				scope& parent,
+				descriptor_editor_ref::field_descriptor const& field_info,
+				descriptor_editor_ref::table_descriptor&&
+			)
+			{ return descriptor_table_editor_ref{parent.deserializer->enter(parent, field_info.label), std::type_identity<traits>{}}; }
+
+			static descriptor_editor_ref add_record(scope& parent, std::u8string_view label)
+			{ return descriptor_editor_ref{parent.deserializer->enter(parent, label), std::type_identity<traits>{}}; }
+
+			static descriptor_editor_ref create_form(
+				scope& parent,
+				descriptor_editor_ref::field_descriptor const& field_info,
+				descriptor_editor_ref::form_descriptor&&
+			)
+			{ return descriptor_editor_ref{parent.deserializer->enter(parent, field_info.label), std::type_identity<traits>{}}; }
+
+			template<class FloatWrapper>
+			static void create_float_input(
+				scope& parent,
+				std::u8string_view label,
+				FloatWrapper value,
+				descriptor_editor_ref::knob_descriptor&&
+			)
+			{ parent.deserializer->read(parent, label, value); }
+
+			template<class FloatWrapper>
+			static void create_float_input(
+				scope& parent,
+				descriptor_editor_ref::field_descriptor const& field_info,
+				FloatWrapper value,
+				descriptor_editor_ref::slider_descriptor&&
+			)
+			{ parent.deserializer->read(parent, field_info.label, value); }
+
+			static void create_string_input(
+				scope& parent,
+				std::u8string_view label,
+				std::reference_wrapper<std::u8string> value,
+				descriptor_editor_ref::single_line_text_input_descriptor&&
+			)
+			{ parent.deserializer->read(parent, label, value); }
+
+			static void create_rng_seed_input(
+				scope& parent,
+				std::u8string_view label,
+				std::array<std::byte, 16>& value
+			)
+			{ parent.deserializer->read(parent, label, std::ref(value)); }
+
+			static void create_range_input(
+				scope& parent,
+				std::u8string_view label,
+				closed_closed_interval<float>& value,
+				descriptor_editor_ref::range_input_descriptor&&
+			)
+			{ parent.deserializer->read(parent, label, std::ref(value)); }
+
+			static void append_pending_widgets(scope&)
+			{}
+		};
+
+		explicit descriptor_deserializer(descriptor_field_map const& fields);
+
+		descriptor_deserializer(descriptor_deserializer const&) = delete;
+		descriptor_deserializer& operator=(descriptor_deserializer const&) = delete;
+
+		descriptor_editor_ref get_editor()
+		{ return descriptor_editor_ref{m_scopes.front(), std::type_identity<traits>{}}; }
+
+		/**
+		 * Returns the paths in the field map that did not match any field
+		 */
+		std::vector<std::string> unused_fields() const;
+
+	private:
+		scope& enter(scope const& parent, std::u8string_view label)
+		{
+			return m_scopes.emplace_back(
+				scope{
+					.deserializer = this,
+					.path = m_paths.make_path(parent.path, label).append("/")
+				}
+			);
+		}
+
+		template<class ValueWrapper>
+		void read(scope const& parent, std::u8string_view label, ValueWrapper value)
+		{
+			auto const path = m_paths.make_path(parent.path, label);
+			auto const i = m_fields.find(path);
+			if(i == std::end(m_fields))
+			{ return; }
+
+			i->second.used = true;
+			using value_type = std::conditional_t<
+				std::is_same_v<ValueWrapper, descriptor_editor_ref::assigner<float>>,
+				float,
+				std::remove_cvref_t<decltype(value.get())>
+			>;
+			try
+			{ value.get() = deserialize_field_value(std::type_identity<value_type>{}, i->second.value); }
+			catch(std::runtime_error const& error)
+			{ throw input_error{std::string{path}.append(": ").append(error.what())}; }
+		}
+
+		struct field
+		{
+			std::string value;
+			bool used;
+		};
+
+		std::deque<scope> m_scopes;
+		descriptor_field_paths m_paths;
+		std::map<std::string, field, std::less<>> m_fields;
+	};
+
+	/**
+	 * Writes all fields that descriptor exposes through bind as text
+	 */
+	template<class Descriptor>
+	std::string serialize_descriptor(Descriptor& descriptor)
+	{
+		descriptor_serializer serializer;
+		descriptor.bind(serializer.get_editor());
+		return serializer.text();
+	}
+
+	/**
+	 * Assigns the values in fields to descriptor. Throws input_error if a value cannot be parsed,
+	 * or if fields contains a path that does not match any field of descriptor.
+	 */
+	template<class Descriptor>
+	void deserialize_descriptor(Descriptor& descriptor, descriptor_field_map const& fields)
+	{
+		descriptor_deserializer deserializer{fields};
+		descriptor.bind(deserializer.get_editor());
+		if(auto const unused_fields = deserializer.unused_fields(); !unused_fields.empty())
+		{ throw input_error{std::string{"Unknown field `"}.append(unused_fields.front()).append("`")}; }
+	}
+}
+
+#endif
@@ -0,0 +1,161 @@
+//@	{"target":{"name":"descriptor_serializer.test"}}
+
+#include "./descriptor_serializer.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <algorithm>
+
+namespace
+{
+	struct test_descriptor
+	{
+		std::array<std::byte, 16> rng_seed{};
+		std::u8string name = u8"Foo";
+		float amplitude = 1.0f;
+		size_t iteration_count = 4;
+		terraformer::closed_closed_interval<float> range{0.0f, 1.0f};
+		std::array<float, 2> gains{0.5f, 0.25f};
+
+		void bind(terraformer::descriptor_editor_ref editor)
+		{
+			editor.create_rng_seed_input(u8"Seed", rng_seed);
+			auto form = editor.create_form(
+				terraformer::descriptor_editor_ref::field_descriptor{.label = u8"Form"},
+				terraformer::descriptor_editor_ref::form_descriptor{}
+			);
+			form.create_string_input(
+				u8"Name",
+				name,
+				terraformer::descriptor_editor_ref::single_line_text_input_descriptor{}
+			);
+			form.create_float_input(
+				u8"Amplitude",
+				amplitude,
+				terraformer::descriptor_editor_ref::knob_descriptor{}
+			);
+			form.create_float_input(
+				u8"Iteration count",
+				terraformer::descriptor_editor_ref::assigner<float>{iteration_count},
+				terraformer::descriptor_editor_ref::knob_descriptor{}
+			);
+			form.create_range_input(
+				u8"Range",
+				range,
+				terraformer::descriptor_editor_ref::range_input_descriptor{}
+			);
+
+			auto table = editor.create_table(
+				terraformer::descriptor_editor_ref::field_descriptor{.label = u8"Table"},
+				terraformer::descriptor_editor_ref::table_descriptor{}
+			);
+			for(auto& item : gains)
+			{
+				// Both records have the same label
+				auto record = table.add_record(u8"Record");
+				record.create_float_input(
+					terraformer::descriptor_editor_ref::field_descriptor{.label = u8"Gain"},
+					item,
+					terraformer::descriptor_editor_ref::slider_descriptor{}
+				);
+			}
+		}
+
+		bool operator==(test_descriptor const&) const = default;
+	};
+}
+
+TESTCASE(terraformer_descriptor_serializer_serialize)
+{
+	test_descriptor obj{};
+	obj.rng_seed[0] = std::byte{0xa5};
+	obj.amplitude = 0.1f;
+
+	terraformer::descriptor_serializer serializer;
+	obj.bind(serializer.get_editor());
+	EXPECT_EQ(
+		serializer.text(),
+		"Seed = A5000000000000000000000000000000\n"
+		"Form/Name = Foo\n"
+		"Form/Amplitude = 0.1\n"
+		"Form/Iteration count = 4\n"
+		"Form/Range = [0, 1]\n"
+		"Table/Record/Gain = 0.5\n"
+		"Table/Record#2/Gain = 0.25\n"
+	);
+	REQUIRE_EQ(std::size(serializer.rng_seed_fields()), 1);
+	EXPECT_EQ(serializer.rng_seed_fields()[0], "Seed");
+}
+
+TESTCASE(terraformer_descriptor_serializer_round_trip)
+{
+	test_descriptor obj{};
+	obj.rng_seed[3] = std::byte{0x7f};
+	obj.name = u8"Bar baz";
+	obj.amplitude = std::nextafter(1.0f/3.0f, 1.0f);
+	obj.iteration_count = 7;
+	obj.range = terraformer::closed_closed_interval<float>{-0.5f, 2.0f};
+	obj.gains = std::array{1.0f/7.0f, -3.0f};
+
+	auto const text = terraformer::serialize_descriptor(obj);
+	test_descriptor other{};
+	terraformer::deserialize_descriptor(other, terraformer::parse_descriptor_fields(text));
+	EXPECT_EQ(other == obj, true);
+}
+
+TESTCASE(terraformer_descriptor_serializer_partial_input_keeps_other_fields)
+{
+	test_descriptor obj{};
+	terraformer::deserialize_descriptor(
+		obj,
+		terraformer::parse_descriptor_fields(
+			"# Comments and empty lines are ignored\n"
+			"\n"
+			"  Form/Amplitude =  2.5  \n"
+			"Table/Record#2/Gain=0.75"
+		)
+	);
+
+	test_descriptor expected{};
+	expected.amplitude = 2.5f;
+	expected.gains[1] = 0.75f;
+	EXPECT_EQ(obj == expected, true);
+}
+
+TESTCASE(terraformer_descriptor_serializer_invalid_input)
+{
+	auto const expect_input_error = [](std::string_view text) {
+		test_descriptor obj{};
+		try
+		{
+			terraformer::deserialize_descriptor(obj, terraformer::parse_descriptor_fields(text));
+			abort();
+		}
+		catch(terraformer::input_error const&)
+		{}
+	};
+
+	// Missing value separator
+	expect_input_error("Form/Amplitude 2.5");
+	// Field set twice
+	expect_input_error("Form/Amplitude = 2.5\nForm/Amplitude = 3");
+	// No such field
+	expect_input_error("Form/Amplitudes = 2.5");
+	// Invalid values
+	expect_input_error("Form/Amplitude = foo");
+	expect_input_error("Seed = 0123");
+	expect_input_error("Form/Range = [1, 0]");
+	expect_input_error("Form/Range = 0, 1");
+}
+
+TESTCASE(terraformer_descriptor_serializer_error_message_contains_path)
+{
+	test_descriptor obj{};
+	try
+	{
+		terraformer::deserialize_descriptor(obj, terraformer::parse_descriptor_fields("Form/Amplitude = foo"));
+		abort();
+	}
+	catch(terraformer::input_error const& err)
+	{ EXPECT_EQ(err.what(), std::string_view{"Form/Amplitude: Expected a number"}); }
+}
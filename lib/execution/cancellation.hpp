@@ -0,0 +1,27 @@
+#ifndef TERRAFORMER_CANCELLATION_HPP
+#define TERRAFORMER_CANCELLATION_HPP
+
+#include <stdexcept>
+#include <stop_token>
+
+namespace terraformer
+{
+	/**
+	 * Thrown when a computation is abandoned because a stop has been requested through its
+	 * std::stop_token
+	 */
+	class operation_cancelled:public std::runtime_error
+	{
+	public:
+		operation_cancelled():std::runtime_error{"Operation cancelled"}
+		{}
+	};
+
+	inline void throw_if_stop_requested(std::stop_token const& stop_token)
+	{
+		if(stop_token.stop_requested())
+		{ throw operation_cancelled{}; }
+	}
+}
+
+#endif
@@ -1,9 +1,13 @@
 #ifndef TERRAFORMER_TASK_RECEIVER_HPP
 #define TERRAFORMER_TASK_RECEIVER_HPP
 
+#include "./cancellation.hpp"
+
 #include <thread>
 #include <condition_variable>
 #include <optional>
+#include <stop_token>
+#include <type_traits>
 
 namespace terraformer
 {
@@ -14,10 +18,16 @@ namespace terraformer
 		explicit task_receiver():m_should_stop{false}, m_worker{[this](){dispatch();}}
 		{}
 
+		/**
+		 * Replaces the pending task with task. If a task is running, a stop is requested through
+		 * its std::stop_token, since its result has been superseded. Only tasks that accept a
+		 * std::stop_token can stop early.
+		 */
 		void replace_pending_task(Task&& task)
 		{
 			std::lock_guard lock{m_mutex};
 			m_task = std::move(task);
+			m_running_task_stop_source.request_stop();
 			m_cv.notify_one();
 		}
 
@@ -26,6 +36,7 @@ namespace terraformer
 			{
 				std::lock_guard lock{m_mutex};
 				m_should_stop = true;
+				m_running_task_stop_source.request_stop();
 				m_cv.notify_one();
 			}
 			m_worker.join();
@@ -36,6 +47,7 @@ namespace terraformer
 
 	private:
 		std::optional<Task> m_task;
+		std::stop_source m_running_task_stop_source;
 		bool m_should_stop;
 
 		void dispatch()
@@ -44,6 +56,7 @@ namespace terraformer
 			{
 				bool should_stop{};
 				std::optional<Task> t{};
+				std::stop_token stop_token{};
 				{
 					std::unique_lock lock{m_mutex};
 					m_cv.wait(lock, [this](){
@@ -52,6 +65,8 @@ namespace terraformer
 					should_stop = m_should_stop;
 					t = std::move(m_task);
 					m_task.reset();
+					m_running_task_stop_source = std::stop_source{};
+					stop_token = m_running_task_stop_source.get_token();
 				}
 				if(should_stop)
 				{ return; }
@@ -59,7 +74,14 @@ namespace terraformer
 				if(t.has_value())
 				{
 					try
-					{ (*t)(); }
+					{
+						if constexpr(std::is_invocable_v<Task&, std::stop_token>)
+						{ (*t)(stop_token); }
+						else
+						{ (*t)(); }
+					}
+					catch(operation_cancelled const&)
+					{}
 					catch(std::exception const& err)
 					{
 						fprintf(stderr, "(x) %s\n", err.what());
@@ -0,0 +1,202 @@
+//@	{"target":{"name":"./distance_transform.o"}}
+
+#include "./distance_transform.hpp"
+
+#include "lib/common/chunk_by_chunk_count_view.hpp"
+#include "lib/execution/batch_result.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <ranges>
+#include <utility>
+#include <vector>
+
+void terraformer::compute_column_distances(
+	span_2d<float> distances,
+	span_2d<uint32_t> nearest_row,
+	span_2d<bool const> seeds,
+	uint32_t x_begin,
+	uint32_t x_end
+)
+{
+	auto const h = seeds.height();
+	if(h == 0)
+	{ return; }
+
+	// NOTE: Scan the rows, rather than the columns, to access memory in the order it is stored
+	constexpr auto inf = std::numeric_limits<float>::infinity();
+	for(uint32_t x = x_begin; x != x_end; ++x)
+	{
+		distances(x, 0) = seeds(x, 0)? 0.0f : inf;
+		nearest_row(x, 0) = 0;
+	}
+
+	for(uint32_t y = 1; y != h; ++y)
+	{
+		for(uint32_t x = x_begin; x != x_end; ++x)
+		{
+			if(seeds(x, y))
+			{
+				distances(x, y) = 0.0f;
+				nearest_row(x, y) = y;
+			}
+			else
+			{
+				distances(x, y) = distances(x, y - 1) + 1.0f;
+				nearest_row(x, y) = nearest_row(x, y - 1);
+			}
+		}
+	}
+
+	for(uint32_t y = h - 1; y != 0; --y)
+	{
+		for(uint32_t x = x_begin; x != x_end; ++x)
+		{
+			auto const d_below = distances(x, y) + 1.0f;
+			if(d_below < distances(x, y - 1))
+			{
+				distances(x, y - 1) = d_below;
+				nearest_row(x, y - 1) = nearest_row(x, y);
+			}
+		}
+	}
+}
+
+void terraformer::compute_row_distances(
+	scanline_processing_job_info const& jobinfo,
+	span_2d<float> distances,
+	span_2d<uint32_t> nearest_seed,
+	span_2d<float const> column_distances,
+	span_2d<uint32_t const> nearest_row
+)
+{
+	auto const w = distances.width();
+	auto const h = distances.height();
+	auto const input_y_offset = jobinfo.input_y_offset;
+
+	// NOTE: Squared distances may exceed the precision of float for large images
+	std::vector<uint32_t> parabolas(w);
+	std::vector<double> boundaries(w + 1);
+	auto const f = [column_distances](uint32_t x, uint32_t y) {
+		auto const val = static_cast<double>(column_distances(x, y));
+		return val*val;
+	};
+
+	for(uint32_t y = 0; y != h; ++y)
+	{
+		auto const y_in = y + input_y_offset;
+
+		size_t k = 0;
+		size_t parabola_count = 0;
+		for(uint32_t q = 0; q != w; ++q)
+		{
+			if(!std::isfinite(column_distances(q, y_in)))
+			{ continue; }
+
+			if(parabola_count == 0)
+			{
+				parabolas[0] = q;
+				boundaries[0] = -std::numeric_limits<double>::infinity();
+				boundaries[1] = std::numeric_limits<double>::infinity();
+				parabola_count = 1;
+				continue;
+			}
+
+			auto const x_q = static_cast<double>(q);
+			auto const f_q = f(q, y_in) + x_q*x_q;
+			k = parabola_count - 1;
+			auto intersection = [&](){
+				auto const x_p = static_cast<double>(parabolas[k]);
+				return (f_q - (f(parabolas[k], y_in) + x_p*x_p))/(2.0*(x_q - x_p));
+			};
+
+			auto s = intersection();
+			while(s <= boundaries[k])
+			{
+				--k;
+				s = intersection();
+			}
+
+			++k;
+			parabolas[k] = q;
+			boundaries[k] = s;
+			boundaries[k + 1] = std::numeric_limits<double>::infinity();
+			parabola_count = k + 1;
+		}
+
+		if(parabola_count == 0)
+		{
+			for(uint32_t x = 0; x != w; ++x)
+			{
+				distances(x, y) = std::numeric_limits<float>::infinity();
+				nearest_seed(x, y_in) = no_seed;
+			}
+			continue;
+		}
+
+		k = 0;
+		for(uint32_t x = 0; x != w; ++x)
+		{
+			auto const x_d = static_cast<double>(x);
+			while(boundaries[k + 1] < x_d)
+			{ ++k; }
+
+			auto const p = parabolas[k];
+			auto const dx = x_d - static_cast<double>(p);
+			distances(x, y) = static_cast<float>(std::sqrt(dx*dx + f(p, y_in)));
+			nearest_seed(x, y_in) = nearest_row(p, y_in)*w + p;
+		}
+	}
+}
+
+terraformer::distance_transform_result terraformer::make_distance_transform(
+	span_2d<bool const> seeds,
+	thread_pool<move_only_function<void()>>& workers
+)
+{
+	auto const w = seeds.width();
+	auto const h = seeds.height();
+	grayscale_image column_distances{w, h};
+	basic_image<uint32_t> nearest_row{w, h};
+	distance_transform_result ret{
+		.distances = grayscale_image{w, h},
+		.nearest_seed = basic_image<uint32_t>{w, h}
+	};
+
+	auto const n_column_jobs = std::min(static_cast<size_t>(w), workers.max_concurrency());
+	if(n_column_jobs == 0 || h == 0)
+	{ return ret; }
+
+	batch_result<void> pending_columns{n_column_jobs};
+	for(auto chunk : chunk_by_chunk_count_view{std::ranges::iota_view{0u, w}, n_column_jobs})
+	{
+		workers.submit(
+			[
+				&pending_columns = pending_columns.get_state(),
+				distances = column_distances.pixels(),
+				nearest_row = nearest_row.pixels(),
+				seeds,
+				x_begin = chunk.front(),
+				x_end = chunk.back() + 1
+			](){
+				compute_column_distances(distances, nearest_row, seeds, x_begin, x_end);
+				pending_columns.mark_batch_as_completed();
+			}
+		);
+	}
+	pending_columns.wait();
+
+	process_scanlines(
+		ret.distances.pixels(),
+		workers,
+		std::stop_token{},
+		[]<class ... Args>(Args&&... args){
+			compute_row_distances(std::forward<Args>(args)...);
+		},
+		ret.nearest_seed.pixels(),
+		std::as_const(column_distances).pixels(),
+		std::as_const(nearest_row).pixels()
+	).wait();
+
+	return ret;
+}
@@ -0,0 +1,82 @@
+//@	{"dependencies_extra":[{"ref":"./distance_transform.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_FILTERS_DISTANCE_TRANSFORM_HPP
+#define TERRAFORMER_FILTERS_DISTANCE_TRANSFORM_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/execution/thread_pool.hpp"
+#include "lib/pixel_store/image.hpp"
+
+#include <limits>
+
+namespace terraformer
+{
+	/**
+	 * Value stored in nearest_seed for pixels that do not have any seed pixel in reach
+	 */
+	inline constexpr auto no_seed = std::numeric_limits<uint32_t>::max();
+
+	struct distance_transform_result
+	{
+		/**
+		 * Euclidian distance, in pixels, to the closest seed pixel
+		 */
+		grayscale_image distances;
+
+		/**
+		 * The index y*width + x of the closest seed pixel, or no_seed if there are no seed pixels
+		 */
+		basic_image<uint32_t> nearest_seed;
+	};
+
+	inline pixel_coordinates seed_location(distance_transform_result const& res, uint32_t x, uint32_t y)
+	{
+		auto const i = res.nearest_seed(x, y);
+		auto const w = res.nearest_seed.width();
+		return pixel_coordinates{
+			.x = static_cast<int32_t>(i % w),
+			.y = static_cast<int32_t>(i / w)
+		};
+	}
+
+	/**
+	 * Computes the distance along each column to the closest seed pixel, together with the row of
+	 * that pixel. Only columns within [x_begin, x_end) are processed.
+	 */
+	void compute_column_distances(
+		span_2d<float> distances,
+		span_2d<uint32_t> nearest_row,
+		span_2d<bool const> seeds,
+		uint32_t x_begin,
+		uint32_t x_end
+	);
+
+	/**
+	 * Combines column distances into exact Euclidian distances, by computing the lower envelope of
+	 * the parabolas (x - x')^2 + column_distance(x')^2 along each row.
+	 *
+	 * NOTE: nearest_seed refers to the entire image, while distances only contains the rows
+	 *       assigned to the job.
+	 */
+	void compute_row_distances(
+		scanline_processing_job_info const& jobinfo,
+		span_2d<float> distances,
+		span_2d<uint32_t> nearest_seed,
+		span_2d<float const> column_distances,
+		span_2d<uint32_t const> nearest_row
+	);
+
+	/**
+	 * Computes the exact Euclidian distance transform of seeds, using the separable algorithm by
+	 * Felzenszwalb and Huttenlocher. The cost is linear in the number of pixels, regardless of the
+	 * number of seed pixels. Columns are processed in parallel in the first pass, and rows in the
+	 * second pass.
+	 */
+	distance_transform_result make_distance_transform(
+		span_2d<bool const> seeds,
+		thread_pool<move_only_function<void()>>& workers
+	);
+}
+
+#endif
@@ -0,0 +1,97 @@
+//@	{"target":{"name":"distance_transform.test"}}
+
+#include "./distance_transform.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace
+{
+	float brute_force_distance(terraformer::span_2d<bool const> seeds, uint32_t x, uint32_t y)
+	{
+		auto ret = std::numeric_limits<float>::infinity();
+		for(uint32_t y_s = 0; y_s != seeds.height(); ++y_s)
+		{
+			for(uint32_t x_s = 0; x_s != seeds.width(); ++x_s)
+			{
+				if(seeds(x_s, y_s))
+				{
+					auto const dx = static_cast<float>(x_s) - static_cast<float>(x);
+					auto const dy = static_cast<float>(y_s) - static_cast<float>(y);
+					ret = std::min(ret, std::sqrt(dx*dx + dy*dy));
+				}
+			}
+		}
+		return ret;
+	}
+}
+
+TESTCASE(terraformer_distance_transform_random_seeds)
+{
+	terraformer::basic_image<bool> seeds{47, 31};
+	std::mt19937 rng{12345};
+	std::bernoulli_distribution seed_dist{0.02};
+	for(uint32_t y = 0; y != seeds.height(); ++y)
+	{
+		for(uint32_t x = 0; x != seeds.width(); ++x)
+		{ seeds(x, y) = seed_dist(rng); }
+	}
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const res = make_distance_transform(seeds.pixels(), workers);
+
+	for(uint32_t y = 0; y != seeds.height(); ++y)
+	{
+		for(uint32_t x = 0; x != seeds.width(); ++x)
+		{
+			auto const expected = brute_force_distance(seeds.pixels(), x, y);
+			EXPECT_LT(std::abs(res.distances(x, y) - expected), 1.0e-5f);
+
+			auto const seed = seed_location(res, x, y);
+			EXPECT_EQ(seeds(seed.x, seed.y), true);
+
+			auto const dx = static_cast<float>(seed.x) - static_cast<float>(x);
+			auto const dy = static_cast<float>(seed.y) - static_cast<float>(y);
+			EXPECT_LT(std::abs(std::sqrt(dx*dx + dy*dy) - expected), 1.0e-5f);
+		}
+	}
+}
+
+TESTCASE(terraformer_distance_transform_single_seed_few_scanlines)
+{
+	terraformer::basic_image<bool> seeds{13, 2};
+	seeds(3, 1) = true;
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const res = make_distance_transform(seeds.pixels(), workers);
+
+	EXPECT_EQ(res.distances(3, 1), 0.0f);
+	EXPECT_EQ(res.distances(7, 1), 4.0f);
+	EXPECT_EQ(res.distances(3, 0), 1.0f);
+	EXPECT_EQ(res.distances(0, 0), std::sqrt(10.0f));
+	for(uint32_t y = 0; y != seeds.height(); ++y)
+	{
+		for(uint32_t x = 0; x != seeds.width(); ++x)
+		{ EXPECT_EQ(res.nearest_seed(x, y), 1u*13u + 3u); }
+	}
+}
+
+TESTCASE(terraformer_distance_transform_no_seeds)
+{
+	terraformer::basic_image<bool> seeds{9, 11};
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const res = make_distance_transform(seeds.pixels(), workers);
+
+	for(uint32_t y = 0; y != seeds.height(); ++y)
+	{
+		for(uint32_t x = 0; x != seeds.width(); ++x)
+		{
+			EXPECT_EQ(std::isinf(res.distances(x, y)), true);
+			EXPECT_EQ(res.nearest_seed(x, y), terraformer::no_seed);
+		}
+	}
+}
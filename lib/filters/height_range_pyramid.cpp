@@ -0,0 +1,142 @@
+//@	{"target":{"name":"./height_range_pyramid.o"}}
+
+#include "./height_range_pyramid.hpp"
+#include "./max_height_pyramid.hpp"
+
+#include <bit>
+#include <cmath>
+
+void terraformer::make_min_level(
+	scanline_processing_job_info const& jobinfo,
+	span_2d<float> output,
+	span_2d<float const> input
+)
+{
+	auto const w = static_cast<int32_t>(output.width());
+	auto const h = static_cast<int32_t>(output.height());
+	auto const input_y_offset = static_cast<int32_t>(jobinfo.input_y_offset);
+	using clamp_tag = span_2d_extents::clamp_tag;
+
+	for(int32_t y = 0; y != h; ++y)
+	{
+		auto const y_in = 2*(y + input_y_offset);
+		for(int32_t x = 0; x != w; ++x)
+		{
+			auto const x_in = 2*x;
+			output(x, y) = std::min(
+				std::min(input(x_in, y_in, clamp_tag{}), input(x_in + 1, y_in, clamp_tag{})),
+				std::min(input(x_in, y_in + 1, clamp_tag{}), input(x_in + 1, y_in + 1, clamp_tag{}))
+			);
+		}
+	}
+}
+
+terraformer::height_range_pyramid::height_range_pyramid(
+	span_2d<float const> heightmap,
+	thread_pool<move_only_function<void()>>& workers
+):m_source{heightmap}
+{
+	if(heightmap.width() == 0 || heightmap.height() == 0)
+	{ return; }
+
+	auto min_input = heightmap;
+	auto max_input = heightmap;
+	do
+	{
+		grayscale_image min_output{(min_input.width() + 1)/2, (min_input.height() + 1)/2};
+		process_scanlines(
+			min_output.pixels(),
+			workers,
+			std::stop_token{},
+			[]<class ... Args>(Args&&... args){
+				make_min_level(std::forward<Args>(args)...);
+			},
+			min_input
+		).wait();
+
+		grayscale_image max_output{(max_input.width() + 1)/2, (max_input.height() + 1)/2};
+		process_scanlines(
+			max_output.pixels(),
+			workers,
+			std::stop_token{},
+			[]<class ... Args>(Args&&... args){
+				make_max_level(std::forward<Args>(args)...);
+			},
+			max_input
+		).wait();
+
+		m_min_levels.push_back(std::move(min_output));
+		m_max_levels.push_back(std::move(max_output));
+		min_input = m_min_levels.back().pixels();
+		max_input = m_max_levels.back().pixels();
+	}
+	while(min_input.width() != 1 || min_input.height() != 1);
+
+	m_global_range = std::ranges::min_max_result<float>{
+		.min = min_input(0, 0),
+		.max = max_input(0, 0)
+	};
+}
+
+std::ranges::min_max_result<float> terraformer::height_range_pyramid::elevation_range(
+	float x_min,
+	float y_min,
+	float x_max,
+	float y_max
+) const
+{
+	auto const w = m_source.width();
+	auto const h = m_source.height();
+	if(w == 0 || h == 0)
+	{ return std::ranges::min_max_result<float>{}; }
+
+	auto const x_upper = static_cast<float>(w - 1);
+	auto const y_upper = static_cast<float>(h - 1);
+	auto const x_begin = static_cast<uint32_t>(std::floor(std::clamp(x_min, 0.0f, x_upper)));
+	auto const y_begin = static_cast<uint32_t>(std::floor(std::clamp(y_min, 0.0f, y_upper)));
+	auto const x_last = static_cast<uint32_t>(std::ceil(std::clamp(x_max, 0.0f, x_upper)));
+	auto const y_last = static_cast<uint32_t>(std::ceil(std::clamp(y_max, 0.0f, y_upper)));
+
+	auto const find_range = [](
+		span_2d<float const> min_vals,
+		span_2d<float const> max_vals,
+		uint32_t x_begin,
+		uint32_t y_begin,
+		uint32_t x_last,
+		uint32_t y_last
+	) {
+		std::ranges::min_max_result<float> ret{
+			.min = min_vals(x_begin, y_begin),
+			.max = max_vals(x_begin, y_begin)
+		};
+		for(auto y = y_begin; y != y_last + 1; ++y)
+		{
+			for(auto x = x_begin; x != x_last + 1; ++x)
+			{
+				ret.min = std::min(ret.min, min_vals(x, y));
+				ret.max = std::max(ret.max, max_vals(x, y));
+			}
+		}
+		return ret;
+	};
+
+	auto const pixel_count = std::max(x_last - x_begin, y_last - y_begin) + 1;
+	if(pixel_count < 4)
+	{ return find_range(m_source, m_source, x_begin, y_begin, x_last, y_last); }
+
+	// Pick the level where a cell is at most pixel_count wide. Then, the rectangle covers at
+	// most three cells in each direction.
+	auto const level = std::min(
+		static_cast<size_t>(std::bit_width(pixel_count) - 2),
+		level_count() - 1
+	);
+	auto const cell_size = 2u << level;
+	return find_range(
+		min_level(level),
+		max_level(level),
+		x_begin/cell_size,
+		y_begin/cell_size,
+		x_last/cell_size,
+		y_last/cell_size
+	);
+}
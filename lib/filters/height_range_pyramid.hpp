@@ -0,0 +1,82 @@
+//@	{"dependencies_extra":[{"ref":"./height_range_pyramid.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_FILTERS_HEIGHT_RANGE_PYRAMID_HPP
+#define TERRAFORMER_FILTERS_HEIGHT_RANGE_PYRAMID_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/execution/thread_pool.hpp"
+#include "lib/pixel_store/image.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace terraformer
+{
+	/**
+	 * Reduces input by a factor of two in both directions, by taking the min of each 2x2 block
+	 */
+	void make_min_level(
+		scanline_processing_job_info const& jobinfo,
+		span_2d<float> output,
+		span_2d<float const> input
+	);
+
+	/**
+	 * A mip pyramid where each level stores the min and max elevation within its cells. A cell at
+	 * level L covers 2^(L + 1) by 2^(L + 1) pixels of the source heightmap, and the last level
+	 * contains a single pixel. Unlike max_height_pyramid, there is no level at full resolution,
+	 * since bounds that cover less than 2x2 pixels are cheaper to compute from the source.
+	 *
+	 * NOTE: The pyramid refers to the source heightmap, which must outlive the pyramid.
+	 */
+	class height_range_pyramid
+	{
+	public:
+		height_range_pyramid() = default;
+
+		explicit height_range_pyramid(
+			span_2d<float const> heightmap,
+			thread_pool<move_only_function<void()>>& workers
+		);
+
+		span_2d<float const> source() const
+		{ return m_source; }
+
+		size_t level_count() const
+		{ return std::size(m_min_levels); }
+
+		span_2d<float const> min_level(size_t k) const
+		{ return m_min_levels[k].pixels(); }
+
+		span_2d<float const> max_level(size_t k) const
+		{ return m_max_levels[k].pixels(); }
+
+		float min_elevation() const
+		{ return m_global_range.min; }
+
+		float max_elevation() const
+		{ return m_global_range.max; }
+
+		/**
+		 * Returns bounds of the bilinear interpolation of the source heightmap within
+		 * [x_min, x_max]x[y_min, y_max]. Pixel (x, y) is centered at (x, y), and coordinates
+		 * outside the heightmap are clamped. At most nine pixels or cells are visited, regardless
+		 * of the size of the rectangle.
+		 */
+		std::ranges::min_max_result<float> elevation_range(
+			float x_min,
+			float y_min,
+			float x_max,
+			float y_max
+		) const;
+
+	private:
+		span_2d<float const> m_source;
+		std::vector<grayscale_image> m_min_levels;
+		std::vector<grayscale_image> m_max_levels;
+		std::ranges::min_max_result<float> m_global_range{};
+	};
+}
+
+#endif
@@ -0,0 +1,95 @@
+//@	{"target":{"name":"height_range_pyramid.test"}}
+
+#include "./height_range_pyramid.hpp"
+#include "./test_terrain.hpp"
+
+#include "lib/math_utils/interp.hpp"
+#include "lib/math_utils/boundary_sampling_policies.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <cmath>
+
+namespace
+{
+	constexpr terraformer::test_terrain_params terrain_params{
+		.amplitude = 32.0f,
+		.wavenumber_x = 0.17f,
+		.wavenumber_y = 0.23f,
+		.slope_x = -0.5f
+	};
+}
+
+TESTCASE(terraformer_height_range_pyramid_levels)
+{
+	auto const heightmap = make_test_terrain(37, 21, terrain_params);
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	terraformer::height_range_pyramid const pyramid{heightmap.pixels(), workers};
+
+	EXPECT_EQ(pyramid.level_count(), 6);
+	EXPECT_EQ(pyramid.min_level(0).width(), 19);
+	EXPECT_EQ(pyramid.min_level(0).height(), 11);
+	EXPECT_EQ(pyramid.max_level(5).width(), 1);
+	EXPECT_EQ(pyramid.max_level(5).height(), 1);
+
+	auto const expected_range = terraformer::minmax_value(heightmap.pixels());
+	EXPECT_EQ(pyramid.min_elevation(), expected_range.min);
+	EXPECT_EQ(pyramid.max_elevation(), expected_range.max);
+
+	for(size_t level = 0; level != pyramid.level_count(); ++level)
+	{
+		auto const cell_size = 2u << level;
+		auto const min_vals = pyramid.min_level(level);
+		auto const max_vals = pyramid.max_level(level);
+		for(uint32_t y = 0; y != heightmap.height(); ++y)
+		{
+			for(uint32_t x = 0; x != heightmap.width(); ++x)
+			{
+				EXPECT_LE(min_vals(x/cell_size, y/cell_size), heightmap(x, y));
+				EXPECT_GE(max_vals(x/cell_size, y/cell_size), heightmap(x, y));
+			}
+		}
+	}
+}
+
+TESTCASE(terraformer_height_range_pyramid_elevation_range_bounds_interpolated_values)
+{
+	auto const heightmap = make_test_terrain(64, 48, terrain_params);
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	terraformer::height_range_pyramid const pyramid{heightmap.pixels(), workers};
+
+	for(auto const size : {0.0f, 0.75f, 2.5f, 5.0f, 13.0f, 40.0f, 100.0f})
+	{
+		for(float y = -3.0f; y < 50.0f; y += 4.25f)
+		{
+			for(float x = -2.0f; x < 66.0f; x += 3.5f)
+			{
+				auto const range = pyramid.elevation_range(x, y, x + size, y + 0.5f*size);
+				EXPECT_LE(range.min, range.max);
+				for(int k = 0; k != 9; ++k)
+				{
+					auto const t = static_cast<float>(k)/8.0f;
+					auto const val = interp(
+						heightmap.pixels(),
+						x + t*size,
+						y + 0.5f*t*size,
+						terraformer::clamp_at_boundary{}
+					);
+					EXPECT_LE(range.min, val);
+					EXPECT_GE(range.max, val);
+				}
+			}
+		}
+	}
+}
+
+TESTCASE(terraformer_height_range_pyramid_elevation_range_is_exact_for_single_pixel)
+{
+	auto const heightmap = make_test_terrain(16, 16, terrain_params);
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	terraformer::height_range_pyramid const pyramid{heightmap.pixels(), workers};
+
+	auto const range = pyramid.elevation_range(5.0f, 7.0f, 5.0f, 7.0f);
+	EXPECT_EQ(range.min, heightmap(5, 7));
+	EXPECT_EQ(range.max, heightmap(5, 7));
+}
@@ -0,0 +1,275 @@
+//@	{"target":{"name":"./hydraulic_erosion.o"}}
+
+#include "./hydraulic_erosion.hpp"
+
+#include "lib/execution/batch_result.hpp"
+#include "lib/math_utils/boundary_sampling_policies.hpp"
+#include "lib/math_utils/differentiation.hpp"
+#include "lib/math_utils/interp.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <random>
+
+terraformer::erosion_brush::erosion_brush(int32_t radius):
+	m_radius{std::max(radius, 0)},
+	m_weights(static_cast<size_t>((2*m_radius + 1)*(2*m_radius + 1)))
+{
+	auto const size = 2*m_radius + 1;
+	auto const r = static_cast<float>(m_radius) + 0.5f;
+	auto sum = 0.0f;
+	for(int32_t y = 0; y != size; ++y)
+	{
+		for(int32_t x = 0; x != size; ++x)
+		{
+			auto const dx = static_cast<float>(x - m_radius);
+			auto const dy = static_cast<float>(y - m_radius);
+			auto const w = std::max(r - std::sqrt(dx*dx + dy*dy), 0.0f);
+			m_weights[static_cast<size_t>(y*size + x)] = w;
+			sum += w;
+		}
+	}
+
+	for(auto& item : m_weights)
+	{ item /= sum; }
+}
+
+void terraformer::erosion_brush::apply(span_2d<float> heightmap, uint32_t x, uint32_t y, float amount) const
+{
+	auto const size = static_cast<size_t>(2*m_radius + 1);
+	auto const x_0 = x - static_cast<uint32_t>(m_radius);
+	auto const y_0 = y - static_cast<uint32_t>(m_radius);
+
+	// NOTE: Each brush row is contiguous in memory, which lets the compiler vectorize the inner
+	//       loop
+	for(size_t row = 0; row != size; ++row)
+	{
+		auto const output = &heightmap(x_0, y_0 + static_cast<uint32_t>(row));
+		auto const weights = m_weights.data() + row*size;
+		for(size_t k = 0; k != size; ++k)
+		{ output[k] -= amount*weights[k]; }
+	}
+}
+
+void terraformer::simulate_droplets(
+	span_2d<float> heightmap,
+	pixel_region spawn_region,
+	pixel_region owned_region,
+	size_t droplet_count,
+	random_generator& rng,
+	erosion_brush const& brush,
+	hydraulic_erosion_descriptor const& params
+)
+{
+	// Keep droplets far enough from the boundary of owned_region, so that the brush, and all
+	// samples needed by interp and grad, stay inside it.
+	auto const margin = static_cast<float>(std::max(brush.radius(), 1) + 2);
+	auto const x_min = static_cast<float>(owned_region.x_begin) + margin;
+	auto const y_min = static_cast<float>(owned_region.y_begin) + margin;
+	auto const x_max = static_cast<float>(owned_region.x_end) - margin;
+	auto const y_max = static_cast<float>(owned_region.y_end) - margin;
+
+	auto const spawn_x_min = std::max(static_cast<float>(spawn_region.x_begin), x_min);
+	auto const spawn_y_min = std::max(static_cast<float>(spawn_region.y_begin), y_min);
+	auto const spawn_x_max = std::min(static_cast<float>(spawn_region.x_end), x_max);
+	auto const spawn_y_max = std::min(static_cast<float>(spawn_region.y_end), y_max);
+	if(spawn_x_min >= spawn_x_max || spawn_y_min >= spawn_y_max)
+	{ return; }
+
+	std::uniform_real_distribution spawn_x{spawn_x_min, spawn_x_max};
+	std::uniform_real_distribution spawn_y{spawn_y_min, spawn_y_max};
+	auto const inside_owned_region = [x_min, y_min, x_max, y_max](float x, float y) {
+		return x >= x_min && x < x_max && y >= y_min && y < y_max;
+	};
+
+	for(size_t droplet = 0; droplet != droplet_count; ++droplet)
+	{
+		auto x = spawn_x(rng);
+		auto y = spawn_y(rng);
+		auto dir_x = 0.0f;
+		auto dir_y = 0.0f;
+		auto speed = params.initial_speed;
+		auto water = params.initial_water;
+		auto sediment = 0.0f;
+
+		for(size_t k = 0; k != params.max_lifetime; ++k)
+		{
+			auto const cell_x = static_cast<uint32_t>(x);
+			auto const cell_y = static_cast<uint32_t>(y);
+			auto const z = interp(heightmap, x, y, clamp_at_boundary{});
+			auto const g = grad(heightmap, x, y, 1.0f, clamp_at_boundary{});
+
+			dir_x = dir_x*params.inertia - g[0]*(1.0f - params.inertia);
+			dir_y = dir_y*params.inertia - g[1]*(1.0f - params.inertia);
+			auto const dir_length = std::sqrt(dir_x*dir_x + dir_y*dir_y);
+			if(dir_length == 0.0f)
+			{ break; }
+
+			dir_x /= dir_length;
+			dir_y /= dir_length;
+			auto const x_next = x + dir_x;
+			auto const y_next = y + dir_y;
+			if(!inside_owned_region(x_next, y_next))
+			{ break; }
+
+			auto const dz = interp(heightmap, x_next, y_next, clamp_at_boundary{}) - z;
+			auto const capacity = std::max(-dz*speed*water*params.capacity, params.min_capacity);
+
+			if(sediment > capacity || dz > 0.0f)
+			{
+				auto const amount = dz > 0.0f?
+					std::min(dz, sediment) :
+					(sediment - capacity)*params.deposition_rate;
+				sediment -= amount;
+
+				auto const t_x = x - static_cast<float>(cell_x);
+				auto const t_y = y - static_cast<float>(cell_y);
+				heightmap(cell_x, cell_y) += amount*(1.0f - t_x)*(1.0f - t_y);
+				heightmap(cell_x + 1, cell_y) += amount*t_x*(1.0f - t_y);
+				heightmap(cell_x, cell_y + 1) += amount*(1.0f - t_x)*t_y;
+				heightmap(cell_x + 1, cell_y + 1) += amount*t_x*t_y;
+			}
+			else
+			{
+				auto const amount = std::min((capacity - sediment)*params.erosion_rate, -dz);
+				brush.apply(heightmap, cell_x, cell_y, amount);
+				sediment += amount;
+			}
+
+			speed = std::sqrt(std::max(speed*speed - dz*params.gravity, 0.0f));
+			water *= 1.0f - params.evaporation_rate;
+			x = x_next;
+			y = y_next;
+		}
+	}
+}
+
+namespace
+{
+	struct tile_info
+	{
+		terraformer::pixel_region spawn_region;
+		terraformer::pixel_region owned_region;
+		size_t droplet_count;
+		size_t phase;
+	};
+
+	std::vector<tile_info> make_tiles(
+		terraformer::span_2d_extents domain_size,
+		terraformer::hydraulic_erosion_descriptor const& params
+	)
+	{
+		auto const tile_size = std::max(params.tile_size, 1u);
+		auto const halo = tile_size/2;
+		auto const w = domain_size.width;
+		auto const h = domain_size.height;
+		auto const total_area = static_cast<double>(w)*static_cast<double>(h);
+
+		std::vector<tile_info> ret;
+		auto accumulated_area = 0.0;
+		size_t accumulated_droplets = 0;
+		for(uint32_t y = 0; y < h; y += tile_size)
+		{
+			for(uint32_t x = 0; x < w; x += tile_size)
+			{
+				terraformer::pixel_region const spawn_region{
+					.x_begin = x,
+					.y_begin = y,
+					.x_end = std::min(x + tile_size, w),
+					.y_end = std::min(y + tile_size, h)
+				};
+
+				// Distribute droplets proportionally to tile area, without losing any to rounding
+				accumulated_area += static_cast<double>(spawn_region.x_end - spawn_region.x_begin)
+					*static_cast<double>(spawn_region.y_end - spawn_region.y_begin);
+				auto const droplets_so_far = static_cast<size_t>(
+					static_cast<double>(params.droplet_count)*accumulated_area/total_area
+				);
+
+				ret.push_back(
+					tile_info{
+						.spawn_region = spawn_region,
+						.owned_region = terraformer::pixel_region{
+							.x_begin = x >= halo? x - halo : 0,
+							.y_begin = y >= halo? y - halo : 0,
+							.x_end = std::min(x + tile_size + halo, w),
+							.y_end = std::min(y + tile_size + halo, h)
+						},
+						.droplet_count = droplets_so_far - accumulated_droplets,
+						.phase = 2*((y/tile_size)%2) + (x/tile_size)%2
+					}
+				);
+				accumulated_droplets = droplets_so_far;
+			}
+		}
+		return ret;
+	}
+}
+
+void terraformer::erode_hydraulic(
+	span_2d<float> heightmap,
+	hydraulic_erosion_descriptor const& params,
+	thread_pool<move_only_function<void()>>& workers
+)
+{
+	auto const tiles = make_tiles(heightmap.extents(), params);
+	if(tiles.empty())
+	{ return; }
+
+	random_generator master_rng{std::bit_cast<rng_seed_type>(params.rng_seed)};
+	std::vector<random_generator> rngs;
+	rngs.reserve(std::size(tiles));
+	for(size_t k = 0; k != std::size(tiles); ++k)
+	{ rngs.push_back(random_generator{generate_rng_seed(master_rng)}); }
+
+	erosion_brush const brush{params.brush_radius};
+	auto const round_count = std::max(params.round_count, static_cast<size_t>(1));
+	for(size_t round = 0; round != round_count; ++round)
+	{
+		// NOTE: Tiles within the same phase are two tiles apart, so their owned regions do not
+		//       overlap
+		for(size_t phase = 0; phase != 4; ++phase)
+		{
+			auto const task_count = static_cast<size_t>(
+				std::ranges::count_if(tiles, [phase](auto const& item){ return item.phase == phase; })
+			);
+			if(task_count == 0)
+			{ continue; }
+
+			batch_result<void> pending_tiles{task_count};
+			for(size_t k = 0; k != std::size(tiles); ++k)
+			{
+				auto const& tile = tiles[k];
+				if(tile.phase != phase)
+				{ continue; }
+
+				auto const droplet_count = tile.droplet_count*(round + 1)/round_count
+					- tile.droplet_count*round/round_count;
+				workers.submit(
+					[
+						heightmap,
+						&tile,
+						droplet_count,
+						&rng = rngs[k],
+						&brush,
+						&params,
+						&pending_tiles = pending_tiles.get_state()
+					](){
+						simulate_droplets(
+							heightmap,
+							tile.spawn_region,
+							tile.owned_region,
+							droplet_count,
+							rng,
+							brush,
+							params
+						);
+						pending_tiles.mark_batch_as_completed();
+					}
+				);
+			}
+			pending_tiles.wait();
+		}
+	}
+}
@@ -0,0 +1,101 @@
+//@	{"dependencies_extra":[{"ref":"./hydraulic_erosion.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_FILTERS_HYDRAULIC_EROSION_HPP
+#define TERRAFORMER_FILTERS_HYDRAULIC_EROSION_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/common/rng.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/execution/thread_pool.hpp"
+
+#include <array>
+#include <vector>
+
+namespace terraformer
+{
+	struct hydraulic_erosion_descriptor
+	{
+		std::array<std::byte, 16> rng_seed{};
+		size_t droplet_count = 65536;
+		size_t max_lifetime = 32;
+		float inertia = 0.05f;
+		float capacity = 4.0f;
+		float min_capacity = 0.01f;
+		float erosion_rate = 0.3f;
+		float deposition_rate = 0.3f;
+		float evaporation_rate = 0.01f;
+		float gravity = 4.0f;
+		float initial_water = 1.0f;
+		float initial_speed = 1.0f;
+		int32_t brush_radius = 3;
+
+		/**
+		 * The map is split into tiles of tile_size x tile_size pixels. Each tile owns a region that
+		 * extends tile_size/2 pixels into its neighbours.
+		 */
+		uint32_t tile_size = 256;
+
+		/**
+		 * Number of times all tiles are visited. Droplets are evenly distributed between rounds,
+		 * so erosion in one tile can affect droplets in its neighbours in the next round.
+		 */
+		size_t round_count = 4;
+
+		bool operator==(hydraulic_erosion_descriptor const&) const = default;
+		bool operator!=(hydraulic_erosion_descriptor const&) const = default;
+	};
+
+	/**
+	 * Weights used to distribute eroded material around the center pixel. Weights decrease
+	 * linearly with distance, and sum to one.
+	 */
+	class erosion_brush
+	{
+	public:
+		explicit erosion_brush(int32_t radius);
+
+		int32_t radius() const
+		{ return m_radius; }
+
+		/**
+		 * Subtracts amount, distributed according to the brush, from the pixels around (x, y).
+		 * All pixels covered by the brush must be inside heightmap.
+		 */
+		void apply(span_2d<float> heightmap, uint32_t x, uint32_t y, float amount) const;
+
+	private:
+		int32_t m_radius;
+		std::vector<float> m_weights;
+	};
+
+	/**
+	 * Simulates droplets spawned within spawn_region. Droplets are only allowed to read and modify
+	 * pixels within owned_region, and are removed when they get too close to its boundary.
+	 */
+	void simulate_droplets(
+		span_2d<float> heightmap,
+		pixel_region spawn_region,
+		pixel_region owned_region,
+		size_t droplet_count,
+		random_generator& rng,
+		erosion_brush const& brush,
+		hydraulic_erosion_descriptor const& params
+	);
+
+	/**
+	 * Erodes heightmap with a particle based hydraulic erosion model. Droplets pick up sediment
+	 * when moving downhill faster than their capacity allows, and deposit it when they slow down
+	 * or move uphill.
+	 *
+	 * To avoid synchronization on the heightmap, tiles are processed in four phases, so that
+	 * tiles that run at the same time own disjoint regions. Every tile has its own random number
+	 * generator, which makes the result independent of the number of workers.
+	 */
+	void erode_hydraulic(
+		span_2d<float> heightmap,
+		hydraulic_erosion_descriptor const& params,
+		thread_pool<move_only_function<void()>>& workers
+	);
+}
+
+#endif
@@ -0,0 +1,80 @@
+//@	{"target":{"name":"hydraulic_erosion.test"}}
+
+#include "./hydraulic_erosion.hpp"
+#include "./test_terrain.hpp"
+
+#include "lib/pixel_store/image.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+namespace
+{
+	constexpr terraformer::test_terrain_params terrain_params{
+		.amplitude = 16.0f,
+		.wavenumber_x = 0.11f,
+		.wavenumber_y = 0.07f,
+		.slope_x = 0.125f
+	};
+
+	double sum(terraformer::span_2d<float const> pixels)
+	{
+		auto ret = 0.0;
+		for(auto item : pixels)
+		{ ret += static_cast<double>(item); }
+		return ret;
+	}
+}
+
+TESTCASE(terraformer_erosion_brush_weights_sum_to_one)
+{
+	terraformer::grayscale_image img{9, 9};
+	terraformer::erosion_brush const brush{3};
+	brush.apply(img.pixels(), 4, 4, 1.0f);
+
+	EXPECT_LT(std::abs(sum(img.pixels()) + 1.0), 1.0e-6);
+	EXPECT_LT(img(4, 4), img(5, 4));
+	EXPECT_EQ(img(0, 0), 0.0f);
+	EXPECT_EQ(img(1, 4), img(7, 4));
+}
+
+TESTCASE(terraformer_hydraulic_erosion_does_not_create_material)
+{
+	auto heightmap = make_test_terrain(200, 150, terrain_params);
+	auto const input = heightmap;
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	erode_hydraulic(
+		heightmap.pixels(),
+		terraformer::hydraulic_erosion_descriptor{
+			.droplet_count = 4096,
+			.tile_size = 64
+		},
+		workers
+	);
+
+	auto const sum_before = sum(input.pixels());
+	auto const sum_after = sum(heightmap.pixels());
+	EXPECT_LT(sum_after, sum_before);
+	EXPECT_GT(sum_after, 0.9*sum_before);
+
+	for(auto item : heightmap.pixels())
+	{ EXPECT_EQ(std::isfinite(item), true); }
+}
+
+TESTCASE(terraformer_hydraulic_erosion_result_independent_of_worker_count)
+{
+	auto const input = make_test_terrain(200, 150, terrain_params);
+	terraformer::hydraulic_erosion_descriptor const params{
+		.droplet_count = 4096,
+		.tile_size = 64
+	};
+
+	auto a = input;
+	terraformer::thread_pool<terraformer::move_only_function<void()>> one_worker{1};
+	erode_hydraulic(a.pixels(), params, one_worker);
+
+	auto b = input;
+	terraformer::thread_pool<terraformer::move_only_function<void()>> four_workers{4};
+	erode_hydraulic(b.pixels(), params, four_workers);
+
+	EXPECT_EQ(std::ranges::equal(a.pixels(), b.pixels()), true);
+}
@@ -0,0 +1,430 @@
+//@	{"target":{"name":"./hydrology.o"}}
+
+#include "./hydrology.hpp"
+
+#include "lib/execution/batch_result.hpp"
+
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	auto neighbour_distance(size_t k)
+	{ return k % 2 == 0? 1.0f : std::numbers::sqrt2_v<float>; }
+
+	auto raise(float z, float epsilon)
+	{
+		auto const ret = z + epsilon;
+		return ret > z? ret : std::nextafter(z, std::numeric_limits<float>::infinity());
+	}
+
+	struct flood_queue_entry
+	{
+		float z;
+		uint32_t x;
+		uint32_t y;
+
+		bool operator>(flood_queue_entry const& other) const
+		{ return z > other.z; }
+	};
+
+	struct d8_receiver_visitor
+	{
+		terraformer::span_2d<uint8_t const> directions;
+
+		template<class Callable>
+		void operator()(uint32_t x, uint32_t y, Callable&& cb) const
+		{
+			auto const k = directions(x, y);
+			if(k != terraformer::d8_no_outflow)
+			{ cb(k, 1.0f); }
+		}
+	};
+
+	struct dinf_receiver_visitor
+	{
+		terraformer::span_2d<float const> directions;
+
+		template<class Callable>
+		void operator()(uint32_t x, uint32_t y, Callable&& cb) const
+		{
+			auto const angle = directions(x, y);
+			if(std::isnan(angle))
+			{ return; }
+
+			auto const receivers = terraformer::get_dinf_receivers(angle);
+			for(size_t k = 0; k != 2; ++k)
+			{
+				if(receivers.weights[k] > 0.0f)
+				{ cb(receivers.neighbours[k], receivers.weights[k]); }
+			}
+		}
+	};
+
+	template<class ReceiverVisitor>
+	void count_donors(
+		terraformer::scanline_processing_job_info const& jobinfo,
+		terraformer::span_2d<uint8_t> output,
+		ReceiverVisitor const& visit_receivers,
+		terraformer::span_2d_extents domain_size
+	)
+	{
+		auto const w = output.width();
+		auto const h = output.height();
+		auto const input_y_offset = jobinfo.input_y_offset;
+
+		for(uint32_t y = 0; y != h; ++y)
+		{
+			auto const y_in = static_cast<int32_t>(y + input_y_offset);
+			for(uint32_t x = 0; x != w; ++x)
+			{
+				uint8_t count = 0;
+				for(size_t k = 0; k != std::size(terraformer::d8_neighbours); ++k)
+				{
+					auto const offset = terraformer::d8_neighbours[k];
+					auto const x_n = static_cast<int32_t>(x) + offset.x;
+					auto const y_n = y_in + offset.y;
+					if(x_n < 0 || x_n >= static_cast<int32_t>(domain_size.width)
+						|| y_n < 0 || y_n >= static_cast<int32_t>(domain_size.height))
+					{ continue; }
+
+					// The neighbour is a donor if it drains in the opposite direction of offset
+					visit_receivers(
+						static_cast<uint32_t>(x_n),
+						static_cast<uint32_t>(y_n),
+						[&count, opposite = (k + 4)%8](uint8_t receiver, float){
+							if(receiver == opposite)
+							{ ++count; }
+						}
+					);
+				}
+				output(x, y) = count;
+			}
+		}
+	}
+
+	template<class ReceiverVisitor>
+	terraformer::grayscale_image accumulate_flow(
+		terraformer::span_2d_extents domain_size,
+		ReceiverVisitor const& visit_receivers,
+		terraformer::thread_pool<terraformer::move_only_function<void()>>& workers
+	)
+	{
+		auto const w = domain_size.width;
+		auto const h = domain_size.height;
+		terraformer::basic_image<uint8_t> donor_count{w, h};
+		process_scanlines(
+			donor_count.pixels(),
+			workers,
+			std::stop_token{},
+			[]<class ... Args>(Args&&... args){
+				count_donors(std::forward<Args>(args)...);
+			},
+			visit_receivers,
+			domain_size
+		).wait();
+
+		terraformer::grayscale_image ret{w, h};
+		std::vector<terraformer::pixel_coordinates> pending;
+		for(uint32_t y = 0; y != h; ++y)
+		{
+			for(uint32_t x = 0; x != w; ++x)
+			{
+				ret(x, y) = 1.0f;
+				if(donor_count(x, y) == 0)
+				{ pending.push_back(terraformer::pixel_coordinates{static_cast<int32_t>(x), static_cast<int32_t>(y)}); }
+			}
+		}
+
+		// NOTE: A pixel is only pushed when all its donors have been processed, so its
+		//       accumulated flow is final when it is popped.
+		while(!pending.empty())
+		{
+			auto const current = pending.back();
+			pending.pop_back();
+			auto const x = static_cast<uint32_t>(current.x);
+			auto const y = static_cast<uint32_t>(current.y);
+			auto const flow = ret(x, y);
+			visit_receivers(x, y, [&](uint8_t receiver, float weight){
+				auto const offset = terraformer::d8_neighbours[receiver];
+				auto const x_n = static_cast<uint32_t>(current.x + offset.x);
+				auto const y_n = static_cast<uint32_t>(current.y + offset.y);
+				ret(x_n, y_n) += weight*flow;
+				--donor_count(x_n, y_n);
+				if(donor_count(x_n, y_n) == 0)
+				{
+					pending.push_back(
+						terraformer::pixel_coordinates{
+							static_cast<int32_t>(x_n),
+							static_cast<int32_t>(y_n)
+						}
+					);
+				}
+			});
+		}
+
+		return ret;
+	}
+}
+
+terraformer::grayscale_image terraformer::fill_depressions(span_2d<float const> heightmap, float epsilon)
+{
+	grayscale_image ret{heightmap};
+	auto const w = heightmap.width();
+	auto const h = heightmap.height();
+	if(w == 0 || h == 0)
+	{ return ret; }
+
+	basic_image<uint8_t> closed{w, h};
+
+	std::priority_queue<flood_queue_entry, std::vector<flood_queue_entry>, std::greater<>> open;
+	std::queue<pixel_coordinates> pit;
+
+	auto const push_boundary_pixel = [&](uint32_t x, uint32_t y){
+		if(closed(x, y))
+		{ return; }
+		closed(x, y) = 1;
+		open.push(flood_queue_entry{ret(x, y), x, y});
+	};
+
+	for(uint32_t x = 0; x != w; ++x)
+	{
+		push_boundary_pixel(x, 0);
+		push_boundary_pixel(x, h - 1);
+	}
+
+	for(uint32_t y = 0; y != h; ++y)
+	{
+		push_boundary_pixel(0, y);
+		push_boundary_pixel(w - 1, y);
+	}
+
+	auto const extents = ret.pixels();
+	while(!open.empty() || !pit.empty())
+	{
+		pixel_coordinates current;
+		if(!pit.empty())
+		{
+			current = pit.front();
+			pit.pop();
+		}
+		else
+		{
+			auto const item = open.top();
+			open.pop();
+			current = pixel_coordinates{static_cast<int32_t>(item.x), static_cast<int32_t>(item.y)};
+		}
+
+		auto const z_min = raise(ret(static_cast<uint32_t>(current.x), static_cast<uint32_t>(current.y)), epsilon);
+		for(auto const offset : d8_neighbours)
+		{
+			auto const x_n = current.x + offset.x;
+			auto const y_n = current.y + offset.y;
+			if(!inside(extents, x_n, y_n))
+			{ continue; }
+
+			auto const x = static_cast<uint32_t>(x_n);
+			auto const y = static_cast<uint32_t>(y_n);
+			if(closed(x, y))
+			{ continue; }
+
+			closed(x, y) = 1;
+			if(ret(x, y) <= z_min)
+			{
+				ret(x, y) = z_min;
+				pit.push(pixel_coordinates{x_n, y_n});
+			}
+			else
+			{ open.push(flood_queue_entry{ret(x, y), x, y}); }
+		}
+	}
+
+	return ret;
+}
+
+void terraformer::compute_d8_directions(
+	scanline_processing_job_info const& jobinfo,
+	span_2d<uint8_t> output,
+	span_2d<float const> heightmap
+)
+{
+	auto const w = output.width();
+	auto const h = output.height();
+	auto const input_y_offset = jobinfo.input_y_offset;
+
+	for(uint32_t y = 0; y != h; ++y)
+	{
+		auto const y_in = static_cast<int32_t>(y + input_y_offset);
+		for(uint32_t x = 0; x != w; ++x)
+		{
+			auto const z = heightmap(x, static_cast<uint32_t>(y_in));
+			auto steepest_slope = 0.0f;
+			auto direction = d8_no_outflow;
+			for(size_t k = 0; k != std::size(d8_neighbours); ++k)
+			{
+				auto const x_n = static_cast<int32_t>(x) + d8_neighbours[k].x;
+				auto const y_n = y_in + d8_neighbours[k].y;
+				if(!inside(heightmap, x_n, y_n))
+				{ continue; }
+
+				auto const z_n = heightmap(static_cast<uint32_t>(x_n), static_cast<uint32_t>(y_n));
+				auto const slope = (z - z_n)/neighbour_distance(k);
+				if(slope > steepest_slope)
+				{
+					steepest_slope = slope;
+					direction = static_cast<uint8_t>(k);
+				}
+			}
+			output(x, y) = direction;
+		}
+	}
+}
+
+void terraformer::compute_dinf_directions(
+	scanline_processing_job_info const& jobinfo,
+	span_2d<float> output,
+	span_2d<float const> heightmap
+)
+{
+	auto const w = output.width();
+	auto const h = output.height();
+	auto const input_y_offset = jobinfo.input_y_offset;
+	constexpr auto sector_angle = std::numbers::pi_v<float>/4.0f;
+	constexpr auto two_pi = 2.0f*std::numbers::pi_v<float>;
+
+	for(uint32_t y = 0; y != h; ++y)
+	{
+		auto const y_in = static_cast<int32_t>(y + input_y_offset);
+		for(uint32_t x = 0; x != w; ++x)
+		{
+			auto const z = heightmap(x, static_cast<uint32_t>(y_in));
+			auto steepest_slope = 0.0f;
+			auto direction = std::numeric_limits<float>::quiet_NaN();
+
+			// Each facet is the triangle spanned by the pixel and two adjacent neighbours
+			for(size_t k = 0; k != std::size(d8_neighbours); ++k)
+			{
+				auto const p_1 = d8_neighbours[k];
+				auto const p_2 = d8_neighbours[(k + 1)%8];
+				auto const x_1 = static_cast<int32_t>(x) + p_1.x;
+				auto const y_1 = y_in + p_1.y;
+				auto const x_2 = static_cast<int32_t>(x) + p_2.x;
+				auto const y_2 = y_in + p_2.y;
+				if(!inside(heightmap, x_1, y_1) || !inside(heightmap, x_2, y_2))
+				{ continue; }
+
+				auto const dz_1 = heightmap(static_cast<uint32_t>(x_1), static_cast<uint32_t>(y_1)) - z;
+				auto const dz_2 = heightmap(static_cast<uint32_t>(x_2), static_cast<uint32_t>(y_2)) - z;
+
+				// Solve for the gradient g of the plane through the facet: g.p_1 = dz_1, g.p_2 = dz_2
+				auto const p_1x = static_cast<float>(p_1.x);
+				auto const p_1y = static_cast<float>(p_1.y);
+				auto const p_2x = static_cast<float>(p_2.x);
+				auto const p_2y = static_cast<float>(p_2.y);
+				auto const det = p_1x*p_2y - p_1y*p_2x;
+				auto const g_x = (dz_1*p_2y - p_1y*dz_2)/det;
+				auto const g_y = (p_1x*dz_2 - dz_1*p_2x)/det;
+
+				auto const facet_start = static_cast<float>(k)*sector_angle;
+				auto const descent_angle = std::atan2(-g_y, -g_x);
+				auto rel_angle = (descent_angle < 0.0f? descent_angle + two_pi : descent_angle) - facet_start;
+				rel_angle = rel_angle < 0.0f? rel_angle + two_pi : rel_angle;
+
+				auto slope = 0.0f;
+				auto angle = 0.0f;
+				if(rel_angle <= sector_angle)
+				{
+					slope = std::sqrt(g_x*g_x + g_y*g_y);
+					angle = facet_start + rel_angle;
+				}
+				else
+				{
+					// The steepest direction is outside the facet, use the steepest edge instead
+					auto const slope_1 = -dz_1/neighbour_distance(k);
+					auto const slope_2 = -dz_2/neighbour_distance(k + 1);
+					slope = std::max(slope_1, slope_2);
+					angle = slope_1 >= slope_2? facet_start : facet_start + sector_angle;
+				}
+
+				if(slope > steepest_slope)
+				{
+					steepest_slope = slope;
+					direction = angle >= two_pi? angle - two_pi : angle;
+				}
+			}
+			output(x, y) = direction;
+		}
+	}
+}
+
+terraformer::grayscale_image terraformer::accumulate_d8_flow(
+	span_2d<uint8_t const> directions,
+	thread_pool<move_only_function<void()>>& workers
+)
+{ return accumulate_flow(directions.extents(), d8_receiver_visitor{directions}, workers); }
+
+terraformer::grayscale_image terraformer::accumulate_dinf_flow(
+	span_2d<float const> directions,
+	thread_pool<move_only_function<void()>>& workers
+)
+{ return accumulate_flow(directions.extents(), dinf_receiver_visitor{directions}, workers); }
+
+terraformer::drainage_maps terraformer::make_drainage_maps(
+	span_2d<float const> heightmap,
+	drainage_descriptor const& params,
+	thread_pool<move_only_function<void()>>& workers
+)
+{
+	auto const w = heightmap.width();
+	auto const h = heightmap.height();
+	drainage_maps ret{
+		.filled_heightmap = fill_depressions(heightmap, params.epsilon),
+		.lake_depth = grayscale_image{w, h},
+		.d8_directions = basic_image<uint8_t>{w, h},
+		.discharge = grayscale_image{}
+	};
+
+	for(uint32_t y = 0; y != h; ++y)
+	{
+		for(uint32_t x = 0; x != w; ++x)
+		{ ret.lake_depth(x, y) = ret.filled_heightmap(x, y) - heightmap(x, y); }
+	}
+
+	auto const filled = std::as_const(ret.filled_heightmap).pixels();
+	process_scanlines(
+		ret.d8_directions.pixels(),
+		workers,
+		std::stop_token{},
+		[]<class ... Args>(Args&&... args){
+			compute_d8_directions(std::forward<Args>(args)...);
+		},
+		filled
+	).wait();
+
+	switch(params.routing)
+	{
+		case flow_routing::d8:
+			ret.discharge = accumulate_d8_flow(ret.d8_directions.pixels(), workers);
+			break;
+
+		case flow_routing::dinf:
+		{
+			grayscale_image directions{w, h};
+			process_scanlines(
+				directions.pixels(),
+				workers,
+				std::stop_token{},
+				[]<class ... Args>(Args&&... args){
+					compute_dinf_directions(std::forward<Args>(args)...);
+				},
+				filled
+			).wait();
+			ret.discharge = accumulate_dinf_flow(directions.pixels(), workers);
+			break;
+		}
+	}
+
+	return ret;
+}
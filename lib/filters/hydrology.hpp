@@ -0,0 +1,137 @@
+//@	{"dependencies_extra":[{"ref":"./hydrology.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_FILTERS_HYDROLOGY_HPP
+#define TERRAFORMER_FILTERS_HYDROLOGY_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/execution/thread_pool.hpp"
+#include "lib/pixel_store/image.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+
+namespace terraformer
+{
+	/**
+	 * Offsets to the eight neighbours of a pixel, sorted by angle. Neighbour k is located in the
+	 * direction k*pi/4, measured from the x axis towards the y axis.
+	 */
+	inline constexpr std::array<pixel_coordinates, 8> d8_neighbours{
+		pixel_coordinates{1, 0},
+		pixel_coordinates{1, 1},
+		pixel_coordinates{0, 1},
+		pixel_coordinates{-1, 1},
+		pixel_coordinates{-1, 0},
+		pixel_coordinates{-1, -1},
+		pixel_coordinates{0, -1},
+		pixel_coordinates{1, -1}
+	};
+
+	/**
+	 * Value stored in a D8 direction map for pixels without any lower neighbour
+	 */
+	inline constexpr uint8_t d8_no_outflow = 0xff;
+
+	/**
+	 * Fills all depressions in heightmap, so that there is a strictly descending path from every
+	 * pixel to the boundary. Filled pixels are raised by at least epsilon above the pixel they
+	 * drain to. If epsilon is too small to change the elevation, the next representable value is
+	 * used instead.
+	 *
+	 * The implementation uses the Priority-Flood algorithm by Barnes et al. Pixels that are
+	 * flooded from within a depression are processed by a plain FIFO queue, so the cost is
+	 * O(N log N) in the worst case, but close to O(N) for maps with many depressions.
+	 */
+	grayscale_image fill_depressions(span_2d<float const> heightmap, float epsilon);
+
+	/**
+	 * Stores the index into d8_neighbours of the steepest downhill neighbour, or d8_no_outflow.
+	 */
+	void compute_d8_directions(
+		scanline_processing_job_info const& jobinfo,
+		span_2d<uint8_t> output,
+		span_2d<float const> heightmap
+	);
+
+	/**
+	 * Stores the direction of steepest descent, as an angle in [0, 2pi) measured the same way as
+	 * d8_neighbours, using the D-infinity method by Tarboton. Pixels without any downhill
+	 * direction are set to NaN.
+	 */
+	void compute_dinf_directions(
+		scanline_processing_job_info const& jobinfo,
+		span_2d<float> output,
+		span_2d<float const> heightmap
+	);
+
+	struct dinf_receivers
+	{
+		std::array<uint8_t, 2> neighbours;
+		std::array<float, 2> weights;
+	};
+
+	/**
+	 * Splits the flow in direction angle between the two neighbours that enclose it. Directions
+	 * within rounding error of a neighbour sends all flow to that neighbour, so a facet boundary
+	 * never leaks flow into the next facet.
+	 */
+	inline dinf_receivers get_dinf_receivers(float angle)
+	{
+		constexpr auto sector_angle = std::numbers::pi_v<float>/4.0f;
+		constexpr auto tolerance = 1.0f/65536.0f;
+		auto const t = angle/sector_angle;
+		auto const nearest = std::round(t);
+		auto const snap = std::abs(t - nearest) < tolerance;
+		auto const sector = snap? static_cast<int>(nearest) : static_cast<int>(t);
+		auto const weight = snap? 0.0f : std::clamp(t - static_cast<float>(sector), 0.0f, 1.0f);
+		return dinf_receivers{
+			.neighbours{static_cast<uint8_t>(sector%8), static_cast<uint8_t>((sector + 1)%8)},
+			.weights{1.0f - weight, weight}
+		};
+	}
+
+	/**
+	 * Computes the number of pixels that drain through each pixel, including the pixel itself.
+	 * Pixels are visited in topological order, so the cost is linear in the number of pixels.
+	 */
+	grayscale_image accumulate_d8_flow(
+		span_2d<uint8_t const> directions,
+		thread_pool<move_only_function<void()>>& workers
+	);
+
+	/**
+	 * Same as accumulate_d8_flow, but the flow from each pixel is split between two neighbours
+	 * according to get_dinf_receivers.
+	 */
+	grayscale_image accumulate_dinf_flow(
+		span_2d<float const> directions,
+		thread_pool<move_only_function<void()>>& workers
+	);
+
+	enum class flow_routing{d8, dinf};
+
+	struct drainage_descriptor
+	{
+		float epsilon = 1.0f/1024.0f;
+		flow_routing routing = flow_routing::d8;
+	};
+
+	struct drainage_maps
+	{
+		grayscale_image filled_heightmap;
+		grayscale_image lake_depth;
+		basic_image<uint8_t> d8_directions;
+		grayscale_image discharge;
+	};
+
+	drainage_maps make_drainage_maps(
+		span_2d<float const> heightmap,
+		drainage_descriptor const& params,
+		thread_pool<move_only_function<void()>>& workers
+	);
+}
+
+#endif
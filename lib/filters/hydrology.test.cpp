@@ -0,0 +1,178 @@
+//@	{"target":{"name":"hydrology.test"}}
+
+#include "./hydrology.hpp"
+#include "./test_terrain.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+namespace
+{
+	constexpr terraformer::test_terrain_params terrain_params{
+		.amplitude = 32.0f,
+		.wavenumber_x = 0.37f,
+		.wavenumber_y = 0.29f,
+		.slope_x = 0.25f
+	};
+
+	bool has_lower_neighbour(terraformer::span_2d<float const> heightmap, uint32_t x, uint32_t y)
+	{
+		for(auto const offset : terraformer::d8_neighbours)
+		{
+			auto const x_n = static_cast<int32_t>(x) + offset.x;
+			auto const y_n = static_cast<int32_t>(y) + offset.y;
+			if(inside(heightmap, x_n, y_n)
+				&& heightmap(static_cast<uint32_t>(x_n), static_cast<uint32_t>(y_n)) < heightmap(x, y))
+			{ return true; }
+		}
+		return false;
+	}
+
+	template<class IsOutlet>
+	float total_outflow(terraformer::span_2d<float const> discharge, IsOutlet&& is_outlet)
+	{
+		auto ret = 0.0f;
+		for(uint32_t y = 0; y != discharge.height(); ++y)
+		{
+			for(uint32_t x = 0; x != discharge.width(); ++x)
+			{
+				if(is_outlet(x, y))
+				{ ret += discharge(x, y); }
+			}
+		}
+		return ret;
+	}
+}
+
+TESTCASE(terraformer_hydrology_fill_depressions)
+{
+	auto const heightmap = make_test_terrain(43, 37, terrain_params);
+	auto const filled = fill_depressions(heightmap.pixels(), 1.0f/1024.0f);
+
+	size_t raised_pixels = 0;
+	for(uint32_t y = 1; y != heightmap.height() - 1; ++y)
+	{
+		for(uint32_t x = 1; x != heightmap.width() - 1; ++x)
+		{
+			EXPECT_GE(filled(x, y), heightmap(x, y));
+			EXPECT_EQ(has_lower_neighbour(filled.pixels(), x, y), true);
+			raised_pixels += filled(x, y) > heightmap(x, y)? 1 : 0;
+		}
+	}
+
+	// The test terrain has several pits
+	EXPECT_GT(raised_pixels, 0);
+}
+
+TESTCASE(terraformer_hydrology_d8_flow_on_inclined_plane)
+{
+	terraformer::grayscale_image heightmap{11, 7};
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{ heightmap(x, y) = 16.0f - static_cast<float>(x); }
+	}
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const res = make_drainage_maps(heightmap.pixels(), terraformer::drainage_descriptor{}, workers);
+
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width() - 1; ++x)
+		{
+			EXPECT_EQ(res.d8_directions(x, y), 0);
+			EXPECT_EQ(res.discharge(x, y), static_cast<float>(x + 1));
+			EXPECT_EQ(res.lake_depth(x, y), 0.0f);
+		}
+		EXPECT_EQ(res.d8_directions(heightmap.width() - 1, y), terraformer::d8_no_outflow);
+	}
+}
+
+TESTCASE(terraformer_hydrology_fewer_scanlines_than_workers)
+{
+	terraformer::grayscale_image heightmap{11, 3};
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{ heightmap(x, y) = 16.0f - static_cast<float>(x); }
+	}
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{8};
+	auto const res = make_drainage_maps(
+		heightmap.pixels(),
+		terraformer::drainage_descriptor{.routing = terraformer::flow_routing::dinf},
+		workers
+	);
+
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width() - 1; ++x)
+		{
+			EXPECT_EQ(res.d8_directions(x, y), 0);
+			EXPECT_LT(std::abs(res.discharge(x, y) - static_cast<float>(x + 1)), 1.0e-5f);
+		}
+		EXPECT_EQ(res.d8_directions(heightmap.width() - 1, y), terraformer::d8_no_outflow);
+	}
+}
+
+TESTCASE(terraformer_hydrology_dinf_directions_on_inclined_plane)
+{
+	terraformer::grayscale_image heightmap{9, 9};
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{ heightmap(x, y) = 32.0f - static_cast<float>(x) - 0.5f*static_cast<float>(y); }
+	}
+
+	terraformer::grayscale_image directions{9, 9};
+	compute_dinf_directions(
+		terraformer::scanline_processing_job_info{.input_y_offset = 0, .total_height = 9},
+		directions.pixels(),
+		std::as_const(heightmap).pixels()
+	);
+
+	auto const expected = std::atan2(0.5f, 1.0f);
+	EXPECT_LT(std::abs(directions(4, 4) - expected), 1.0e-6f);
+
+	auto const receivers = terraformer::get_dinf_receivers(directions(4, 4));
+	EXPECT_EQ(receivers.neighbours[0], 0);
+	EXPECT_EQ(receivers.neighbours[1], 1);
+	EXPECT_LT(std::abs(receivers.weights[0] + receivers.weights[1] - 1.0f), 1.0e-6f);
+}
+
+TESTCASE(terraformer_hydrology_flow_is_conserved)
+{
+	auto const heightmap = make_test_terrain(43, 37, terrain_params);
+	auto const total_area = static_cast<float>(heightmap.width()*heightmap.height());
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+
+	{
+		auto const res = make_drainage_maps(
+			heightmap.pixels(),
+			terraformer::drainage_descriptor{.routing = terraformer::flow_routing::d8},
+			workers
+		);
+		auto const outflow = total_outflow(res.discharge.pixels(), [&res](uint32_t x, uint32_t y){
+			return res.d8_directions(x, y) == terraformer::d8_no_outflow;
+		});
+		EXPECT_EQ(outflow, total_area);
+	}
+
+	{
+		auto const res = make_drainage_maps(
+			heightmap.pixels(),
+			terraformer::drainage_descriptor{.routing = terraformer::flow_routing::dinf},
+			workers
+		);
+
+		terraformer::grayscale_image directions{heightmap.width(), heightmap.height()};
+		compute_dinf_directions(
+			terraformer::scanline_processing_job_info{.input_y_offset = 0, .total_height = heightmap.height()},
+			directions.pixels(),
+			std::as_const(res.filled_heightmap).pixels()
+		);
+		auto const outflow = total_outflow(res.discharge.pixels(), [&directions](uint32_t x, uint32_t y){
+			return std::isnan(directions(x, y));
+		});
+		EXPECT_LT(std::abs(outflow - total_area)/total_area, 1.0e-5f);
+	}
+}
@@ -0,0 +1,366 @@
+//@	{"target":{"name":"./isolines.o"}}
+
+#include "./isolines.hpp"
+
+#include "lib/common/chunk_by_chunk_count_view.hpp"
+#include "lib/execution/batch_result.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <ranges>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	// Edges are identified by the pixel where they start. Horizontal edges go from (x, y) to
+	// (x + 1, y), and vertical edges from (x, y) to (x, y + 1).
+	using edge_id = uint64_t;
+
+	constexpr edge_id horizontal_edge(uint32_t x, uint32_t y, uint32_t width)
+	{ return 2*(static_cast<edge_id>(y)*width + x); }
+
+	constexpr edge_id vertical_edge(uint32_t x, uint32_t y, uint32_t width)
+	{ return 2*(static_cast<edge_id>(y)*width + x) + 1; }
+
+	struct crossing_key
+	{
+		int32_t level;
+		edge_id edge;
+
+		bool operator==(crossing_key const&) const = default;
+	};
+
+	struct crossing_key_hash
+	{
+		size_t operator()(crossing_key const& key) const
+		{
+			return std::hash<uint64_t>{}(
+				key.edge ^ (static_cast<uint64_t>(static_cast<uint32_t>(key.level))*0x9e37'79b9'7f4a'7c15)
+			);
+		}
+	};
+
+	/**
+	 * A set of curve pieces, where each piece is a sequence of edges crossed at the same level
+	 */
+	struct piece_set
+	{
+		struct piece
+		{
+			int32_t level;
+			size_t begin;
+			size_t end;
+		};
+
+		std::vector<edge_id> edges;
+		std::vector<piece> pieces;
+
+		void append(int32_t level, std::span<edge_id const> piece_edges)
+		{
+			auto const begin = std::size(edges);
+			edges.insert(std::end(edges), std::begin(piece_edges), std::end(piece_edges));
+			pieces.push_back(piece{.level = level, .begin = begin, .end = std::size(edges)});
+		}
+
+		void append(piece_set const& other)
+		{
+			auto const offset = std::size(edges);
+			edges.insert(std::end(edges), std::begin(other.edges), std::end(other.edges));
+			for(auto item : other.pieces)
+			{
+				item.begin += offset;
+				item.end += offset;
+				pieces.push_back(item);
+			}
+		}
+	};
+
+	struct piece_end
+	{
+		uint32_t piece;
+		bool at_back;
+	};
+
+	/**
+	 * Joins pieces that end at the same edge, and at the same level
+	 */
+	piece_set chain_pieces(piece_set const& input)
+	{
+		auto const& pieces = input.pieces;
+		auto const& edges = input.edges;
+		auto const is_closed = [&edges](auto const& item) {
+			return item.end - item.begin > 2 && edges[item.begin] == edges[item.end - 1];
+		};
+
+		struct piece_end_pair
+		{
+			std::array<piece_end, 2> ends;
+			uint32_t count = 0;
+		};
+
+		std::unordered_map<crossing_key, piece_end_pair, crossing_key_hash> ends;
+		ends.reserve(2*std::size(pieces));
+		for(uint32_t k = 0; k != static_cast<uint32_t>(std::size(pieces)); ++k)
+		{
+			auto const& item = pieces[k];
+			if(is_closed(item))
+			{ continue; }
+
+			for(auto const at_back : {false, true})
+			{
+				auto& pair = ends[crossing_key{
+					.level = item.level,
+					.edge = at_back? edges[item.end - 1] : edges[item.begin]
+				}];
+				assert(pair.count < 2);
+				if(pair.count < 2)
+				{
+					pair.ends[pair.count] = piece_end{.piece = k, .at_back = at_back};
+					++pair.count;
+				}
+			}
+		}
+
+		auto const find_partner = [&ends, &pieces, &edges](piece_end end) -> std::optional<piece_end> {
+			auto const& item = pieces[end.piece];
+			auto const i = ends.find(crossing_key{
+				.level = item.level,
+				.edge = end.at_back? edges[item.end - 1] : edges[item.begin]
+			});
+			if(i == std::end(ends) || i->second.count != 2)
+			{ return std::nullopt; }
+
+			auto const& pair = i->second.ends;
+			return (pair[0].piece == end.piece && pair[0].at_back == end.at_back)? pair[1] : pair[0];
+		};
+
+		piece_set ret;
+		std::vector<uint8_t> visited(std::size(pieces));
+		std::vector<edge_id> current_edges;
+
+		// Starts a curve at the front of start_piece, or at its back if reversed is set, and
+		// follows the chain of partners until there is no partner left
+		auto const follow_chain = [&](uint32_t start_piece, bool reversed) {
+			current_edges.clear();
+			auto current = piece_end{.piece = start_piece, .at_back = reversed};
+			auto first = true;
+			while(true)
+			{
+				auto const& item = pieces[current.piece];
+				visited[current.piece] = 1;
+				auto const piece_edges = std::span{edges}.subspan(item.begin, item.end - item.begin);
+				// NOTE: The first edge of every piece but the first is already in current_edges
+				auto const skip = first? 0 : 1;
+				if(current.at_back)
+				{
+					std::ranges::copy(
+						piece_edges | std::views::reverse | std::views::drop(skip),
+						std::back_inserter(current_edges)
+					);
+				}
+				else
+				{ std::ranges::copy(piece_edges | std::views::drop(skip), std::back_inserter(current_edges)); }
+				first = false;
+
+				auto const partner = find_partner(piece_end{.piece = current.piece, .at_back = !current.at_back});
+				if(!partner.has_value() || visited[partner->piece])
+				{ break; }
+				current = *partner;
+			}
+			ret.append(pieces[start_piece].level, current_edges);
+		};
+
+		// Open curves start at a piece end that has no partner
+		for(uint32_t k = 0; k != static_cast<uint32_t>(std::size(pieces)); ++k)
+		{
+			if(visited[k] || is_closed(pieces[k]))
+			{ continue; }
+
+			if(!find_partner(piece_end{.piece = k, .at_back = false}).has_value())
+			{ follow_chain(k, false); }
+			else
+			if(!find_partner(piece_end{.piece = k, .at_back = true}).has_value())
+			{ follow_chain(k, true); }
+		}
+
+		// All remaining pieces are parts of closed curves
+		for(uint32_t k = 0; k != static_cast<uint32_t>(std::size(pieces)); ++k)
+		{
+			if(visited[k])
+			{ continue; }
+
+			if(is_closed(pieces[k]))
+			{
+				visited[k] = 1;
+				ret.append(pieces[k].level, std::span{edges}.subspan(pieces[k].begin, pieces[k].end - pieces[k].begin));
+				continue;
+			}
+			follow_chain(k, false);
+		}
+
+		return ret;
+	}
+
+	void collect_cell_segments(
+		piece_set& output,
+		terraformer::span_2d<float const> heightmap,
+		float interval,
+		uint32_t x,
+		uint32_t y
+	)
+	{
+		auto const w = heightmap.width();
+		std::array const corners{
+			heightmap(x, y),
+			heightmap(x + 1, y),
+			heightmap(x + 1, y + 1),
+			heightmap(x, y + 1)
+		};
+		// Edges in the same order as the corners they start from, going around the cell
+		std::array const cell_edges{
+			horizontal_edge(x, y, w),
+			vertical_edge(x + 1, y, w),
+			horizontal_edge(x, y + 1, w),
+			vertical_edge(x, y, w)
+		};
+
+		auto const [min, max] = std::ranges::minmax(corners);
+		auto const level_begin = static_cast<int32_t>(std::floor(min/interval));
+		auto const level_end = static_cast<int32_t>(std::floor(max/interval)) + 1;
+		for(auto level = level_begin; level != level_end; ++level)
+		{
+			auto const z = static_cast<float>(level)*interval;
+			std::array<bool, 4> above{};
+			for(size_t k = 0; k != 4; ++k)
+			{ above[k] = corners[k] >= z; }
+
+			std::array<edge_id, 4> crossed{};
+			size_t crossing_count = 0;
+			for(size_t k = 0; k != 4; ++k)
+			{
+				if(above[k] != above[(k + 1)%4])
+				{
+					crossed[crossing_count] = cell_edges[k];
+					++crossing_count;
+				}
+			}
+
+			if(crossing_count == 2)
+			{ output.append(level, std::span{crossed}.first(2)); }
+			else
+			if(crossing_count == 4)
+			{
+				// Saddle. crossed is ordered as cell_edges.
+				auto const mean = 0.25f*(corners[0] + corners[1] + corners[2] + corners[3]);
+				if((mean >= z) == above[0])
+				{
+					// Corner 0 and 2 are connected through the center. Cut off corner 1 and 3.
+					output.append(level, std::array{crossed[0], crossed[1]});
+					output.append(level, std::array{crossed[2], crossed[3]});
+				}
+				else
+				{
+					// Cut off corner 0 and 2
+					output.append(level, std::array{crossed[3], crossed[0]});
+					output.append(level, std::array{crossed[1], crossed[2]});
+				}
+			}
+		}
+	}
+
+	piece_set extract_band(
+		terraformer::span_2d<float const> heightmap,
+		float interval,
+		uint32_t y_begin,
+		uint32_t y_end
+	)
+	{
+		piece_set segments;
+		for(auto y = y_begin; y != y_end; ++y)
+		{
+			for(uint32_t x = 0; x != heightmap.width() - 1; ++x)
+			{ collect_cell_segments(segments, heightmap, interval, x, y); }
+		}
+		return chain_pieces(segments);
+	}
+
+	terraformer::location get_crossing_point(
+		terraformer::span_2d<float const> heightmap,
+		edge_id edge,
+		float z
+	)
+	{
+		auto const pixel = edge/2;
+		auto const x = static_cast<uint32_t>(pixel%heightmap.width());
+		auto const y = static_cast<uint32_t>(pixel/heightmap.width());
+		auto const is_vertical = edge%2 != 0;
+		auto const a = heightmap(x, y);
+		auto const b = is_vertical? heightmap(x, y + 1) : heightmap(x + 1, y);
+		auto const t = (z - a)/(b - a);
+		return is_vertical?
+			terraformer::location{static_cast<float>(x), static_cast<float>(y) + t, z}:
+			terraformer::location{static_cast<float>(x) + t, static_cast<float>(y), z};
+	}
+}
+
+terraformer::polyline_store terraformer::extract_isolines(
+	span_2d<float const> heightmap,
+	float interval,
+	thread_pool<move_only_function<void()>>& workers
+)
+{
+	assert(interval > 0.0f);
+	polyline_store ret;
+	auto const w = heightmap.width();
+	auto const h = heightmap.height();
+	if(w < 2 || h < 2)
+	{ return ret; }
+
+	auto const cell_rows = h - 1;
+	auto const band_count = (cell_rows + isoline_band_height - 1)/isoline_band_height;
+	std::vector<piece_set> bands(band_count);
+	auto const n_tasks = std::min(static_cast<size_t>(band_count), workers.max_concurrency());
+	batch_result<void> pending_bands{n_tasks};
+	for(auto chunk : chunk_by_chunk_count_view{std::ranges::iota_view{0u, band_count}, n_tasks})
+	{
+		workers.submit(
+			[
+				heightmap,
+				interval,
+				cell_rows,
+				chunk,
+				&bands,
+				&pending_bands = pending_bands.get_state()
+			](){
+				for(auto const band : chunk)
+				{
+					auto const y_begin = band*isoline_band_height;
+					auto const y_end = std::min(y_begin + isoline_band_height, cell_rows);
+					bands[band] = extract_band(heightmap, interval, y_begin, y_end);
+				}
+				pending_bands.mark_batch_as_completed();
+			}
+		);
+	}
+	pending_bands.wait();
+
+	// Stitch curves that continue into the next band
+	piece_set all_pieces;
+	for(auto const& band : bands)
+	{ all_pieces.append(band); }
+	auto const curves = chain_pieces(all_pieces);
+
+	ret.reserve(std::size(curves.pieces), std::size(curves.edges));
+	for(auto const& curve : curves.pieces)
+	{
+		auto const z = static_cast<float>(curve.level)*interval;
+		for(auto k = curve.begin; k != curve.end; ++k)
+		{ ret.push_back(get_crossing_point(heightmap, curves.edges[k], z), z); }
+		ret.end_polyline();
+	}
+
+	return ret;
+}
@@ -0,0 +1,35 @@
+//@	{"dependencies_extra":[{"ref":"./isolines.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_FILTERS_ISOLINES_HPP
+#define TERRAFORMER_FILTERS_ISOLINES_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/common/polyline_store.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/execution/thread_pool.hpp"
+
+namespace terraformer
+{
+	/**
+	 * Number of cell rows in each band processed by extract_isolines
+	 */
+	constexpr uint32_t isoline_band_height = 64;
+
+	/**
+	 * Extracts the curves where heightmap crosses an integer multiple of interval, using
+	 * marching squares. Points are given in pixel coordinates, with the level as z coordinate.
+	 * The value stored with each point is the level. Closed curves end with a copy of their first
+	 * point. Saddle points are resolved by the mean of the four corners of the cell.
+	 *
+	 * The map is split into bands of isoline_band_height cell rows, which are processed in
+	 * parallel. Curves that cross band boundaries are stitched together afterwards. Since the
+	 * bands do not depend on the number of workers, neither does the result.
+	 */
+	polyline_store extract_isolines(
+		span_2d<float const> heightmap,
+		float interval,
+		thread_pool<move_only_function<void()>>& workers
+	);
+}
+
+#endif
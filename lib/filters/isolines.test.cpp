@@ -0,0 +1,128 @@
+//@	{"target":{"name":"isolines.test"}}
+
+#include "./isolines.hpp"
+
+#include "lib/pixel_store/image.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <cmath>
+
+namespace
+{
+	terraformer::grayscale_image make_cone(uint32_t width, uint32_t height)
+	{
+		terraformer::grayscale_image ret{width, height};
+		auto const x_0 = 0.5f*static_cast<float>(width) + 0.25f;
+		auto const y_0 = 0.5f*static_cast<float>(height) - 0.125f;
+		for(uint32_t y = 0; y != height; ++y)
+		{
+			for(uint32_t x = 0; x != width; ++x)
+			{
+				auto const dx = static_cast<float>(x) - x_0;
+				auto const dy = static_cast<float>(y) - y_0;
+				ret(x, y) = std::sqrt(dx*dx + dy*dy);
+			}
+		}
+		return ret;
+	}
+
+	bool is_closed(terraformer::polyline_store::polyline const& curve)
+	{ return curve.points.front() == curve.points.back(); }
+}
+
+TESTCASE(terraformer_extract_isolines_ramp)
+{
+	terraformer::grayscale_image ramp{32, 150};
+	for(uint32_t y = 0; y != ramp.height(); ++y)
+	{
+		for(uint32_t x = 0; x != ramp.width(); ++x)
+		{ ramp(x, y) = static_cast<float>(x) + 0.5f; }
+	}
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const result = terraformer::extract_isolines(ramp.pixels(), 4.0f, workers);
+
+	// Each vertical line crosses all bands, and must have been stitched into one curve
+	REQUIRE_EQ(result.size(), 7);
+	for(size_t k = 0; k != result.size(); ++k)
+	{
+		auto const curve = result[k];
+		EXPECT_EQ(std::size(curve.points), ramp.height());
+		EXPECT_EQ(is_closed(curve), false);
+		auto const level = curve.values.front();
+		EXPECT_EQ(std::fmod(level, 4.0f), 0.0f);
+		for(auto const point : curve.points)
+		{
+			EXPECT_EQ(point[0], level - 0.5f);
+			EXPECT_EQ(point[2], level);
+		}
+	}
+}
+
+TESTCASE(terraformer_extract_isolines_cone)
+{
+	auto const cone = make_cone(200, 200);
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const result = terraformer::extract_isolines(cone.pixels(), 10.0f, workers);
+
+	// Circles with radius 10 to 90 fit inside the map. Those further out are cut by the
+	// boundary.
+	size_t closed_count = 0;
+	for(size_t k = 0; k != result.size(); ++k)
+	{
+		auto const curve = result[k];
+		auto const level = curve.values.front();
+		if(!is_closed(curve))
+		{
+			EXPECT_GT(level, 90.0f);
+			continue;
+		}
+
+		++closed_count;
+		for(auto const point : curve.points)
+		{
+			auto const dx = point[0] - (100.0f + 0.25f);
+			auto const dy = point[1] - (100.0f - 0.125f);
+			EXPECT_LT(std::abs(std::sqrt(dx*dx + dy*dy) - level), 0.25f);
+		}
+	}
+	EXPECT_EQ(closed_count, 9);
+}
+
+TESTCASE(terraformer_extract_isolines_independent_of_worker_count)
+{
+	auto const cone = make_cone(97, 301);
+	terraformer::thread_pool<terraformer::move_only_function<void()>> one_worker{1};
+	terraformer::thread_pool<terraformer::move_only_function<void()>> many_workers{7};
+	auto const a = terraformer::extract_isolines(cone.pixels(), 7.0f, one_worker);
+	auto const b = terraformer::extract_isolines(cone.pixels(), 7.0f, many_workers);
+
+	REQUIRE_EQ(a.size(), b.size());
+	REQUIRE_EQ(a.point_count(), b.point_count());
+	for(size_t k = 0; k != a.size(); ++k)
+	{
+		auto const curve_a = a[k];
+		auto const curve_b = b[k];
+		REQUIRE_EQ(std::size(curve_a.points), std::size(curve_b.points));
+		for(size_t l = 0; l != std::size(curve_a.points); ++l)
+		{ EXPECT_EQ(curve_a.points[l], curve_b.points[l]); }
+	}
+}
+
+TESTCASE(terraformer_extract_isolines_saddle)
+{
+	terraformer::grayscale_image saddle{2, 2};
+	saddle(0, 0) = 1.0f;
+	saddle(1, 0) = -1.0f;
+	saddle(1, 1) = 1.0f;
+	saddle(0, 1) = -1.0f;
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{1};
+	auto const result = terraformer::extract_isolines(saddle.pixels(), 4.0f, workers);
+
+	// The mean is zero, which is on the upper side, so the high corners are connected
+	REQUIRE_EQ(result.size(), 2);
+	EXPECT_EQ(std::size(result[0].points), 2);
+	EXPECT_EQ(std::size(result[1].points), 2);
+}
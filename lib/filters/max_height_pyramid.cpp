@@ -0,0 +1,90 @@
+//@	{"target":{"name":"./max_height_pyramid.o"}}
+
+#include "./max_height_pyramid.hpp"
+
+#include <algorithm>
+
+void terraformer::make_bilinear_max(
+	scanline_processing_job_info const& jobinfo,
+	span_2d<float> output,
+	span_2d<float const> input
+)
+{
+	auto const w = static_cast<int32_t>(output.width());
+	auto const h = static_cast<int32_t>(output.height());
+	auto const input_y_offset = static_cast<int32_t>(jobinfo.input_y_offset);
+	using clamp_tag = span_2d_extents::clamp_tag;
+
+	for(int32_t y = 0; y != h; ++y)
+	{
+		auto const y_in = y + input_y_offset;
+		for(int32_t x = 0; x != w; ++x)
+		{
+			output(x, y) = std::max(
+				std::max(input(x, y_in, clamp_tag{}), input(x + 1, y_in, clamp_tag{})),
+				std::max(input(x, y_in + 1, clamp_tag{}), input(x + 1, y_in + 1, clamp_tag{}))
+			);
+		}
+	}
+}
+
+void terraformer::make_max_level(
+	scanline_processing_job_info const& jobinfo,
+	span_2d<float> output,
+	span_2d<float const> input
+)
+{
+	auto const w = static_cast<int32_t>(output.width());
+	auto const h = static_cast<int32_t>(output.height());
+	auto const input_y_offset = static_cast<int32_t>(jobinfo.input_y_offset);
+	using clamp_tag = span_2d_extents::clamp_tag;
+
+	for(int32_t y = 0; y != h; ++y)
+	{
+		auto const y_in = 2*(y + input_y_offset);
+		for(int32_t x = 0; x != w; ++x)
+		{
+			auto const x_in = 2*x;
+			output(x, y) = std::max(
+				std::max(input(x_in, y_in, clamp_tag{}), input(x_in + 1, y_in, clamp_tag{})),
+				std::max(input(x_in, y_in + 1, clamp_tag{}), input(x_in + 1, y_in + 1, clamp_tag{}))
+			);
+		}
+	}
+}
+
+terraformer::max_height_pyramid::max_height_pyramid(
+	span_2d<float const> heightmap,
+	thread_pool<move_only_function<void()>>& workers
+):m_source{heightmap}
+{
+	if(heightmap.width() == 0 || heightmap.height() == 0)
+	{ return; }
+
+	m_levels.push_back(grayscale_image{heightmap.extents()});
+	process_scanlines(
+		m_levels.back().pixels(),
+		workers,
+		std::stop_token{},
+		[]<class ... Args>(Args&&... args){
+			make_bilinear_max(std::forward<Args>(args)...);
+		},
+		heightmap
+	).wait();
+
+	while(m_levels.back().width() != 1 || m_levels.back().height() != 1)
+	{
+		auto const& prev = m_levels.back();
+		grayscale_image next{(prev.width() + 1)/2, (prev.height() + 1)/2};
+		process_scanlines(
+			next.pixels(),
+			workers,
+			std::stop_token{},
+			[]<class ... Args>(Args&&... args){
+				make_max_level(std::forward<Args>(args)...);
+			},
+			prev.pixels()
+		).wait();
+		m_levels.push_back(std::move(next));
+	}
+}
@@ -0,0 +1,69 @@
+//@	{"dependencies_extra":[{"ref":"./max_height_pyramid.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_FILTERS_MAX_HEIGHT_PYRAMID_HPP
+#define TERRAFORMER_FILTERS_MAX_HEIGHT_PYRAMID_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/execution/thread_pool.hpp"
+#include "lib/pixel_store/image.hpp"
+
+#include <limits>
+#include <vector>
+
+namespace terraformer
+{
+	/**
+	 * Stores the maximum of 2x2 pixels, taking clamping at the right and bottom edge into account.
+	 * Thus, output(x, y) is an upper bound of the bilinear interpolation of input within
+	 * [x, x + 1)x[y, y + 1).
+	 */
+	void make_bilinear_max(
+		scanline_processing_job_info const& jobinfo,
+		span_2d<float> output,
+		span_2d<float const> input
+	);
+
+	/**
+	 * Reduces input by a factor of two in both directions, by taking the max of each 2x2 block
+	 */
+	void make_max_level(
+		scanline_processing_job_info const& jobinfo,
+		span_2d<float> output,
+		span_2d<float const> input
+	);
+
+	/**
+	 * A mip pyramid where each level stores the max elevation within its cells. A cell at level L
+	 * covers 2^L by 2^L pixels of the source heightmap, and the last level contains a single
+	 * pixel. The pyramid of an empty heightmap has no levels.
+	 *
+	 * NOTE: The pyramid refers to the source heightmap, which must outlive the pyramid.
+	 */
+	class max_height_pyramid
+	{
+	public:
+		explicit max_height_pyramid(
+			span_2d<float const> heightmap,
+			thread_pool<move_only_function<void()>>& workers
+		);
+
+		span_2d<float const> source() const
+		{ return m_source; }
+
+		size_t level_count() const
+		{ return std::size(m_levels); }
+
+		span_2d<float const> level(size_t k) const
+		{ return m_levels[k].pixels(); }
+
+		float max_elevation() const
+		{ return m_levels.empty()? -std::numeric_limits<float>::infinity() : m_levels.back()(0, 0); }
+
+	private:
+		span_2d<float const> m_source;
+		std::vector<grayscale_image> m_levels;
+	};
+}
+
+#endif
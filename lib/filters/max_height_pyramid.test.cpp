@@ -0,0 +1,107 @@
+//@	{"target":{"name":"max_height_pyramid.test"}}
+
+#include "./max_height_pyramid.hpp"
+#include "./raycaster.hpp"
+#include "./test_terrain.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+namespace
+{
+	constexpr terraformer::test_terrain_params terrain_params{
+		.amplitude = 32.0f,
+		.wavenumber_x = 0.17f,
+		.wavenumber_y = 0.23f,
+		.slope_x = 0.5f
+	};
+}
+
+TESTCASE(terraformer_max_height_pyramid_levels)
+{
+	auto const heightmap = make_test_terrain(37, 21, terrain_params);
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	terraformer::max_height_pyramid const pyramid{heightmap.pixels(), workers};
+
+	EXPECT_EQ(pyramid.level_count(), 7);
+	EXPECT_EQ(pyramid.level(0).width(), 37);
+	EXPECT_EQ(pyramid.level(0).height(), 21);
+	EXPECT_EQ(pyramid.level(1).width(), 19);
+	EXPECT_EQ(pyramid.level(1).height(), 11);
+	EXPECT_EQ(pyramid.level(6).width(), 1);
+	EXPECT_EQ(pyramid.level(6).height(), 1);
+	EXPECT_EQ(pyramid.max_elevation(), terraformer::minmax_value(heightmap.pixels()).max);
+
+	for(size_t level = 0; level != pyramid.level_count(); ++level)
+	{
+		auto const cell_size = 1u << level;
+		auto const pixels = pyramid.level(level);
+		for(uint32_t y = 0; y != heightmap.height(); ++y)
+		{
+			for(uint32_t x = 0; x != heightmap.width(); ++x)
+			{ EXPECT_GE(pixels(x/cell_size, y/cell_size), heightmap(x, y)); }
+		}
+	}
+}
+
+TESTCASE(terraformer_max_height_pyramid_fewer_scanlines_than_workers)
+{
+	auto const heightmap = make_test_terrain(37, 3, terrain_params);
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{8};
+	terraformer::max_height_pyramid const pyramid{heightmap.pixels(), workers};
+
+	EXPECT_EQ(pyramid.level_count(), 7);
+	EXPECT_EQ(pyramid.level(6).width(), 1);
+	EXPECT_EQ(pyramid.level(6).height(), 1);
+	EXPECT_EQ(pyramid.max_elevation(), terraformer::minmax_value(heightmap.pixels()).max);
+}
+
+TESTCASE(terraformer_max_height_pyramid_empty_heightmap)
+{
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	for(auto const& heightmap : {
+		terraformer::grayscale_image{0, 0},
+		terraformer::grayscale_image{0, 5},
+		terraformer::grayscale_image{7, 0}
+	})
+	{
+		terraformer::max_height_pyramid const pyramid{heightmap.pixels(), workers};
+		EXPECT_EQ(pyramid.level_count(), 0);
+		EXPECT_EQ(pyramid.max_elevation(), -std::numeric_limits<float>::infinity());
+	}
+}
+
+TESTCASE(terraformer_max_height_pyramid_raycast_same_result_as_linear_raycast)
+{
+	auto const heightmap = make_test_terrain(64, 48, terrain_params);
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	terraformer::max_height_pyramid const pyramid{heightmap.pixels(), workers};
+
+	auto const pred = [pixels = heightmap.pixels()](auto, auto loc) {
+		return terraformer::inside(pixels, loc[0], loc[1])?
+			terraformer::raycast_pred_result::keep_going:
+			terraformer::raycast_pred_result::stop;
+	};
+
+	for(int32_t y = 0; y < 48; y += 5)
+	{
+		for(int32_t x = 0; x < 64; x += 3)
+		{
+			for(int k = 0; k != 16; ++k)
+			{
+				auto const phi = 0.3926991f*static_cast<float>(k);
+				auto const elevation = 0.05f*static_cast<float>(k % 5) - 0.05f;
+				terraformer::direction const dir{
+					terraformer::displacement{std::cos(phi), std::sin(phi), elevation}
+				};
+				terraformer::pixel_coordinates const loc{x, y};
+				auto const z_0 = heightmap(static_cast<uint32_t>(x), static_cast<uint32_t>(y)) + 1.0f;
+
+				auto const expected = terraformer::raycast(heightmap.pixels(), loc, z_0, dir, 4.0f, pred);
+				auto const actual = terraformer::raycast(pyramid, loc, z_0, dir, 4.0f, pred);
+				EXPECT_EQ(expected.has_value(), actual.has_value());
+				if(expected.has_value() && actual.has_value())
+				{ EXPECT_EQ(*expected, *actual); }
+			}
+		}
+	}
+}
@@ -7,6 +7,32 @@
 #include "lib/math_utils/boundary_sampling_policies.hpp"
 #include "lib/value_maps/log_value_map.hpp"
 #include <algorithm>
+#include <cmath>
+
+terraformer::filters::modulation_function::modulation_function(
+	modulator_descriptor const& params,
+	image_registry_view control_images
+):
+	m_image{control_images.get_image(params.modulator)},
+	m_exponent{params.modulator_exponent},
+	m_depth{params.modulation_depth}
+{
+	auto const pixel_count = static_cast<size_t>(m_image.width())*static_cast<size_t>(m_image.height());
+	auto const range = std::minmax_element(m_image.data(), m_image.data() + pixel_count);
+	m_min = *range.first;
+	m_max = *range.second;
+}
+
+float terraformer::filters::modulation_function::operator()(float x, float y) const
+{
+	auto const x_mod = x*static_cast<float>(m_image.width()) - 0.5f;
+	auto const y_mod = y*static_cast<float>(m_image.height()) - 0.5f;
+	auto const mod_in = interp(m_image, x_mod, y_mod, clamp_at_boundary{});
+	auto const mod = std::pow((mod_in - m_min)/(m_max - m_min), m_exponent);
+
+	return m_depth >= 0.0f?
+		std::lerp(1.0f, mod, m_depth) : std::lerp(1.0f, 1.0f - mod, -m_depth);
+}
 
 terraformer::grayscale_image
 terraformer::filters::modulator_descriptor::compose_image_from(
@@ -15,23 +41,13 @@ terraformer::filters::modulator_descriptor::compose_image_from(
 	image_registry_view control_images
 ) const
 {
+	modulation_function const f{*this, control_images};
+	if(f.is_constant())
+	{ return grayscale_image{input_image}; }
+
 	grayscale_image ret{output_size};
 	auto const w_float = static_cast<float>(ret.width());
 	auto const h_float = static_cast<float>(ret.height());
-
-	auto const mod_img = control_images.get_image(modulator);
-	auto const pixel_count = static_cast<size_t>(mod_img.width())*static_cast<size_t>(mod_img.height());
-	auto const range = std::minmax_element(mod_img.data(), mod_img.data() + pixel_count);
-	auto const mod_img_min = *range.first;
-	auto const mod_img_max = *range.second;
-	if(std::abs(mod_img_max - mod_img_min) < 1.0e-6f)
-	{ return grayscale_image{input_image}; }
-
-	auto const mod_depth = modulation_depth;
-	auto const mod_exp = modulator_exponent;
-
-	auto const scale_mod_x = static_cast<float>(mod_img.width())/w_float;
-	auto const scale_mod_y = static_cast<float>(mod_img.height())/h_float;
 	auto const scale_input_x = static_cast<float>(input_image.width())/w_float;
 	auto const scale_input_y = static_cast<float>(input_image.height())/h_float;
 
@@ -43,16 +59,9 @@ terraformer::filters::modulator_descriptor::compose_image_from(
 			auto const y_float = static_cast<float>(y);
 			auto const x_in = (0.5f + x_float)*scale_input_x - 0.5f;
 			auto const y_in = (0.5f + y_float)*scale_input_y - 0.5f;
-			auto const x_mod = (0.5f + x_float)*scale_mod_x - 0.5f;
-			auto const y_mod = (0.5f + y_float)*scale_mod_y - 0.5f;
 
 			auto const in = interp(input_image, x_in, y_in, clamp_at_boundary{});
-			auto const mod_in = interp(mod_img, x_mod, y_mod, clamp_at_boundary{});
-			auto const mod = std::pow((mod_in - mod_img_min)/(mod_img_max - mod_img_min), mod_exp);
-
-			ret(x, y) = in*(mod_depth >= 0.0f?
-				std::lerp(1.0f, mod, mod_depth) : std::lerp(1.0f, 1.0f - mod, -mod_depth)
-			);
+			ret(x, y) = in*f((0.5f + x_float)/w_float, (0.5f + y_float)/h_float);
 		}
 	}
 
@@ -25,6 +25,34 @@ namespace terraformer::filters
 
 		void bind(descriptor_editor_ref);
 	};
+
+	/**
+	 * Evaluates the modulation factor of a modulator_descriptor at normalized image
+	 * coordinates, where (0, 0) and (1, 1) are opposite corners of the image
+	 */
+	class modulation_function
+	{
+	public:
+		explicit modulation_function(
+			modulator_descriptor const& params,
+			image_registry_view control_images
+		);
+
+		/**
+		 * A constant modulator image gives no modulation
+		 */
+		bool is_constant() const
+		{ return m_max - m_min < 1.0e-6f; }
+
+		float operator()(float x, float y) const;
+
+	private:
+		span_2d<float const> m_image;
+		float m_min;
+		float m_max;
+		float m_exponent;
+		float m_depth;
+	};
 }
 
 #endif
\ No newline at end of file
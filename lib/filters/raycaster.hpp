@@ -1,9 +1,15 @@
 #ifndef TERRAFORMER_FILTERS_RAYCASTER_HPP
 #define TERRAFORMER_FILTERS_RAYCASTER_HPP
 
+#include "./max_height_pyramid.hpp"
+
 #include "lib/common/span_2d.hpp"
 #include "lib/common/spaces.hpp"
+#include "lib/math_utils/interp.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
 #include <optional>
 
 namespace terraformer
@@ -38,8 +44,8 @@ namespace terraformer
 			if(k != 0 && r[2] < z_ref)
 			{
 				return pixel_coordinates{
-					static_cast<uint32_t>(r[0] + 0.5f),
-					static_cast<uint32_t>(r[1] + 0.5f)
+					static_cast<int32_t>(r[0] + 0.5f),
+					static_cast<int32_t>(r[1] + 0.5f)
 				};
 			}
 
@@ -49,6 +55,106 @@ namespace terraformer
 
 		return std::nullopt;
 	}
+
+	/**
+	 * Returns the first sample index after k, that may be below the terrain. Samples are skipped
+	 * by walking up the pyramid, as long as the ray stays above the max elevation of the cell it
+	 * passes through.
+	 */
+	inline size_t next_sample_to_test(
+		max_height_pyramid const& heightmap,
+		location r_0,
+		displacement v,
+		size_t k
+	)
+	{
+		auto const s = static_cast<float>(k);
+		auto const r = r_0 + s*v;
+		auto const x = static_cast<uint32_t>(r[0]);
+		auto const y = static_cast<uint32_t>(r[1]);
+
+		auto const param_to_boundary = [](float pos, float dir, float cell_begin, float cell_end) {
+			if(dir > 0.0f)
+			{ return (cell_end - pos)/dir; }
+			if(dir < 0.0f)
+			{ return (cell_begin - pos)/dir; }
+			return std::numeric_limits<float>::infinity();
+		};
+
+		auto s_skip = s;
+		for(size_t level = 0; level != heightmap.level_count(); ++level)
+		{
+			auto const i = x >> level;
+			auto const j = y >> level;
+			auto const cell_size = static_cast<float>(1u << level);
+			auto const x_begin = static_cast<float>(i)*cell_size;
+			auto const y_begin = static_cast<float>(j)*cell_size;
+
+			auto const s_exit = s + std::min(
+				param_to_boundary(r[0], v[0], x_begin, x_begin + cell_size),
+				param_to_boundary(r[1], v[1], y_begin, y_begin + cell_size)
+			);
+
+			auto const z_min = std::isfinite(s_exit)?
+				std::min(r[2], r_0[2] + s_exit*v[2]) :
+				(v[2] >= 0.0f? r[2] : -std::numeric_limits<float>::infinity());
+
+			if(!(heightmap.level(level)(i, j) < z_min))
+			{ break; }
+
+			s_skip = s_exit;
+		}
+
+		if(!std::isfinite(s_skip))
+		{ return std::numeric_limits<size_t>::max(); }
+
+		// NOTE: Rounding down, so a sample is never skipped due to rounding errors in s_skip
+		return std::max(k + 1, static_cast<size_t>(s_skip));
+	}
+
+	/**
+	 * Same as raycast above, but uses heightmap to skip samples that cannot be below the
+	 * terrain. Thus, the ray only needs to be sampled densely close to the terrain. Since
+	 * the pyramid only covers the source heightmap, the search ends when the ray leaves the
+	 * heightmap.
+	 *
+	 * NOTE: pred is only invoked for samples that are not skipped
+	 */
+	template<raycast_stop_predicate StopPredicate>
+	inline std::optional<pixel_coordinates> raycast(max_height_pyramid const& heightmap,
+		pixel_coordinates loc,
+		float src_altitude,
+		direction src_dir,
+		float scale,
+		StopPredicate&& pred)
+	{
+		auto const pixels = heightmap.source();
+		location const r_0{static_cast<float>(loc.x), static_cast<float>(loc.y), src_altitude};
+		displacement const v{src_dir[0], src_dir[1], scale*src_dir[2]};
+
+		size_t k = 0;
+		while(true)
+		{
+			auto const r = r_0 + static_cast<float>(k)*v;
+			if(!inside(pixels, r[0], r[1]))
+			{ return std::nullopt; }
+
+			if(pred(k, r) == raycast_pred_result::stop)
+			{ return std::nullopt; }
+
+			if(k != 0 && r[2] < interp(pixels, r[0], r[1], clamp_at_boundary{}))
+			{
+				return pixel_coordinates{
+					static_cast<int32_t>(r[0] + 0.5f),
+					static_cast<int32_t>(r[1] + 0.5f)
+				};
+			}
+
+			k = next_sample_to_test(heightmap, r_0, v, k);
+			if(k == std::numeric_limits<size_t>::max())
+			{ return std::nullopt; }
+		}
+	}
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,268 @@
+//@	{"target":{"name":"./stream_power_erosion.o"}}
+
+#include "./stream_power_erosion.hpp"
+#include "./hydrology.hpp"
+
+#include "lib/common/chunk_by_chunk_count_view.hpp"
+#include "lib/execution/batch_result.hpp"
+#include "lib/pixel_store/image.hpp"
+#include "lib/value_maps/affine_value_map.hpp"
+#include "lib/value_maps/log_value_map.hpp"
+
+#include <cmath>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	struct basin_node
+	{
+		uint32_t x;
+		uint32_t y;
+		uint32_t receiver;
+		uint8_t direction;
+	};
+
+	struct basin_solver_context
+	{
+		terraformer::span_2d<float> heightmap;
+		terraformer::span_2d<uint8_t const> receivers;
+		float pixel_size;
+		terraformer::stream_power_erosion_descriptor params;
+	};
+
+	void collect_basin(
+		std::vector<basin_node>& nodes,
+		terraformer::span_2d<uint8_t const> receivers,
+		terraformer::pixel_coordinates outlet
+	)
+	{
+		nodes.clear();
+		nodes.push_back(
+			basin_node{
+				.x = static_cast<uint32_t>(outlet.x),
+				.y = static_cast<uint32_t>(outlet.y),
+				.receiver = 0,
+				.direction = terraformer::d8_no_outflow
+			}
+		);
+
+		// NOTE: Nodes are visited breadth first, so every node comes after its receiver
+		for(size_t k = 0; k != std::size(nodes); ++k)
+		{
+			auto const current = nodes[k];
+			for(size_t l = 0; l != std::size(terraformer::d8_neighbours); ++l)
+			{
+				auto const offset = terraformer::d8_neighbours[l];
+				auto const x_n = static_cast<int32_t>(current.x) + offset.x;
+				auto const y_n = static_cast<int32_t>(current.y) + offset.y;
+				if(!inside(receivers, x_n, y_n))
+				{ continue; }
+
+				auto const opposite = static_cast<uint8_t>((l + 4)%8);
+				if(receivers(static_cast<uint32_t>(x_n), static_cast<uint32_t>(y_n)) == opposite)
+				{
+					nodes.push_back(
+						basin_node{
+							.x = static_cast<uint32_t>(x_n),
+							.y = static_cast<uint32_t>(y_n),
+							.receiver = static_cast<uint32_t>(k),
+							.direction = opposite
+						}
+					);
+				}
+			}
+		}
+	}
+
+	float solve_elevation(float h_0, float h_receiver, float f, float n)
+	{
+		if(n == 1.0f)
+		{ return (h_0 + f*h_receiver)/(1.0f + f); }
+
+		// Solve h - h_0 + f*(h - h_receiver)^n = 0. The function is increasing, so Newton
+		// iteration starting at h_0 approaches the root from above.
+		auto h = h_0;
+		for(size_t k = 0; k != 32; ++k)
+		{
+			auto const dh = std::max(h - h_receiver, 0.0f);
+			auto const g = h - h_0 + f*std::pow(dh, n);
+			auto const g_prime = 1.0f + n*f*std::pow(dh, n - 1.0f);
+			auto const h_next = std::max(h - g/g_prime, h_receiver);
+			if(std::abs(h_next - h) <= 1.0e-6f*std::max(std::abs(h), 1.0f))
+			{ return h_next; }
+			h = h_next;
+		}
+		return h;
+	}
+
+	void erode_basins(
+		basin_solver_context const& ctxt,
+		std::span<terraformer::pixel_coordinates const> outlets
+	)
+	{
+		auto const heightmap = ctxt.heightmap;
+		auto const& params = ctxt.params;
+		auto const pixel_area = ctxt.pixel_size*ctxt.pixel_size;
+		auto const uplift = params.uplift_rate*params.time_step;
+		auto const k_dt = params.erodibility*params.time_step;
+		auto const m = params.area_exponent;
+		auto const n = params.slope_exponent;
+
+		std::vector<basin_node> nodes;
+		std::vector<float> drainage_area;
+		for(auto const outlet : outlets)
+		{
+			collect_basin(nodes, ctxt.receivers, outlet);
+
+			drainage_area.assign(std::size(nodes), pixel_area);
+			for(size_t k = std::size(nodes) - 1; k != 0; --k)
+			{ drainage_area[nodes[k].receiver] += drainage_area[k]; }
+
+			for(size_t k = 1; k != std::size(nodes); ++k)
+			{
+				auto const node = nodes[k];
+				auto const receiver = nodes[node.receiver];
+				auto const h_receiver = heightmap(receiver.x, receiver.y);
+				auto const h_0 = heightmap(node.x, node.y) + uplift;
+
+				// Pixels below their receiver are inside a lake, and are not eroded
+				if(h_0 <= h_receiver)
+				{
+					heightmap(node.x, node.y) = h_0;
+					continue;
+				}
+
+				auto const distance = ctxt.pixel_size*(node.direction % 2 == 0? 1.0f : std::numbers::sqrt2_v<float>);
+				auto const f = k_dt*std::pow(drainage_area[k], m)/std::pow(distance, n);
+				heightmap(node.x, node.y) = solve_elevation(h_0, h_receiver, f, n);
+			}
+		}
+	}
+}
+
+void terraformer::stream_power_erosion_descriptor::bind(descriptor_editor_ref editor)
+{
+	editor.create_float_input(
+		u8"Erodibility",
+		erodibility,
+		descriptor_editor_ref::knob_descriptor{
+			.value_map = type_erased_value_map{value_maps::log_value_map{1.0e-7f, 1.0e-3f, 10.0f}},
+			.textbox_placeholder_string = u8"0.123456789",
+			.visual_angle_range = std::nullopt
+		}
+	);
+
+	editor.create_float_input(
+		u8"Area exponent",
+		area_exponent,
+		descriptor_editor_ref::knob_descriptor{
+			.value_map = type_erased_value_map{value_maps::affine_value_map{0.0f, 1.0f}},
+			.textbox_placeholder_string = u8"0.123456789",
+			.visual_angle_range = std::nullopt
+		}
+	);
+
+	editor.create_float_input(
+		u8"Slope exponent",
+		slope_exponent,
+		descriptor_editor_ref::knob_descriptor{
+			.value_map = type_erased_value_map{value_maps::log_value_map{0.5f, 2.0f, 2.0f}},
+			.textbox_placeholder_string = u8"0.123456789",
+			.visual_angle_range = std::nullopt
+		}
+	);
+
+	editor.create_float_input(
+		u8"Uplift rate/(m/yr)",
+		uplift_rate,
+		descriptor_editor_ref::knob_descriptor{
+			.value_map = type_erased_value_map{value_maps::affine_value_map{0.0f, 1.0e-2f}},
+			.textbox_placeholder_string = u8"0.123456789",
+			.visual_angle_range = std::nullopt
+		}
+	);
+
+	editor.create_float_input(
+		u8"Time step/yr",
+		time_step,
+		descriptor_editor_ref::knob_descriptor{
+			.value_map = type_erased_value_map{value_maps::log_value_map{1.0e2f, 1.0e6f, 10.0f}},
+			.textbox_placeholder_string = u8"123456.789",
+			.visual_angle_range = std::nullopt
+		}
+	);
+
+	editor.create_float_input(
+		u8"Iterations",
+		descriptor_editor_ref::assigner<float>{iteration_count},
+		descriptor_editor_ref::knob_descriptor{
+			.value_map = type_erased_value_map{value_maps::affine_int_value_map{0, 64}},
+			.textbox_placeholder_string = u8"64",
+			.visual_angle_range = std::nullopt
+		}
+	);
+}
+
+void terraformer::erode_stream_power(
+	span_2d<float> heightmap,
+	float pixel_size,
+	stream_power_erosion_descriptor const& params,
+	thread_pool<move_only_function<void()>>& workers,
+	std::stop_token const& stop_token
+)
+{
+	auto const w = heightmap.width();
+	auto const h = heightmap.height();
+	basic_image<uint8_t> receivers{w, h};
+	std::vector<pixel_coordinates> outlets;
+
+	for(size_t iteration = 0; iteration != params.iteration_count; ++iteration)
+	{
+		throw_if_stop_requested(stop_token);
+		auto const filled = fill_depressions(heightmap, 0.0f);
+		process_scanlines(
+			receivers.pixels(),
+			workers,
+			stop_token,
+			[]<class ... Args>(Args&&... args){
+				compute_d8_directions(std::forward<Args>(args)...);
+			},
+			filled.pixels()
+		).wait();
+		throw_if_stop_requested(stop_token);
+
+		outlets.clear();
+		for(uint32_t y = 0; y != h; ++y)
+		{
+			for(uint32_t x = 0; x != w; ++x)
+			{
+				if(receivers(x, y) == d8_no_outflow)
+				{ outlets.push_back(pixel_coordinates{static_cast<int32_t>(x), static_cast<int32_t>(y)}); }
+			}
+		}
+
+		// NOTE: Use more tasks than workers, since basins vary a lot in size
+		auto const n_tasks = std::min(std::size(outlets), 4*workers.max_concurrency());
+		if(n_tasks == 0)
+		{ return; }
+
+		basin_solver_context const ctxt{
+			.heightmap = heightmap,
+			.receivers = std::as_const(receivers).pixels(),
+			.pixel_size = pixel_size,
+			.params = params
+		};
+
+		batch_result<void> pending_basins{n_tasks};
+		for(auto chunk : chunk_by_chunk_count_view{std::span{std::as_const(outlets)}, n_tasks})
+		{
+			workers.submit([&ctxt, chunk, &pending_basins = pending_basins.get_state()](){
+				erode_basins(ctxt, chunk);
+				pending_basins.mark_batch_as_completed();
+			});
+		}
+		pending_basins.wait();
+	}
+}
@@ -0,0 +1,56 @@
+//@	{"dependencies_extra":[{"ref":"./stream_power_erosion.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_FILTERS_STREAM_POWER_EROSION_HPP
+#define TERRAFORMER_FILTERS_STREAM_POWER_EROSION_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/descriptor_io/descriptor_editor_ref.hpp"
+#include "lib/execution/cancellation.hpp"
+#include "lib/execution/thread_pool.hpp"
+
+namespace terraformer
+{
+	/**
+	 * Parameters for the stream power law dh/dt = U - K A^m S^n, where A is the drainage area in
+	 * square meters, and S is the slope towards the receiver.
+	 */
+	struct stream_power_erosion_descriptor
+	{
+		float erodibility = 1.0e-5f;
+		float area_exponent = 0.5f;
+		float slope_exponent = 1.0f;
+		float uplift_rate = 0.0f;
+		float time_step = 1.0e4f;
+		size_t iteration_count = 0;
+
+		bool operator==(stream_power_erosion_descriptor const&) const = default;
+		bool operator!=(stream_power_erosion_descriptor const&) const = default;
+
+		void bind(descriptor_editor_ref editor);
+	};
+
+	/**
+	 * Erodes heightmap using the implicit solver by Braun and Willett. In each iteration, flow
+	 * receivers are determined by steepest descent on the depression-filled heightmap. Then,
+	 * every drainage basin is traversed from its outlet and upwards, so the elevation of a pixel
+	 * can be solved for directly, given the new elevation of its receiver. Basins are independent,
+	 * and are distributed over workers. Outlets are held at a fixed base level.
+	 *
+	 * The solver is unconditionally stable, so it converges in a few tens of iterations even with
+	 * large time steps. For slope_exponent other than 1, the elevation is found by Newton
+	 * iteration.
+	 *
+	 * Throws operation_cancelled if a stop is requested through stop_token before all iterations
+	 * have completed. In that case, heightmap holds the result of the last completed iteration.
+	 */
+	void erode_stream_power(
+		span_2d<float> heightmap,
+		float pixel_size,
+		stream_power_erosion_descriptor const& params,
+		thread_pool<move_only_function<void()>>& workers,
+		std::stop_token const& stop_token = std::stop_token{}
+	);
+}
+
+#endif
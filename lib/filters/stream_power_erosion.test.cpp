@@ -0,0 +1,161 @@
+//@	{"target":{"name":"stream_power_erosion.test"}}
+
+#include "./stream_power_erosion.hpp"
+#include "./test_terrain.hpp"
+
+#include "lib/pixel_store/image.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+namespace
+{
+	constexpr terraformer::test_terrain_params terrain_params{
+		.amplitude = 64.0f,
+		.wavenumber_x = 0.37f,
+		.wavenumber_y = 0.29f,
+		.slope_x = 4.0f
+	};
+
+	float max_abs_difference(terraformer::span_2d<float const> a, terraformer::span_2d<float const> b)
+	{
+		auto ret = 0.0f;
+		for(uint32_t y = 0; y != a.height(); ++y)
+		{
+			for(uint32_t x = 0; x != a.width(); ++x)
+			{ ret = std::max(ret, std::abs(a(x, y) - b(x, y))); }
+		}
+		return ret;
+	}
+}
+
+TESTCASE(terraformer_stream_power_erosion_no_iterations)
+{
+	auto heightmap = make_test_terrain(37, 29, terrain_params);
+	auto const input = heightmap;
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	erode_stream_power(heightmap.pixels(), 30.0f, terraformer::stream_power_erosion_descriptor{}, workers);
+	EXPECT_EQ(max_abs_difference(heightmap.pixels(), input.pixels()), 0.0f);
+}
+
+TESTCASE(terraformer_stream_power_erosion_without_uplift_lowers_terrain)
+{
+	auto heightmap = make_test_terrain(37, 29, terrain_params);
+	auto const input = heightmap;
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	erode_stream_power(
+		heightmap.pixels(),
+		30.0f,
+		terraformer::stream_power_erosion_descriptor{.iteration_count = 8},
+		workers
+	);
+
+	auto total_change = 0.0f;
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{
+			EXPECT_LE(heightmap(x, y), input(x, y));
+			EXPECT_EQ(std::isfinite(heightmap(x, y)), true);
+			total_change += input(x, y) - heightmap(x, y);
+		}
+	}
+	EXPECT_GT(total_change, 0.0f);
+
+	// Boundary pixels are outlets, and should not move
+	EXPECT_EQ(heightmap(0, 0), input(0, 0));
+}
+
+TESTCASE(terraformer_stream_power_erosion_fewer_scanlines_than_workers)
+{
+	auto heightmap = make_test_terrain(37, 3, terrain_params);
+	auto const input = heightmap;
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{8};
+	erode_stream_power(
+		heightmap.pixels(),
+		30.0f,
+		terraformer::stream_power_erosion_descriptor{.iteration_count = 4},
+		workers
+	);
+
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{
+			EXPECT_LE(heightmap(x, y), input(x, y));
+			EXPECT_EQ(std::isfinite(heightmap(x, y)), true);
+		}
+	}
+}
+
+TESTCASE(terraformer_stream_power_erosion_reaches_steady_state)
+{
+	auto heightmap = make_test_terrain(37, 29, terrain_params);
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	terraformer::stream_power_erosion_descriptor params{
+		.erodibility = 1.0e-4f,
+		.uplift_rate = 1.0e-3f,
+		.iteration_count = 200
+	};
+	erode_stream_power(heightmap.pixels(), 30.0f, params, workers);
+
+	auto const prev = heightmap;
+	params.iteration_count = 1;
+	erode_stream_power(heightmap.pixels(), 30.0f, params, workers);
+
+	// In steady state, erosion balances uplift
+	EXPECT_LT(max_abs_difference(heightmap.pixels(), prev.pixels()), 1.0e-2f*params.uplift_rate*params.time_step);
+}
+
+TESTCASE(terraformer_stream_power_erosion_nonlinear_slope)
+{
+	auto heightmap = make_test_terrain(37, 29, terrain_params);
+	auto const input = heightmap;
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	erode_stream_power(
+		heightmap.pixels(),
+		30.0f,
+		terraformer::stream_power_erosion_descriptor{
+			.slope_exponent = 1.5f,
+			.iteration_count = 4
+		},
+		workers
+	);
+
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{
+			EXPECT_EQ(std::isfinite(heightmap(x, y)), true);
+			EXPECT_LE(heightmap(x, y), input(x, y));
+		}
+	}
+}
+
+TESTCASE(terraformer_stream_power_erosion_cancelled)
+{
+	auto heightmap = make_test_terrain(37, 29, terrain_params);
+	auto const input = heightmap;
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	std::stop_source stop_source;
+	stop_source.request_stop();
+	try
+	{
+		erode_stream_power(
+			heightmap.pixels(),
+			30.0f,
+			terraformer::stream_power_erosion_descriptor{.iteration_count = 4},
+			workers,
+			stop_source.get_token()
+		);
+		abort();
+	}
+	catch(terraformer::operation_cancelled const&)
+	{}
+
+	// No iteration has been completed
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{ EXPECT_EQ(heightmap(x, y), input(x, y)); }
+	}
+}
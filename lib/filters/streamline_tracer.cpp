@@ -0,0 +1,152 @@
+//@	{"target":{"name":"./streamline_tracer.o"}}
+
+#include "./streamline_tracer.hpp"
+
+#include "lib/common/chunk_by_chunk_count_view.hpp"
+#include "lib/execution/batch_result.hpp"
+#include "lib/math_utils/interp.hpp"
+#include "lib/math_utils/normalized_image_gradient.hpp"
+#include "lib/pixel_store/image.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	struct vector_2d
+	{
+		float x;
+		float y;
+	};
+
+	std::optional<vector_2d> sample_direction(
+		terraformer::span_2d<terraformer::direction const> field,
+		float x,
+		float y
+	)
+	{
+		auto const x_0 = std::floor(x);
+		auto const y_0 = std::floor(y);
+		auto const t_x = x - x_0;
+		auto const t_y = y - y_0;
+		auto const x_i = static_cast<int32_t>(x_0);
+		auto const y_i = static_cast<int32_t>(y_0);
+		using clamp_tag = terraformer::span_2d_extents::clamp_tag;
+
+		std::array const samples{
+			std::pair{field(x_i, y_i, clamp_tag{}), (1.0f - t_x)*(1.0f - t_y)},
+			std::pair{field(x_i + 1, y_i, clamp_tag{}), t_x*(1.0f - t_y)},
+			std::pair{field(x_i, y_i + 1, clamp_tag{}), (1.0f - t_x)*t_y},
+			std::pair{field(x_i + 1, y_i + 1, clamp_tag{}), t_x*t_y}
+		};
+
+		// NOTE: Pixels without any gradient contain NaN, since they cannot be normalized
+		vector_2d sum{0.0f, 0.0f};
+		for(auto const& item : samples)
+		{
+			if(std::isfinite(item.first[0]) && std::isfinite(item.first[1]))
+			{
+				sum.x += item.second*item.first[0];
+				sum.y += item.second*item.first[1];
+			}
+		}
+
+		auto const length = std::sqrt(sum.x*sum.x + sum.y*sum.y);
+		if(!(length > 0.0f))
+		{ return std::nullopt; }
+
+		return vector_2d{sum.x/length, sum.y/length};
+	}
+}
+
+void terraformer::trace_gradient(
+	polyline_store& output,
+	span_2d<float const> heightmap,
+	span_2d<direction const> gradient,
+	pixel_coordinates start_point,
+	size_t max_length
+)
+{
+	auto x = static_cast<float>(start_point.x);
+	auto y = static_cast<float>(start_point.y);
+	auto z = heightmap(static_cast<uint32_t>(start_point.x), static_cast<uint32_t>(start_point.y));
+
+	for(size_t k = 0; k != max_length; ++k)
+	{
+		auto const dir = sample_direction(gradient, x, y);
+		if(!dir.has_value())
+		{ break; }
+
+		auto const x_next = x - dir->x;
+		auto const y_next = y - dir->y;
+		if(!inside(heightmap, x_next, y_next))
+		{ break; }
+
+		auto const z_next = interp(heightmap, x_next, y_next, clamp_at_boundary{});
+		if(z_next >= z)
+		{ break; }
+
+		output.push_back(location{x_next, y_next, z_next}, z - z_next);
+		x = x_next;
+		y = y_next;
+		z = z_next;
+	}
+
+	output.end_polyline();
+}
+
+terraformer::polyline_store terraformer::trace_gradients(
+	span_2d<float const> heightmap,
+	std::span<pixel_coordinates const> seeds,
+	thread_pool<move_only_function<void()>>& workers,
+	size_t max_length
+)
+{
+	basic_image<direction> gradient{heightmap.extents()};
+	compute_normalized_gradient(gradient.pixels(), workers, heightmap).wait();
+
+	auto const n_tasks = std::min(std::size(seeds), workers.max_concurrency());
+	if(n_tasks == 0)
+	{ return polyline_store{}; }
+
+	// NOTE: Each task writes into its own store. The stores are concatenated in seed order
+	//       afterwards, so the result does not depend on scheduling.
+	std::vector<polyline_store> partial_results(n_tasks);
+	batch_result<void> pending_paths{n_tasks};
+	size_t task_index = 0;
+	for(auto chunk : chunk_by_chunk_count_view{seeds, n_tasks})
+	{
+		workers.submit(
+			[
+				&output = partial_results[task_index],
+				chunk,
+				heightmap,
+				gradient = std::as_const(gradient).pixels(),
+				max_length,
+				&pending_paths = pending_paths.get_state()
+			](){
+				output.reserve(std::size(chunk), 0);
+				for(auto const seed : chunk)
+				{ trace_gradient(output, heightmap, gradient, seed, max_length); }
+				pending_paths.mark_batch_as_completed();
+			}
+		);
+		++task_index;
+	}
+	pending_paths.wait();
+
+	polyline_store ret;
+	size_t point_count = 0;
+	for(auto const& item : partial_results)
+	{ point_count += item.point_count(); }
+	ret.reserve(std::size(seeds), point_count);
+
+	for(auto const& item : partial_results)
+	{ ret.append(item); }
+
+	return ret;
+}
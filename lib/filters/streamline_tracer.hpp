@@ -0,0 +1,43 @@
+//@	{"dependencies_extra":[{"ref":"./streamline_tracer.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_FILTERS_STREAMLINE_TRACER_HPP
+#define TERRAFORMER_FILTERS_STREAMLINE_TRACER_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/common/polyline_store.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/execution/thread_pool.hpp"
+
+#include <limits>
+#include <span>
+
+namespace terraformer
+{
+	/**
+	 * Follows the direction of steepest descent in heightmap from start_point, using the
+	 * precomputed normalized gradient field. Each step is one pixel long. The trace ends when
+	 * the elevation no longer decreases, when the path leaves the map, or after max_length
+	 * steps. The start point itself is not stored. The value stored with each point is the drop
+	 * in elevation since the previous point.
+	 */
+	void trace_gradient(
+		polyline_store& output,
+		span_2d<float const> heightmap,
+		span_2d<direction const> gradient,
+		pixel_coordinates start_point,
+		size_t max_length
+	);
+
+	/**
+	 * Traces one path per seed. The gradient field is computed once, and the seeds are
+	 * distributed over workers. Path k in the returned store starts at seeds[k].
+	 */
+	polyline_store trace_gradients(
+		span_2d<float const> heightmap,
+		std::span<pixel_coordinates const> seeds,
+		thread_pool<move_only_function<void()>>& workers,
+		size_t max_length = std::numeric_limits<size_t>::max()
+	);
+}
+
+#endif
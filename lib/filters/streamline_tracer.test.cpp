@@ -0,0 +1,139 @@
+//@	{"target":{"name":"streamline_tracer.test"}}
+
+#include "./streamline_tracer.hpp"
+
+#include "lib/math_utils/normalized_image_gradient.hpp"
+#include "lib/pixel_store/image.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace
+{
+	terraformer::grayscale_image make_bowl(uint32_t width, uint32_t height)
+	{
+		terraformer::grayscale_image ret{width, height};
+		auto const x_0 = 0.5f*static_cast<float>(width);
+		auto const y_0 = 0.4f*static_cast<float>(height);
+		for(uint32_t y = 0; y != height; ++y)
+		{
+			for(uint32_t x = 0; x != width; ++x)
+			{
+				auto const dx = static_cast<float>(x) - x_0;
+				auto const dy = static_cast<float>(y) - y_0;
+				ret(x, y) = std::sqrt(dx*dx + dy*dy) + 4.0f*std::sin(0.1f*static_cast<float>(x));
+			}
+		}
+		return ret;
+	}
+
+	std::vector<terraformer::pixel_coordinates> make_seeds(uint32_t width, uint32_t height)
+	{
+		std::vector<terraformer::pixel_coordinates> ret;
+		for(uint32_t y = 3; y < height; y += 7)
+		{
+			for(uint32_t x = 5; x < width; x += 11)
+			{ ret.push_back(terraformer::pixel_coordinates{static_cast<int32_t>(x), static_cast<int32_t>(y)}); }
+		}
+		return ret;
+	}
+
+	bool equal(terraformer::polyline_store const& a, terraformer::polyline_store const& b)
+	{
+		if(a.size() != b.size())
+		{ return false; }
+
+		for(size_t k = 0; k != a.size(); ++k)
+		{
+			auto const path_a = a[k];
+			auto const path_b = b[k];
+			if(!std::ranges::equal(path_a.values, path_b.values))
+			{ return false; }
+
+			if(!std::ranges::equal(path_a.points, path_b.points, [](auto const& p, auto const& q){
+				return p[0] == q[0] && p[1] == q[1] && p[2] == q[2];
+			}))
+			{ return false; }
+		}
+		return true;
+	}
+}
+
+TESTCASE(terraformer_trace_gradients_paths_descend)
+{
+	auto const heightmap = make_bowl(120, 100);
+	auto const seeds = make_seeds(120, 100);
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const paths = trace_gradients(heightmap.pixels(), seeds, workers);
+
+	EXPECT_EQ(paths.size(), std::size(seeds));
+	EXPECT_GT(paths.point_count(), 0);
+	for(size_t k = 0; k != paths.size(); ++k)
+	{
+		auto z_prev = heightmap(static_cast<uint32_t>(seeds[k].x), static_cast<uint32_t>(seeds[k].y));
+		auto const path = paths[k];
+		for(size_t l = 0; l != std::size(path.points); ++l)
+		{
+			auto const z = path.points[l][2];
+			EXPECT_LT(z, z_prev);
+			EXPECT_GT(path.values[l], 0.0f);
+			z_prev = z;
+		}
+	}
+}
+
+TESTCASE(terraformer_trace_gradients_matches_serial_trace)
+{
+	auto const heightmap = make_bowl(120, 100);
+	auto const seeds = make_seeds(120, 100);
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const paths = trace_gradients(heightmap.pixels(), seeds, workers, 64);
+
+	terraformer::basic_image<terraformer::direction> gradient{heightmap.pixels().extents()};
+	compute_normalized_gradient(
+		terraformer::scanline_processing_job_info{
+			.input_y_offset = 0,
+			.total_height = heightmap.height()
+		},
+		gradient.pixels(),
+		heightmap.pixels()
+	);
+
+	terraformer::polyline_store expected;
+	for(auto const seed : seeds)
+	{ trace_gradient(expected, heightmap.pixels(), gradient.pixels(), seed, 64); }
+
+	EXPECT_EQ(equal(paths, expected), true);
+}
+
+TESTCASE(terraformer_trace_gradients_independent_of_worker_count)
+{
+	auto const heightmap = make_bowl(120, 100);
+	auto const seeds = make_seeds(120, 100);
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> one_worker{1};
+	auto const a = trace_gradients(heightmap.pixels(), seeds, one_worker);
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> four_workers{4};
+	auto const b = trace_gradients(heightmap.pixels(), seeds, four_workers);
+
+	EXPECT_EQ(equal(a, b), true);
+}
+
+TESTCASE(terraformer_trace_gradients_fewer_scanlines_than_workers)
+{
+	auto const heightmap = make_bowl(120, 5);
+	auto const seeds = make_seeds(120, 5);
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> one_worker{1};
+	auto const a = trace_gradients(heightmap.pixels(), seeds, one_worker);
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> eight_workers{8};
+	auto const b = trace_gradients(heightmap.pixels(), seeds, eight_workers);
+
+	EXPECT_EQ(std::size(seeds), 11);
+	EXPECT_EQ(equal(a, b), true);
+}
@@ -0,0 +1,225 @@
+//@	{"target":{"name":"./talus_relaxation.o"}}
+
+#include "./talus_relaxation.hpp"
+
+#include "lib/common/chunk_by_chunk_count_view.hpp"
+#include "lib/execution/batch_result.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <span>
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t tile_size = 64;
+
+	/**
+	 * A set of pixel pairs, where the first pixel is selected by the parity of its x or y
+	 * coordinate, and the second pixel is at offset from the first pixel
+	 */
+	struct pair_set
+	{
+		int32_t dx;
+		int32_t dy;
+		bool select_by_y;
+		uint32_t parity;
+	};
+
+	constexpr std::array<pair_set, 4> axis_aligned_pair_sets{
+		pair_set{1, 0, false, 0},
+		pair_set{1, 0, false, 1},
+		pair_set{0, 1, true, 0},
+		pair_set{0, 1, true, 1}
+	};
+
+	constexpr std::array<pair_set, 4> diagonal_pair_sets{
+		pair_set{1, 1, false, 0},
+		pair_set{1, 1, false, 1},
+		pair_set{-1, 1, false, 0},
+		pair_set{-1, 1, false, 1}
+	};
+
+	struct tile_grid
+	{
+		uint32_t width;
+		uint32_t height;
+	};
+
+	struct relaxation_context
+	{
+		terraformer::span_2d<float> heightmap;
+		float talus_slope;
+		float pixel_size;
+		terraformer::talus_relaxation_descriptor params;
+	};
+
+	bool relax_pairs(
+		relaxation_context const& ctxt,
+		pair_set pairs,
+		uint32_t tile_x,
+		uint32_t tile_y
+	)
+	{
+		auto const heightmap = ctxt.heightmap;
+		auto const w = static_cast<int32_t>(heightmap.width());
+		auto const h = static_cast<int32_t>(heightmap.height());
+		auto const x_begin = static_cast<int32_t>(tile_x*tile_size);
+		auto const y_begin = static_cast<int32_t>(tile_y*tile_size);
+		auto const x_end = std::min(x_begin + static_cast<int32_t>(tile_size), w);
+		auto const y_end = std::min(y_begin + static_cast<int32_t>(tile_size), h);
+		auto const distance = (pairs.dx != 0 && pairs.dy != 0? std::numbers::sqrt2_v<float> : 1.0f)
+			*ctxt.pixel_size;
+		auto const max_dz = ctxt.talus_slope*distance;
+		auto const rate = 0.5f*ctxt.params.rate;
+		auto const tolerance = ctxt.params.tolerance;
+
+		auto changed = false;
+		for(auto y = y_begin; y != y_end; ++y)
+		{
+			auto const y_n = y + pairs.dy;
+			if(y_n < 0 || y_n >= h || (pairs.select_by_y && static_cast<uint32_t>(y)%2 != pairs.parity))
+			{ continue; }
+
+			auto x = x_begin;
+			auto x_step = 1;
+			if(!pairs.select_by_y)
+			{
+				x += static_cast<uint32_t>(x)%2 == pairs.parity? 0 : 1;
+				x_step = 2;
+			}
+
+			for(; x < x_end; x += x_step)
+			{
+				auto const x_n = x + pairs.dx;
+				if(x_n < 0 || x_n >= w)
+				{ continue; }
+
+				auto& a = heightmap(static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+				auto& b = heightmap(static_cast<uint32_t>(x_n), static_cast<uint32_t>(y_n));
+				auto const dz = a - b;
+				auto const excess = std::abs(dz) - max_dz;
+				if(excess <= 0.0f)
+				{ continue; }
+
+				auto const amount = std::copysign(rate*excess, dz);
+				a -= amount;
+				b += amount;
+				changed = changed || std::abs(amount) > tolerance;
+			}
+		}
+		return changed;
+	}
+
+	void dilate(std::vector<uint8_t>& output, std::span<uint8_t const> input, tile_grid grid)
+	{
+		std::ranges::fill(output, 0);
+		for(uint32_t y = 0; y != grid.height; ++y)
+		{
+			for(uint32_t x = 0; x != grid.width; ++x)
+			{
+				if(!input[y*grid.width + x])
+				{ continue; }
+
+				auto const y_min = y == 0? 0 : y - 1;
+				auto const y_max = std::min(y + 2, grid.height);
+				auto const x_min = x == 0? 0 : x - 1;
+				auto const x_max = std::min(x + 2, grid.width);
+				for(auto y_n = y_min; y_n != y_max; ++y_n)
+				{
+					for(auto x_n = x_min; x_n != x_max; ++x_n)
+					{ output[y_n*grid.width + x_n] = 1; }
+				}
+			}
+		}
+	}
+}
+
+terraformer::talus_relaxation_result terraformer::relax_talus(
+	span_2d<float> heightmap,
+	float pixel_size,
+	talus_relaxation_descriptor const& params,
+	thread_pool<move_only_function<void()>>& workers
+)
+{
+	tile_grid const grid{
+		.width = (heightmap.width() + tile_size - 1)/tile_size,
+		.height = (heightmap.height() + tile_size - 1)/tile_size
+	};
+	auto const tile_count = static_cast<size_t>(grid.width)*static_cast<size_t>(grid.height);
+	std::vector<uint8_t> changed_tiles(tile_count, 1);
+	std::vector<uint8_t> active_tiles(tile_count);
+	std::vector<uint32_t> active_tile_indices;
+
+	relaxation_context const ctxt{
+		.heightmap = heightmap,
+		.talus_slope = std::tan(params.repose_angle),
+		.pixel_size = pixel_size,
+		.params = params
+	};
+
+	for(size_t iteration = 0; iteration != params.max_iterations; ++iteration)
+	{
+		// NOTE: A change in one tile may break the slope limit across the border to a neighbour
+		dilate(active_tiles, changed_tiles, grid);
+		active_tile_indices.clear();
+		for(uint32_t k = 0; k != static_cast<uint32_t>(tile_count); ++k)
+		{
+			if(active_tiles[k])
+			{ active_tile_indices.push_back(k); }
+		}
+
+		if(active_tile_indices.empty())
+		{
+			return talus_relaxation_result{
+				.iteration_count = iteration,
+				.converged = true
+			};
+		}
+
+		std::ranges::fill(changed_tiles, 0);
+		auto const n_tasks = std::min(std::size(active_tile_indices), workers.max_concurrency());
+		auto const process_pair_set = [&](pair_set pairs) {
+			batch_result<void> pending_tiles{n_tasks};
+			for(auto chunk : chunk_by_chunk_count_view{std::span{std::as_const(active_tile_indices)}, n_tasks})
+			{
+				workers.submit(
+					[
+						&ctxt,
+						pairs,
+						chunk,
+						grid,
+						changed = std::span{changed_tiles},
+						&pending_tiles = pending_tiles.get_state()
+					](){
+						// NOTE: Each tile belongs to exactly one chunk, so changed can be updated
+						//       without synchronization
+						for(auto index : chunk)
+						{
+							if(relax_pairs(ctxt, pairs, index%grid.width, index/grid.width))
+							{ changed[index] = 1; }
+						}
+						pending_tiles.mark_batch_as_completed();
+					}
+				);
+			}
+			pending_tiles.wait();
+		};
+
+		for(auto const pairs : axis_aligned_pair_sets)
+		{ process_pair_set(pairs); }
+
+		if(params.include_diagonals)
+		{
+			for(auto const pairs : diagonal_pair_sets)
+			{ process_pair_set(pairs); }
+		}
+	}
+
+	dilate(active_tiles, changed_tiles, grid);
+	return talus_relaxation_result{
+		.iteration_count = params.max_iterations,
+		.converged = std::ranges::none_of(active_tiles, [](auto item){ return item != 0; })
+	};
+}
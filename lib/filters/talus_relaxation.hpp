@@ -0,0 +1,62 @@
+//@	{"dependencies_extra":[{"ref":"./talus_relaxation.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_FILTERS_TALUS_RELAXATION_HPP
+#define TERRAFORMER_FILTERS_TALUS_RELAXATION_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/execution/thread_pool.hpp"
+
+#include <numbers>
+
+namespace terraformer
+{
+	struct talus_relaxation_descriptor
+	{
+		/**
+		 * The steepest stable slope, in radians
+		 */
+		float repose_angle = std::numbers::pi_v<float>/6.0f;
+
+		/**
+		 * Fraction of the excess height difference that is moved in each exchange. A value of
+		 * 1 brings the slope between two pixels to the repose angle in a single exchange.
+		 */
+		float rate = 1.0f;
+
+		/**
+		 * Exchanges that move less material than tolerance do not keep a tile active
+		 */
+		float tolerance = 1.0f/1024.0f;
+
+		size_t max_iterations = 1024;
+		bool include_diagonals = true;
+	};
+
+	struct talus_relaxation_result
+	{
+		size_t iteration_count;
+		bool converged;
+	};
+
+	/**
+	 * Moves material downhill wherever the slope between two neighbouring pixels exceeds the
+	 * repose angle. Total volume is preserved.
+	 *
+	 * Each iteration visits the pairs of neighbouring pixels in a fixed number of sets, such that
+	 * no pixel occurs twice within a set (for example, horizontal pairs that start at an even x
+	 * coordinate). Pairs within a set are independent, and are processed in parallel, which makes
+	 * the result independent of the number of workers.
+	 *
+	 * The map is divided into tiles, and only tiles that changed in the previous iteration, and
+	 * their neighbours, are processed. Relaxation stops when no tile is active.
+	 */
+	talus_relaxation_result relax_talus(
+		span_2d<float> heightmap,
+		float pixel_size,
+		talus_relaxation_descriptor const& params,
+		thread_pool<move_only_function<void()>>& workers
+	);
+}
+
+#endif
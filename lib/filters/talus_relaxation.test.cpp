@@ -0,0 +1,94 @@
+//@	{"target":{"name":"talus_relaxation.test"}}
+
+#include "./talus_relaxation.hpp"
+
+#include "lib/pixel_store/image.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+namespace
+{
+	terraformer::grayscale_image make_spiky_terrain(uint32_t width, uint32_t height)
+	{
+		terraformer::grayscale_image ret{width, height};
+		ret(width/3, height/2) = 400.0f;
+		ret(2*width/3, height/3) = 250.0f;
+		ret(width/5, height/5) = -100.0f;
+		return ret;
+	}
+
+	double sum(terraformer::span_2d<float const> pixels)
+	{
+		auto ret = 0.0;
+		for(auto item : pixels)
+		{ ret += static_cast<double>(item); }
+		return ret;
+	}
+
+	float max_slope(terraformer::span_2d<float const> pixels, float pixel_size)
+	{
+		auto ret = 0.0f;
+		for(uint32_t y = 0; y != pixels.height(); ++y)
+		{
+			for(uint32_t x = 0; x + 1 < pixels.width(); ++x)
+			{ ret = std::max(ret, std::abs(pixels(x + 1, y) - pixels(x, y))/pixel_size); }
+		}
+
+		for(uint32_t y = 0; y + 1 < pixels.height(); ++y)
+		{
+			for(uint32_t x = 0; x != pixels.width(); ++x)
+			{ ret = std::max(ret, std::abs(pixels(x, y + 1) - pixels(x, y))/pixel_size); }
+		}
+		return ret;
+	}
+}
+
+TESTCASE(terraformer_talus_relaxation_limits_slope_and_preserves_volume)
+{
+	auto heightmap = make_spiky_terrain(150, 130);
+	auto const volume_before = sum(heightmap.pixels());
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	terraformer::talus_relaxation_descriptor const params{};
+	auto const res = relax_talus(heightmap.pixels(), 2.0f, params, workers);
+
+	EXPECT_EQ(res.converged, true);
+	EXPECT_LT(std::abs(sum(heightmap.pixels()) - volume_before), 1.0e-2);
+	EXPECT_LT(max_slope(heightmap.pixels(), 2.0f), std::tan(params.repose_angle) + 1.0e-2f);
+	EXPECT_LT(heightmap(50, 65), 400.0f);
+	EXPECT_GT(heightmap(51, 65), 0.0f);
+}
+
+TESTCASE(terraformer_talus_relaxation_independent_of_worker_count)
+{
+	auto const input = make_spiky_terrain(150, 130);
+	terraformer::talus_relaxation_descriptor const params{};
+
+	auto a = input;
+	terraformer::thread_pool<terraformer::move_only_function<void()>> one_worker{1};
+	auto const res_a = relax_talus(a.pixels(), 2.0f, params, one_worker);
+
+	auto b = input;
+	terraformer::thread_pool<terraformer::move_only_function<void()>> four_workers{4};
+	auto const res_b = relax_talus(b.pixels(), 2.0f, params, four_workers);
+
+	EXPECT_EQ(res_a.iteration_count, res_b.iteration_count);
+	EXPECT_EQ(std::ranges::equal(a.pixels(), b.pixels()), true);
+}
+
+TESTCASE(terraformer_talus_relaxation_stable_terrain_exits_early)
+{
+	terraformer::grayscale_image heightmap{150, 130};
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{ heightmap(x, y) = 0.25f*static_cast<float>(x); }
+	}
+	auto const input = heightmap;
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const res = relax_talus(heightmap.pixels(), 1.0f, terraformer::talus_relaxation_descriptor{}, workers);
+
+	EXPECT_EQ(res.converged, true);
+	EXPECT_EQ(res.iteration_count, 1);
+	EXPECT_EQ(std::ranges::equal(heightmap.pixels(), input.pixels()), true);
+}
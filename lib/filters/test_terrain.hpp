@@ -0,0 +1,40 @@
+#ifndef TERRAFORMER_FILTERS_TEST_TERRAIN_HPP
+#define TERRAFORMER_FILTERS_TEST_TERRAIN_HPP
+
+#include "lib/pixel_store/image.hpp"
+
+#include <cmath>
+#include <cstdint>
+
+namespace terraformer
+{
+	struct test_terrain_params
+	{
+		float amplitude;
+		float wavenumber_x;
+		float wavenumber_y;
+		float slope_x;
+	};
+
+	/**
+	 * Generates a wavy heightmap, with ridges and valleys, on top of a plane inclined along x.
+	 * Used by the filter tests.
+	 */
+	inline grayscale_image make_test_terrain(uint32_t width, uint32_t height, test_terrain_params const& params)
+	{
+		grayscale_image ret{width, height};
+		for(uint32_t y = 0; y != height; ++y)
+		{
+			for(uint32_t x = 0; x != width; ++x)
+			{
+				auto const xi = static_cast<float>(x);
+				auto const eta = static_cast<float>(y);
+				ret(x, y) = params.amplitude*(std::sin(params.wavenumber_x*xi)*std::cos(params.wavenumber_y*eta) + 1.0f)
+					+ params.slope_x*xi;
+			}
+		}
+		return ret;
+	}
+}
+
+#endif
@@ -0,0 +1,220 @@
+//@	{"target":{"name":"./viewshed.o"}}
+
+#include "./viewshed.hpp"
+
+#include "lib/common/chunk_by_chunk_count_view.hpp"
+#include "lib/common/input_error.hpp"
+#include "lib/execution/batch_result.hpp"
+#include "lib/math_utils/interp.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace
+{
+	struct viewshed_bounds
+	{
+		int32_t x_min;
+		int32_t y_min;
+		int32_t x_max;
+		int32_t y_max;
+	};
+
+	viewshed_bounds get_region_within_reach(
+		terraformer::span_2d_extents domain_size,
+		terraformer::viewshed_observer const& observer
+	)
+	{
+		auto const w = static_cast<int32_t>(domain_size.width);
+		auto const h = static_cast<int32_t>(domain_size.height);
+		auto const reach = std::isfinite(observer.max_distance)?
+			static_cast<int32_t>(std::min(observer.max_distance, static_cast<float>(std::max(w, h)))) :
+			std::max(w, h);
+		auto const loc = observer.location;
+
+		return viewshed_bounds{
+			.x_min = std::max(loc.x - reach, 0),
+			.y_min = std::max(loc.y - reach, 0),
+			.x_max = std::min(loc.x + reach, w - 1),
+			.y_max = std::min(loc.y + reach, h - 1)
+		};
+	}
+
+	void cast_ray(
+		terraformer::span_2d<float> output,
+		terraformer::span_2d<float const> heightmap,
+		terraformer::viewshed_observer const& observer,
+		float z_observer,
+		terraformer::pixel_coordinates target
+	)
+	{
+		auto const origin = observer.location;
+		auto const dx = target.x - origin.x;
+		auto const dy = target.y - origin.y;
+		auto const n = std::max(std::abs(dx), std::abs(dy));
+		if(n == 0)
+		{ return; }
+
+		auto const step_x = static_cast<float>(dx)/static_cast<float>(n);
+		auto const step_y = static_cast<float>(dy)/static_cast<float>(n);
+		auto const step_length = std::sqrt(step_x*step_x + step_y*step_y);
+		auto const x_0 = static_cast<float>(origin.x);
+		auto const y_0 = static_cast<float>(origin.y);
+
+		auto max_slope = -std::numeric_limits<float>::infinity();
+		for(int32_t k = 1; k <= n; ++k)
+		{
+			auto const dist = static_cast<float>(k)*step_length;
+			if(dist > observer.max_distance)
+			{ return; }
+
+			auto const x = x_0 + static_cast<float>(k)*step_x;
+			auto const y = y_0 + static_cast<float>(k)*step_y;
+			auto const z = interp(heightmap, x, y, terraformer::clamp_at_boundary{});
+
+			if((z + observer.target_height - z_observer)/dist >= max_slope)
+			{
+				output(
+					static_cast<uint32_t>(std::lround(x)),
+					static_cast<uint32_t>(std::lround(y))
+				) = 1.0f;
+			}
+
+			max_slope = std::max(max_slope, (z - z_observer)/dist);
+		}
+	}
+
+	void validate_observer(
+		terraformer::span_2d<float const> heightmap,
+		terraformer::viewshed_observer const& observer
+	)
+	{
+		if(!inside(heightmap, observer.location.x, observer.location.y))
+		{ throw terraformer::input_error{"The observer must be placed within the heightmap"}; }
+	}
+
+	void mark_visible_pixels(
+		terraformer::span_2d<float> output,
+		terraformer::span_2d<float const> heightmap,
+		terraformer::viewshed_observer const& observer,
+		viewshed_bounds region
+	)
+	{
+		auto const loc = observer.location;
+		assert(inside(heightmap, loc.x, loc.y));
+
+		auto const x_obs = static_cast<uint32_t>(loc.x);
+		auto const y_obs = static_cast<uint32_t>(loc.y);
+		auto const z_observer = heightmap(x_obs, y_obs) + observer.observer_height;
+		output(x_obs, y_obs) = 1.0f;
+
+		for(auto x = region.x_min; x <= region.x_max; ++x)
+		{
+			cast_ray(output, heightmap, observer, z_observer, terraformer::pixel_coordinates{x, region.y_min});
+			cast_ray(output, heightmap, observer, z_observer, terraformer::pixel_coordinates{x, region.y_max});
+		}
+
+		for(auto y = region.y_min + 1; y < region.y_max; ++y)
+		{
+			cast_ray(output, heightmap, observer, z_observer, terraformer::pixel_coordinates{region.x_min, y});
+			cast_ray(output, heightmap, observer, z_observer, terraformer::pixel_coordinates{region.x_max, y});
+		}
+	}
+}
+
+void terraformer::mark_visible_pixels(
+	span_2d<float> output,
+	span_2d<float const> heightmap,
+	viewshed_observer const& observer
+)
+{
+	validate_observer(heightmap, observer);
+	::mark_visible_pixels(
+		output,
+		heightmap,
+		observer,
+		get_region_within_reach(heightmap.extents(), observer)
+	);
+}
+
+terraformer::grayscale_image terraformer::make_cumulative_viewshed(
+	span_2d<float const> heightmap,
+	std::span<viewshed_observer const> observers,
+	thread_pool<move_only_function<void()>>& workers
+)
+{
+	// NOTE: Validate all observers before any task is started, so no task can throw
+	for(auto const& observer : observers)
+	{ validate_observer(heightmap, observer); }
+
+	auto const n_tasks = std::min(workers.max_concurrency(), std::size(observers));
+	if(n_tasks == 0)
+	{ return grayscale_image{heightmap.extents()}; }
+
+	batch_result<grayscale_image> pending_viewsheds{n_tasks};
+	for(auto chunk : chunk_by_chunk_count_view{observers, n_tasks})
+	{
+		workers.submit(
+			[
+				&pending_viewsheds = pending_viewsheds.get_state(),
+				chunk,
+				heightmap
+			]()
+			{
+				grayscale_image sum{heightmap.extents()};
+				grayscale_image visible{heightmap.extents()};
+				for(auto const& observer : chunk)
+				{
+					auto const region = get_region_within_reach(heightmap.extents(), observer);
+					for(auto y = region.y_min; y <= region.y_max; ++y)
+					{
+						for(auto x = region.x_min; x <= region.x_max; ++x)
+						{ visible(x, y) = 0.0f; }
+					}
+
+					::mark_visible_pixels(visible.pixels(), heightmap, observer, region);
+
+					for(auto y = region.y_min; y <= region.y_max; ++y)
+					{
+						for(auto x = region.x_min; x <= region.x_max; ++x)
+						{ sum(x, y) += visible(x, y); }
+					}
+				}
+				pending_viewsheds.save_partial_result(std::move(sum));
+			}
+		);
+	}
+
+	return pending_viewsheds.get_result(
+		[extents = heightmap.extents(), &workers](auto const& images){
+			grayscale_image ret{extents};
+			for(auto const& item : images)
+			{
+				// NOTE: Use the chunked version, since heightmap may have fewer scanlines than there
+				//       are workers
+				process_scanlines(
+					ret.pixels(),
+					workers,
+					std::stop_token{},
+					[](
+						scanline_processing_job_info const& jobinfo,
+						span_2d<float> output,
+						span_2d<float const> input
+					){
+						auto const w = output.width();
+						auto const h = output.height();
+						auto const input_y_offset = jobinfo.input_y_offset;
+						for(uint32_t y = 0; y != h; ++y)
+						{
+							for(uint32_t x = 0; x != w; ++x)
+							{ output(x, y) += input(x, y + input_y_offset); }
+						}
+					},
+					item.pixels()
+				).wait();
+			}
+			return ret;
+		}
+	);
+}
@@ -0,0 +1,67 @@
+//@	{"dependencies_extra":[{"ref":"./viewshed.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_FILTERS_VIEWSHED_HPP
+#define TERRAFORMER_FILTERS_VIEWSHED_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/execution/thread_pool.hpp"
+#include "lib/pixel_store/image.hpp"
+
+#include <limits>
+#include <span>
+
+namespace terraformer
+{
+	struct viewshed_observer
+	{
+		pixel_coordinates location;
+		float observer_height = 0.0f;
+		float target_height = 0.0f;
+		float max_distance = std::numeric_limits<float>::infinity();
+	};
+
+	/**
+	 * Sets all pixels in output that are visible from observer to 1. Other pixels are left as is.
+	 * A pixel is visible if a target, observer.target_height above the ground, can be seen by an
+	 * observer that is observer.observer_height above the ground. max_distance is measured in
+	 * pixels.
+	 *
+	 * Rays are cast from the observer to every pixel on the boundary of the region within
+	 * max_distance. Along a ray, the steepest elevation angle seen so far is tracked, which makes
+	 * the cost proportional to the number of pixels (the R2 algorithm).
+	 *
+	 * NOTE: Since elevation angles only are compared with each other, the pixel size does not
+	 *       affect the result.
+	 *
+	 * Throws input_error if the observer is outside heightmap.
+	 */
+	void mark_visible_pixels(
+		span_2d<float> output,
+		span_2d<float const> heightmap,
+		viewshed_observer const& observer
+	);
+
+	inline grayscale_image make_viewshed(
+		span_2d<float const> heightmap,
+		viewshed_observer const& observer
+	)
+	{
+		grayscale_image ret{heightmap.extents()};
+		mark_visible_pixels(ret.pixels(), heightmap, observer);
+		return ret;
+	}
+
+	/**
+	 * Computes the number of observers that can see each pixel. Observers are distributed over
+	 * the workers, and each worker accumulates into its own image. Throws input_error if any
+	 * observer is outside heightmap.
+	 */
+	grayscale_image make_cumulative_viewshed(
+		span_2d<float const> heightmap,
+		std::span<viewshed_observer const> observers,
+		thread_pool<move_only_function<void()>>& workers
+	);
+}
+
+#endif
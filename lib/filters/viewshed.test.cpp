@@ -0,0 +1,140 @@
+//@	{"target":{"name":"viewshed.test"}}
+
+#include "./viewshed.hpp"
+
+#include "lib/common/input_error.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <array>
+
+TESTCASE(terraformer_viewshed_flat_terrain_everything_visible)
+{
+	terraformer::grayscale_image heightmap{17, 13};
+	auto const res = make_viewshed(
+		heightmap.pixels(),
+		terraformer::viewshed_observer{
+			.location = terraformer::pixel_coordinates{5, 7},
+			.observer_height = 1.0f
+		}
+	);
+
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{ EXPECT_EQ(res(x, y), 1.0f); }
+	}
+}
+
+TESTCASE(terraformer_viewshed_max_distance)
+{
+	terraformer::grayscale_image heightmap{17, 13};
+	auto const res = make_viewshed(
+		heightmap.pixels(),
+		terraformer::viewshed_observer{
+			.location = terraformer::pixel_coordinates{8, 6},
+			.observer_height = 1.0f,
+			.max_distance = 4.0f
+		}
+	);
+
+	EXPECT_EQ(res(8, 6), 1.0f);
+	EXPECT_EQ(res(12, 6), 1.0f);
+	EXPECT_EQ(res(8, 2), 1.0f);
+	EXPECT_EQ(res(13, 6), 0.0f);
+	EXPECT_EQ(res(11, 9), 0.0f);
+	EXPECT_EQ(res(0, 0), 0.0f);
+}
+
+TESTCASE(terraformer_viewshed_wall_hides_terrain_behind)
+{
+	terraformer::grayscale_image heightmap{32, 16};
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{ heightmap(16, y) = 8.0f; }
+
+	terraformer::viewshed_observer const observer{
+		.location = terraformer::pixel_coordinates{4, 8},
+		.observer_height = 1.0f
+	};
+
+	auto const res = make_viewshed(heightmap.pixels(), observer);
+
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != 16; ++x)
+		{ EXPECT_EQ(res(x, y), 1.0f); }
+
+		EXPECT_EQ(res(16, y), 1.0f);
+
+		for(uint32_t x = 18; x != heightmap.width(); ++x)
+		{ EXPECT_EQ(res(x, y), 0.0f); }
+	}
+
+	auto const res_tall_target = make_viewshed(
+		heightmap.pixels(),
+		terraformer::viewshed_observer{
+			.location = observer.location,
+			.observer_height = observer.observer_height,
+			.target_height = 64.0f
+		}
+	);
+
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{ EXPECT_EQ(res_tall_target(x, y), 1.0f); }
+	}
+}
+
+TESTCASE(terraformer_viewshed_observer_outside_heightmap)
+{
+	terraformer::grayscale_image heightmap{17, 13};
+	try
+	{
+		(void)make_viewshed(
+			heightmap.pixels(),
+			terraformer::viewshed_observer{.location = terraformer::pixel_coordinates{17, 7}}
+		);
+		abort();
+	}
+	catch(terraformer::input_error const&)
+	{}
+}
+
+TESTCASE(terraformer_viewshed_cumulative_same_as_sum_of_viewsheds)
+{
+	// Fewer scanlines than workers
+	terraformer::grayscale_image heightmap{16, 4};
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{ heightmap(8, y) = 8.0f; }
+
+	std::array const observers{
+		terraformer::viewshed_observer{.location = terraformer::pixel_coordinates{2, 1}, .observer_height = 1.0f},
+		terraformer::viewshed_observer{.location = terraformer::pixel_coordinates{3, 2}, .observer_height = 1.0f},
+		terraformer::viewshed_observer{.location = terraformer::pixel_coordinates{13, 3}, .observer_height = 1.0f}
+	};
+
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{8};
+	auto const res = make_cumulative_viewshed(heightmap.pixels(), observers, workers);
+
+	terraformer::grayscale_image expected{heightmap.pixels().extents()};
+	for(auto const& observer : observers)
+	{
+		auto const viewshed = make_viewshed(heightmap.pixels(), observer);
+		for(uint32_t y = 0; y != heightmap.height(); ++y)
+		{
+			for(uint32_t x = 0; x != heightmap.width(); ++x)
+			{ expected(x, y) += viewshed(x, y); }
+		}
+	}
+
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{ EXPECT_EQ(res(x, y), expected(x, y)); }
+	}
+
+	// The wall is seen from both sides
+	EXPECT_EQ(res(8, 2), 3.0f);
+	EXPECT_EQ(res(12, 2), 1.0f);
+}
@@ -10,6 +10,10 @@
 #include "lib/pixel_store/image.hpp"
 #include "lib/common/string_to_value_map.hpp"
 
+#include <algorithm>
+#include <cassert>
+#include <optional>
+
 void terraformer::heightmap_generator_channel_strip_descriptor::bind(descriptor_editor_ref editor)
 {
 	// TODO: Use a combobox instead
@@ -104,60 +108,166 @@ void terraformer::heightmap_descriptor::bind(descriptor_editor_ref editor)
 		record.append_pending_widgets();
 		++k;
 	}
+
+	auto erosion_editor = editor.create_form(
+		descriptor_editor_ref::field_descriptor{
+			.label = u8"Erosion",
+		},
+		descriptor_editor_ref::form_descriptor{}
+	);
+	erosion.bind(erosion_editor);
 }
 
-terraformer::grayscale_image terraformer::generate(
+terraformer::heightmap_generator_outputs terraformer::run_generators(
 	computation_context& comp_ctxt,
-	heightmap_descriptor const& descriptor
+	heightmap_descriptor const& descriptor,
+	std::stop_token const& stop_token,
+	persistent_image_cache* output_cache,
+	uint32_t downsampling_factor
 )
 {
-	u8string_to_value_map<grayscale_image> inputs;
-	uint32_t output_width = 0;
-	uint32_t output_height = 0;
+	heightmap_generator_outputs ret{
+		.images = u8string_to_value_map<grayscale_image>{},
+		.output_size = span_2d_extents{0, 0}
+	};
+
 	for(auto const& item : descriptor.generators)
 	{
 		auto img = item.second.generate_heightmap(
 			heightmap_generator_context{
 				.domain_size = descriptor.domain_size,
-				.comp_ctxt = comp_ctxt
+				.comp_ctxt = comp_ctxt,
+				.stop_token = stop_token,
+				.output_cache = output_cache,
+				.downsampling_factor = downsampling_factor
 			}
 		);
-		output_height = std::max(img.height(), output_height);
-		output_width = std::max(img.width(), output_width);
-		inputs.insert(std::pair{item.first, std::move(img)});
+		ret.output_size.height = std::max(img.height(), ret.output_size.height);
+		ret.output_size.width = std::max(img.width(), ret.output_size.width);
+		ret.images.insert(std::pair{item.first, grayscale_image{img}});
 	}
 
-	single_array<std::pair<grayscale_image, float>> images_to_mix;
-	image_registry_view registry{std::cref(inputs)};
-	for(auto& item : descriptor.channel_strips)
+	return ret;
+}
+
+void terraformer::mix_channel_strips(
+	span_2d<float> output,
+	span_2d_extents canvas_size,
+	pixel_region region,
+	heightmap_generator_outputs const& inputs,
+	heightmap_descriptor const& descriptor
+)
+{
+	assert(output.width() == width(region));
+	assert(output.height() == height(region));
+
+	auto const w_canvas = static_cast<float>(canvas_size.width);
+	auto const h_canvas = static_cast<float>(canvas_size.height);
+	image_registry_view registry{std::cref(inputs.images)};
+
+	std::ranges::fill(output, 0.0f);
+	for(auto const& item : descriptor.channel_strips)
 	{
-		auto& img = std::as_const(inputs).at(item.input);
+		auto const input = inputs.images.at(item.input).pixels();
+		auto const w_input = static_cast<float>(input.width());
+		auto const h_input = static_cast<float>(input.height());
 
-		auto output_image = img;
+		std::optional<filters::modulation_function> mod_a;
 		if(!item.modulation_a.modulator.empty())
 		{
-			output_image = item.modulation_a.compose_image_from(
-				span_2d_extents{output_width, output_height},
-				output_image.pixels(),
-				registry
-			);
+			filters::modulation_function f{item.modulation_a, registry};
+			if(!f.is_constant())
+			{ mod_a = f; }
 		}
 
+		std::optional<filters::modulation_function> mod_b;
 		if(!item.modulation_b.modulator.empty())
 		{
-			output_image = item.modulation_b.compose_image_from(
-				span_2d_extents{output_width, output_height},
-				output_image.pixels(),
-				registry
-			);
+			filters::modulation_function f{item.modulation_b, registry};
+			if(!f.is_constant())
+			{ mod_b = f; }
 		}
 
-		images_to_mix.push_back(std::pair{std::move(output_image), item.gain});
+		for(uint32_t y = 0; y != output.height(); ++y)
+		{
+			auto const y_canvas = (0.5f + static_cast<float>(y + region.y_begin))/h_canvas;
+			for(uint32_t x = 0; x != output.width(); ++x)
+			{
+				auto const x_canvas = (0.5f + static_cast<float>(x + region.x_begin))/w_canvas;
+				auto val = interp(
+					input,
+					x_canvas*w_input - 0.5f,
+					y_canvas*h_input - 0.5f,
+					clamp_at_boundary{}
+				);
+
+				if(mod_a.has_value())
+				{ val *= (*mod_a)(x_canvas, y_canvas); }
+
+				if(mod_b.has_value())
+				{ val *= (*mod_b)(x_canvas, y_canvas); }
+
+				output(x, y) += item.gain*val;
+			}
+		}
 	}
+}
+
+terraformer::grayscale_image terraformer::generate(
+	computation_context& comp_ctxt,
+	heightmap_descriptor const& descriptor,
+	std::stop_token const& stop_token,
+	persistent_image_cache* output_cache
+)
+{
+	auto const inputs = run_generators(comp_ctxt, descriptor, stop_token, output_cache);
+	auto const output_size = inputs.output_size;
+	terraformer::grayscale_image ret{output_size};
+	if(output_size.width == 0 || output_size.height == 0)
+	{ return ret; }
+
+	auto const mix_scanlines = [](
+		scanline_processing_job_info const& jobinfo,
+		span_2d<float> output,
+		span_2d_extents canvas_size,
+		heightmap_generator_outputs const& inputs,
+		heightmap_descriptor const& descriptor
+	){
+		mix_channel_strips(
+			output,
+			canvas_size,
+			pixel_region{
+				.x_begin = 0,
+				.y_begin = jobinfo.input_y_offset,
+				.x_end = output.width(),
+				.y_end = jobinfo.input_y_offset + output.height()
+			},
+			inputs,
+			descriptor
+		);
+	};
 
-	terraformer::grayscale_image ret{output_width, output_height};
-	for(auto const& item : images_to_mix)
-	{ add_resampled(item.first.pixels(), ret.pixels(), item.second); }
+	process_scanlines(
+		ret.pixels(),
+		comp_ctxt.workers,
+		stop_token,
+		mix_scanlines,
+		output_size,
+		std::cref(inputs),
+		std::cref(descriptor)
+	).wait();
+	throw_if_stop_requested(stop_token);
+
+	if(descriptor.erosion.iteration_count != 0)
+	{
+		erode_stream_power(
+			ret.pixels(),
+			descriptor.domain_size.width/static_cast<float>(output_size.width),
+			descriptor.erosion,
+			comp_ctxt.workers,
+			stop_token
+		);
+	}
 
 	return ret;
 }
@@ -7,11 +7,14 @@
 
 #include "lib/common/shared_resource.hpp"
 #include "lib/common/span_2d.hpp"
+#include "lib/common/string_to_value_map.hpp"
 #include "lib/common/unique_resource.hpp"
 #include "lib/common/shared_resource.hpp"
 #include "lib/descriptor_io/descriptor_editor_ref.hpp"
+#include "lib/descriptor_io/descriptor_hasher.hpp"
 #include "lib/filters/heightmap_to_mesh.hpp"
 #include "lib/filters/modulator/modulator.hpp"
+#include "lib/filters/stream_power_erosion.hpp"
 #include "lib/generators/plain_generator/plain.hpp"
 #include "lib/generators/rolling_hills_generator/rolling_hills_generator.hpp"
 #include "lib/generators/ridge_tree_generator_new/ridge_tree_generator.hpp"
@@ -22,6 +25,7 @@
 #include <concepts>
 #include <map>
 #include <string>
+#include <string_view>
 
 namespace terraformer
 {
@@ -34,8 +38,42 @@ namespace terraformer
 	{
 		{std::as_const(x).generate_heightmap(ctxt)} -> std::same_as<grayscale_image>;
 		{x.bind(editor)} -> std::same_as<void>;
+		{T::generator_name} -> std::convertible_to<std::string_view>;
 	} && std::equality_comparable<T>;
 
+	/**
+	 * Version of the heightmap generators. Bump this value whenever a change to a generator
+	 * changes its output, so that outputs stored in a persistent_image_cache are invalidated.
+	 */
+	constexpr uint32_t heightmap_generator_version = 2;
+
+	/**
+	 * Computes the key used to look up the output of a generator in a persistent_image_cache.
+	 * Descriptor::generator_name is used to tell generators apart, since it is stable between
+	 * builds and compilers.
+	 */
+	template<heightmap_generator_source_descriptor Descriptor>
+	persistent_image_cache::key_type make_generator_output_key(
+		domain_size_descriptor const& domain_size,
+		uint32_t downsampling_factor,
+		Descriptor const& descriptor
+	)
+	{
+		auto const descriptor_digest = hash_descriptor(descriptor);
+		fnv1a_128 hash;
+		hash.update(heightmap_generator_version);
+		hash.update(std::string_view{Descriptor::generator_name});
+		hash.update(domain_size.width);
+		hash.update(domain_size.height);
+		hash.update(downsampling_factor);
+		hash.update(std::span{descriptor_digest});
+		return hash.digest();
+	}
+
+	/**
+	 * Keeps the most recent output of a generator, for each downsampling factor. This way, a
+	 * preview does not evict the full resolution output.
+	 */
 	template<heightmap_generator_source_descriptor Descriptor>
 	class generated_heightmap
 	{
@@ -45,24 +83,47 @@ namespace terraformer
 			Descriptor const& new_descriptor
 		)
 		{
+			auto& stored = m_stored_outputs[ctxt.downsampling_factor];
 			if(
-				ctxt.domain_size != m_dom_size ||
-				new_descriptor != m_descriptor ||
-				m_output.width() == 0 ||
-				m_output.height() == 0
+				ctxt.domain_size != stored.dom_size ||
+				new_descriptor != stored.descriptor ||
+				stored.output.width() == 0 ||
+				stored.output.height() == 0
 			)
 			{
-				m_output = new_descriptor.generate_heightmap(ctxt);
-				m_dom_size = ctxt.domain_size;
-				m_descriptor = new_descriptor;
+				stored.output = generate_or_load(ctxt, new_descriptor);
+				stored.dom_size = ctxt.domain_size;
+				stored.descriptor = new_descriptor;
 			}
-			return m_output.pixels();
+			return stored.output.pixels();
 		}
 
 	private:
-		domain_size_descriptor m_dom_size{};
-		Descriptor m_descriptor{};
-		grayscale_image m_output{};
+		static grayscale_image generate_or_load(
+			heightmap_generator_context const& ctxt,
+			Descriptor const& descriptor
+		)
+		{
+			if(ctxt.output_cache == nullptr)
+			{ return descriptor.generate_heightmap(ctxt); }
+
+			auto const key = make_generator_output_key(ctxt.domain_size, ctxt.downsampling_factor, descriptor);
+			if(auto cached = ctxt.output_cache->load(key); cached.has_value())
+			{ return std::move(*cached); }
+
+			auto ret = descriptor.generate_heightmap(ctxt);
+			ctxt.output_cache->store(key, std::as_const(ret).pixels());
+			return ret;
+		}
+
+		struct stored_output
+		{
+			domain_size_descriptor dom_size{};
+			Descriptor descriptor{};
+			grayscale_image output{};
+		};
+
+		std::map<uint32_t, stored_output> m_stored_outputs;
 	};
 
 
@@ -194,10 +255,62 @@ namespace terraformer
 			}
 		};
 
+		stream_power_erosion_descriptor erosion;
+
 		void bind(descriptor_editor_ref editor);
 	};
 
-	grayscale_image generate(computation_context& comp_ctxt, heightmap_descriptor const& descriptor);
+	/**
+	 * The images produced by the generators of a heightmap_descriptor, before they are mixed
+	 */
+	struct heightmap_generator_outputs
+	{
+		u8string_to_value_map<grayscale_image> images;
+
+		/**
+		 * The size of the largest image, which is used as the size of the mixed heightmap. Since
+		 * each generator divides its size by the downsampling factor, rounded up, this is also the
+		 * full resolution size divided by the downsampling factor, rounded up.
+		 */
+		span_2d_extents output_size;
+	};
+
+	/**
+	 * Runs all generators of descriptor. If output_cache is set, generator outputs are looked up
+	 * in, and stored to, output_cache. downsampling_factor is passed on to the generators through
+	 * heightmap_generator_context.
+	 */
+	heightmap_generator_outputs run_generators(
+		computation_context& comp_ctxt,
+		heightmap_descriptor const& descriptor,
+		std::stop_token const& stop_token = std::stop_token{},
+		persistent_image_cache* output_cache = nullptr,
+		uint32_t downsampling_factor = 1
+	);
+
+	/**
+	 * Mixes the channel strips of descriptor into output, which holds the pixels within region of
+	 * an image with canvas_size pixels. The canvas does not have to match inputs.output_size.
+	 * A smaller canvas gives a low-resolution version of the mix.
+	 */
+	void mix_channel_strips(
+		span_2d<float> output,
+		span_2d_extents canvas_size,
+		pixel_region region,
+		heightmap_generator_outputs const& inputs,
+		heightmap_descriptor const& descriptor
+	);
+
+	/**
+	 * Generates the heightmap described by descriptor. Throws operation_cancelled if a stop is
+	 * requested through stop_token before the heightmap is complete.
+	 */
+	grayscale_image generate(
+		computation_context& comp_ctxt,
+		heightmap_descriptor const& descriptor,
+		std::stop_token const& stop_token = std::stop_token{},
+		persistent_image_cache* output_cache = nullptr
+	);
 }
 
 #endif
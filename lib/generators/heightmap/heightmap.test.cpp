@@ -0,0 +1,162 @@
+//@	{"target":{"name":"heightmap.test"}}
+
+#include "./heightmap.hpp"
+
+#include "lib/common/image_registry_view.hpp"
+#include "lib/math_utils/interp.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <cmath>
+#include <thread>
+
+namespace
+{
+	terraformer::grayscale_image make_test_image(uint32_t width, uint32_t height, float wavenumber)
+	{
+		terraformer::grayscale_image ret{width, height};
+		for(uint32_t y = 0; y != height; ++y)
+		{
+			for(uint32_t x = 0; x != width; ++x)
+			{
+				auto const xi = static_cast<float>(x);
+				auto const eta = static_cast<float>(y);
+				ret(x, y) = std::sin(wavenumber*xi)*std::cos(0.5f*wavenumber*eta) + 0.25f*xi/static_cast<float>(width);
+			}
+		}
+		return ret;
+	}
+
+	// This is how heightmaps were mixed before mix_channel_strips was introduced
+	terraformer::grayscale_image compose_and_add_resampled(
+		terraformer::heightmap_generator_outputs const& inputs,
+		terraformer::heightmap_descriptor const& descriptor
+	)
+	{
+		auto const output_size = inputs.output_size;
+		terraformer::image_registry_view registry{std::cref(inputs.images)};
+		terraformer::grayscale_image ret{output_size};
+		for(auto const& item : descriptor.channel_strips)
+		{
+			auto output_image = inputs.images.at(item.input);
+			if(!item.modulation_a.modulator.empty())
+			{
+				output_image = item.modulation_a.compose_image_from(
+					output_size,
+					std::as_const(output_image).pixels(),
+					registry
+				);
+			}
+
+			if(!item.modulation_b.modulator.empty())
+			{
+				output_image = item.modulation_b.compose_image_from(
+					output_size,
+					std::as_const(output_image).pixels(),
+					registry
+				);
+			}
+
+			add_resampled(std::as_const(output_image).pixels(), ret.pixels(), item.gain);
+		}
+		return ret;
+	}
+}
+
+TESTCASE(terraformer_heightmap_mix_channel_strips_matches_compose_and_add_resampled)
+{
+	terraformer::heightmap_generator_outputs inputs{
+		.images = terraformer::u8string_to_value_map<terraformer::grayscale_image>{},
+		.output_size = terraformer::span_2d_extents{48, 32}
+	};
+	inputs.images.insert(std::pair{std::u8string{u8"A"}, make_test_image(48, 32, 0.25f)});
+	inputs.images.insert(std::pair{std::u8string{u8"B"}, make_test_image(37, 29, 0.375f)});
+	inputs.images.insert(std::pair{std::u8string{u8"C"}, make_test_image(12, 9, 0.75f)});
+
+	terraformer::heightmap_descriptor descriptor{};
+	descriptor.channel_strips = std::array{
+		terraformer::heightmap_generator_channel_strip_descriptor{
+			.input = u8"A",
+			.modulation_a = terraformer::filters::modulator_descriptor{
+				.modulator = u8"B",
+				.modulator_exponent = 1.0f,
+				.modulation_depth = 0.5f
+			},
+			.modulation_b = terraformer::filters::modulator_descriptor{
+				.modulator = u8"C",
+				.modulator_exponent = 1.0f,
+				.modulation_depth = -1.0f
+			},
+			.gain = 1.0f
+		},
+		terraformer::heightmap_generator_channel_strip_descriptor{
+			.input = u8"B",
+			.modulation_a = terraformer::filters::modulator_descriptor{},
+			.modulation_b = terraformer::filters::modulator_descriptor{},
+			.gain = -0.5f
+		},
+		terraformer::heightmap_generator_channel_strip_descriptor{
+			.input = u8"C",
+			.modulation_a = terraformer::filters::modulator_descriptor{
+				.modulator = u8"A",
+				.modulator_exponent = 2.0f,
+				.modulation_depth = 0.75f
+			},
+			.modulation_b = terraformer::filters::modulator_descriptor{},
+			.gain = 0.25f
+		}
+	};
+
+	auto const expected = compose_and_add_resampled(inputs, descriptor);
+
+	terraformer::grayscale_image mixed{inputs.output_size};
+	terraformer::mix_channel_strips(
+		mixed.pixels(),
+		inputs.output_size,
+		terraformer::pixel_region{
+			.x_begin = 0,
+			.y_begin = 0,
+			.x_end = inputs.output_size.width,
+			.y_end = inputs.output_size.height
+		},
+		inputs,
+		descriptor
+	);
+
+	for(uint32_t y = 0; y != mixed.height(); ++y)
+	{
+		for(uint32_t x = 0; x != mixed.width(); ++x)
+		{ EXPECT_LT(std::abs(mixed(x, y) - expected(x, y)), 1.0e-5f); }
+	}
+}
+
+TESTCASE(terraformer_heightmap_run_generators_downsampled_size)
+{
+	terraformer::computation_context comp_ctxt{
+		.workers = terraformer::thread_pool<terraformer::move_only_function<void()>>{
+			std::thread::hardware_concurrency()
+		},
+		.dft_engine = terraformer::dft_engine{}
+	};
+
+	terraformer::heightmap_descriptor descriptor{};
+	descriptor.domain_size = terraformer::domain_size_descriptor{
+		.width = 8192.0f,
+		.height = 6144.0f
+	};
+
+	auto const full = run_generators(comp_ctxt, descriptor);
+
+	uint32_t const factor = 3;
+	auto const downsampled = run_generators(comp_ctxt, descriptor, std::stop_token{}, nullptr, factor);
+
+	EXPECT_EQ(downsampled.output_size.width, (full.output_size.width + factor - 1)/factor);
+	EXPECT_EQ(downsampled.output_size.height, (full.output_size.height + factor - 1)/factor);
+
+	for(auto const& item : full.images)
+	{
+		auto const& img = downsampled.images.at(item.first);
+		EXPECT_EQ(img.width(), (item.second.width() + factor - 1)/factor);
+		EXPECT_EQ(img.height(), (item.second.height() + factor - 1)/factor);
+	}
+}
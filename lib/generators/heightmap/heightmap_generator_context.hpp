@@ -1,12 +1,15 @@
 #ifndef TERRAFORMER_HEIGHTMAP_GENERATOR_CONTEXT_HPP
 #define TERRAFORMER_HEIGHTMAP_GENERATOR_CONTEXT_HPP
 
+#include "lib/execution/cancellation.hpp"
 #include "lib/math_utils/computation_context.hpp"
 #include "lib/generators/domain/domain_size.hpp"
+#include "lib/pixel_store/persistent_image_cache.hpp"
 
 #include "lib/math_utils/dft_engine.hpp"
 
 #include <functional>
+#include <stop_token>
 
 namespace terraformer
 {
@@ -14,6 +17,25 @@ namespace terraformer
 	{
 		domain_size_descriptor domain_size;
 		std::reference_wrapper<computation_context> comp_ctxt;
+
+		/**
+		 * Generators should check stop_token between expensive stages, and throw
+		 * operation_cancelled when a stop has been requested
+		 */
+		std::stop_token stop_token{};
+
+		/**
+		 * If set, generator outputs are looked up in, and stored to, output_cache
+		 */
+		persistent_image_cache* output_cache = nullptr;
+
+		/**
+		 * Generators divide the size of their output by downsampling_factor, rounded up. This is
+		 * used for previews. The output should be an approximation of the full resolution output,
+		 * so a generator whose output depends on its resolution should compute that part at full
+		 * resolution.
+		 */
+		uint32_t downsampling_factor = 1;
 	};
 };
 
@@ -0,0 +1,202 @@
+//@	{"target":{"name":"./heightmap_preview.o"}}
+
+#include "./heightmap_preview.hpp"
+
+#include "lib/execution/batch_result.hpp"
+#include "lib/execution/cancellation.hpp"
+#include "lib/math_utils/interp.hpp"
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
+namespace
+{
+	bool intersects(terraformer::pixel_region a, terraformer::pixel_region b)
+	{
+		return a.x_begin < b.x_end && b.x_begin < a.x_end
+			&& a.y_begin < b.y_end && b.y_begin < a.y_end;
+	}
+
+	void upsample(
+		terraformer::scanline_processing_job_info const& jobinfo,
+		terraformer::span_2d<float> output,
+		terraformer::span_2d<float const> input,
+		uint32_t total_width
+	)
+	{
+		auto const scale_x = static_cast<float>(input.width())/static_cast<float>(total_width);
+		auto const scale_y = static_cast<float>(input.height())/static_cast<float>(jobinfo.total_height);
+		for(uint32_t y = 0; y != output.height(); ++y)
+		{
+			auto const y_in = (0.5f + static_cast<float>(y + jobinfo.input_y_offset))*scale_y - 0.5f;
+			for(uint32_t x = 0; x != output.width(); ++x)
+			{
+				auto const x_in = (0.5f + static_cast<float>(x))*scale_x - 0.5f;
+				output(x, y) = interp(input, x_in, y_in, terraformer::clamp_at_boundary{});
+			}
+		}
+	}
+
+	/**
+	 * Mixes tiles directly into output, which covers the entire canvas. Tiles do not overlap,
+	 * so they can be written in parallel.
+	 */
+	void mix_tiles(
+		terraformer::span_2d<float> output,
+		std::span<terraformer::pixel_region const> tiles,
+		terraformer::heightmap_generator_outputs const& inputs,
+		terraformer::heightmap_descriptor const& descriptor,
+		terraformer::thread_pool<terraformer::move_only_function<void()>>& workers
+	)
+	{
+		terraformer::batch_result<void> pending_tiles{std::size(tiles)};
+		for(auto const tile : tiles)
+		{
+			workers.submit(
+				[
+					output,
+					tile,
+					&inputs,
+					&descriptor,
+					&pending_tiles = pending_tiles.get_state()
+				](){
+					terraformer::grayscale_image buffer{width(tile), height(tile)};
+					mix_channel_strips(buffer.pixels(), output.extents(), tile, inputs, descriptor);
+					for(uint32_t y = 0; y != buffer.height(); ++y)
+					{
+						std::copy_n(
+							&buffer(0, y),
+							buffer.width(),
+							&output(tile.x_begin, tile.y_begin + y)
+						);
+					}
+					pending_tiles.mark_batch_as_completed();
+				}
+			);
+		}
+		pending_tiles.wait();
+	}
+
+	std::vector<terraformer::pixel_region> make_tiles(terraformer::span_2d_extents size, uint32_t tile_size)
+	{
+		std::vector<terraformer::pixel_region> ret;
+		for(uint32_t y = 0; y < size.height; y += tile_size)
+		{
+			for(uint32_t x = 0; x < size.width; x += tile_size)
+			{
+				ret.push_back(
+					terraformer::pixel_region{
+						.x_begin = x,
+						.y_begin = y,
+						.x_end = std::min(x + tile_size, size.width),
+						.y_end = std::min(y + tile_size, size.height)
+					}
+				);
+			}
+		}
+		return ret;
+	}
+
+	/**
+	 * Mixes tiles in batches of one tile per worker, so that stop_token is checked regularly
+	 */
+	void mix_tiles_in_batches(
+		terraformer::span_2d<float> output,
+		std::span<terraformer::pixel_region const> tiles,
+		terraformer::heightmap_generator_outputs const& inputs,
+		terraformer::heightmap_descriptor const& descriptor,
+		terraformer::thread_pool<terraformer::move_only_function<void()>>& workers,
+		std::stop_token const& stop_token
+	)
+	{
+		auto const batch_size = std::max(workers.max_concurrency(), static_cast<size_t>(1));
+		while(!tiles.empty())
+		{
+			terraformer::throw_if_stop_requested(stop_token);
+			auto const n = std::min(batch_size, std::size(tiles));
+			mix_tiles(output, tiles.first(n), inputs, descriptor, workers);
+			tiles = tiles.subspan(n);
+		}
+	}
+}
+
+terraformer::grayscale_image terraformer::generate_progressively(
+	computation_context& comp_ctxt,
+	heightmap_descriptor const& descriptor,
+	heightmap_preview_descriptor const& params,
+	function_ref<void(heightmap_preview_stage, span_2d<float const>)> on_stage_completed,
+	std::stop_token const& stop_token,
+	persistent_image_cache* output_cache
+)
+{
+	auto& workers = comp_ctxt.workers;
+	auto const tile_size = std::max(params.tile_size, 1u);
+
+	auto const factor = std::max(params.proxy_downsampling_factor, 1u);
+	auto const proxy_inputs = run_generators(comp_ctxt, descriptor, stop_token, output_cache, factor);
+	throw_if_stop_requested(stop_token);
+	if(proxy_inputs.output_size.width == 0 || proxy_inputs.output_size.height == 0)
+	{ return grayscale_image{proxy_inputs.output_size}; }
+
+	// The generator outputs may differ in size. mix_channel_strips resamples them onto the proxy.
+	grayscale_image proxy{proxy_inputs.output_size};
+	auto const proxy_tiles = make_tiles(proxy.pixels().extents(), tile_size);
+	mix_tiles(proxy.pixels(), proxy_tiles, proxy_inputs, descriptor, workers);
+	on_stage_completed(heightmap_preview_stage::proxy, std::as_const(proxy).pixels());
+
+	auto const inputs = run_generators(comp_ctxt, descriptor, stop_token, output_cache);
+	auto const output_size = inputs.output_size;
+	throw_if_stop_requested(stop_token);
+	if(output_size.width == 0 || output_size.height == 0)
+	{ return grayscale_image{output_size}; }
+
+	grayscale_image ret{output_size};
+	process_scanlines(
+		ret.pixels(),
+		workers,
+		stop_token,
+		upsample,
+		std::as_const(proxy).pixels(),
+		output_size.width
+	).wait();
+	throw_if_stop_requested(stop_token);
+
+	auto tiles = make_tiles(output_size, tile_size);
+	auto const viewport = params.viewport.value_or(
+		pixel_region{
+			.x_begin = 0,
+			.y_begin = 0,
+			.x_end = output_size.width,
+			.y_end = output_size.height
+		}
+	);
+	auto const remaining_tiles_begin = std::ranges::stable_partition(
+		tiles,
+		[viewport](auto const& tile){ return intersects(tile, viewport); }
+	).begin();
+	auto const viewport_tiles = std::span{std::as_const(tiles)}.first(
+		static_cast<size_t>(remaining_tiles_begin - std::begin(tiles))
+	);
+	auto const remaining_tiles = std::span{std::as_const(tiles)}.subspan(std::size(viewport_tiles));
+
+	mix_tiles_in_batches(ret.pixels(), viewport_tiles, inputs, descriptor, workers, stop_token);
+	on_stage_completed(heightmap_preview_stage::viewport, std::as_const(ret).pixels());
+
+	mix_tiles_in_batches(ret.pixels(), remaining_tiles, inputs, descriptor, workers, stop_token);
+	throw_if_stop_requested(stop_token);
+
+	if(descriptor.erosion.iteration_count != 0)
+	{
+		erode_stream_power(
+			ret.pixels(),
+			descriptor.domain_size.width/static_cast<float>(output_size.width),
+			descriptor.erosion,
+			workers,
+			stop_token
+		);
+	}
+
+	on_stage_completed(heightmap_preview_stage::complete, std::as_const(ret).pixels());
+	return ret;
+}
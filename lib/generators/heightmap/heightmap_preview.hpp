@@ -0,0 +1,64 @@
+//@	{"dependencies_extra":[{"ref":"./heightmap_preview.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_HEIGHTMAP_PREVIEW_HPP
+#define TERRAFORMER_HEIGHTMAP_PREVIEW_HPP
+
+#include "./heightmap.hpp"
+
+#include "lib/common/function_ref.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/pixel_store/image.hpp"
+
+#include <optional>
+#include <stop_token>
+
+namespace terraformer
+{
+	enum class heightmap_preview_stage{proxy, viewport, complete};
+
+	struct heightmap_preview_descriptor
+	{
+		/**
+		 * The generators are first run with this downsampling factor, and their outputs are mixed
+		 * into the proxy. The size of the proxy is the size of the full resolution heightmap
+		 * divided by this factor, rounded up.
+		 */
+		uint32_t proxy_downsampling_factor = 8;
+
+		/**
+		 * The part of the full resolution heightmap that is visible. Tiles within the viewport are
+		 * refined first. No viewport means that the entire heightmap is visible.
+		 */
+		std::optional<pixel_region> viewport;
+
+		uint32_t tile_size = 256;
+	};
+
+	/**
+	 * Generates heightmap in stages, so a preview can be presented before the full resolution
+	 * heightmap is ready:
+	 *
+	 * 1. A low-resolution proxy, mixed from generator outputs computed at reduced resolution
+	 * 2. The proxy, upsampled to full resolution, with all tiles within the viewport refined
+	 * 3. The complete heightmap, with erosion applied
+	 *
+	 * on_stage_completed is called after each stage. The image passed to on_stage_completed is
+	 * only valid during the call.
+	 *
+	 * stop_token is checked before each batch of tiles. If a stop has been requested,
+	 * generation is abandoned by throwing operation_cancelled.
+	 *
+	 * \note Generator outputs are cached for each resolution, so only generators whose parameters
+	 *       have changed need to run again.
+	 */
+	grayscale_image generate_progressively(
+		computation_context& comp_ctxt,
+		heightmap_descriptor const& descriptor,
+		heightmap_preview_descriptor const& params,
+		function_ref<void(heightmap_preview_stage, span_2d<float const>)> on_stage_completed,
+		std::stop_token const& stop_token,
+		persistent_image_cache* output_cache = nullptr
+	);
+}
+
+#endif
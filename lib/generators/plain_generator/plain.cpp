@@ -68,7 +68,8 @@ namespace
 
 terraformer::grayscale_image terraformer::generate(
 	domain_size_descriptor dom_size,
-	plain_descriptor const& params
+	plain_descriptor const& params,
+	uint32_t downsampling_factor
 )
 {
 	auto const size_factor = std::min(dom_size.width, dom_size.height);
@@ -76,9 +77,10 @@ terraformer::grayscale_image terraformer::generate(
 	auto const w_scaled = min_pixel_count*dom_size.width/size_factor;
 	auto const h_scaled = min_pixel_count*dom_size.height/size_factor;
 
+	downsampling_factor = std::max(downsampling_factor, 1u);
 	grayscale_image ret{
-		static_cast<uint32_t>(w_scaled + 0.5f),
-			static_cast<uint32_t>(h_scaled + 0.5f)
+		(static_cast<uint32_t>(w_scaled + 0.5f) + downsampling_factor - 1)/downsampling_factor,
+		(static_cast<uint32_t>(h_scaled + 0.5f) + downsampling_factor - 1)/downsampling_factor
 	};
 
 	auto const w = ret.width();
@@ -450,7 +452,7 @@ void terraformer::plain_midpoints_info::bind(descriptor_editor_ref editor)
 terraformer::grayscale_image terraformer::plain_descriptor::generate_heightmap(
 	heightmap_generator_context const& ctxt
 ) const
-{ return generate(ctxt.domain_size, *this); }
+{ return generate(ctxt.domain_size, *this, ctxt.downsampling_factor); }
 
 void terraformer::plain_descriptor::bind(descriptor_editor_ref editor)
 {
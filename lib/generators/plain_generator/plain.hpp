@@ -10,6 +10,8 @@
 #include "lib/common/bounded_value.hpp"
 #include "lib/descriptor_io/descriptor_editor_ref.hpp"
 
+#include <string_view>
+
 namespace terraformer
 {
 	struct plain_control_point_descriptor
@@ -63,6 +65,8 @@ namespace terraformer
 		plain_control_points_info control_points;
 		plain_midpoints_info midpoints;
 
+		static constexpr std::string_view generator_name{"plain"};
+
 		grayscale_image generate_heightmap(heightmap_generator_context const& ctxt) const;
 		void bind(descriptor_editor_ref editor);
 
@@ -70,7 +74,15 @@ namespace terraformer
 		bool operator!=(plain_descriptor const&) const = default;
 	};
 
-	grayscale_image generate(domain_size_descriptor dom_size, plain_descriptor const& params);
+	/**
+	 * Generates a plain described by params. The size of the output is divided by
+	 * downsampling_factor, rounded up.
+	 */
+	grayscale_image generate(
+		domain_size_descriptor dom_size,
+		plain_descriptor const& params,
+		uint32_t downsampling_factor = 1
+	);
 }
 
 #endif
@@ -9,6 +9,7 @@
 #include "lib/common/span_2d.hpp"
 #include "lib/common/value_map.hpp"
 #include "lib/descriptor_io/descriptor_editor_ref.hpp"
+#include "lib/execution/cancellation.hpp"
 #include "lib/generators/domain/domain_size.hpp"
 #include "lib/generators/heightmap/heightmap_generator_context.hpp"
 #include "lib/generators/ridge_tree_generator_new/ridge_curve.hpp"
@@ -132,7 +133,8 @@ void terraformer::fill_curves(
 	ridge_tree_trunk const& trunk,
 	ridge_tree_ridge_height_profile const& elev_profile,
 	float pixel_size,
-	random_generator& rng
+	random_generator& rng,
+	std::stop_token const& stop_token
 )
 {
 	auto const elems = trunk.branches.element_indices();
@@ -144,6 +146,7 @@ void terraformer::fill_curves(
 	std::uniform_real_distribution value_noise_gen{-1.0f, std::nextafter(1.0f, 2.0f)};
 	for(auto k : elems)
 	{
+		throw_if_stop_requested(stop_token);
 		auto const& curve = curves[k];
 		if(curve.points().empty())
 		{ continue; }
@@ -256,7 +259,8 @@ namespace
 				.y_direction = 0.0f
 			},
 			output,
-			ctxt.comp_ctxt
+			ctxt.comp_ctxt,
+			ctxt.stop_token
 		);
 
 		auto const minmax = std::ranges::minmax_element(filtered_noise.pixels());
@@ -313,9 +317,19 @@ terraformer::generate(terraformer::heightmap_generator_context const& ctxt, ridg
 	terraformer::random_generator rng{rng_seed};
 
 	auto const dom_size = ctxt.domain_size;
-	auto const global_pixel_size = get_min_pixel_size(params);
-	auto const w_img = 2u*std::max(static_cast<uint32_t>(dom_size.width/(2.0f*global_pixel_size) + 0.5f), 1u);
-	auto const h_img = 2u*std::max(static_cast<uint32_t>(dom_size.height/(2.0f*global_pixel_size) + 0.5f), 1u);
+	auto const min_pixel_size = get_min_pixel_size(params);
+	auto const half_w_full = std::max(static_cast<uint32_t>(dom_size.width/(2.0f*min_pixel_size) + 0.5f), 1u);
+	auto const half_h_full = std::max(static_cast<uint32_t>(dom_size.height/(2.0f*min_pixel_size) + 0.5f), 1u);
+
+	// When downsampling, the image is generated with an even size, as the noise filter requires,
+	// and is then cropped to the full resolution size divided by downsampling_factor, rounded up.
+	// The cropped pixels are outside the domain.
+	auto const downsampling_factor = std::max(ctxt.downsampling_factor, 1u);
+	auto const global_pixel_size = min_pixel_size*static_cast<float>(downsampling_factor);
+	auto const w_img = 2u*((half_w_full + downsampling_factor - 1)/downsampling_factor);
+	auto const h_img = 2u*((half_h_full + downsampling_factor - 1)/downsampling_factor);
+	auto const w_out = (2u*half_w_full + downsampling_factor - 1)/downsampling_factor;
+	auto const h_out = (2u*half_h_full + downsampling_factor - 1)/downsampling_factor;
 	grayscale_image ret{w_img, h_img};
 
 	single_array<ridge_tree_trunk> trunks;
@@ -339,7 +353,8 @@ terraformer::generate(terraformer::heightmap_generator_context const& ctxt, ridg
 			.rolloff_exponent_variability = trunk_height_profile.rolloff_exponent_variability
 		},
 		global_pixel_size,
-		rng
+		rng,
+		ctxt.stop_token
 	);
 
 	auto trace_input = ret;
@@ -363,6 +378,8 @@ terraformer::generate(terraformer::heightmap_generator_context const& ctxt, ridg
 		if(current_trunk_index == std::size(trunks))
 		{ break; }
 
+		throw_if_stop_requested(ctxt.stop_token);
+
 		auto& current_trunk = trunks[current_trunk_index];
 		auto const next_level_index = current_trunk.level + 1;
 		if(next_level_index == std::size(branch_growth_params) + 1)
@@ -456,7 +473,7 @@ terraformer::generate(terraformer::heightmap_generator_context const& ctxt, ridg
 					}
 				);
 
-				fill_curves(tmp, trunks.back(), current_height_profile, global_pixel_size, rng);
+				fill_curves(tmp, trunks.back(), current_height_profile, global_pixel_size, rng, ctxt.stop_token);
 			}
 
 			if(!stem.right.empty())
@@ -470,7 +487,7 @@ terraformer::generate(terraformer::heightmap_generator_context const& ctxt, ridg
 						.side = ridge_tree_trunk::side::right
 					}
 				);
-				fill_curves(tmp, trunks.back(), current_height_profile, global_pixel_size, rng);
+				fill_curves(tmp, trunks.back(), current_height_profile, global_pixel_size, rng, ctxt.stop_token);
 			}
 		}
 		add(trace_input.pixels(), std::as_const(tmp).pixels());
@@ -489,7 +506,17 @@ terraformer::generate(terraformer::heightmap_generator_context const& ctxt, ridg
 		add(ret.pixels(), std::as_const(tmp).pixels());
 		++current_trunk_index;
 	}
-	return ret;
+
+	if(w_out == w_img && h_out == h_img)
+	{ return ret; }
+
+	grayscale_image cropped{w_out, h_out};
+	for(uint32_t y = 0; y != h_out; ++y)
+	{
+		for(uint32_t x = 0; x != w_out; ++x)
+		{ cropped(x, y) = ret(x, y); }
+	}
+	return cropped;
 }
 
 terraformer::grayscale_image
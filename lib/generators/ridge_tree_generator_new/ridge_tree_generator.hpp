@@ -19,6 +19,7 @@
 
 #include <geosimd/angle.hpp>
 #include <numbers>
+#include <string_view>
 
 namespace terraformer
 {
@@ -192,7 +193,8 @@ namespace terraformer
 		ridge_tree_trunk const& trunk,
 		ridge_tree_ridge_height_profile const& elev_profile,
 		float pixel_size,
-		random_generator& rng
+		random_generator& rng,
+		std::stop_token const& stop_token
 	);
 
 	struct ridge_tree_elevation_modulation
@@ -223,6 +225,7 @@ namespace terraformer
 		std::array<std::byte, 16> rng_seed{};
 		ridge_tree_trunk_descriptor trunk;
 
+		static constexpr std::string_view generator_name{"ridge_tree"};
 		static constexpr size_t num_levels = 3;
 
 		std::array<ridge_tree_brach_seed_sequence_boundary_point_descriptor, num_levels - 1> endpoint_branches{
@@ -11,6 +11,7 @@
 #include "lib/value_maps/affine_value_map.hpp"
 #include "lib/value_maps/log_value_map.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <random>
 
@@ -237,15 +238,18 @@ terraformer::generate(heightmap_generator_context const& ctxt, rolling_hills_des
 	auto const h_img = filter.height();
 
 	auto noise = make_noise(w_img, h_img, std::bit_cast<rng_seed_type>(params.rng_seed));
+	throw_if_stop_requested(ctxt.stop_token);
 
 	basic_image<std::complex<float>> transformed_input{w_img, h_img};
 	dft_engine.transform(noise.pixels(), transformed_input.pixels(), dft_direction::forward).wait();
+	throw_if_stop_requested(ctxt.stop_token);
 	for(uint32_t y = 0; y != h_img; ++y)
 	{
 		for(uint32_t x = 0; x != w_img; ++x)
 		{ transformed_input(x, y) *= filter(x, y); }
 	}
 	dft_engine.transform(transformed_input.pixels(), noise.pixels(), dft_direction::backward).wait();
+	throw_if_stop_requested(ctxt.stop_token);
 
 	grayscale_image filtered_output{w_img, h_img};
 	auto sign_y = 1.0f;
@@ -274,8 +278,12 @@ terraformer::generate(heightmap_generator_context const& ctxt, rolling_hills_des
 
 	shape_output_range output_range{params.shape};
 	auto const shape_scale_factor = std::ceil(std::exp2(std::abs(std::log2(params.shape.exponent))));
-	auto const w_out = w_img * static_cast<uint32_t>(shape_scale_factor);
-	auto const h_out = h_img * static_cast<uint32_t>(shape_scale_factor);
+
+	// The noise depends on its resolution, so it is always filtered at full resolution. When
+	// downsampling, only every downsampling_factor:th output pixel is shaped.
+	auto const downsampling_factor = std::max(ctxt.downsampling_factor, 1u);
+	auto const w_out = (w_img*static_cast<uint32_t>(shape_scale_factor) + downsampling_factor - 1)/downsampling_factor;
+	auto const h_out = (h_img*static_cast<uint32_t>(shape_scale_factor) + downsampling_factor - 1)/downsampling_factor;
 	grayscale_image ret{w_out, h_out};
 	auto const amplitude = params.amplitude;
 	auto const relative_z_offset = params.relative_z_offset;
@@ -284,8 +292,8 @@ terraformer::generate(heightmap_generator_context const& ctxt, rolling_hills_des
 	{
 		for(uint32_t x = 0; x != w_out; ++x)
 		{
-			auto const x_in = static_cast<float>(x)/shape_scale_factor;
-			auto const y_in = static_cast<float>(y)/shape_scale_factor;
+			auto const x_in = static_cast<float>(x*downsampling_factor)/shape_scale_factor;
+			auto const y_in = static_cast<float>(y*downsampling_factor)/shape_scale_factor;
 			auto const input_value = interp(filtered_output, x_in, y_in, wrap_around_at_boundary{});
 			auto const normalized_value = 2.0f*(input_value - min)/(max - min) - 1.0f;
 
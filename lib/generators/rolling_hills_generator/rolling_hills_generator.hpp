@@ -9,6 +9,8 @@
 #include "lib/common/bounded_value.hpp"
 #include "lib/descriptor_io/descriptor_editor_ref.hpp"
 
+#include <string_view>
+
 namespace terraformer
 {
 	struct rolling_hills_filter_descriptor
@@ -88,6 +90,8 @@ namespace terraformer
 		float amplitude = 4096.0f/(4.0f*std::numbers::pi_v<float>);
 		float relative_z_offset = 0.0f;
 
+		static constexpr std::string_view generator_name{"rolling_hills"};
+
 		bool operator==(rolling_hills_descriptor const&) const = default;
 		bool operator!=(rolling_hills_descriptor const&) const = default;
 
@@ -2,6 +2,8 @@
 
 #include "./rolling_hills_generator.hpp"
 #include "lib/common/bounded_value.hpp"
+#include "lib/generators/heightmap/heightmap_generator_context.hpp"
+#include "lib/math_utils/computation_context.hpp"
 
 #include <testfwk/testfwk.hpp>
 
@@ -202,4 +204,47 @@ TESTCASE(terraformer_rolling_hills_generator_make_rolling_hills_smooth_clamp_des
 		auto const x = x_0 + static_cast<float>(k)*dx;
 		printf("%.8g %.8g\n", x, clamp(x, smooth_clamp_params));
 	}
-}
\ No newline at end of file
+}
+TESTCASE(terraformer_rolling_hills_generator_generate_downsampled)
+{
+	terraformer::computation_context comp_ctxt{
+		.workers = terraformer::thread_pool<terraformer::move_only_function<void()>>{4},
+		.dft_engine = terraformer::dft_engine{}
+	};
+
+	terraformer::domain_size_descriptor const dom_size{
+		.width = 8192.0f,
+		.height = 4096.0f
+	};
+
+	terraformer::rolling_hills_descriptor params{};
+	params.filter.wavelength_x = 4096.0f;
+	params.filter.wavelength_y = 4096.0f;
+
+	auto const full = generate(
+		terraformer::heightmap_generator_context{
+			.domain_size = dom_size,
+			.comp_ctxt = comp_ctxt
+		},
+		params
+	);
+
+	uint32_t const factor = 3;
+	auto const downsampled = generate(
+		terraformer::heightmap_generator_context{
+			.domain_size = dom_size,
+			.comp_ctxt = comp_ctxt,
+			.downsampling_factor = factor
+		},
+		params
+	);
+
+	EXPECT_EQ(downsampled.width(), (full.width() + factor - 1)/factor);
+	EXPECT_EQ(downsampled.height(), (full.height() + factor - 1)/factor);
+
+	for(uint32_t y = 0; y != downsampled.height(); ++y)
+	{
+		for(uint32_t x = 0; x != downsampled.width(); ++x)
+		{ EXPECT_EQ(downsampled(x, y), full(factor*x, factor*y)); }
+	}
+}
@@ -2,8 +2,14 @@
 #define TERRAFORMER_GENERATE_LIGHTMAP_HPP
 
 #include "./sun_direction.hpp"
+#include "./horizon_map.hpp"
 #include "lib/math_utils/wave_sum.hpp"
+#include "lib/math_utils/differentiation.hpp"
 #include "lib/filters/raycaster.hpp"
+#include "lib/filters/max_height_pyramid.hpp"
+#include "lib/execution/notifying_task.hpp"
+
+#include <optional>
 
 namespace terraformer
 {
@@ -58,15 +64,13 @@ namespace terraformer
 		};
 	}
 
-	inline float intensity(span_2d<float const> heightmap,
-					span_2d<float const> upper_boundary,
-					pixel_coordinates loc,
-					lightmap_params const& params)
+	inline std::optional<direction> sun_direction_in_domain(span_2d_extents domain_size,
+		pixel_coordinates loc,
+		lightmap_params const& params)
 	{
-		auto const n = normal(heightmap, loc.x, loc.y, 1.0f/params.pixel_size, clamp_at_boundary{});
 		auto const maploc = to_map_location(
 			loc,
-			heightmap.extents(),
+			domain_size,
 			params.pixel_size/params.planet_radius
 		);
 
@@ -79,7 +83,7 @@ namespace terraformer
 		// NOTE: It is assumed that domain is only rotated around z axis. Thus, it is ok to discard
 		//       the current fragment if sun is below horizon before applying domain rotation.
 		if(sun_dir[2] <= 0.0)
-		{ return 0.0f; }
+		{ return std::nullopt; }
 
 		terraformer::displacement const sun_dir_float{
 			static_cast<float>(sun_dir[0]),
@@ -87,9 +91,20 @@ namespace terraformer
 			static_cast<float>(sun_dir[2])
 		};
 
-		auto const d = terraformer::direction(sun_dir_float).apply(params.domain_rot);
+		return terraformer::direction(sun_dir_float).apply(params.domain_rot);
+	}
 
-		auto const n_proj = inner_product(n, d);
+	inline float intensity(span_2d<float const> heightmap,
+					span_2d<float const> upper_boundary,
+					pixel_coordinates loc,
+					lightmap_params const& params)
+	{
+		auto const d = sun_direction_in_domain(heightmap.extents(), loc, params);
+		if(!d.has_value())
+		{ return 0.0f; }
+
+		auto const n = normal(heightmap, loc.x, loc.y, 1.0f/params.pixel_size, clamp_at_boundary{});
+		auto const n_proj = inner_product(n, *d);
 
 		if(n_proj <= 0.0f)
 		{ return 0.0f; }
@@ -98,7 +113,7 @@ namespace terraformer
 			heightmap,
 			loc,
 			heightmap(loc.x, loc.y),
-			d,
+			*d,
 			params.pixel_size,
 			[heightmap, upper_boundary](auto, auto loc){
 				if(!inside(heightmap, loc[0], loc[1]))
@@ -117,6 +132,117 @@ namespace terraformer
 		return n_proj;
 	}
 
+	inline float intensity(max_height_pyramid const& heightmap,
+		pixel_coordinates loc,
+		lightmap_params const& params)
+	{
+		auto const pixels = heightmap.source();
+		auto const d = sun_direction_in_domain(pixels.extents(), loc, params);
+		if(!d.has_value())
+		{ return 0.0f; }
+
+		auto const x = static_cast<uint32_t>(loc.x);
+		auto const y = static_cast<uint32_t>(loc.y);
+		auto const n = normal(pixels, x, y, 1.0f/params.pixel_size, clamp_at_boundary{});
+		auto const n_proj = inner_product(n, *d);
+
+		if(n_proj <= 0.0f)
+		{ return 0.0f; }
+
+		auto const raycast_result = raycast(
+			heightmap,
+			loc,
+			pixels(x, y),
+			*d,
+			params.pixel_size,
+			[](auto, auto){ return raycast_pred_result::keep_going; }
+		);
+
+		if(raycast_result.has_value())
+		{ return 0.0f; }
+
+		return n_proj;
+	}
+
+	inline float intensity(span_2d<float const> heightmap,
+		horizon_map const& horizons,
+		pixel_coordinates loc,
+		lightmap_params const& params)
+	{
+		auto const d = sun_direction_in_domain(heightmap.extents(), loc, params);
+		if(!d.has_value())
+		{ return 0.0f; }
+
+		auto const x = static_cast<uint32_t>(loc.x);
+		auto const y = static_cast<uint32_t>(loc.y);
+		auto const n = normal(heightmap, x, y, 1.0f/params.pixel_size, clamp_at_boundary{});
+		auto const n_proj = inner_product(n, *d);
+
+		if(n_proj <= 0.0f)
+		{ return 0.0f; }
+
+		// NOTE: d is normalized, so d[2] is the sine of the sun elevation angle
+		if((*d)[2] <= horizons.horizon_sine(x, y, *d))
+		{ return 0.0f; }
+
+		return n_proj;
+	}
+
+	inline void generate_lightmap(
+		scanline_processing_job_info const& jobinfo,
+		span_2d<float> output,
+		span_2d<float const> heightmap,
+		horizon_map const& horizons,
+		lightmap_params const& params
+	)
+	{
+		auto const w = output.width();
+		auto const h = output.height();
+		auto const input_y_offset = jobinfo.input_y_offset;
+
+		for(uint32_t y = 0; y != h; ++y)
+		{
+			for(uint32_t x = 0; x != w; ++x)
+			{
+				output(x, y) = intensity(
+					heightmap,
+					horizons,
+					pixel_coordinates{
+						.x = static_cast<int32_t>(x),
+						.y = static_cast<int32_t>(y + input_y_offset)
+					},
+					params
+				);
+			}
+		}
+	}
+
+	/**
+	 * Generates a lightmap using precomputed horizons. Since the horizons do not depend on the sun
+	 * position, the same horizon_map can be reused for all lightmaps of a time series.
+	 */
+	[[nodiscard]] inline batch_result<void> generate_lightmap(
+		span_2d<float> output,
+		thread_pool<move_only_function<void()>>& workers,
+		span_2d<float const> heightmap,
+		horizon_map const& horizons,
+		lightmap_params const& params
+	)
+	{
+		// NOTE: Use the chunked version, since output may have fewer scanlines than there are workers
+		return process_scanlines(
+			output,
+			workers,
+			std::stop_token{},
+			[]<class ... Args>(Args&&... args){
+				generate_lightmap(std::forward<Args>(args)...);
+			},
+			heightmap,
+			std::cref(horizons),
+			params
+		);
+	}
+
 	inline void generate_lightmap(span_2d<float> output_buffer,
 		span_2d<float const> heightmap,
 		span_2d<float const> upper_boundary,
@@ -127,7 +253,7 @@ namespace terraformer
 		{
 			for(uint32_t l = 0; l != heightmap.width(); ++l)
 			{
-				output_buffer(l, k) = intensity(heightmap, upper_boundary, pixel_coordinates{.x = l, .y = k}, params);
+				output_buffer(l, k) = intensity(heightmap, upper_boundary, pixel_coordinates{.x = static_cast<int32_t>(l), .y = static_cast<int32_t>(k)}, params);
 			}
 		}
 	}
@@ -0,0 +1,105 @@
+//@	{"target":{"name":"generate_lightmap.test"}}
+
+#include "./generate_lightmap.hpp"
+
+#include "testfwk/testfwk.hpp"
+
+#include <algorithm>
+
+namespace
+{
+	terraformer::grayscale_image make_hills(uint32_t width, uint32_t height)
+	{
+		terraformer::grayscale_image ret{width, height};
+		for(uint32_t y = 0; y != height; ++y)
+		{
+			for(uint32_t x = 0; x != width; ++x)
+			{
+				auto const xi = static_cast<float>(x);
+				auto const eta = static_cast<float>(y);
+				ret(x, y) = 6.0f*std::sin(0.41f*xi)*std::cos(0.33f*eta) + 0.25f*xi;
+			}
+		}
+		return ret;
+	}
+
+	// At 09 UTC, 45 degrees north, the sun is low in the sky, so there are shadows
+	terraformer::lightmap_params make_params()
+	{
+		return terraformer::lightmap_params{
+			.planet_loc = terraformer::hires_location{-1024.0*1024.0*1024.0, 0.0, 0.0},
+			.planet_rot = terraformer::hires_rotation{
+				geosimd::rotation_angle{0xe000'0000},
+				geosimd::dimension_tag<2>{}
+			},
+			.planet_radius = 6.371e6,
+			.pixel_size = 1.0f,
+			.center_latitude = geosimd::rotation_angle{0x2000'0000},
+			.domain_rot = terraformer::rotation{geosimd::rotation_angle{0x0}, geosimd::dimension_tag<2>{}}
+		};
+	}
+}
+
+TESTCASE(terraformer_generate_lightmap_horizons_agree_with_raycast)
+{
+	auto const heightmap = make_hills(32, 32);
+	auto const params = make_params();
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const horizons = make_horizon_map(heightmap.pixels(), params.pixel_size, 32, workers);
+
+	terraformer::grayscale_image output{32, 32};
+	generate_lightmap(output.pixels(), workers, heightmap.pixels(), horizons, params).wait();
+
+	// With a flat upper boundary at the highest point, the raycaster is only limited by the
+	// domain boundary
+	terraformer::grayscale_image upper_boundary{32, 32};
+	auto const max_height = *std::ranges::max_element(heightmap.pixels());
+	std::ranges::fill(upper_boundary.pixels(), max_height);
+
+	size_t lit_count = 0;
+	size_t mismatch_count = 0;
+	for(uint32_t y = 0; y != 32; ++y)
+	{
+		for(uint32_t x = 0; x != 32; ++x)
+		{
+			auto const expected = terraformer::intensity(
+				std::as_const(heightmap).pixels(),
+				std::as_const(upper_boundary).pixels(),
+				terraformer::pixel_coordinates{.x = static_cast<int32_t>(x), .y = static_cast<int32_t>(y)},
+				params
+			);
+			lit_count += expected > 0.0f? 1 : 0;
+			mismatch_count += (expected > 0.0f) != (output(x, y) > 0.0f)? 1 : 0;
+		}
+	}
+
+	// The horizon map is interpolated between sectors, so pixels close to the shadow boundary
+	// may differ
+	EXPECT_NE(lit_count, 0);
+	EXPECT_LT(mismatch_count, 32*32/10);
+}
+
+TESTCASE(terraformer_generate_lightmap_fewer_scanlines_than_workers)
+{
+	auto const heightmap = make_hills(64, 4);
+	auto const params = make_params();
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{8};
+	auto const horizons = make_horizon_map(heightmap.pixels(), params.pixel_size, 16, workers);
+
+	terraformer::grayscale_image output{64, 4};
+	generate_lightmap(output.pixels(), workers, heightmap.pixels(), horizons, params).wait();
+
+	for(uint32_t y = 0; y != 4; ++y)
+	{
+		for(uint32_t x = 0; x != 64; ++x)
+		{
+			auto const expected = terraformer::intensity(
+				std::as_const(heightmap).pixels(),
+				horizons,
+				terraformer::pixel_coordinates{.x = static_cast<int32_t>(x), .y = static_cast<int32_t>(y)},
+				params
+			);
+			EXPECT_EQ(output(x, y), expected);
+		}
+	}
+}
@@ -0,0 +1,159 @@
+//@	{"target":{"name":"./horizon_map.o"}}
+
+#include "./horizon_map.hpp"
+
+#include "lib/execution/batch_result.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	struct sweep_geometry
+	{
+		explicit sweep_geometry(terraformer::span_2d_extents size, float azimuth)
+		{
+			auto const dx = std::cos(azimuth);
+			auto const dy = std::sin(azimuth);
+			x_major = std::abs(dx) >= std::abs(dy);
+
+			auto const d_major = x_major? dx : dy;
+			auto const d_minor = x_major? dy : dx;
+			line_length = x_major? size.width : size.height;
+			minor_length = x_major? size.height : size.width;
+			slope = d_minor/d_major;
+			step_length = 1.0f/std::abs(d_major);
+
+			// Traverse the line from the far end, so the hull is complete when a pixel is visited
+			reversed = d_major > 0.0f;
+
+			auto const last_offset = minor_offset(line_length - 1);
+			auto const offset_min = std::min(0, last_offset);
+			auto const offset_max = std::max(0, last_offset);
+			first_line = -offset_max;
+			line_count = minor_length + static_cast<uint32_t>(offset_max - offset_min);
+		}
+
+		int32_t minor_offset(uint32_t k) const
+		{ return static_cast<int32_t>(std::lround(slope*static_cast<float>(k))); }
+
+		terraformer::pixel_coordinates pixel(uint32_t line, uint32_t k) const
+		{
+			auto const major = reversed? line_length - 1 - k : k;
+			auto const minor = first_line + static_cast<int32_t>(line) + minor_offset(major);
+			return x_major?
+				terraformer::pixel_coordinates{static_cast<int32_t>(major), minor}:
+				terraformer::pixel_coordinates{minor, static_cast<int32_t>(major)};
+		}
+
+		bool x_major;
+		bool reversed;
+		float slope;
+		float step_length;
+		uint32_t line_length;
+		uint32_t minor_length;
+		int32_t first_line;
+		uint32_t line_count;
+	};
+
+	struct profile_point
+	{
+		float t;
+		float z;
+	};
+}
+
+uint32_t terraformer::horizon_sweep_line_count(span_2d_extents size, float azimuth)
+{ return sweep_geometry{size, azimuth}.line_count; }
+
+void terraformer::compute_horizon_sines(
+	scanline_processing_job_info const& jobinfo,
+	span_2d_extents lines,
+	span_2d<float> output,
+	span_2d<float const> heightmap,
+	float azimuth,
+	float pixel_size
+)
+{
+	sweep_geometry const geom{heightmap.extents(), azimuth};
+	auto const step_length = pixel_size*geom.step_length;
+	auto const line_offset = jobinfo.input_y_offset;
+
+	std::vector<profile_point> hull;
+	hull.reserve(geom.line_length);
+
+	for(uint32_t line = 0; line != lines.height; ++line)
+	{
+		hull.clear();
+		for(uint32_t k = 0; k != geom.line_length; ++k)
+		{
+			auto const loc = geom.pixel(line + line_offset, k);
+			if(!inside(heightmap, loc.x, loc.y))
+			{ continue; }
+
+			auto const x = static_cast<uint32_t>(loc.x);
+			auto const y = static_cast<uint32_t>(loc.y);
+			profile_point const p{
+				.t = static_cast<float>(k)*step_length,
+				.z = heightmap(x, y)
+			};
+
+			auto const tangent_to = [p](profile_point q) {
+				return (q.z - p.z)/(p.t - q.t);
+			};
+
+			while(std::size(hull) >= 2 && tangent_to(hull[std::size(hull) - 2]) >= tangent_to(hull.back()))
+			{ hull.pop_back(); }
+
+			if(hull.empty())
+			{ output(x, y) = -1.0f; }
+			else
+			{
+				auto const tangent = tangent_to(hull.back());
+				output(x, y) = tangent/std::sqrt(1.0f + tangent*tangent);
+			}
+
+			hull.push_back(p);
+		}
+	}
+}
+
+terraformer::horizon_map terraformer::make_horizon_map(
+	span_2d<float const> heightmap,
+	float pixel_size,
+	size_t sector_count,
+	thread_pool<move_only_function<void()>>& workers
+)
+{
+	horizon_map ret{heightmap.extents(), sector_count};
+
+	std::vector<batch_result<void>> pending_sectors;
+	pending_sectors.reserve(sector_count);
+	for(size_t k = 0; k != sector_count; ++k)
+	{
+		auto const azimuth = sector_azimuth(k, sector_count);
+		pending_sectors.push_back(
+			process_scanlines(
+				span_2d_extents{
+					.width = 1,
+					.height = horizon_sweep_line_count(heightmap.extents(), azimuth)
+				},
+				workers,
+				// NOTE: Use the chunked version, since there may be fewer sweep lines than workers
+				std::stop_token{},
+				[]<class ... Args>(Args&&... args){
+					compute_horizon_sines(std::forward<Args>(args)...);
+				},
+				ret.sector(k),
+				heightmap,
+				azimuth,
+				pixel_size
+			)
+		);
+	}
+
+	for(auto const& item : pending_sectors)
+	{ item.wait(); }
+
+	return ret;
+}
@@ -0,0 +1,109 @@
+//@	{"dependencies_extra":[{"ref":"./horizon_map.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_GEOMODELS_HORIZON_MAP_HPP
+#define TERRAFORMER_GEOMODELS_HORIZON_MAP_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/common/spaces.hpp"
+#include "lib/common/span_2d.hpp"
+#include "lib/execution/thread_pool.hpp"
+#include "lib/pixel_store/image.hpp"
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace terraformer
+{
+	/**
+	 * Holds the sine of the horizon elevation angle for every pixel, sampled in a fixed number
+	 * of azimuth sectors. Sector k looks in the direction 2 pi k/sector_count, measured from the
+	 * x axis towards the y axis. An unobstructed horizon is stored as -1.
+	 */
+	class horizon_map
+	{
+	public:
+		horizon_map() = default;
+
+		explicit horizon_map(span_2d_extents size, size_t sector_count)
+		{
+			m_sectors.reserve(sector_count);
+			for(size_t k = 0; k != sector_count; ++k)
+			{ m_sectors.push_back(grayscale_image{size}); }
+		}
+
+		size_t sector_count() const
+		{ return std::size(m_sectors); }
+
+		span_2d_extents extents() const
+		{
+			return m_sectors.empty()?
+				span_2d_extents{0, 0} :
+				m_sectors.front().pixels().extents();
+		}
+
+		span_2d<float> sector(size_t k)
+		{ return m_sectors[k].pixels(); }
+
+		span_2d<float const> sector(size_t k) const
+		{ return m_sectors[k].pixels(); }
+
+		/**
+		 * Returns the sine of the horizon elevation angle at (x, y), when looking in direction dir.
+		 * Only the xy components of dir are used. Values are linearly interpolated between the two
+		 * closest sectors.
+		 */
+		float horizon_sine(uint32_t x, uint32_t y, direction dir) const
+		{
+			auto const n = static_cast<float>(sector_count());
+			auto const azimuth = std::atan2(dir[1], dir[0]);
+			auto const u_raw = n*azimuth/(2.0f*std::numbers::pi_v<float>);
+			auto const u = u_raw < 0.0f? u_raw + n : u_raw;
+			auto const u_0 = std::floor(u);
+			auto const t = u - u_0;
+			auto const k_0 = static_cast<size_t>(u_0)%sector_count();
+			auto const k_1 = (k_0 + 1)%sector_count();
+			return (1.0f - t)*m_sectors[k_0](x, y) + t*m_sectors[k_1](x, y);
+		}
+
+	private:
+		std::vector<grayscale_image> m_sectors;
+	};
+
+	inline float sector_azimuth(size_t k, size_t sector_count)
+	{
+		return 2.0f*std::numbers::pi_v<float>*static_cast<float>(k)/static_cast<float>(sector_count);
+	}
+
+	/**
+	 * Returns the number of sweep lines used when computing horizons for the given azimuth
+	 */
+	uint32_t horizon_sweep_line_count(span_2d_extents size, float azimuth);
+
+	/**
+	 * Computes the horizon for the sweep lines [jobinfo.input_y_offset,
+	 * jobinfo.input_y_offset + lines.height) in the direction given by azimuth. Every pixel
+	 * belongs to exactly one sweep line, so different line ranges can be processed concurrently.
+	 *
+	 * Each line is traversed from its far end, while the upper convex hull of the visited profile
+	 * is maintained. The horizon of a pixel is then the tangent from the pixel to the hull, which
+	 * makes the cost linear in the number of pixels.
+	 */
+	void compute_horizon_sines(
+		scanline_processing_job_info const& jobinfo,
+		span_2d_extents lines,
+		span_2d<float> output,
+		span_2d<float const> heightmap,
+		float azimuth,
+		float pixel_size
+	);
+
+	horizon_map make_horizon_map(
+		span_2d<float const> heightmap,
+		float pixel_size,
+		size_t sector_count,
+		thread_pool<move_only_function<void()>>& workers
+	);
+}
+
+#endif
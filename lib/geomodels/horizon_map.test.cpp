@@ -0,0 +1,201 @@
+//@	{"target":{"name":"horizon_map.test"}}
+
+#include "./horizon_map.hpp"
+
+#include "lib/filters/raycaster.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+namespace
+{
+	terraformer::grayscale_image make_wall(uint32_t size, uint32_t wall_at, float wall_height)
+	{
+		terraformer::grayscale_image ret{size, size};
+		for(uint32_t y = 0; y != size; ++y)
+		{
+			for(uint32_t x = 0; x != size; ++x)
+			{ ret(x, y) = x == wall_at? wall_height : 0.0f; }
+		}
+		return ret;
+	}
+
+	terraformer::grayscale_image make_hills(uint32_t width, uint32_t height)
+	{
+		terraformer::grayscale_image ret{width, height};
+		for(uint32_t y = 0; y != height; ++y)
+		{
+			for(uint32_t x = 0; x != width; ++x)
+			{
+				auto const xi = static_cast<float>(x);
+				auto const eta = static_cast<float>(y);
+				ret(x, y) = 6.0f*std::sin(0.41f*xi)*std::cos(0.33f*eta) + 0.25f*xi;
+			}
+		}
+		return ret;
+	}
+
+	void compute_all_lines(
+		terraformer::span_2d<float> output,
+		terraformer::span_2d<float const> heightmap,
+		float azimuth,
+		float pixel_size
+	)
+	{
+		auto const line_count = terraformer::horizon_sweep_line_count(heightmap.extents(), azimuth);
+		compute_horizon_sines(
+			terraformer::scanline_processing_job_info{
+				.input_y_offset = 0,
+				.total_height = line_count
+			},
+			terraformer::span_2d_extents{
+				.width = 1,
+				.height = line_count
+			},
+			output,
+			heightmap,
+			azimuth,
+			pixel_size
+		);
+	}
+}
+
+TESTCASE(terraformer_horizon_map_sweep_line_count)
+{
+	terraformer::span_2d_extents const size{.width = 16, .height = 8};
+	EXPECT_EQ(terraformer::horizon_sweep_line_count(size, 0.0f), 8);
+	EXPECT_EQ(terraformer::horizon_sweep_line_count(size, 0.5f*std::numbers::pi_v<float>), 16);
+	EXPECT_EQ(terraformer::horizon_sweep_line_count(size, 0.25f*std::numbers::pi_v<float>), 23);
+}
+
+TESTCASE(terraformer_horizon_map_compute_horizon_sines_wall_ahead)
+{
+	auto const heightmap = make_wall(16, 12, 4.0f);
+	terraformer::grayscale_image output{16, 16};
+	compute_all_lines(output.pixels(), heightmap.pixels(), 0.0f, 1.0f);
+
+	for(uint32_t y = 0; y != 16; ++y)
+	{
+		EXPECT_EQ(output(8, y), 1.0f/std::sqrt(2.0f));
+		EXPECT_EQ(output(11, y), 4.0f/std::sqrt(17.0f));
+		EXPECT_LT(std::abs(output(12, y) + 0.8f), 1.0e-6f);
+		EXPECT_EQ(output(14, y), 0.0f);
+		EXPECT_EQ(output(15, y), -1.0f);
+	}
+}
+
+TESTCASE(terraformer_horizon_map_compute_horizon_sines_wall_behind)
+{
+	auto const heightmap = make_wall(16, 12, 4.0f);
+	terraformer::grayscale_image output{16, 16};
+	compute_all_lines(output.pixels(), heightmap.pixels(), std::numbers::pi_v<float>, 2.0f);
+
+	for(uint32_t y = 0; y != 16; ++y)
+	{
+		EXPECT_EQ(output(0, y), -1.0f);
+		EXPECT_EQ(output(8, y), 0.0f);
+		EXPECT_EQ(output(13, y), 2.0f/std::sqrt(5.0f));
+		EXPECT_EQ(output(14, y), 1.0f/std::sqrt(2.0f));
+	}
+}
+
+TESTCASE(terraformer_horizon_map_horizon_sine_interpolates_between_sectors)
+{
+	terraformer::horizon_map horizons{terraformer::span_2d_extents{.width = 1, .height = 1}, 4};
+	horizons.sector(0)(0, 0) = 0.0f;
+	horizons.sector(1)(0, 0) = 0.5f;
+	horizons.sector(2)(0, 0) = -0.5f;
+	horizons.sector(3)(0, 0) = -1.0f;
+
+	EXPECT_EQ(horizons.horizon_sine(0, 0, terraformer::direction{terraformer::displacement{1.0f, 0.0f, 0.0f}}), 0.0f);
+	EXPECT_EQ(horizons.horizon_sine(0, 0, terraformer::direction{terraformer::displacement{0.0f, 1.0f, 0.0f}}), 0.5f);
+	EXPECT_EQ(horizons.horizon_sine(0, 0, terraformer::direction{terraformer::displacement{-1.0f, 0.0f, 0.0f}}), -0.5f);
+	EXPECT_LT(
+		std::abs(
+			horizons.horizon_sine(0, 0, terraformer::direction{terraformer::displacement{1.0f, -1.0f, 0.0f}})
+			+ 0.5f
+		),
+		1.0e-6f
+	);
+}
+
+TESTCASE(terraformer_horizon_map_make_horizon_map_same_as_compute_horizon_sines)
+{
+	// Fewer scanlines than workers
+	auto const heightmap = make_hills(16, 4);
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{8};
+	auto const horizons = make_horizon_map(heightmap.pixels(), 2.0f, 8, workers);
+	REQUIRE_EQ(horizons.sector_count(), 8);
+
+	for(size_t k = 0; k != horizons.sector_count(); ++k)
+	{
+		terraformer::grayscale_image expected{16, 4};
+		compute_all_lines(
+			expected.pixels(),
+			heightmap.pixels(),
+			terraformer::sector_azimuth(k, horizons.sector_count()),
+			2.0f
+		);
+
+		for(uint32_t y = 0; y != 4; ++y)
+		{
+			for(uint32_t x = 0; x != 16; ++x)
+			{ EXPECT_EQ(horizons.sector(k)(x, y), expected(x, y)); }
+		}
+	}
+}
+
+TESTCASE(terraformer_horizon_map_make_horizon_map_agrees_with_raycast)
+{
+	auto const heightmap = make_hills(32, 32);
+	auto const pixel_size = 1.0f;
+	terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+	auto const horizons = make_horizon_map(heightmap.pixels(), pixel_size, 8, workers);
+
+	size_t shadow_count = 0;
+	size_t mismatch_count = 0;
+	size_t total_count = 0;
+	for(size_t k = 0; k != horizons.sector_count(); ++k)
+	{
+		for(auto const elevation : {0.2f, 0.5f})
+		{
+			// Use directions along the sectors, so that no interpolation is needed
+			auto const azimuth = terraformer::sector_azimuth(k, horizons.sector_count());
+			terraformer::direction const dir{
+				terraformer::displacement{
+					std::cos(azimuth)*std::cos(elevation),
+					std::sin(azimuth)*std::cos(elevation),
+					std::sin(elevation)
+				}
+			};
+
+			for(uint32_t y = 0; y != heightmap.height(); ++y)
+			{
+				for(uint32_t x = 0; x != heightmap.width(); ++x)
+				{
+					auto const in_shadow = dir[2] <= horizons.horizon_sine(x, y, dir);
+					auto const hit = raycast(
+						std::as_const(heightmap).pixels(),
+						terraformer::pixel_coordinates{static_cast<int32_t>(x), static_cast<int32_t>(y)},
+						heightmap(x, y),
+						dir,
+						pixel_size,
+						[pixels = std::as_const(heightmap).pixels()](auto, auto loc){
+							return inside(pixels, loc[0], loc[1])?
+								terraformer::raycast_pred_result::keep_going:
+								terraformer::raycast_pred_result::stop;
+						}
+					).has_value();
+
+					shadow_count += in_shadow? 1 : 0;
+					mismatch_count += in_shadow != hit? 1 : 0;
+					++total_count;
+				}
+			}
+		}
+	}
+
+	// The raycaster interpolates between pixels, while horizons are computed from pixel centers,
+	// so they may disagree close to the shadow boundary
+	EXPECT_NE(shadow_count, 0);
+	EXPECT_LT(mismatch_count, total_count/20);
+}
@@ -0,0 +1,201 @@
+#ifndef TERRAFORMER_GEOMODELS_INSOLATION_HPP
+#define TERRAFORMER_GEOMODELS_INSOLATION_HPP
+
+#include "./generate_lightmap.hpp"
+#include "./horizon_map.hpp"
+
+#include "lib/common/span_2d.hpp"
+#include "lib/pixel_store/image.hpp"
+
+#include <span>
+#include <vector>
+
+namespace terraformer
+{
+	struct insolation_sampling_descriptor
+	{
+		year start;
+		year duration;
+		size_t sample_count;
+	};
+
+	struct insolation_maps
+	{
+		/**
+		 * Time integral of the lightmap intensity, in intensity times planetary days
+		 */
+		grayscale_image insolation;
+
+		/**
+		 * Time during which the pixel is lit, assuming that one planetary day is 24 hours
+		 */
+		grayscale_image sun_hours;
+	};
+
+	struct insolation_sample
+	{
+		lightmap_params params;
+		float weight;
+	};
+
+	/**
+	 * Creates the samples needed to integrate over the time interval given by sampling. The
+	 * midpoint rule is used, so each sample covers duration/sample_count years. The weight of a
+	 * sample is its duration in planetary days.
+	 */
+	inline auto make_insolation_samples(
+		insolation_sampling_descriptor const& sampling,
+		planet_descriptor const& planetary_data,
+		float pixel_size,
+		geosimd::rotation_angle center_latitude,
+		geosimd::rotation_angle domain_orientation
+	)
+	{
+		std::vector<insolation_sample> ret;
+		ret.reserve(sampling.sample_count);
+		auto const n = static_cast<double>(sampling.sample_count);
+		year const dt{sampling.duration.value()/n};
+		auto const weight = static_cast<float>(dt.value()*planetary_data.spin_frequency);
+		for(size_t k = 0; k != sampling.sample_count; ++k)
+		{
+			auto const t = sampling.start + (static_cast<double>(k) + 0.5)*dt;
+			ret.push_back(
+				insolation_sample{
+					.params = make_lightmap_params(
+						t,
+						planetary_data,
+						pixel_size,
+						center_latitude,
+						domain_orientation
+					),
+					.weight = weight
+				}
+			);
+		}
+		return ret;
+	}
+
+	inline void accumulate_insolation(
+		scanline_processing_job_info const& jobinfo,
+		span_2d<float> insolation,
+		span_2d<float> sun_hours,
+		span_2d<float const> heightmap,
+		horizon_map const& horizons,
+		std::span<insolation_sample const> samples
+	)
+	{
+		auto const w = insolation.width();
+		auto const h = insolation.height();
+		auto const input_y_offset = jobinfo.input_y_offset;
+
+		for(uint32_t y = 0; y != h; ++y)
+		{
+			for(uint32_t x = 0; x != w; ++x)
+			{
+				pixel_coordinates const loc{
+					.x = static_cast<int32_t>(x),
+					.y = static_cast<int32_t>(y + input_y_offset)
+				};
+
+				auto energy = 0.0f;
+				auto lit_days = 0.0f;
+				for(auto const& sample : samples)
+				{
+					auto const val = intensity(heightmap, horizons, loc, sample.params);
+					energy += sample.weight*val;
+					lit_days += val > 0.0f? sample.weight : 0.0f;
+				}
+
+				insolation(x, y) += energy;
+				sun_hours(x, y + input_y_offset) += 24.0f*lit_days;
+			}
+		}
+	}
+
+	/**
+	 * Accumulates insolation and sun hours over samples. The result
+	 * is added to output, so a longer interval can be integrated piecewise.
+	 */
+	[[nodiscard]] inline batch_result<void> accumulate_insolation(
+		insolation_maps& output,
+		thread_pool<move_only_function<void()>>& workers,
+		span_2d<float const> heightmap,
+		horizon_map const& horizons,
+		std::span<insolation_sample const> samples
+	)
+	{
+		// NOTE: Use the chunked version, since heightmap may have fewer scanlines than there are workers
+		return process_scanlines(
+			output.insolation.pixels(),
+			workers,
+			std::stop_token{},
+			[]<class ... Args>(Args&&... args){
+				accumulate_insolation(std::forward<Args>(args)...);
+			},
+			output.sun_hours.pixels(),
+			heightmap,
+			std::cref(horizons),
+			samples
+		);
+	}
+
+	inline insolation_maps compute_insolation(
+		thread_pool<move_only_function<void()>>& workers,
+		span_2d<float const> heightmap,
+		horizon_map const& horizons,
+		insolation_sampling_descriptor const& sampling,
+		planet_descriptor const& planetary_data,
+		float pixel_size,
+		geosimd::rotation_angle center_latitude,
+		geosimd::rotation_angle domain_orientation
+	)
+	{
+		insolation_maps ret{
+			.insolation = grayscale_image{heightmap.extents()},
+			.sun_hours = grayscale_image{heightmap.extents()}
+		};
+
+		auto const samples = make_insolation_samples(
+			sampling,
+			planetary_data,
+			pixel_size,
+			center_latitude,
+			domain_orientation
+		);
+
+		accumulate_insolation(
+			ret,
+			workers,
+			heightmap,
+			horizons,
+			std::span{std::as_const(samples)}
+		).wait();
+
+		return ret;
+	}
+
+	inline insolation_maps compute_insolation(
+		thread_pool<move_only_function<void()>>& workers,
+		span_2d<float const> heightmap,
+		size_t horizon_sector_count,
+		insolation_sampling_descriptor const& sampling,
+		planet_descriptor const& planetary_data,
+		float pixel_size,
+		geosimd::rotation_angle center_latitude,
+		geosimd::rotation_angle domain_orientation
+	)
+	{
+		return compute_insolation(
+			workers,
+			heightmap,
+			make_horizon_map(heightmap, pixel_size, horizon_sector_count, workers),
+			sampling,
+			planetary_data,
+			pixel_size,
+			center_latitude,
+			domain_orientation
+		);
+	}
+}
+
+#endif
@@ -0,0 +1,115 @@
+//@	{"target":{"name":"insolation.test"}}
+
+#include "./insolation.hpp"
+
+#include "testfwk/testfwk.hpp"
+
+#include <array>
+#include <cmath>
+
+namespace
+{
+	terraformer::lightmap_params make_params(
+		terraformer::hires_rotation const& planet_rot,
+		geosimd::rotation_angle colatitude
+	)
+	{
+		return terraformer::lightmap_params{
+			.planet_loc = terraformer::hires_location{-1024.0*1024.0*1024.0, 0.0, 0.0},
+			.planet_rot = planet_rot,
+			.planet_radius = 6.371e6,
+			.pixel_size = 1.0f,
+			.center_latitude = colatitude,
+			.domain_rot = terraformer::rotation{geosimd::rotation_angle{0x0}, geosimd::dimension_tag<2>{}}
+		};
+	}
+
+	// One planetary day, with the given tilt of the planet axis
+	std::vector<terraformer::insolation_sample> make_daily_samples(
+		geosimd::turn_angle tilt,
+		geosimd::rotation_angle colatitude,
+		size_t sample_count
+	)
+	{
+		std::vector<terraformer::insolation_sample> ret;
+		auto const n = static_cast<double>(sample_count);
+		for(size_t k = 0; k != sample_count; ++k)
+		{
+			geosimd::turn_angle const spin{geosimd::turns{(static_cast<double>(k) + 0.5)/n}};
+			ret.push_back(
+				terraformer::insolation_sample{
+					.params = make_params(terraformer::planet_rotation(spin, tilt), colatitude),
+					.weight = static_cast<float>(1.0/n)
+				}
+			);
+		}
+		return ret;
+	}
+
+	terraformer::insolation_maps compute_insolation_maps(
+		terraformer::grayscale_image const& heightmap,
+		std::span<terraformer::insolation_sample const> samples
+	)
+	{
+		terraformer::thread_pool<terraformer::move_only_function<void()>> workers{4};
+		auto const horizons = make_horizon_map(heightmap.pixels(), 1.0f, 8, workers);
+		terraformer::insolation_maps ret{
+			.insolation = terraformer::grayscale_image{heightmap.pixels().extents()},
+			.sun_hours = terraformer::grayscale_image{heightmap.pixels().extents()}
+		};
+		accumulate_insolation(ret, workers, heightmap.pixels(), horizons, samples).wait();
+		return ret;
+	}
+}
+
+TESTCASE(terraformer_insolation_flat_plane_at_equator_at_noon)
+{
+	terraformer::grayscale_image const heightmap{8, 8};
+
+	// At 12 UTC, without any tilt, the sun is in zenith at the equator
+	std::array const samples{
+		terraformer::insolation_sample{
+			.params = make_params(
+				terraformer::hires_rotation{geosimd::rotation_angle{0x0}, geosimd::dimension_tag<2>{}},
+				geosimd::rotation_angle{0x4000'0000}
+			),
+			.weight = 0.25f
+		}
+	};
+
+	auto const result = compute_insolation_maps(heightmap, samples);
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{
+			EXPECT_LT(std::abs(result.insolation(x, y) - 0.25f), 1.0e-4f);
+			EXPECT_EQ(result.sun_hours(x, y), 6.0f);
+		}
+	}
+}
+
+TESTCASE(terraformer_insolation_polar_night)
+{
+	terraformer::grayscale_image const heightmap{8, 8};
+	geosimd::turn_angle const tilt{geosimd::turns{1.0/16.0}};
+
+	// Close to the poles, the sun stays on one side of the horizon all day. Which pole has polar
+	// night depends on the sign of the tilt.
+	auto const north_samples = make_daily_samples(tilt, geosimd::rotation_angle{0x0100'0000}, 24);
+	auto const north = compute_insolation_maps(heightmap, north_samples);
+	auto const south_samples = make_daily_samples(tilt, geosimd::rotation_angle{0x7f00'0000}, 24);
+	auto const south = compute_insolation_maps(heightmap, south_samples);
+
+	auto const& night = north.insolation(4, 4) == 0.0f? north : south;
+	auto const& day = north.insolation(4, 4) == 0.0f? south : north;
+	for(uint32_t y = 0; y != heightmap.height(); ++y)
+	{
+		for(uint32_t x = 0; x != heightmap.width(); ++x)
+		{
+			EXPECT_EQ(night.insolation(x, y), 0.0f);
+			EXPECT_EQ(night.sun_hours(x, y), 0.0f);
+			EXPECT_GT(day.insolation(x, y), 0.0f);
+			EXPECT_LT(std::abs(day.sun_hours(x, y) - 24.0f), 1.0e-4f);
+		}
+	}
+}
@@ -30,7 +30,8 @@ namespace terraformer
 		span_2d<float const> input,
 		span_2d<float> filtered_output,
 		computation_context& comp_ctxt,
-		butter_lp_2d_descriptor const& params
+		butter_lp_2d_descriptor const& params,
+		std::stop_token const& stop_token = std::stop_token{}
 	)
 	{
 		auto const w = input.width();
@@ -47,20 +48,21 @@ namespace terraformer
 		).wait();
 
 		return apply_filter(
-			input, filtered_output, comp_ctxt, std::as_const(filter_mask).pixels()
+			input, filtered_output, comp_ctxt, std::as_const(filter_mask).pixels(), stop_token
 		);
 	}
 
 	inline grayscale_image apply(
 		butter_lp_2d_descriptor const& filter,
 		span_2d<float const> input,
-		computation_context& comp_ctxt
+		computation_context& comp_ctxt,
+		std::stop_token const& stop_token = std::stop_token{}
 	)
 	{
 		auto const w = input.width();
 		auto const h = input.height();
 		grayscale_image filtered_output{w, h};
-		apply(input, filtered_output.pixels(), comp_ctxt, filter).wait();
+		apply(input, filtered_output.pixels(), comp_ctxt, filter, stop_token).wait();
 		return filtered_output;
 	}
 
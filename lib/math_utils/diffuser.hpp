@@ -1,6 +1,7 @@
 #ifndef TERRAFORMER_FILTERS_DIFFUSER_HPP
 #define TERRAFORMER_FILTERS_DIFFUSER_HPP
 
+#include "lib/execution/cancellation.hpp"
 #include "lib/execution/signaling_counter.hpp"
 #include "lib/execution/notifying_task.hpp"
 #include "lib/pixel_store/image.hpp"
@@ -9,6 +10,7 @@
 #include <type_traits>
 #include <concepts>
 #include <cassert>
+#include <stop_token>
 
 namespace terraformer
 {
@@ -208,6 +210,7 @@ namespace terraformer
 		DiffusionStepExecutorFactory step_executor_factory;
 		Boundary boundary;
 		Src source;
+		std::stop_token stop_token{};
 	};
 
 	template<class DiffusionStepExecutorFactory,
@@ -231,6 +234,7 @@ namespace terraformer
 		size_t k = 0;
 		while(true)
 		{
+			throw_if_stop_requested(params.stop_token);
 			auto const delta = diffuser();
 
 			if(delta < tolerance)
@@ -254,6 +258,7 @@ namespace terraformer
 		float tolerance;
 		DiffusionStepExecutorFactory step_executor_factory;
 		Boundary boundary;
+		std::stop_token stop_token{};
 	};
 
 	template<class DiffusionStepExecutorFactory,
@@ -266,7 +271,8 @@ namespace terraformer
 			.tolerance = params.tolerance,
 			.step_executor_factory = std::forward<DiffusionStepExecutorFactory>(params.step_executor_factory),
 			.boundary = std::forward<Boundary>(params.boundary),
-			.source = [](auto&&...){return 0.0f;}
+			.source = [](auto&&...){return 0.0f;},
+			.stop_token = params.stop_token
 		});
 	}
 }
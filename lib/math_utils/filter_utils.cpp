@@ -3,6 +3,7 @@
 #include "./filter_utils.hpp"
 #include "lib/common/span_2d.hpp"
 #include "lib/common/utils.hpp"
+#include "lib/execution/cancellation.hpp"
 #include "lib/execution/signaling_counter.hpp"
 #include "lib/common/chunk_by_chunk_count_view.hpp"
 #include "lib/pixel_store/image.hpp"
@@ -58,7 +59,8 @@ terraformer::filter_2d_job terraformer::apply_filter(
 	span_2d<float const> input,
 	span_2d<float> filtered_output,
 	computation_context& comp_ctxt,
-	span_2d<float const> filter_mask
+	span_2d<float const> filter_mask,
+	std::stop_token const& stop_token
 )
 {
 	auto const w = input.width();
@@ -68,11 +70,13 @@ terraformer::filter_2d_job terraformer::apply_filter(
 	process_scanlines(
 		filter_input.pixels(),
 		comp_ctxt.workers,
+		stop_token,
 		[]<class ... Args>(Args&&... args){
 			make_filter_input(std::forward<Args>(args)...);
 		},
 		input
 	).wait();
+	throw_if_stop_requested(stop_token);
 
 	terraformer::basic_image<std::complex<float>> transformed_input{w, h};
 	comp_ctxt.dft_engine.transform(
@@ -80,21 +84,25 @@ terraformer::filter_2d_job terraformer::apply_filter(
 		transformed_input.pixels(),
 		dft_direction::forward
 	).wait();
+	throw_if_stop_requested(stop_token);
 
 	process_scanlines(
 		transformed_input.pixels(),
 		comp_ctxt.workers,
+		stop_token,
 		[]<class ... Args>(Args&&... args){
 			multiply_assign(std::forward<Args>(args)...);
 		},
 		filter_mask
 	).wait();
+	throw_if_stop_requested(stop_token);
 
 	comp_ctxt.dft_engine.transform(
 		std::as_const(transformed_input).pixels(),
 		filter_input.pixels(),
 		dft_direction::backward
 	).wait();
+	throw_if_stop_requested(stop_token);
 
 	auto fip = std::as_const(filter_input).pixels();
 	return filter_2d_job{
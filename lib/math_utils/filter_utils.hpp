@@ -8,6 +8,7 @@
 #include "lib/execution/batch_result.hpp"
 #include "lib/math_utils/computation_context.hpp"
 #include <complex>
+#include <stop_token>
 
 namespace terraformer
 {
@@ -37,11 +38,16 @@ namespace terraformer
 		unique_handle m_temp_buffer;
 	};
 
+	/**
+	 * Filters input in the frequency domain. If a stop is requested through stop_token, the
+	 * filter is abandoned between stages by throwing operation_cancelled.
+	 */
 	filter_2d_job apply_filter(
 		span_2d<float const> input,
 		span_2d<float> filtered_output,
 		computation_context& comp_ctxt,
-		span_2d<float const> filter_mask
+		span_2d<float const> filter_mask,
+		std::stop_token const& stop_token = std::stop_token{}
 	);
 }
 
@@ -26,6 +26,7 @@ namespace terraformer
 		return process_scanlines(
 			output,
 			workers,
+			std::stop_token{},
 			[]<class... Args>(Args&&...args){
 				compute_normalized_gradient(std::forward<Args>(args)...);
 			},
@@ -0,0 +1,198 @@
+//@	{"target":{"name":"./persistent_image_cache.o"}}
+
+#include "./persistent_image_cache.hpp"
+
+#include "lib/common/cfile_owner.hpp"
+#include "lib/common/fnv1a_hash.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+namespace
+{
+	constexpr std::array<char, 8> file_magic{'t', 'f', 'i', 'm', 'g', 'f', '3', '2'};
+	constexpr uint32_t file_format_version = 1;
+
+	struct file_header
+	{
+		std::array<char, 8> magic;
+		uint32_t format_version;
+		uint32_t width;
+		uint32_t height;
+		std::array<std::byte, 44> reserved;
+	};
+	static_assert(sizeof(file_header) == 64);
+
+	// NOTE: Headers and pixels are read and written in native byte order. Since all supported
+	//       platforms are little-endian, this matches the documented file format.
+	static_assert(std::endian::native == std::endian::little);
+
+	struct entry_info
+	{
+		std::filesystem::path path;
+		std::filesystem::file_time_type last_use;
+		uintmax_t size;
+	};
+}
+
+terraformer::persistent_image_cache::persistent_image_cache(
+	std::filesystem::path directory,
+	size_t size_budget
+):
+	m_directory{std::move(directory)},
+	m_size_budget{size_budget},
+	m_enabled{true}
+{
+	std::error_code ec;
+	create_directories(m_directory, ec);
+	m_enabled = !ec;
+}
+
+std::filesystem::path terraformer::persistent_image_cache::get_entry_path(key_type const& key) const
+{ return m_directory / (to_hex_string(key) + ".tfimg"); }
+
+std::optional<terraformer::grayscale_image>
+terraformer::persistent_image_cache::load(key_type const& key)
+{
+	if(!m_enabled)
+	{ return std::nullopt; }
+
+	std::lock_guard lock{m_mutex};
+	auto const path = get_entry_path(key);
+	std::unique_ptr<FILE, cfile_deleter> src{fopen(path.c_str(), "rb")};
+	if(src == nullptr)
+	{ return std::nullopt; }
+
+	file_header header{};
+	if(fread(&header, sizeof(header), 1, src.get()) != 1
+		|| header.magic != file_magic
+		|| header.format_version != file_format_version)
+	{ return std::nullopt; }
+
+	// Reject truncated entries before allocating the image
+	auto const pixel_count = static_cast<size_t>(header.width)*static_cast<size_t>(header.height);
+	std::error_code ec;
+	if(file_size(path, ec) != sizeof(header) + pixel_count*sizeof(float) || ec)
+	{ return std::nullopt; }
+
+	grayscale_image ret{header.width, header.height};
+	if(fread(ret.pixels().data(), sizeof(float), pixel_count, src.get()) != pixel_count)
+	{ return std::nullopt; }
+
+	// Mark the entry as recently used
+	last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+	return ret;
+}
+
+void terraformer::persistent_image_cache::store(key_type const& key, span_2d<float const> pixels)
+{
+	if(!m_enabled)
+	{ return; }
+
+	std::lock_guard lock{m_mutex};
+	auto const path = get_entry_path(key);
+
+	// Write to a temporary file first, so other processes never see a partially written entry.
+	// The name of the temporary file is unique, so processes storing the same entry do not write
+	// to the same file.
+	std::string tmp_path{path.native()};
+	tmp_path.append(".XXXXXX");
+	{
+		auto const fd = mkstemp(std::data(tmp_path));
+		if(fd == -1)
+		{ return; }
+
+		std::unique_ptr<FILE, cfile_deleter> dest{fdopen(fd, "wb")};
+		if(dest == nullptr)
+		{
+			close(fd);
+			std::error_code ec;
+			remove(std::filesystem::path{tmp_path}, ec);
+			return;
+		}
+
+		file_header header{};
+		header.magic = file_magic;
+		header.format_version = file_format_version;
+		header.width = pixels.width();
+		header.height = pixels.height();
+
+		auto const pixel_count = static_cast<size_t>(pixels.width())*static_cast<size_t>(pixels.height());
+		if(fwrite(&header, sizeof(header), 1, dest.get()) != 1
+			|| fwrite(pixels.data(), sizeof(float), pixel_count, dest.get()) != pixel_count
+			|| fflush(dest.get()) != 0)
+		{
+			dest.reset();
+			std::error_code ec;
+			remove(std::filesystem::path{tmp_path}, ec);
+			return;
+		}
+	}
+
+	std::error_code ec;
+	rename(std::filesystem::path{tmp_path}, path, ec);
+	if(ec)
+	{
+		remove(std::filesystem::path{tmp_path}, ec);
+		return;
+	}
+
+	evict_entries();
+}
+
+void terraformer::persistent_image_cache::evict_entries()
+{
+	std::vector<entry_info> entries;
+	uintmax_t total_size = 0;
+	std::error_code ec;
+	for(auto const& item : std::filesystem::directory_iterator{m_directory, ec})
+	{
+		if(item.path().extension() != ".tfimg")
+		{ continue; }
+
+		auto const size = item.file_size(ec);
+		if(ec)
+		{ continue; }
+
+		auto const last_use = item.last_write_time(ec);
+		if(ec)
+		{ continue; }
+
+		entries.push_back(entry_info{item.path(), last_use, size});
+		total_size += size;
+	}
+
+	if(total_size <= m_size_budget)
+	{ return; }
+
+	std::ranges::sort(entries, [](auto const& a, auto const& b){
+		return a.last_use < b.last_use;
+	});
+
+	for(auto const& item : entries)
+	{
+		if(total_size <= m_size_budget)
+		{ return; }
+
+		if(remove(item.path, ec))
+		{ total_size -= item.size; }
+	}
+}
+
+std::filesystem::path terraformer::get_default_image_cache_directory()
+{
+	if(auto const xdg_cache_home = getenv("XDG_CACHE_HOME"); xdg_cache_home != nullptr && *xdg_cache_home != '\0')
+	{ return std::filesystem::path{xdg_cache_home} / "terraformer"; }
+
+	if(auto const home = getenv("HOME"); home != nullptr)
+	{ return std::filesystem::path{home} / ".cache" / "terraformer"; }
+
+	return std::filesystem::temp_directory_path() / "terraformer_cache";
+}
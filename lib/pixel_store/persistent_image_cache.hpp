@@ -0,0 +1,76 @@
+//@	{"dependencies_extra":[{"ref":"./persistent_image_cache.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_PERSISTENT_IMAGE_CACHE_HPP
+#define TERRAFORMER_PERSISTENT_IMAGE_CACHE_HPP
+
+#include "./image.hpp"
+
+#include "lib/common/span_2d.hpp"
+
+#include <array>
+#include <cstddef>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+
+namespace terraformer
+{
+	/**
+	 * A content-addressed cache of grayscale images, stored as one file per key in a directory.
+	 * Entries are kept between sessions, and can be shared between processes.
+	 *
+	 * Each file consists of a 64 byte header, followed by the pixels as raw little-endian floats,
+	 * so the pixel data can be memory mapped directly.
+	 *
+	 * When the total size of all entries exceeds the size budget, the least recently used entries
+	 * are removed. The last write time of a file is used as its last use time.
+	 *
+	 * If the directory cannot be created, the cache is disabled, so load always misses and store
+	 * does nothing.
+	 */
+	class persistent_image_cache
+	{
+	public:
+		using key_type = std::array<std::byte, 16>;
+
+		explicit persistent_image_cache(std::filesystem::path directory, size_t size_budget);
+
+		/**
+		 * Returns the image stored under key, or std::nullopt if there is no valid entry
+		 */
+		std::optional<grayscale_image> load(key_type const& key);
+
+		/**
+		 * Stores pixels under key, and evicts entries until the cache fits within its budget.
+		 * Failing to write the entry is not an error, since the cache is only an optimization.
+		 */
+		void store(key_type const& key, span_2d<float const> pixels);
+
+		size_t size_budget() const
+		{ return m_size_budget; }
+
+		std::filesystem::path const& directory() const
+		{ return m_directory; }
+
+		bool is_enabled() const
+		{ return m_enabled; }
+
+		std::filesystem::path get_entry_path(key_type const& key) const;
+
+	private:
+		void evict_entries();
+
+		std::filesystem::path m_directory;
+		size_t m_size_budget;
+		bool m_enabled;
+		std::mutex m_mutex;
+	};
+
+	/**
+	 * Returns the default cache directory, which is $XDG_CACHE_HOME/terraformer, or
+	 * $HOME/.cache/terraformer if XDG_CACHE_HOME is not set
+	 */
+	std::filesystem::path get_default_image_cache_directory();
+}
+
+#endif
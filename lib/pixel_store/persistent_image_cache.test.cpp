@@ -0,0 +1,138 @@
+//@	{"target":{"name":"persistent_image_cache.test"}}
+
+#include "./persistent_image_cache.hpp"
+
+#include "lib/common/cfile_owner.hpp"
+#include "lib/common/tempdir.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <chrono>
+
+namespace
+{
+	terraformer::persistent_image_cache::key_type make_key(uint8_t value)
+	{
+		terraformer::persistent_image_cache::key_type ret{};
+		ret[0] = static_cast<std::byte>(value);
+		return ret;
+	}
+
+	terraformer::grayscale_image make_image(uint32_t width, uint32_t height, float offset)
+	{
+		terraformer::grayscale_image ret{width, height};
+		for(uint32_t y = 0; y != height; ++y)
+		{
+			for(uint32_t x = 0; x != width; ++x)
+			{ ret(x, y) = offset + static_cast<float>(y*width + x); }
+		}
+		return ret;
+	}
+
+	void set_last_use(
+		terraformer::persistent_image_cache const& cache,
+		terraformer::persistent_image_cache::key_type const& key,
+		std::chrono::seconds age
+	)
+	{
+		last_write_time(
+			cache.get_entry_path(key),
+			std::filesystem::file_time_type::clock::now() - age
+		);
+	}
+}
+
+TESTCASE(terraformer_persistent_image_cache_store_and_load)
+{
+	terraformer::tempdir dir{"/tmp/terraformer_image_cache_XXXXXX"};
+	terraformer::persistent_image_cache cache{dir.get_name(), 1024*1024};
+
+	EXPECT_EQ(cache.load(make_key(1)).has_value(), false);
+
+	auto const img = make_image(13, 7, 0.5f);
+	cache.store(make_key(1), img.pixels());
+
+	auto const loaded = cache.load(make_key(1));
+	REQUIRE_EQ(loaded.has_value(), true);
+	EXPECT_EQ(loaded->width(), img.width());
+	EXPECT_EQ(loaded->height(), img.height());
+	for(uint32_t y = 0; y != img.height(); ++y)
+	{
+		for(uint32_t x = 0; x != img.width(); ++x)
+		{ EXPECT_EQ((*loaded)(x, y), img(x, y)); }
+	}
+
+	// Entries survive the cache object
+	terraformer::persistent_image_cache other_cache{dir.get_name(), 1024*1024};
+	EXPECT_EQ(other_cache.load(make_key(1)).has_value(), true);
+	EXPECT_EQ(other_cache.load(make_key(2)).has_value(), false);
+}
+
+TESTCASE(terraformer_persistent_image_cache_truncated_entry_is_a_miss)
+{
+	terraformer::tempdir dir{"/tmp/terraformer_image_cache_XXXXXX"};
+	terraformer::persistent_image_cache cache{dir.get_name(), 1024*1024};
+
+	auto const img = make_image(16, 16, 0.0f);
+	cache.store(make_key(1), img.pixels());
+	resize_file(cache.get_entry_path(make_key(1)), 128);
+
+	EXPECT_EQ(cache.load(make_key(1)).has_value(), false);
+}
+
+TESTCASE(terraformer_persistent_image_cache_evict_least_recently_used)
+{
+	terraformer::tempdir dir{"/tmp/terraformer_image_cache_XXXXXX"};
+
+	// Each entry is 64 + 16*16*4 = 1088 bytes. Make room for two entries.
+	terraformer::persistent_image_cache cache{dir.get_name(), 2*1088};
+
+	cache.store(make_key(1), make_image(16, 16, 1.0f).pixels());
+	set_last_use(cache, make_key(1), std::chrono::seconds{30});
+	cache.store(make_key(2), make_image(16, 16, 2.0f).pixels());
+	set_last_use(cache, make_key(2), std::chrono::seconds{20});
+
+	// Loading the oldest entry makes it the most recently used one
+	REQUIRE_EQ(cache.load(make_key(1)).has_value(), true);
+
+	cache.store(make_key(3), make_image(16, 16, 3.0f).pixels());
+
+	EXPECT_EQ(cache.load(make_key(1)).has_value(), true);
+	EXPECT_EQ(cache.load(make_key(2)).has_value(), false);
+	EXPECT_EQ(cache.load(make_key(3)).has_value(), true);
+}
+
+TESTCASE(terraformer_persistent_image_cache_no_temporary_files_are_left)
+{
+	terraformer::tempdir dir{"/tmp/terraformer_image_cache_XXXXXX"};
+	terraformer::persistent_image_cache cache{dir.get_name(), 1024*1024};
+
+	cache.store(make_key(1), make_image(16, 16, 1.0f).pixels());
+	cache.store(make_key(1), make_image(16, 16, 2.0f).pixels());
+
+	size_t file_count = 0;
+	for(auto const& item : std::filesystem::directory_iterator{dir.get_name()})
+	{
+		EXPECT_EQ(item.path(), cache.get_entry_path(make_key(1)));
+		++file_count;
+	}
+	EXPECT_EQ(file_count, 1);
+
+	auto const loaded = cache.load(make_key(1));
+	REQUIRE_EQ(loaded.has_value(), true);
+	EXPECT_EQ((*loaded)(0, 0), 2.0f);
+}
+
+TESTCASE(terraformer_persistent_image_cache_invalid_directory_disables_cache)
+{
+	terraformer::tempdir dir{"/tmp/terraformer_image_cache_XXXXXX"};
+
+	// A directory cannot be created within a regular file
+	auto const file_path = dir.get_name() / "file";
+	std::unique_ptr<FILE, terraformer::cfile_deleter>{fopen(file_path.c_str(), "wb")};
+	terraformer::persistent_image_cache cache{file_path / "cache", 1024*1024};
+	EXPECT_EQ(cache.is_enabled(), false);
+
+	cache.store(make_key(1), make_image(16, 16, 1.0f).pixels());
+	EXPECT_EQ(cache.load(make_key(1)).has_value(), false);
+}
@@ -3,9 +3,11 @@
 
 #include "./gl_resource.hpp"
 
+#include <algorithm>
 #include <memory>
 #include <type_traits>
 #include <array>
+#include <bit>
 #include <span>
 
 namespace terraformer::ui::drawing_api
@@ -97,6 +99,69 @@ namespace terraformer::ui::drawing_api
 		gl_buffer_handle m_buffer;
 		size_t m_capacity;
 	};
+
+	/**
+	 * A buffer for data that changes size between uploads. Buffer storage is immutable, so a
+	 * larger buffer is created when the current one is too small. The capacity is rounded up to a
+	 * power of two, so data that grows one element at a time does not reallocate on every upload.
+	 */
+	template<class T>
+	class gl_dynamic_buffer
+	{
+	public:
+		explicit gl_dynamic_buffer():m_capacity{0}, m_size{0}
+		{}
+
+		/**
+		 * Returns true if a new buffer was created, in which case any bindings to the old buffer
+		 * must be updated.
+		 */
+		bool upload(std::span<T const> data)
+		{
+			auto const reallocated = reserve(std::size(data));
+			if(!data.empty())
+			{
+				glNamedBufferSubData(
+					m_buffer.get(),
+					0,
+					static_cast<GLsizeiptr>(std::size(data)*sizeof(T)),
+					std::data(data)
+				);
+			}
+			m_size = std::size(data);
+			return reallocated;
+		}
+
+		bool reserve(size_t n)
+		{
+			if(n <= m_capacity && m_capacity != 0) [[likely]]
+			{ return false; }
+
+			auto const new_capacity = std::max(std::bit_ceil(n), size_t{16});
+			GLuint buffer;
+			glCreateBuffers(1, &buffer);
+			glNamedBufferStorage(
+				buffer,
+				static_cast<GLsizeiptr>(new_capacity*sizeof(T)),
+				nullptr,
+				GL_DYNAMIC_STORAGE_BIT
+			);
+			m_buffer.reset(buffer);
+			m_capacity = new_capacity;
+			return true;
+		}
+
+		auto get() const { return m_buffer.get(); }
+
+		size_t size() const { return m_size; }
+
+		size_t capacity() const { return m_capacity; }
+
+	private:
+		gl_buffer_handle m_buffer;
+		size_t m_capacity;
+		size_t m_size;
+	};
 }
 
-#endif
+#endif
\ No newline at end of file
@@ -0,0 +1,242 @@
+#ifndef TERRAFORMER_UI_DRAWING_API_GL_FRAMEBUFFER_HPP
+#define TERRAFORMER_UI_DRAWING_API_GL_FRAMEBUFFER_HPP
+
+#include "./gl_resource.hpp"
+#include "./gl_mesh.hpp"
+#include "./gl_shader.hpp"
+#include "./gl_texture.hpp"
+
+#include <algorithm>
+
+namespace terraformer::ui::drawing_api
+{
+	struct gl_framebuffer_deleter
+	{
+		void operator()(GLuint handle) const
+		{ glDeleteFramebuffers(1, &handle); }
+	};
+
+	using gl_framebuffer_handle = gl_resource<gl_framebuffer_deleter>;
+
+	struct gl_renderbuffer_deleter
+	{
+		void operator()(GLuint handle) const
+		{ glDeleteRenderbuffers(1, &handle); }
+	};
+
+	using gl_renderbuffer_handle = gl_resource<gl_renderbuffer_deleter>;
+
+	/**
+	 * A framebuffer with a single color attachment. Without multisampling, the color attachment
+	 * is a texture, so the content can be sampled. Otherwise, it is a renderbuffer, that has to
+	 * be resolved into a framebuffer without multisampling first.
+	 */
+	class gl_framebuffer
+	{
+	public:
+		gl_framebuffer() = default;
+
+		explicit gl_framebuffer(GLsizei width, GLsizei height, GLenum format, GLsizei samples)
+		{
+			GLuint framebuffer;
+			glCreateFramebuffers(1, &framebuffer);
+			m_handle.reset(framebuffer);
+
+			if(samples == 0)
+			{
+				GLuint texture;
+				glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+				m_color_texture.reset(texture);
+				glTextureStorage2D(texture, 1, format, width, height);
+				glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, texture, 0);
+			}
+			else
+			{
+				GLuint renderbuffer;
+				glCreateRenderbuffers(1, &renderbuffer);
+				m_color_renderbuffer.reset(renderbuffer);
+				glNamedRenderbufferStorageMultisample(renderbuffer, samples, format, width, height);
+				glNamedFramebufferRenderbuffer(framebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, renderbuffer);
+			}
+		}
+
+		auto get() const
+		{ return m_handle.get(); }
+
+		auto color_texture() const
+		{ return m_color_texture.get(); }
+
+	private:
+		gl_framebuffer_handle m_handle;
+		gl_texture_handle m_color_texture;
+		gl_renderbuffer_handle m_color_renderbuffer;
+	};
+
+	/**
+	 * An offscreen framebuffer that keeps its content between frames, so only the regions that
+	 * have changed need to be redrawn. Drawing between begin_redraw and end_redraw goes to the
+	 * offscreen framebuffer. end_redraw copies the content to the framebuffer that was bound when
+	 * begin_redraw was called.
+	 *
+	 * The sample count and the color encoding of the offscreen framebuffer follow the
+	 * framebuffer it is copied to, so the result looks the same as if it had been drawn there
+	 * directly.
+	 */
+	class gl_retained_framebuffer
+	{
+	public:
+		/**
+		 * Binds the offscreen framebuffer, and enables the scissor test. Returns false if the
+		 * previous content is lost, because the offscreen framebuffer had to be recreated. Then,
+		 * the entire framebuffer must be redrawn.
+		 */
+		bool begin_redraw(GLsizei width, GLsizei height)
+		{
+			GLint target{};
+			glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+			m_target = static_cast<GLuint>(target);
+
+			if(width <= 0 || height <= 0) [[unlikely]]
+			{
+				m_multisampled = gl_framebuffer{};
+				m_resolved = gl_framebuffer{};
+				m_width = 0;
+				m_height = 0;
+				return false;
+			}
+
+			GLint samples{};
+			glGetIntegerv(GL_SAMPLES, &samples);
+			auto const format = static_cast<GLenum>(glIsEnabled(GL_FRAMEBUFFER_SRGB)? GL_SRGB8_ALPHA8 : GL_RGBA8);
+
+			auto const content_is_kept = width == m_width && height == m_height
+				&& samples == m_samples && format == m_format;
+			if(!content_is_kept) [[unlikely]]
+			{
+				m_resolved = gl_framebuffer{width, height, format, 0};
+				m_multisampled = samples != 0? gl_framebuffer{width, height, format, samples} : gl_framebuffer{};
+				m_width = width;
+				m_height = height;
+				m_samples = samples;
+				m_format = format;
+			}
+
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_samples != 0? m_multisampled.get() : m_resolved.get());
+			glEnable(GL_SCISSOR_TEST);
+			m_redrawn_region = region{};
+			return content_is_kept;
+		}
+
+		/**
+		 * Clears the given region, and restricts drawing to it
+		 */
+		void set_redraw_region(GLint x, GLint y, GLsizei width, GLsizei height)
+		{
+			if(m_width == 0 || m_height == 0) [[unlikely]]
+			{ return; }
+
+			glScissor(x, y, width, height);
+			glClear(GL_COLOR_BUFFER_BIT);
+
+			if(m_redrawn_region.width == 0 || m_redrawn_region.height == 0)
+			{
+				m_redrawn_region = region{x, y, width, height};
+				return;
+			}
+
+			auto const x_max = std::max(m_redrawn_region.x + m_redrawn_region.width, x + width);
+			auto const y_max = std::max(m_redrawn_region.y + m_redrawn_region.height, y + height);
+			m_redrawn_region.x = std::min(m_redrawn_region.x, x);
+			m_redrawn_region.y = std::min(m_redrawn_region.y, y);
+			m_redrawn_region.width = x_max - m_redrawn_region.x;
+			m_redrawn_region.height = y_max - m_redrawn_region.y;
+		}
+
+		/**
+		 * Copies the content to the framebuffer that was bound by the time begin_redraw was
+		 * called, and binds that framebuffer again
+		 */
+		void end_redraw()
+		{
+			if(m_width == 0 || m_height == 0) [[unlikely]]
+			{ return; }
+
+			if(m_samples != 0 && m_redrawn_region.width != 0 && m_redrawn_region.height != 0)
+			{
+				// Only the bounding box of the regions drawn this frame needs to be resolved
+				glScissor(m_redrawn_region.x, m_redrawn_region.y, m_redrawn_region.width, m_redrawn_region.height);
+				glBlitNamedFramebuffer(
+					m_multisampled.get(),
+					m_resolved.get(),
+					0, 0, m_width, m_height,
+					0, 0, m_width, m_height,
+					GL_COLOR_BUFFER_BIT,
+					GL_NEAREST
+				);
+			}
+			glDisable(GL_SCISSOR_TEST);
+
+			glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_target);
+			auto const blending_enabled = glIsEnabled(GL_BLEND);
+			glDisable(GL_BLEND);
+			m_program.bind();
+			glBindTextureUnit(0, m_resolved.color_texture());
+			m_mesh.bind();
+			gl_bindings::draw_triangles();
+			if(blending_enabled)
+			{ glEnable(GL_BLEND); }
+		}
+
+	private:
+		struct region
+		{
+			GLint x;
+			GLint y;
+			GLsizei width;
+			GLsizei height;
+		};
+
+		gl_framebuffer m_multisampled;
+		gl_framebuffer m_resolved;
+		GLsizei m_width{0};
+		GLsizei m_height{0};
+		GLint m_samples{0};
+		GLenum m_format{0};
+		GLuint m_target{0};
+		region m_redrawn_region{};
+
+		gl_mesh<unsigned int> m_mesh{
+			std::array<unsigned int, 6>{
+				0, 1, 2, 0, 2, 3
+			}
+		};
+
+		gl_program m_program{
+			gl_shader<GL_VERTEX_SHADER>{R"(#version 460 core
+const vec4 coords[4] = vec4[4](
+	vec4(-1.0f, -1.0f, 0.0f, 1.0f),
+	vec4(1.0f, -1.0f, 0.0f, 1.0f),
+	vec4(1.0f, 1.0f, 0.0f, 1.0f),
+	vec4(-1.0f, 1.0f, 0.0f, 1.0f)
+);
+
+void main()
+{
+	gl_Position = coords[gl_VertexID];
+}
+)"},
+			gl_shader<GL_FRAGMENT_SHADER>{R"(#version 460 core
+layout (binding = 0) uniform sampler2D content;
+
+out vec4 fragment_color;
+
+void main()
+{
+	fragment_color = texelFetch(content, ivec2(gl_FragCoord.xy), 0);
+}
+)"}
+		};
+	};
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef TERRAFORMER_UI_DRAWING_API_GL_GLYPH_QUAD_BUFFER_HPP
+#define TERRAFORMER_UI_DRAWING_API_GL_GLYPH_QUAD_BUFFER_HPP
+
+#include "./gl_buffer.hpp"
+#include "./gl_vertex_array.hpp"
+
+#include "ui/font_handling/glyph_atlas.hpp"
+
+#include <cstddef>
+#include <span>
+
+namespace terraformer::ui::drawing_api
+{
+	/**
+	 * Stores glyph quads as per-instance vertex attributes, together with the indices of a single
+	 * quad. Attribute 0 is the location of the glyph, attribute 1 its size, and attribute 2 its
+	 * location within the glyph atlas.
+	 */
+	class gl_glyph_quad_buffer
+	{
+	public:
+		explicit gl_glyph_quad_buffer(std::span<font_handling::glyph_quad const> quads)
+		{
+			m_vao.set_buffer(m_indices);
+			upload(quads);
+		}
+
+		void upload(std::span<font_handling::glyph_quad const> quads)
+		{
+			if(m_quads.upload(quads)) [[unlikely]]
+			{ bind_attributes(); }
+		}
+
+		void bind() const
+		{ m_vao.bind(); }
+
+		size_t size() const
+		{ return m_quads.size(); }
+
+	private:
+		void bind_attributes()
+		{
+			using font_handling::glyph_quad;
+			m_vao.set_instance_buffer(0, m_quads.get(), sizeof(glyph_quad));
+			m_vao.set_attribute_format(0, 0, 2, GL_FLOAT, offsetof(glyph_quad, x));
+			m_vao.set_attribute_format(1, 0, 2, GL_FLOAT, offsetof(glyph_quad, width));
+			m_vao.set_attribute_format(2, 0, 2, GL_FLOAT, offsetof(glyph_quad, atlas_x));
+		}
+
+		gl_vertex_array m_vao;
+		gl_index_buffer<unsigned int> m_indices{std::array<unsigned int, 6>{0, 1, 2, 0, 2, 3}};
+		gl_dynamic_buffer<font_handling::glyph_quad> m_quads;
+	};
+}
+
+#endif
@@ -2,8 +2,10 @@
 #define TERRAFORMER_UI_DRAWING_API_GL_RESOURCE_FACTORY_HPP
 
 #include "./gl_texture.hpp"
+#include "./gl_glyph_quad_buffer.hpp"
 
 #include "ui/main/texture.hpp"
+#include "ui/main/glyph_quad_buffer.hpp"
 #include "lib/common/global_instance_counter.hpp"
 
 namespace terraformer::ui::drawing_api
@@ -15,6 +17,20 @@ namespace terraformer::ui::drawing_api
 		{
 			return main::texture{std::in_place_type_t<gl_texture>{}, factory_id,  src.pixels()};
 		}
+
+		static main::texture create(std::type_identity<main::texture>, uint64_t factory_id, grayscale_image const& src)
+		{
+			return main::texture{std::in_place_type_t<gl_texture>{}, factory_id,  src.pixels()};
+		}
+
+		static main::glyph_quad_buffer create(
+			std::type_identity<main::glyph_quad_buffer>,
+			uint64_t factory_id,
+			std::span<font_handling::glyph_quad const> quads
+		)
+		{
+			return main::glyph_quad_buffer{std::in_place_type_t<gl_glyph_quad_buffer>{}, factory_id, quads};
+		}
 	};
 }
 
@@ -34,4 +34,107 @@ TESTCASE(terraformer_ui_drawing_api_gl_resource_factory_create_texture)
 
 	EXPECT_EQ(res.get(), true);
 	EXPECT_EQ(res.belongs_to_backend(555), true);
-}
\ No newline at end of file
+}
+TESTCASE(terraformer_ui_drawing_api_gl_resource_factory_create_grayscale_texture)
+{
+	glCreateTextures = [](GLenum target, GLsizei n, GLuint* textures){
+		EXPECT_EQ(target, GL_TEXTURE_2D);
+		EXPECT_EQ(n, 1);
+		REQUIRE_NE(textures, nullptr);
+		textures[0] = 124;
+	};
+	glTextureStorage2D = [](GLuint texture, GLsizei, GLenum format, GLsizei, GLsizei){
+		EXPECT_EQ(texture, 124);
+		EXPECT_EQ(format, GL_R32F);
+	};
+	glTextureParameteri = [](GLuint texture, GLenum, GLint){
+		EXPECT_EQ(texture, 124);
+	};
+	glTextureSubImage2D = [](GLuint texture, GLint, GLint, GLint, GLsizei, GLsizei, GLenum format, GLenum type, void const*){
+		EXPECT_EQ(texture, 124);
+		EXPECT_EQ(format, GL_RED);
+		EXPECT_EQ(type, GL_FLOAT);
+	};
+	glGenerateTextureMipmap = [](GLuint texture){
+		EXPECT_EQ(texture, 124);
+	};
+
+	terraformer::grayscale_image img{320, 220};
+	auto res = terraformer::ui::drawing_api::gl_resource_factory::create(
+		std::type_identity<terraformer::ui::main::texture>{},
+		555,
+		img
+	);
+
+	EXPECT_EQ(res.get(), true);
+	EXPECT_EQ(res.belongs_to_backend(555), true);
+}
+
+namespace
+{
+	size_t buffer_storage_calls = 0;
+	GLsizeiptr uploaded_bytes = 0;
+}
+
+TESTCASE(terraformer_ui_drawing_api_gl_resource_factory_create_glyph_quad_buffer)
+{
+	glCreateVertexArrays = [](GLsizei n, GLuint* arrays){
+		EXPECT_EQ(n, 1);
+		arrays[0] = 7;
+	};
+	glDeleteVertexArrays = [](GLsizei, GLuint const*){};
+	glCreateBuffers = [](GLsizei n, GLuint* buffers){
+		EXPECT_EQ(n, 1);
+		buffers[0] = 8;
+	};
+	glDeleteBuffers = [](GLsizei, GLuint const*){};
+	glVertexArrayElementBuffer = [](GLuint vao, GLuint){
+		EXPECT_EQ(vao, 7);
+	};
+	glVertexArrayVertexBuffer = [](GLuint vao, GLuint, GLuint buffer, GLintptr, GLsizei stride){
+		EXPECT_EQ(vao, 7);
+		EXPECT_EQ(buffer, 8);
+		EXPECT_EQ(stride, sizeof(terraformer::ui::font_handling::glyph_quad));
+	};
+	glVertexArrayBindingDivisor = [](GLuint, GLuint, GLuint divisor){
+		EXPECT_EQ(divisor, 1);
+	};
+	glVertexArrayAttribFormat = [](GLuint, GLuint, GLint size, GLenum type, GLboolean, GLuint){
+		EXPECT_EQ(size, 2);
+		EXPECT_EQ(type, GL_FLOAT);
+	};
+	glVertexArrayAttribBinding = [](GLuint, GLuint, GLuint){};
+	glEnableVertexArrayAttrib = [](GLuint, GLuint){};
+	glNamedBufferStorage = [](GLuint buffer, GLsizeiptr, void const*, GLbitfield){
+		EXPECT_EQ(buffer, 8);
+		++buffer_storage_calls;
+	};
+	glNamedBufferSubData = [](GLuint buffer, GLintptr, GLsizeiptr size, void const*){
+		EXPECT_EQ(buffer, 8);
+		uploaded_bytes = size;
+	};
+
+	std::vector<terraformer::ui::font_handling::glyph_quad> quads(5);
+	auto res = terraformer::ui::drawing_api::gl_resource_factory::create(
+		std::type_identity<terraformer::ui::main::glyph_quad_buffer>{},
+		555,
+		quads
+	);
+
+	EXPECT_EQ(res.belongs_to_backend(555), true);
+	EXPECT_EQ(res.get().size(), 5);
+	EXPECT_EQ(uploaded_bytes, 5*sizeof(terraformer::ui::font_handling::glyph_quad));
+
+	// Changing the text should only upload the new quads
+	auto const storage_calls_after_create = buffer_storage_calls;
+	quads.resize(7);
+	res.upload(quads);
+	EXPECT_EQ(res.get().size(), 7);
+	EXPECT_EQ(buffer_storage_calls, storage_calls_after_create);
+	EXPECT_EQ(uploaded_bytes, 7*sizeof(terraformer::ui::font_handling::glyph_quad));
+
+	quads.resize(100);
+	res.upload(quads);
+	EXPECT_EQ(res.get().size(), 100);
+	EXPECT_EQ(buffer_storage_calls, storage_calls_after_create + 1);
+}
@@ -44,6 +44,12 @@ namespace terraformer::ui::drawing_api
 		static constexpr auto value = GL_RGBA;
 	};
 
+	template<>
+	struct to_gl_color_channel_layout<float>
+	{
+		static constexpr auto value = GL_RED;
+	};
+
 	template<class T>
 	constexpr auto to_gl_color_channel_layout_v = to_gl_color_channel_layout<T>::value;
 
@@ -211,6 +217,7 @@ namespace terraformer::ui::drawing_api
 			glTextureParameteri(handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 			m_handle.reset(handle);
 			m_descriptor = descriptor;
+			m_bindless_handle = 0;
 		}
 
 		void bind(GLuint texture_unit) const
@@ -222,6 +229,21 @@ namespace terraformer::ui::drawing_api
 		auto handle() const
 		{ return static_cast<uint32_t>(m_handle.get()); }
 
+		/**
+		 * Returns a resident bindless handle to the texture. The handle is created the first time
+		 * it is requested, which makes the sampler state of the texture immutable. Only call this
+		 * when GL_ARB_bindless_texture is supported.
+		 */
+		uint64_t bindless_handle() const
+		{
+			if(m_bindless_handle == 0) [[unlikely]]
+			{
+				m_bindless_handle = glGetTextureHandleARB(m_handle.get());
+				glMakeTextureHandleResidentARB(m_bindless_handle);
+			}
+			return m_bindless_handle;
+		}
+
 	private:
 		void upload_impl(std::span<std::byte const> data)
 		{
@@ -241,6 +263,7 @@ namespace terraformer::ui::drawing_api
 
 		gl_texture_handle m_handle;
 		gl_texture_descriptor m_descriptor;
+		mutable GLuint64 m_bindless_handle{};
 	};
 }
 
@@ -19,6 +19,18 @@ namespace terraformer::ui::drawing_api
 
 	using gl_vertex_array_handle = gl_resource<gl_vertex_array_deleter>;
 
+	/**
+	 * The layout of the commands read by glMultiDrawElementsIndirect
+	 */
+	struct gl_draw_elements_indirect_command
+	{
+		GLuint count;
+		GLuint instance_count;
+		GLuint first_index;
+		GLint base_vertex;
+		GLuint base_instance;
+	};
+
 	class gl_bindings
 	{
 	public:
@@ -32,6 +44,21 @@ namespace terraformer::ui::drawing_api
 		static void draw_triangles_repeatedly(GLsizei count)
 		{ glDrawElementsInstanced(GL_TRIANGLES, s_bound_elem_count, s_bound_index_type, nullptr, count); }
 
+		/**
+		 * Issues count draw commands, read from the buffer bound to GL_DRAW_INDIRECT_BUFFER,
+		 * starting at byte offset
+		 */
+		static void draw_triangles_indirect(size_t offset, GLsizei count)
+		{
+			glMultiDrawElementsIndirect(
+				GL_TRIANGLES,
+				s_bound_index_type,
+				reinterpret_cast<void const*>(offset),
+				count,
+				0
+			);
+		}
+
 	protected:
 		thread_local static inline GLsizei s_bound_elem_count;
 		thread_local static inline GLenum s_bound_index_type;
@@ -57,6 +84,29 @@ namespace terraformer::ui::drawing_api
 			glEnableVertexArrayAttrib(m_handle.get(), port);
 		}
 
+		/**
+		 * Binds buffer to binding, so that the attributes that use binding advance once per
+		 * instance, rather than once per vertex
+		 */
+		void set_instance_buffer(GLuint binding, GLuint buffer, GLsizei stride)
+		{
+			glVertexArrayVertexBuffer(m_handle.get(), binding, buffer, 0, stride);
+			glVertexArrayBindingDivisor(m_handle.get(), binding, 1);
+		}
+
+		void set_attribute_format(
+			GLuint attribute,
+			GLuint binding,
+			GLint component_count,
+			GLenum type,
+			GLuint relative_offset
+		)
+		{
+			glVertexArrayAttribFormat(m_handle.get(), attribute, component_count, type, GL_FALSE, relative_offset);
+			glVertexArrayAttribBinding(m_handle.get(), attribute, binding);
+			glEnableVertexArrayAttrib(m_handle.get(), attribute);
+		}
+
 		template<class T>
 		void set_buffer(gl_index_buffer<T> const& buffer)
 		{
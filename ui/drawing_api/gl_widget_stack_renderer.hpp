@@ -1,24 +1,93 @@
 #ifndef TERRAFORMER_UI_DRAWING_API_WIDGET_LAYER_STACK_RENDERER_HPP
 #define TERRAFORMER_UI_DRAWING_API_WIDGET_LAYER_STACK_RENDERER_HPP
 
+#include "./gl_buffer.hpp"
+#include "./gl_framebuffer.hpp"
 #include "./gl_mesh.hpp"
 #include "./gl_shader.hpp"
+#include "./widget_draw_sequence.hpp"
+#include "ui/main/damage_list.hpp"
+#include "ui/main/events.hpp"
 #include "ui/main/widget_layer_stack.hpp"
 
 #include "lib/pixel_store/image.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace terraformer::ui::drawing_api
 {
+	/**
+	 * The parameters of one widget, as stored in the shader storage buffer. The layout matches
+	 * widget_instance in the shaders, using std430 rules.
+	 */
+	struct gl_widget_instance
+	{
+		std::array<float, 4> model_location;
+		std::array<float, 4> model_origin;
+		std::array<float, 4> model_size;
+		std::array<rgba_pixel, 4> background_tints;
+		std::array<rgba_pixel, 4> selection_background_tints;
+		std::array<rgba_pixel, 4> foreground_tints;
+		std::array<rgba_pixel, 4> input_marker_tints;
+		std::array<rgba_pixel, 4> frame_tints;
+		rgba_pixel bg_level_curve_color;
+		std::array<float, 2> fg_offset;
+		std::array<float, 2> input_marker_offset;
+		std::array<float, 2> bg_offset;
+		std::array<float, 2> frame_offset;
+		std::array<float, 2> bg_value_range;
+		std::array<float, 2> bg_image_size;
+		float fg_rotation;
+		float bg_use_color_lut;
+		float bg_level_curve_interval;
+		float padding;
+
+		/**
+		 * Either bindless texture handles, or texture units, in the order background,
+		 * selection background mask, selection background, foreground, input marker, frame,
+		 * and background color lut
+		 */
+		std::array<uint64_t, 8> textures;
+	};
+
+	static_assert(sizeof(gl_widget_instance) == 512);
+
+	/**
+	 * Draws widget layer stacks in batches. Calls to render only record the parameters of the
+	 * widget. The widgets are drawn by flush, using one multi-draw per batch, where each widget
+	 * is one draw command. If bindless textures are used, all widgets end up in the same batch.
+	 * Otherwise, a new batch is started when the textures used by the widgets no longer fit into
+	 * the available texture units.
+	 *
+	 * NOTE: Since widgets within a batch are drawn in order, blending works as if each widget was
+	 *       drawn separately. A multi-draw is split after each widget with text, so the text is
+	 *       drawn before any widget recorded after it.
+	 */
 	class gl_widget_layer_stack_renderer
 	{
 	public:
+		explicit gl_widget_layer_stack_renderer():
+			gl_widget_layer_stack_renderer{static_cast<bool>(GLEW_ARB_bindless_texture)}
+		{}
+
+		explicit gl_widget_layer_stack_renderer(bool use_bindless_textures):
+			m_use_bindless_textures{use_bindless_textures},
+			m_texture_unit_count{get_texture_unit_count()},
+			m_program{make_widget_program(use_bindless_textures, m_texture_unit_count)}
+		{}
+
 		void set_world_transform(location where, main::fb_size size)
 		{
 			scaling const s{2.0f/static_cast<float>(size.width), 2.0f/static_cast<float>(size.height), 1.0f};
 			m_program.set_uniform(3, where[0], where[1], where[2], 1.0f)
 				.set_uniform(4, s[0], s[1], s[2], 0.0f);
+			m_text_program.set_uniform(3, where[0], where[1], where[2], 1.0f)
+				.set_uniform(4, s[0], s[1], s[2], 0.0f);
 		}
 
 		void render(
@@ -28,22 +97,6 @@ namespace terraformer::ui::drawing_api
 			main::widget_layer_stack const& rect
 		)
 		{
-			auto const v = 0.5f*origin.get();
-			m_program.set_uniform(0, where[0], where[1], where[2], 1.0f)
-				.set_uniform(1, v[0], v[1], v[2], 1.0f)
-				.set_uniform(2, scale[0], scale[1], scale[2], 0.0f)
-				.set_uniform(5, rect.background.tints)
-				.set_uniform(9, rect.selection_background.tints)
-				.set_uniform(13, rect.foreground.tints)
-				.set_uniform(17, rect.input_marker.tints)
-				.set_uniform(21, rect.frame.tints)
-				.set_uniform(25, rect.foreground.offset[0], rect.foreground.offset[1])
-				.set_uniform(26, rect.input_marker.offset[0], rect.input_marker.offset[1])
-				.set_uniform(27, static_cast<float>(to_rad(rect.foreground.rotation).value))
-				.set_uniform(28, rect.background.offset[0], rect.background.offset[1])
-				.set_uniform(29, rect.frame.offset[0], rect.frame.offset[1])
-				.bind();
-
 			assert(rect.background.texture);
 			assert(rect.sel_bg_mask.texture);
 			assert(rect.selection_background.texture);
@@ -51,15 +104,133 @@ namespace terraformer::ui::drawing_api
 			assert(rect.input_marker.texture);
 			assert(rect.frame.texture);
 
-			rect.background.texture.bind(0);
-			rect.sel_bg_mask.texture.bind(1);
-			rect.selection_background.texture.bind(2);
-			rect.foreground.texture.bind(3);
-			rect.input_marker.texture.bind(4);
-			rect.frame.texture.bind(5);
+			auto const v = 0.5f*origin.get();
+			auto const& mapping = rect.background_color_mapping;
+			m_widgets.push_back(gl_widget_instance{
+				.model_location{where[0], where[1], where[2], 1.0f},
+				.model_origin{v[0], v[1], v[2], 1.0f},
+				.model_size{scale[0], scale[1], scale[2], 0.0f},
+				.background_tints = rect.background.tints,
+				.selection_background_tints = rect.selection_background.tints,
+				.foreground_tints = rect.foreground.tints,
+				.input_marker_tints = rect.input_marker.tints,
+				.frame_tints = rect.frame.tints,
+				.bg_level_curve_color = mapping.level_curve_color,
+				.fg_offset{rect.foreground.offset[0], rect.foreground.offset[1]},
+				.input_marker_offset{rect.input_marker.offset[0], rect.input_marker.offset[1]},
+				.bg_offset{rect.background.offset[0], rect.background.offset[1]},
+				.frame_offset{rect.frame.offset[0], rect.frame.offset[1]},
+				.bg_value_range{mapping.min_value, mapping.max_value},
+				.bg_image_size{mapping.image_size[0], mapping.image_size[1]},
+				.fg_rotation = static_cast<float>(to_rad(rect.foreground.rotation).value),
+				.bg_use_color_lut = mapping.color_lut? 1.0f : 0.0f,
+				.bg_level_curve_interval = mapping.level_curve_interval,
+				.padding = 0.0f,
+				.textures{}
+			});
+
+			// NOTE: Without a color lut, the slot is never sampled, but it must still refer to a
+			//       valid texture
+			m_widget_textures.push_back(std::array{
+				rect.background.texture,
+				rect.sel_bg_mask.texture,
+				rect.selection_background.texture,
+				rect.foreground.texture,
+				rect.input_marker.texture,
+				rect.frame.texture,
+				mapping.color_lut? mapping.color_lut : rect.background.texture
+			});
 
-			m_mesh.bind();
-			gl_bindings::draw_triangles();
+			auto const& text = rect.text;
+			if(text.glyphs && text.glyphs.size() != 0)
+			{
+				assert(text.glyph_atlas);
+				m_texts.push_back(deferred_text{
+					.widget_index = static_cast<GLuint>(std::size(m_widgets) - 1),
+					.layer = text
+				});
+			}
+		}
+
+		/**
+		 * Draws all widgets that have been recorded by render since the last call to flush
+		 */
+		void flush()
+		{
+			if(m_widgets.empty())
+			{ return; }
+
+			m_batches.clear();
+			m_batch_textures.clear();
+			if(m_use_bindless_textures)
+			{
+				for(size_t k = 0; k != std::size(m_widgets); ++k)
+				{
+					auto const& textures = m_widget_textures[k];
+					for(size_t l = 0; l != std::size(textures); ++l)
+					{ m_widgets[k].textures[l] = textures[l].bindless_handle(); }
+				}
+				m_batches.push_back(widget_batch{
+					.first_widget = 0,
+					.widget_count = std::size(m_widgets),
+					.first_texture = 0,
+					.texture_count = 0
+				});
+			}
+			else
+			{ assign_texture_units(); }
+
+			// Commands only depend on the widget index, so they are only uploaded when more
+			// widgets than before are drawn
+			if(std::size(m_commands) < std::size(m_widgets)) [[unlikely]]
+			{
+				for(auto k = std::size(m_commands); k != std::size(m_widgets); ++k)
+				{
+					m_commands.push_back(gl_draw_elements_indirect_command{
+						.count = 6,
+						.instance_count = 1,
+						.first_index = 0,
+						.base_vertex = 0,
+						.base_instance = static_cast<GLuint>(k)
+					});
+				}
+				m_command_buffer.upload(m_commands);
+			}
+			m_widget_buffer.upload(m_widgets);
+
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_widget_buffer.get());
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_command_buffer.get());
+			visit_draw_sequence(
+				std::span{std::as_const(m_batches)},
+				std::span{std::as_const(m_texts)},
+				[this](widget_batch const& batch) {
+					m_program.bind();
+					m_mesh.bind();
+					for(size_t k = 0; k != batch.texture_count; ++k)
+					{ m_batch_textures[batch.first_texture + k].bind(static_cast<int>(k)); }
+				},
+				[](size_t first_widget, size_t widget_count) {
+					gl_bindings::draw_triangles_indirect(
+						first_widget*sizeof(gl_draw_elements_indirect_command),
+						static_cast<GLsizei>(widget_count)
+					);
+				},
+				[this](deferred_text const& item) {
+					auto const& text = item.layer;
+					auto const tint = text.tint;
+					m_text_program.bind();
+					m_text_program.set_uniform(0, item.widget_index)
+						.set_uniform(5, text.offset[0], text.offset[1])
+						.set_uniform(6, tint.red(), tint.green(), tint.blue(), tint.alpha());
+					text.glyph_atlas.bind(0);
+					text.glyphs.bind();
+					gl_bindings::draw_triangles_repeatedly(static_cast<GLsizei>(text.glyphs.size()));
+				}
+			);
+
+			m_widgets.clear();
+			m_widget_textures.clear();
+			m_texts.clear();
 		}
 
 		auto& clear_buffers()
@@ -71,36 +242,169 @@ namespace terraformer::ui::drawing_api
 		auto& set_viewport(int x, int y, int width, int height)
 		{
 			glViewport(x, y, width, height);
+			m_viewport_width = width;
+			m_viewport_height = height;
 			return *this;
 		}
 
+		/**
+		 * Starts drawing into the retained framebuffer. Returns false if its previous content was
+		 * lost, in which case the entire viewport must be redrawn.
+		 */
+		bool begin_redraw()
+		{ return m_retained_framebuffer.begin_redraw(m_viewport_width, m_viewport_height); }
+
+		/**
+		 * Clears region, and restricts drawing to it, until the next call to set_redraw_region
+		 * or end_redraw. Widgets recorded before must be flushed first.
+		 */
+		auto& set_redraw_region(main::damaged_region const& region)
+		{
+			// NOTE: y is zero at the top of the viewport in widget coordinates, but at the bottom
+			//       in framebuffer coordinates
+			auto const height = static_cast<float>(m_viewport_height);
+			auto const x_min = std::clamp(static_cast<GLint>(std::floor(region.left)), 0, m_viewport_width);
+			auto const x_max = std::clamp(static_cast<GLint>(std::ceil(region.right)), 0, m_viewport_width);
+			auto const y_min = std::clamp(static_cast<GLint>(std::floor(height + region.bottom)), 0, m_viewport_height);
+			auto const y_max = std::clamp(static_cast<GLint>(std::ceil(height + region.top)), 0, m_viewport_height);
+			m_retained_framebuffer.set_redraw_region(x_min, y_min, x_max - x_min, y_max - y_min);
+			return *this;
+		}
+
+		/**
+		 * Copies the retained framebuffer to the framebuffer that was bound when begin_redraw was
+		 * called
+		 */
+		auto& end_redraw()
+		{
+			m_retained_framebuffer.end_redraw();
+			return *this;
+		}
+
+		bool uses_bindless_textures() const
+		{ return m_use_bindless_textures; }
+
 	private:
-		gl_mesh<unsigned int> m_mesh{
-			std::array<unsigned int, 6>{
-				0, 1, 2, 0, 2, 3
-			}
+		static constexpr size_t textures_per_widget = 7;
+
+		struct deferred_text
+		{
+			GLuint widget_index;
+			main::widget_text_layer layer;
 		};
 
-		gl_program m_program{
-			gl_shader<GL_VERTEX_SHADER>{
-				R"(#version 460 core
-layout (location = 0) uniform vec4 model_location;
-layout (location = 1) uniform vec4 model_origin;
-layout (location = 2) uniform vec4 model_size;
+		void assign_texture_units()
+		{
+			widget_batch current{};
+			for(size_t k = 0; k != std::size(m_widgets); ++k)
+			{
+				auto const& textures = m_widget_textures[k];
+				auto const is_bound = [this, &current](main::texture_ref texture) {
+					auto const bound = std::span{m_batch_textures}.subspan(current.first_texture);
+					return std::ranges::find(bound, texture) != std::end(bound);
+				};
+
+				size_t unbound_count = 0;
+				for(size_t l = 0; l != std::size(textures); ++l)
+				{
+					auto const first_use = std::find(std::begin(textures), std::begin(textures) + l, textures[l])
+						== std::begin(textures) + l;
+					if(first_use && !is_bound(textures[l]))
+					{ ++unbound_count; }
+				}
+
+				auto const bound_count = std::size(m_batch_textures) - current.first_texture;
+				if(bound_count + unbound_count > m_texture_unit_count)
+				{
+					current.texture_count = bound_count;
+					m_batches.push_back(current);
+					current = widget_batch{
+						.first_widget = k,
+						.widget_count = 0,
+						.first_texture = std::size(m_batch_textures),
+						.texture_count = 0
+					};
+				}
+
+				for(size_t l = 0; l != std::size(textures); ++l)
+				{
+					auto const bound = std::span{m_batch_textures}.subspan(current.first_texture);
+					auto const i = std::ranges::find(bound, textures[l]);
+					if(i == std::end(bound))
+					{ m_batch_textures.push_back(textures[l]); }
+					m_widgets[k].textures[l] = static_cast<uint64_t>(i - std::begin(bound));
+				}
+				++current.widget_count;
+			}
+			current.texture_count = std::size(m_batch_textures) - current.first_texture;
+			m_batches.push_back(current);
+		}
+
+		static size_t get_texture_unit_count()
+		{
+			GLint ret{};
+			glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &ret);
+			return static_cast<size_t>(std::clamp(ret, static_cast<GLint>(textures_per_widget), 32));
+		}
+
+		static constexpr char const* widget_instance_declaration = R"(
+struct widget_instance
+{
+	vec4 model_location;
+	vec4 model_origin;
+	vec4 model_size;
+	vec4 background_tints[4];
+	vec4 selection_background_tints[4];
+	vec4 foreground_tints[4];
+	vec4 input_marker_tints[4];
+	vec4 frame_tints[4];
+	vec4 bg_level_curve_color;
+	vec2 fg_offset;
+	vec2 input_marker_offset;
+	vec2 bg_offset;
+	vec2 frame_offset;
+	vec2 bg_value_range;
+	vec2 bg_image_size;
+	float fg_rotation;
+	float bg_use_color_lut;
+	float bg_level_curve_interval;
+	float padding;
+	uvec2 textures[8];
+};
+
+layout (std430, binding = 0) readonly buffer widget_instances
+{
+	widget_instance widgets[];
+};
+)";
+
+		static gl_program make_widget_program(bool use_bindless_textures, size_t texture_unit_count)
+		{
+			std::string const header = use_bindless_textures?
+				std::string{"#version 460 core\n#extension GL_ARB_bindless_texture : require\n#define USE_BINDLESS_TEXTURES\n"}:
+				"#version 460 core\n#define TEXTURE_UNIT_COUNT " + std::to_string(texture_unit_count) + "\n";
+
+			auto const vertex_shader = header + widget_instance_declaration + R"(
 layout (location = 3) uniform vec4 world_location;
 layout (location = 4) uniform vec4 world_scale;
-layout (location = 5) uniform vec4 background_tints[4];
-layout (location = 9) uniform vec4 selection_background_tints[4];
-layout (location = 13) uniform vec4 foreground_tints[4];
-layout (location = 17) uniform vec4 input_marker_tints[4];
-layout (location = 21) uniform vec4 frame_tints[4];
 
 out vec2 uv;
+out vec2 bg_uv;
+out vec2 fg_uv;
+out vec2 input_marker_uv;
+out vec2 frame_uv;
 out vec4 background_tint;
 out vec4 selection_background_tint;
 out vec4 foreground_tint;
 out vec4 input_marker_tint;
 out vec4 frame_tint;
+flat out float fg_rotation;
+flat out float bg_use_color_lut;
+flat out vec2 bg_value_range;
+flat out vec2 bg_image_size;
+flat out float bg_level_curve_interval;
+flat out vec4 bg_level_curve_color;
+flat out uvec2 widget_textures[7];
 
 const vec2 uv_coords[4] = vec2[4](
 	vec2(0.0f, 1.0f),
@@ -118,37 +422,63 @@ const vec4 coords[4] = vec4[4](
 
 void main()
 {
+	// NOTE: Each widget is drawn by its own draw command, which means that the base instance
+	//       is dynamically uniform, and so are the textures passed to the fragment shader
+	widget_instance widget = widgets[gl_BaseInstance];
 	const vec4 world_origin = vec4(0.0, 0.0, 0.0, 1.0);
-	vec4 loc = model_location + model_size*(coords[gl_VertexID] - model_origin);
+	vec4 loc = widget.model_location + widget.model_size*(coords[gl_VertexID] - widget.model_origin);
 	gl_Position = world_location + world_scale*(loc - world_origin);
-	uv = model_size.xy*uv_coords[gl_VertexID];
-	background_tint = background_tints[gl_VertexID];
-	selection_background_tint = selection_background_tints[gl_VertexID];
-	foreground_tint = foreground_tints[gl_VertexID];
-	input_marker_tint = input_marker_tints[gl_VertexID];
-	frame_tint = frame_tints[gl_VertexID];
-})"
-			},
-			gl_shader<GL_FRAGMENT_SHADER>{R"(#version 460 core
+
+	// NOTE: Offsets are applied here rather than in the fragment shader, so texture coordinates
+	//       are plain interpolated values. This keeps implicit derivatives well-defined.
+	uv = widget.model_size.xy*uv_coords[gl_VertexID];
+	bg_uv = uv - widget.bg_offset;
+	fg_uv = uv - widget.fg_offset;
+	input_marker_uv = uv - widget.input_marker_offset;
+	frame_uv = uv - widget.frame_offset;
+
+	background_tint = widget.background_tints[gl_VertexID];
+	selection_background_tint = widget.selection_background_tints[gl_VertexID];
+	foreground_tint = widget.foreground_tints[gl_VertexID];
+	input_marker_tint = widget.input_marker_tints[gl_VertexID];
+	frame_tint = widget.frame_tints[gl_VertexID];
+	fg_rotation = widget.fg_rotation;
+	bg_use_color_lut = widget.bg_use_color_lut;
+	bg_value_range = widget.bg_value_range;
+	bg_image_size = widget.bg_image_size;
+	bg_level_curve_interval = widget.bg_level_curve_interval;
+	bg_level_curve_color = widget.bg_level_curve_color;
+	for(int k = 0; k != 7; ++k)
+	{ widget_textures[k] = widget.textures[k]; }
+})";
+
+			auto const fragment_shader = header + R"(
 out vec4 fragment_color;
-layout (binding = 0) uniform sampler2D background;
-layout (binding = 1) uniform sampler2D bg_layer_mask;
-layout (binding = 2) uniform sampler2D selection_background;
-layout (binding = 3) uniform sampler2D foreground;
-layout (binding = 4) uniform sampler2D input_marker;
-layout (binding = 5) uniform sampler2D frame;
-layout (location = 25) uniform vec2 fg_offset;
-layout (location = 26) uniform vec2 input_marker_offset;
-layout (location = 27) uniform float fg_0_rotation;
-layout (location = 28) uniform vec2 bg_offset;
-layout (location = 29) uniform vec2 frame_offset;
 
 in vec2 uv;
+in vec2 bg_uv;
+in vec2 fg_uv;
+in vec2 input_marker_uv;
+in vec2 frame_uv;
 in vec4 background_tint;
 in vec4 selection_background_tint;
 in vec4 foreground_tint;
 in vec4 input_marker_tint;
 in vec4 frame_tint;
+flat in float fg_rotation;
+flat in float bg_use_color_lut;
+flat in vec2 bg_value_range;
+flat in vec2 bg_image_size;
+flat in float bg_level_curve_interval;
+flat in vec4 bg_level_curve_color;
+flat in uvec2 widget_textures[7];
+
+#ifdef USE_BINDLESS_TEXTURES
+#define widget_texture(k) sampler2D(widget_textures[k])
+#else
+layout (binding = 0) uniform sampler2D textures[TEXTURE_UNIT_COUNT];
+#define widget_texture(k) textures[widget_textures[k].x]
+#endif
 
 vec4 sample_scaled(sampler2D tex, vec2 uv)
 {
@@ -171,14 +501,45 @@ vec4 sample_cropped(sampler2D tex, vec2 uv, float rot_angle)
 	{ return vec4(0.0, 0.0, 0.0, 0.0); }
 }
 
+vec4 sample_color_mapped(sampler2D tex, sampler2D color_lut, vec2 uv)
+{
+	vec2 uv_scaled = uv/bg_image_size;
+	float value = texture(tex, uv_scaled).r;
+
+	// NOTE: Derivatives must be computed before any non-uniform control flow
+	float level = value/max(bg_level_curve_interval, 1.0e-30);
+	float level_width = fwidth(level);
+
+	if(uv_scaled.x < 0.0 || uv_scaled.x > 1.0 || uv_scaled.y < 0.0 || uv_scaled.y > 1.0)
+	{ return vec4(0.0, 0.0, 0.0, 0.0); }
+
+	// Sample at texel centers, and always from the base level, so the LUT is never blurred
+	float lut_size = float(textureSize(color_lut, 0).x);
+	float t = clamp((value - bg_value_range.x)/(bg_value_range.y - bg_value_range.x), 0.0, 1.0);
+	vec4 color = textureLod(color_lut, vec2((t*(lut_size - 1.0) + 0.5)/lut_size, 0.5), 0.0);
+
+	if(bg_level_curve_interval > 0.0)
+	{
+		// Distance to the closest level curve, in pixels, gives an anti-aliased line that is
+		// about one pixel wide at any zoom level
+		float distance = abs(fract(level + 0.5) - 0.5)/max(level_width, 1.0e-6);
+		float coverage = 1.0 - clamp(distance - 0.5, 0.0, 1.0);
+		vec4 curve_color = bg_level_curve_color*coverage;
+		color = curve_color + color*(1.0 - curve_color.w);
+	}
+	return color;
+}
+
 void main()
 {
-	vec4 bg_0 = sample_scaled(background, uv - bg_offset)*background_tint;
-	float bg_mask = sample_cropped(bg_layer_mask, uv - fg_offset, 0.0).r;
-	vec4 bg_1 = sample_scaled(selection_background, uv)*selection_background_tint;
-	vec4 fg_0 = sample_cropped(foreground, uv - fg_offset, fg_0_rotation)*foreground_tint;
-	vec4 fg_1 = sample_cropped(input_marker, uv - input_marker_offset, 0.0)*input_marker_tint;
-	vec4 fg_2 = sample_cropped(frame, uv - frame_offset, 0.0)*frame_tint;
+	vec4 bg_0 = (bg_use_color_lut != 0.0?
+		sample_color_mapped(widget_texture(0), widget_texture(6), bg_uv):
+		sample_scaled(widget_texture(0), bg_uv))*background_tint;
+	float bg_mask = sample_cropped(widget_texture(1), fg_uv, 0.0).r;
+	vec4 bg_1 = sample_scaled(widget_texture(2), uv)*selection_background_tint;
+	vec4 fg_0 = sample_cropped(widget_texture(3), fg_uv, fg_rotation)*foreground_tint;
+	vec4 fg_1 = sample_cropped(widget_texture(4), input_marker_uv, 0.0)*input_marker_tint;
+	vec4 fg_2 = sample_cropped(widget_texture(5), frame_uv, 0.0)*frame_tint;
 
 	// This assumes that pre-multiplied alpha is used
 	vec4 result = bg_1 + bg_0*(1 - bg_1.w*bg_mask);
@@ -187,7 +548,98 @@ void main()
 	result = fg_2 + result*(1 - fg_2.w);
 
 	fragment_color = result;
-})"}
+})";
+
+			return gl_program{
+				gl_shader<GL_VERTEX_SHADER>{vertex_shader.c_str()},
+				gl_shader<GL_FRAGMENT_SHADER>{fragment_shader.c_str()}
+			};
+		}
+
+		bool m_use_bindless_textures;
+		size_t m_texture_unit_count;
+
+		std::vector<gl_widget_instance> m_widgets;
+		std::vector<std::array<main::texture_ref, textures_per_widget>> m_widget_textures;
+		std::vector<deferred_text> m_texts;
+		std::vector<widget_batch> m_batches;
+		std::vector<main::texture_ref> m_batch_textures;
+		std::vector<gl_draw_elements_indirect_command> m_commands;
+		gl_dynamic_buffer<gl_widget_instance> m_widget_buffer;
+		gl_dynamic_buffer<gl_draw_elements_indirect_command> m_command_buffer;
+
+		gl_retained_framebuffer m_retained_framebuffer;
+		GLint m_viewport_width{0};
+		GLint m_viewport_height{0};
+
+		gl_mesh<unsigned int> m_mesh{
+			std::array<unsigned int, 6>{
+				0, 1, 2, 0, 2, 3
+			}
+		};
+
+		gl_program m_program;
+
+		gl_program m_text_program{
+			gl_shader<GL_VERTEX_SHADER>{
+				(std::string{"#version 460 core\n"} + widget_instance_declaration + R"(
+layout (location = 0) in vec2 glyph_location;
+layout (location = 1) in vec2 glyph_size;
+layout (location = 2) in vec2 glyph_atlas_location;
+
+layout (location = 0) uniform uint widget_index;
+layout (location = 3) uniform vec4 world_location;
+layout (location = 4) uniform vec4 world_scale;
+layout (location = 5) uniform vec2 text_offset;
+
+out vec2 uv;
+out vec2 atlas_uv;
+flat out vec2 model_size;
+
+const vec2 corners[4] = vec2[4](
+	vec2(0.0f, 1.0f),
+	vec2(1.0f, 1.0f),
+	vec2(1.0f, 0.0f),
+	vec2(0.0f, 0.0f)
+);
+
+void main()
+{
+	const vec4 world_origin = vec4(0.0, 0.0, 0.0, 1.0);
+	widget_instance widget = widgets[widget_index];
+	vec2 corner = corners[gl_VertexID];
+	vec2 pixel = text_offset + glyph_location + corner*glyph_size;
+
+	// Pixels are counted from the upper left corner of the widget, with y pointing down
+	vec4 upper_left = widget.model_location
+		+ widget.model_size*(vec4(-0.5, 0.5, 0.0, 1.0) - widget.model_origin);
+	vec4 loc = upper_left + vec4(pixel.x, -pixel.y, 0.0, 0.0);
+	gl_Position = world_location + world_scale*(loc - world_origin);
+	uv = pixel;
+	atlas_uv = glyph_atlas_location + corner*glyph_size;
+	model_size = widget.model_size.xy;
+})").c_str()
+			},
+			gl_shader<GL_FRAGMENT_SHADER>{
+				R"(#version 460 core
+out vec4 fragment_color;
+layout (binding = 0) uniform sampler2D glyph_atlas;
+layout (location = 6) uniform vec4 text_tint;
+
+in vec2 uv;
+in vec2 atlas_uv;
+flat in vec2 model_size;
+
+void main()
+{
+	if(uv.x < 0.0 || uv.y < 0.0 || uv.x > model_size.x || uv.y > model_size.y)
+	{ discard; }
+
+	// Glyphs are placed at whole pixels, so there is no need for filtering
+	float coverage = texelFetch(glyph_atlas, ivec2(atlas_uv), 0).r;
+	fragment_color = text_tint*coverage;
+})"
+			}
 		};
 	};
 }
@@ -0,0 +1,62 @@
+#ifndef TERRAFORMER_UI_DRAWING_API_WIDGET_DRAW_SEQUENCE_HPP
+#define TERRAFORMER_UI_DRAWING_API_WIDGET_DRAW_SEQUENCE_HPP
+
+#include <cstddef>
+#include <span>
+
+namespace terraformer::ui::drawing_api
+{
+	/**
+	 * A range of widgets that are drawn using the same set of textures
+	 */
+	struct widget_batch
+	{
+		size_t first_widget;
+		size_t widget_count;
+		size_t first_texture;
+		size_t texture_count;
+	};
+
+	/**
+	 * Splits batches into draw calls, so that the text of a widget is drawn after the widget
+	 * itself, but before any widget recorded after it. texts must be sorted by widget_index.
+	 *
+	 * bind_batch(batch) is called before drawing widgets, since drawing text may change the
+	 * bindings used for widgets. draw_widgets(first, count) draws a range of widgets, and
+	 * draw_text(text) draws one text.
+	 */
+	template<class Text, class BindBatch, class DrawWidgets, class DrawText>
+	void visit_draw_sequence(
+		std::span<widget_batch const> batches,
+		std::span<Text const> texts,
+		BindBatch&& bind_batch,
+		DrawWidgets&& draw_widgets,
+		DrawText&& draw_text
+	)
+	{
+		auto next_text = std::begin(texts);
+		for(auto const& batch : batches)
+		{
+			auto first = batch.first_widget;
+			auto const batch_end = batch.first_widget + batch.widget_count;
+			while(first != batch_end)
+			{
+				auto const run_end = next_text != std::end(texts) && next_text->widget_index < batch_end?
+					static_cast<size_t>(next_text->widget_index) + 1 :
+					batch_end;
+
+				bind_batch(batch);
+				draw_widgets(first, run_end - first);
+				first = run_end;
+
+				while(next_text != std::end(texts) && next_text->widget_index < run_end)
+				{
+					draw_text(*next_text);
+					++next_text;
+				}
+			}
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,123 @@
+//@	{"target":{"name":"widget_draw_sequence.test"}}
+
+#include "./widget_draw_sequence.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <array>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct text_item
+	{
+		size_t widget_index;
+	};
+
+	std::vector<std::string> get_draw_sequence(
+		std::span<terraformer::ui::drawing_api::widget_batch const> batches,
+		std::span<text_item const> texts
+	)
+	{
+		std::vector<std::string> ret;
+		visit_draw_sequence(
+			batches,
+			texts,
+			[&ret](terraformer::ui::drawing_api::widget_batch const& batch) {
+				ret.push_back("bind " + std::to_string(batch.first_texture));
+			},
+			[&ret](size_t first_widget, size_t widget_count) {
+				ret.push_back("widgets " + std::to_string(first_widget) + " " + std::to_string(widget_count));
+			},
+			[&ret](text_item const& text) {
+				ret.push_back("text " + std::to_string(text.widget_index));
+			}
+		);
+		return ret;
+	}
+}
+
+TESTCASE(terraformer_ui_drawing_api_visit_draw_sequence_no_text)
+{
+	std::array const batches{
+		terraformer::ui::drawing_api::widget_batch{
+			.first_widget = 0,
+			.widget_count = 3,
+			.first_texture = 0,
+			.texture_count = 7
+		},
+		terraformer::ui::drawing_api::widget_batch{
+			.first_widget = 3,
+			.widget_count = 2,
+			.first_texture = 7,
+			.texture_count = 5
+		}
+	};
+
+	auto const res = get_draw_sequence(batches, std::span<text_item const>{});
+	std::vector<std::string> const expected{
+		"bind 0",
+		"widgets 0 3",
+		"bind 7",
+		"widgets 3 2"
+	};
+	EXPECT_EQ(res == expected, true);
+}
+
+TESTCASE(terraformer_ui_drawing_api_visit_draw_sequence_widget_overlapping_label)
+{
+	// Widget 1 has a label, and widget 2 is recorded after it, so it is drawn on top of the label
+	std::array const batches{
+		terraformer::ui::drawing_api::widget_batch{
+			.first_widget = 0,
+			.widget_count = 3,
+			.first_texture = 0,
+			.texture_count = 7
+		}
+	};
+	std::array const texts{text_item{1}};
+
+	auto const res = get_draw_sequence(batches, texts);
+	std::vector<std::string> const expected{
+		"bind 0",
+		"widgets 0 2",
+		"text 1",
+		"bind 0",
+		"widgets 2 1"
+	};
+	EXPECT_EQ(res == expected, true);
+}
+
+TESTCASE(terraformer_ui_drawing_api_visit_draw_sequence_text_in_several_batches)
+{
+	std::array const batches{
+		terraformer::ui::drawing_api::widget_batch{
+			.first_widget = 0,
+			.widget_count = 2,
+			.first_texture = 0,
+			.texture_count = 7
+		},
+		terraformer::ui::drawing_api::widget_batch{
+			.first_widget = 2,
+			.widget_count = 3,
+			.first_texture = 7,
+			.texture_count = 6
+		}
+	};
+	std::array const texts{text_item{1}, text_item{2}, text_item{4}};
+
+	auto const res = get_draw_sequence(batches, texts);
+	std::vector<std::string> const expected{
+		"bind 0",
+		"widgets 0 2",
+		"text 1",
+		"bind 7",
+		"widgets 2 1",
+		"text 2",
+		"bind 7",
+		"widgets 3 2",
+		"text 4"
+	};
+	EXPECT_EQ(res == expected, true);
+}
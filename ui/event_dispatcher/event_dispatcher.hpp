@@ -2,15 +2,19 @@
 #define TERRAFORMER_UI_MAIN_EVENT_DISPATCHER_HPP
 
 #include "ui/main/widget.hpp"
+#include "ui/main/damage_list.hpp"
 #include "ui/main/events.hpp"
 #include "ui/main/widget_collection.hpp"
 #include "ui/main/flat_widget_collection.hpp"
+#include "ui/main/hit_test_index.hpp"
 #include "ui/main/window_ref.hpp"
 #include "ui/main/ui_controller.hpp"
 #include "ui/main/widget_frame.hpp"
 
 #include "lib/common/value_accessor.hpp"
 
+#include <algorithm>
+
 // TODO (Event routing):
 // Signal that cursor is above the same widget the cursor hit
 // Cursor leave/enter is triggered when mouse button is lefted
@@ -69,12 +73,28 @@ namespace terraformer::ui::main
 			m_root_collection.clear();
 			m_root_collection.append(root, widget_geometry{});
 			main::theme_updated(m_root_collection, m_config);
+			request_full_redraw();
 		}
 
 		void iterators_invalidated(widget_collection const& src)
 		{
 			if(&src == &m_root_collection)
 			{ m_update_flat_collection = true; }
+			// The index refers to the widget collections of the tree
+			m_hit_test_index_is_valid = false;
+			request_full_redraw();
+		}
+
+		/**
+		 * Makes the next frame redraw all widgets, after the layout has been updated. Changes to
+		 * widgets made outside of event handlers, like from a posted event, must be followed by a
+		 * call to this function. Since such changes may affect the size of any widget, all size
+		 * requests are computed again.
+		 */
+		void request_full_redraw()
+		{
+			m_redraw_everything = true;
+			m_size_requests_are_dirty = true;
 		}
 
 		template<class Tag>
@@ -84,12 +104,13 @@ namespace terraformer::ui::main
 		template<class Tag>
 		void handle_event(Tag, window_ref window, mouse_button_event&& event)
 		{
-			auto const res = find_recursive(event.where, m_root_collection);
+			auto const res = find_widget_at(event.where);
 
 			if(event.action == mouse_button_action::press)
 			{
 				auto new_keyboard_widget = flat_widget_collection::npos;
 				try_dispatch(event, res, window, ui_controller{*this});
+				damage_siblings_of(res);
 
 				if(!res.empty() && res.state().accepts_keyboard_input())
 				{
@@ -107,17 +128,26 @@ namespace terraformer::ui::main
 				try_dispatch(event, m_mouse_widget, window, ui_controller{*this});
 				if(m_mouse_widget != res)
 				{ try_dispatch(cursor_leave_event{}, m_mouse_widget, window, ui_controller{*this}); }
+				damage_siblings_of(m_mouse_widget);
 				m_mouse_widget = find_recursive_result{};
 			}
+			m_damage_is_known = true;
 		}
 
 		template<class Tag>
 		void handle_event(Tag, window_ref window, cursor_motion_event&& event)
 		{
 			if(try_dispatch(event, m_mouse_widget, window, ui_controller{*this}))
-			{ return; }
+			{
+				// The widget is being dragged, which may affect other widgets as well
+				damage_siblings_of(m_mouse_widget);
+				m_damage_is_known = true;
+				return;
+			}
 
-			auto const res = find_recursive(event.where, m_root_collection);
+			// Without any mouse button pressed, the cursor may only change the appearance of the
+			// widgets it enters, leaves, or moves within. Thus, the damage is known.
+			auto const res = find_widget_at(event.where);
 
 			if(res != m_hot_widget)
 			{
@@ -127,10 +157,13 @@ namespace terraformer::ui::main
 				if(!try_dispatch(cursor_enter_event{.where = event.where}, res, window, ui_controller{*this}))
 				{ printf("cursor entered the void\n"); }
 
+				damage(m_hot_widget);
 				m_hot_widget = res;
 			}
 
 			try_dispatch(event, res, window, ui_controller{*this});
+			damage(res);
+			m_damage_is_known = true;
 		}
 
 		template<class Tag>
@@ -169,9 +202,11 @@ namespace terraformer::ui::main
 			{
 				if(!try_dispatch(event, m_flat_collection.attributes(), next_widget, window, ui_controller{*this}))
 				{ printf("kbe in the void\n"); }
+				damage_siblings_of(next_widget);
 			}
 			else
 			{ set_keyboard_focus(next_widget, window); }
+			m_damage_is_known = true;
 		}
 
 		template<class Tag>
@@ -179,6 +214,8 @@ namespace terraformer::ui::main
 		{
 			if(!try_dispatch(event, m_flat_collection.attributes(), m_keyboard_widget, window, ui_controller{*this}))
 			{ printf("%08x\n", event.codepoint); }
+			damage_siblings_of(m_keyboard_widget);
+			m_damage_is_known = true;
 		}
 
 
@@ -211,13 +248,14 @@ namespace terraformer::ui::main
 				.set_viewport(0, 0, size.width, size.height)
 				.set_world_transform(location{-1.0f, 1.0f, 0.0f}, size);
 			m_current_size = size;
+			// Size requests do not depend on the window size, so they remain valid
+			m_redraw_everything = true;
 			// TODO: Should update size here as well
 		}
 
 		template<class Viewport, class GraphicsBackend, class ... Overlay>
 		bool operator()(Viewport&& viewport, GraphicsBackend& backend, Overlay&&... overlay)
 		{
-			value_of(m_content_renderer).clear_buffers();
 			render(backend);
 			(...,overlay());
 			value_of(viewport).swap_buffers();
@@ -242,6 +280,8 @@ namespace terraformer::ui::main
 
 			try_dispatch(keyboard_focus_leave_event{}, m_flat_collection.attributes(), m_keyboard_widget, window, ui_controller{*this});
 
+			damage_siblings_of(m_keyboard_widget);
+			damage_siblings_of(new_widget);
 			m_keyboard_widget = new_widget;
 		}
 
@@ -249,47 +289,174 @@ namespace terraformer::ui::main
 		{
 			main::theme_updated(m_root_collection, new_config);
 			m_config = std::move(new_config);
+			request_full_redraw();
 		}
 
+		/**
+		 * Draws the widgets into the retained framebuffer of the content renderer, and then the
+		 * focus indicators on top. If the damage since the previous frame is known, and did not
+		 * change the layout, only the widgets that need it are prepared for presentation again, and
+		 * only the damaged regions are redrawn. Otherwise, all widgets are redrawn.
+		 */
 		template<class GraphicsBackend>
 		void render(GraphicsBackend& backend)
 		{
+			auto& content_renderer = value_of(m_content_renderer);
+			if(!content_renderer.begin_redraw() || !m_damage_is_known)
+			{ m_redraw_everything = true; }
+
+			if(!m_redraw_everything && m_layout_is_dirty && update_layout_of_tree())
+			{ m_redraw_everything = true; }
+
+			auto const glyph_atlas_resets = glyph_atlas_reset_count();
+			if(m_redraw_everything)
+			{ redraw_everything(backend); }
+			else
+			{ redraw_damaged_regions(backend); }
+
+			// If the glyph atlas was reset while widgets were prepared for presentation, glyph quads
+			// of widgets prepared before the reset, or not prepared at all, refer to removed glyphs.
+			// All widgets must then generate their quads again.
+			if(glyph_atlas_reset_count() != glyph_atlas_resets) [[unlikely]]
+			{ redraw_everything(backend); }
+
+			content_renderer.end_redraw();
+			m_damage.clear();
+			m_damage_is_known = false;
+			m_layout_is_dirty = false;
+			m_redraw_everything = false;
+
+			show_focus_indicators(backend);
+		}
+
+		void update_flat_widget_collection()
+		{
+			if(m_update_flat_collection) [[unlikely]]
 			{
-				// TODO: Pick width/height based on window size
-				auto ui_size = run(
-					minimize_cell_size_context{
-						m_root_collection.get_attributes(), m_root_collection.element_indices().front()
-					}
-				);
+				m_flat_collection = flatten(std::as_const(m_root_collection).get_attributes());
+				m_update_flat_collection = false;
+			}
+		}
 
-				ui_size = run(
-					adjust_cell_sizes_context{
-						m_root_collection.get_attributes(), m_root_collection.element_indices().front()
-					},
-					box_size{
-						static_cast<float>(m_current_size.width),
-						static_cast<float>(m_current_size.height),
-						0.0f
-					}
-				);
+	private:
+		/**
+		 * Finds the widget at pos. Until the hit test index has been rebuilt after a change of the
+		 * widget tree, the tree is searched directly.
+		 */
+		find_recursive_result find_widget_at(cursor_position pos)
+		{
+			if(m_hit_test_index_is_valid)
+			{ return m_hit_test_index.find(pos); }
+			return find_recursive(pos, m_root_collection.get_attributes());
+		}
 
-				ui_size = run(
-					confirm_widget_size_context{
+		/**
+		 * Makes the next frame redraw widget, its siblings, and their parent. Since an event handler
+		 * may change any of them, their size requests, and those of the ancestors of widget, are
+		 * computed again. If that changes the layout, all widgets are redrawn.
+		 */
+		void damage_siblings_of(find_recursive_result const& widget)
+		{
+			if(!widget.empty())
+			{ damage_siblings_of(widget.pointer()); }
+		}
+
+		void damage_siblings_of(flat_widget_collection::index_type widget)
+		{
+			if(widget.within(m_flat_collection.element_indices()))
+			{ damage_siblings_of(m_flat_collection.attributes().widget_pointers()[widget]); }
+		}
+
+		void damage_siblings_of(void const* widget)
+		{
+			auto const widgets = m_root_collection.get_attributes();
+			invalidate_size_requests_of_siblings(widgets, widget);
+			if(auto const region = mark_siblings_for_redraw(widgets, widget); region.has_value())
+			{ m_damage.add(*region); }
+			m_layout_is_dirty = true;
+		}
+
+		/**
+		 * Updates the layout of all widgets. Returns true if the geometry of any widget changed.
+		 */
+		bool update_layout_of_tree()
+		{
+			auto const widgets = m_root_collection.get_attributes();
+			single_array<widget_geometry> old_geometries;
+			collect_geometries(widgets, old_geometries);
+
+			// TODO: Pick width/height based on window size
+			auto const ui_size = update_layout(
+				widgets,
+				m_root_collection.element_indices().front(),
+				box_size{
+					static_cast<float>(m_current_size.width),
+					static_cast<float>(m_current_size.height),
+					0.0f
+				}
+			);
+
+			widgets.widget_geometries().front() = widget_geometry{
+				.where = location{0.0f, 0.0f, 0.0f},
+				.origin = location{-1.0f, 1.0f, 0.0f},
+				.size = ui_size
+			};
+
+			single_array<widget_geometry> new_geometries;
+			new_geometries.reserve(old_geometries.size());
+			collect_geometries(widgets, new_geometries);
+			return !std::ranges::equal(old_geometries, new_geometries);
+		}
+
+		size_t glyph_atlas_reset_count() const
+		{
+			auto const& atlas = m_config.misc_textures.glyph_atlas;
+			return atlas != nullptr? atlas->atlas().reset_count() : 0;
+		}
+
+		void damage(find_recursive_result const& widget)
+		{
+			if(widget.empty())
+			{ return; }
+
+			mark_for_redraw(m_root_collection.get_attributes(), widget.pointer());
+			m_damage.add(bounding_region(widget.geometry(), widget.geometric_offset()));
+		}
+
+		template<class GraphicsBackend>
+		void redraw_damaged_regions(GraphicsBackend& backend)
+		{
+			prepare_dirty_widgets_for_presentation(m_root_collection.get_attributes(), backend);
+
+			auto& content_renderer = value_of(m_content_renderer);
+			for(auto const& region : m_damage.regions())
+			{
+				content_renderer.set_redraw_region(region);
+				run(
+					show_widget_context{
 						m_root_collection.get_attributes(), m_root_collection.element_indices().front()
 					},
-					ui_size
+					std::ref(m_content_renderer),
+					region
 				);
+				content_renderer.flush();
+			}
+		}
 
-				run(
-					update_widget_location_context{
-						m_root_collection.get_attributes(), m_root_collection.element_indices().front()
-				});
+		template<class GraphicsBackend>
+		void redraw_everything(GraphicsBackend& backend)
+		{
+			{
+				if(m_size_requests_are_dirty)
+				{
+					invalidate_size_requests(m_root_collection.get_attributes());
+					m_size_requests_are_dirty = false;
+				}
 
-				m_root_collection.get_attributes().widget_geometries().front() = widget_geometry{
-					.where = location{0.0f, 0.0f, 0.0f},
-					.origin = location{-1.0f, 1.0f, 0.0f},
-					.size = ui_size
-				};
+				update_layout_of_tree();
+
+				m_hit_test_index = hit_test_index{m_root_collection.get_attributes()};
+				m_hit_test_index_is_valid = true;
 
 				m_root_collection.get_attributes().widget_layer_stacks().front() = run(
 					prepare_for_presentation_context{
@@ -297,17 +464,27 @@ namespace terraformer::ui::main
 					},
 					backend
 				);
+
+				auto& root_state = m_root_collection.get_attributes().widget_states().front();
+				root_state.needs_redraw = false;
+				root_state.subtree_needs_redraw = false;
 			}
 
 			{
+				value_of(m_content_renderer).set_redraw_region(whole_window(m_current_size));
 				run(
 					show_widget_context{
 						m_root_collection.get_attributes(), m_root_collection.element_indices().front()
 					},
 					std::ref(m_content_renderer)
 				);
+				value_of(m_content_renderer).flush();
 			}
+		}
 
+		template<class GraphicsBackend>
+		void show_focus_indicators(GraphicsBackend& backend)
+		{
 			if(m_hot_widget != find_recursive_result{}
 				&& m_hot_widget.state().has_cursor_focus_indicator())
 			{
@@ -381,16 +558,6 @@ namespace terraformer::ui::main
 			}
 		}
 
-		void update_flat_widget_collection()
-		{
-			if(m_update_flat_collection) [[unlikely]]
-			{
-				m_flat_collection = flatten(std::as_const(m_root_collection).get_attributes());
-				m_update_flat_collection = false;
-			}
-		}
-
-	private:
 		config m_config;
 		WindowController m_window_controller;
 		ContentRenderer m_content_renderer;
@@ -405,7 +572,14 @@ namespace terraformer::ui::main
 		widget_collection m_root_collection;
 		flat_widget_collection m_flat_collection;
 		bool m_update_flat_collection{false};
-		fb_size m_current_size;
+		hit_test_index m_hit_test_index;
+		bool m_hit_test_index_is_valid{false};
+		fb_size m_current_size{};
+		damage_list m_damage;
+		bool m_damage_is_known{false};
+		bool m_layout_is_dirty{false};
+		bool m_redraw_everything{true};
+		bool m_size_requests_are_dirty{true};
 	};
 
 	template<class Cfg, class Wc, class Cr, class Fr, class Eh>
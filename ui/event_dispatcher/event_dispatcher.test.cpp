@@ -2,4 +2,588 @@
 
 #include "./event_dispatcher.hpp"
 
-#include <testfwk/testfwk.hpp>
\ No newline at end of file
+#include <testfwk/testfwk.hpp>
+
+#include <vector>
+
+namespace
+{
+	struct dummy_texture
+	{
+		explicit dummy_texture(terraformer::span_2d<terraformer::rgba_pixel const>){}
+
+		explicit dummy_texture(terraformer::span_2d<float const>){}
+
+		void upload(terraformer::span_2d<terraformer::rgba_pixel const>) {}
+		void upload(terraformer::span_2d<float const>) {}
+		void bind(int){};
+	};
+
+	struct dummy_glyph_quad_buffer
+	{
+		explicit dummy_glyph_quad_buffer(std::span<terraformer::ui::font_handling::glyph_quad const>){}
+
+		void upload(std::span<terraformer::ui::font_handling::glyph_quad const>){}
+
+		void bind(){}
+
+		size_t size() const
+		{ return 0; }
+	};
+
+	struct dummy_backend
+	{
+		constexpr uint64_t get_global_id() const
+		{ return 124; }
+
+		auto create(
+			std::type_identity<terraformer::ui::main::texture>,
+			uint64_t backend_id,
+			terraformer::image const& img
+		)
+		{
+			return terraformer::ui::main::texture{std::in_place_type_t<dummy_texture>{}, backend_id, img};
+		}
+
+		auto create(
+			std::type_identity<terraformer::ui::main::texture>,
+			uint64_t backend_id,
+			terraformer::grayscale_image const& img
+		)
+		{
+			return terraformer::ui::main::texture{std::in_place_type_t<dummy_texture>{}, backend_id, img};
+		}
+
+		auto create(
+			std::type_identity<terraformer::ui::main::glyph_quad_buffer>,
+			uint64_t backend_id,
+			std::span<terraformer::ui::font_handling::glyph_quad const> quads
+		)
+		{
+			return terraformer::ui::main::glyph_quad_buffer{
+				std::in_place_type_t<dummy_glyph_quad_buffer>{},
+				backend_id,
+				quads
+			};
+		}
+	};
+
+	struct leaf_widget : terraformer::ui::main::widget_with_default_actions
+	{
+		using widget_with_default_actions::handle_event;
+
+		size_t prepare_count{0};
+		size_t enter_count{0};
+		size_t leave_count{0};
+		size_t compute_size_count{0};
+		size_t mbe_count{0};
+		float width{10.0f};
+		// A widget that is made wider when this widget is clicked
+		leaf_widget* linked_widget{nullptr};
+
+		terraformer::ui::main::widget_layer_stack prepare_for_presentation(terraformer::ui::main::graphics_backend_ref)
+		{
+			++prepare_count;
+			return terraformer::ui::main::widget_layer_stack{};
+		}
+
+		void handle_event(
+			terraformer::ui::main::cursor_enter_event const&,
+			terraformer::ui::main::window_ref,
+			terraformer::ui::main::ui_controller
+		)
+		{ ++enter_count; }
+
+		void handle_event(
+			terraformer::ui::main::cursor_leave_event const&,
+			terraformer::ui::main::window_ref,
+			terraformer::ui::main::ui_controller
+		)
+		{ ++leave_count; }
+
+		void handle_event(
+			terraformer::ui::main::mouse_button_event const&,
+			terraformer::ui::main::window_ref,
+			terraformer::ui::main::ui_controller
+		)
+		{
+			++mbe_count;
+			if(linked_widget != nullptr)
+			{ linked_widget->width += 10.0f; }
+		}
+
+		terraformer::box_size compute_size(terraformer::ui::main::widget_width_request)
+		{
+			++compute_size_count;
+			return terraformer::box_size{width, 10.0f, 0.0f};
+		}
+
+		terraformer::box_size compute_size(terraformer::ui::main::widget_height_request)
+		{ return terraformer::box_size{width, 10.0f, 0.0f}; }
+	};
+
+	/**
+	 * Puts four cells of size cell_width x 10 from left to right, with 10 pixels between them
+	 */
+	struct row_layout
+	{
+		float cell_width{10.0f};
+
+		void set_default_cell_sizes_to(terraformer::span<terraformer::box_size const>){}
+
+		void adjust_cell_widths(float, terraformer::span<float const>){}
+
+		void adjust_cell_heights(float, terraformer::span<float const>){}
+
+		void get_cell_sizes_into(terraformer::span<terraformer::box_size> sizes_out) const
+		{ std::ranges::fill(sizes_out, terraformer::box_size{cell_width, 10.0f, 0.0f}); }
+
+		void get_cell_locations_into(terraformer::span<terraformer::location> locs_out) const
+		{
+			auto x = 0.0f;
+			for(auto& item : locs_out)
+			{
+				item = terraformer::location{x, 0.0f, 0.0f};
+				x += cell_width + 10.0f;
+			}
+		}
+
+		terraformer::box_size get_dimensions() const
+		{ return terraformer::box_size{4.0f*(cell_width + 10.0f), 10.0f, 0.0f}; }
+	};
+
+	/**
+	 * Has four leaf widgets, laid out by row_layout
+	 */
+	struct container_widget : leaf_widget
+	{
+		template<class Dispatcher>
+		explicit container_widget(Dispatcher& dispatcher):
+			children{terraformer::ui::main::widget_collection::iterator_invalidation_handler_ref{std::ref(dispatcher)}}
+		{
+			// The test config has no textures for drawing focus indicators
+			auto state = terraformer::ui::main::make_default_widget_state<leaf_widget>();
+			state.cursor_focus_indicator_mode = terraformer::ui::main::focus_indicator_mode::always_hidden;
+			for(auto& item : leaves)
+			{ children.append(std::ref(item), terraformer::ui::main::widget_geometry{}, state); }
+		}
+
+		terraformer::ui::main::widget_collection_ref get_children()
+		{ return children.get_attributes(); }
+
+		terraformer::ui::main::widget_collection_view get_children() const
+		{ return children.get_attributes(); }
+
+		terraformer::box_size compute_size(terraformer::ui::main::widget_width_request)
+		{
+			++compute_size_count;
+			return terraformer::box_size{80.0f, 10.0f, 0.0f};
+		}
+
+		terraformer::box_size compute_size(terraformer::ui::main::widget_height_request)
+		{ return terraformer::box_size{80.0f, 10.0f, 0.0f}; }
+
+		terraformer::ui::main::layout_ref get_layout()
+		{ return terraformer::ui::main::layout_ref{layout}; }
+
+		std::array<leaf_widget, 4> leaves;
+		row_layout layout;
+		terraformer::ui::main::widget_collection children;
+	};
+
+	/**
+	 * Has two container widgets, laid out by row_layout
+	 */
+	struct form_widget : leaf_widget
+	{
+		template<class Dispatcher>
+		explicit form_widget(Dispatcher& dispatcher):
+			groups{container_widget{dispatcher}, container_widget{dispatcher}},
+			children{terraformer::ui::main::widget_collection::iterator_invalidation_handler_ref{std::ref(dispatcher)}}
+		{
+			auto state = terraformer::ui::main::make_default_widget_state<container_widget>();
+			state.cursor_focus_indicator_mode = terraformer::ui::main::focus_indicator_mode::always_hidden;
+			for(auto& item : groups)
+			{ children.append(std::ref(item), terraformer::ui::main::widget_geometry{}, state); }
+		}
+
+		terraformer::ui::main::widget_collection_ref get_children()
+		{ return children.get_attributes(); }
+
+		terraformer::ui::main::widget_collection_view get_children() const
+		{ return children.get_attributes(); }
+
+		terraformer::ui::main::layout_ref get_layout()
+		{ return terraformer::ui::main::layout_ref{layout}; }
+
+		std::array<container_widget, 2> groups;
+		row_layout layout{.cell_width = 80.0f};
+		terraformer::ui::main::widget_collection children;
+	};
+
+	struct recording_renderer
+	{
+		bool content_is_kept{true};
+		std::vector<terraformer::ui::main::damaged_region> regions;
+		std::vector<terraformer::location> widgets;
+		size_t frame_count{0};
+
+		bool begin_redraw()
+		{
+			regions.clear();
+			widgets.clear();
+			return content_is_kept;
+		}
+
+		recording_renderer& set_redraw_region(terraformer::ui::main::damaged_region const& region)
+		{
+			regions.push_back(region);
+			return *this;
+		}
+
+		recording_renderer& end_redraw()
+		{
+			++frame_count;
+			return *this;
+		}
+
+		recording_renderer& set_viewport(int, int, int, int)
+		{ return *this; }
+
+		recording_renderer& set_world_transform(terraformer::location, terraformer::ui::main::fb_size)
+		{ return *this; }
+
+		void render(
+			terraformer::location where,
+			terraformer::location,
+			terraformer::scaling,
+			terraformer::ui::main::widget_layer_stack const&
+		)
+		{ widgets.push_back(where); }
+
+		template<class ... Args>
+		void render(terraformer::location, terraformer::location, terraformer::scaling, Args&&...)
+		{ }
+
+		void flush(){}
+	};
+
+	struct dummy_window_controller
+	{
+		template<class Tag, class Event>
+		void handle_event(Tag, Event const&){}
+	};
+
+	struct dummy_error_handler
+	{
+		template<class Tag>
+		void handle_event(Tag, terraformer::ui::main::error_message const&){}
+	};
+
+	struct dummy_window{};
+
+	using test_dispatcher = terraformer::ui::main::event_dispatcher<
+		dummy_window_controller,
+		std::reference_wrapper<recording_renderer>,
+		recording_renderer,
+		dummy_error_handler
+	>;
+
+	test_dispatcher make_dispatcher(recording_renderer& renderer)
+	{
+		return test_dispatcher{
+			terraformer::ui::main::config{},
+			dummy_window_controller{},
+			std::ref(renderer),
+			recording_renderer{},
+			dummy_error_handler{}
+		};
+	}
+}
+
+template<>
+struct terraformer::ui::main::window_traits<dummy_window>
+{
+	static void set_title(dummy_window&, std::u8string_view){}
+
+	static void set_clipboard_string(dummy_window&, std::u8string_view){}
+
+	static std::u8string get_clipboard_string(dummy_window const&)
+	{ return std::u8string{}; }
+};
+
+TESTCASE(terraformer_ui_main_event_dispatcher_hover_redraws_damaged_widgets_only)
+{
+	recording_renderer renderer;
+	auto dispatcher = make_dispatcher(renderer);
+	container_widget root{dispatcher};
+	dispatcher.set_root_widget(std::ref(root));
+	dummy_backend backend;
+	terraformer::ui::main::graphics_backend_ref backend_ref{backend};
+	dummy_window window;
+	terraformer::ui::main::window_ref window_ref{window};
+
+	dispatcher.handle_event(0, window_ref, terraformer::ui::main::fb_size{.width = 100, .height = 50});
+	dispatcher.render(backend_ref);
+
+	// The first frame redraws everything
+	REQUIRE_EQ(std::size(renderer.regions), 1);
+	EXPECT_EQ(renderer.regions[0], terraformer::ui::main::whole_window(terraformer::ui::main::fb_size{100, 50}));
+	EXPECT_EQ(std::size(renderer.widgets), 5);
+	EXPECT_EQ(root.prepare_count, 1);
+	for(auto const& item : root.leaves)
+	{ EXPECT_EQ(item.prepare_count, 1); }
+
+	// Move the cursor to the second leaf
+	dispatcher.handle_event(
+		0,
+		window_ref,
+		terraformer::ui::main::cursor_motion_event{
+			.where = terraformer::ui::main::cursor_position{25.0, -5.0}
+		}
+	);
+	EXPECT_EQ(root.leaves[1].enter_count, 1);
+	dispatcher.render(backend_ref);
+
+	REQUIRE_EQ(std::size(renderer.regions), 1);
+	EXPECT_EQ(
+		renderer.regions[0],
+		(terraformer::ui::main::damaged_region{
+			.left = 20.0f,
+			.bottom = -10.0f,
+			.right = 30.0f,
+			.top = 0.0f
+		})
+	);
+	// The root is drawn as the background of the damaged leaf
+	REQUIRE_EQ(std::size(renderer.widgets), 2);
+	EXPECT_EQ(renderer.widgets[1], (terraformer::location{20.0f, 0.0f, 0.0f}));
+	EXPECT_EQ(root.prepare_count, 1);
+	EXPECT_EQ(root.leaves[0].prepare_count, 1);
+	EXPECT_EQ(root.leaves[1].prepare_count, 2);
+	EXPECT_EQ(root.leaves[2].prepare_count, 1);
+	EXPECT_EQ(root.leaves[3].prepare_count, 1);
+
+	// Move the cursor to the fourth leaf. Both the leaf that the cursor left and the leaf it
+	// entered are redrawn.
+	dispatcher.handle_event(
+		0,
+		window_ref,
+		terraformer::ui::main::cursor_motion_event{
+			.where = terraformer::ui::main::cursor_position{65.0, -5.0}
+		}
+	);
+	EXPECT_EQ(root.leaves[1].leave_count, 1);
+	EXPECT_EQ(root.leaves[3].enter_count, 1);
+	dispatcher.render(backend_ref);
+
+	REQUIRE_EQ(std::size(renderer.regions), 2);
+	EXPECT_EQ(renderer.regions[0].left, 20.0f);
+	EXPECT_EQ(renderer.regions[1].left, 60.0f);
+	EXPECT_EQ(std::size(renderer.widgets), 4);
+	EXPECT_EQ(root.prepare_count, 1);
+	EXPECT_EQ(root.leaves[0].prepare_count, 1);
+	EXPECT_EQ(root.leaves[1].prepare_count, 3);
+	EXPECT_EQ(root.leaves[2].prepare_count, 1);
+	EXPECT_EQ(root.leaves[3].prepare_count, 2);
+}
+
+TESTCASE(terraformer_ui_main_event_dispatcher_redraws_everything_without_known_damage)
+{
+	recording_renderer renderer;
+	auto dispatcher = make_dispatcher(renderer);
+	container_widget root{dispatcher};
+	dispatcher.set_root_widget(std::ref(root));
+	dummy_backend backend;
+	terraformer::ui::main::graphics_backend_ref backend_ref{backend};
+	dummy_window window;
+	terraformer::ui::main::window_ref window_ref{window};
+
+	dispatcher.handle_event(0, window_ref, terraformer::ui::main::fb_size{.width = 100, .height = 50});
+	dispatcher.render(backend_ref);
+	EXPECT_EQ(root.prepare_count, 1);
+
+	// Nothing is known about what happened since the previous frame, for example if a posted
+	// event has changed a widget
+	dispatcher.render(backend_ref);
+	REQUIRE_EQ(std::size(renderer.regions), 1);
+	EXPECT_EQ(std::size(renderer.widgets), 5);
+	EXPECT_EQ(root.prepare_count, 2);
+
+	// A full redraw is also needed if the content renderer lost the previous frame
+	dispatcher.handle_event(
+		0,
+		window_ref,
+		terraformer::ui::main::cursor_motion_event{
+			.where = terraformer::ui::main::cursor_position{25.0, -5.0}
+		}
+	);
+	renderer.content_is_kept = false;
+	dispatcher.render(backend_ref);
+	EXPECT_EQ(std::size(renderer.widgets), 5);
+	EXPECT_EQ(root.prepare_count, 3);
+
+	renderer.content_is_kept = true;
+	dispatcher.handle_event(
+		0,
+		window_ref,
+		terraformer::ui::main::cursor_motion_event{
+			.where = terraformer::ui::main::cursor_position{26.0, -5.0}
+		}
+	);
+	dispatcher.request_full_redraw();
+	dispatcher.render(backend_ref);
+	EXPECT_EQ(std::size(renderer.widgets), 5);
+	EXPECT_EQ(root.prepare_count, 4);
+}
+
+TESTCASE(terraformer_ui_main_event_dispatcher_recomputes_dirty_size_requests_only)
+{
+	recording_renderer renderer;
+	auto dispatcher = make_dispatcher(renderer);
+	container_widget root{dispatcher};
+	dispatcher.set_root_widget(std::ref(root));
+	dummy_backend backend;
+	terraformer::ui::main::graphics_backend_ref backend_ref{backend};
+	dummy_window window;
+	terraformer::ui::main::window_ref window_ref{window};
+
+	dispatcher.handle_event(0, window_ref, terraformer::ui::main::fb_size{.width = 100, .height = 50});
+	dispatcher.render(backend_ref);
+	EXPECT_EQ(root.compute_size_count, 1);
+	for(auto const& item : root.leaves)
+	{ EXPECT_EQ(item.compute_size_count, 1); }
+
+	// Clicking on the third leaf may change its size, the size of its siblings, and therefore the
+	// size of the root
+	dispatcher.handle_event(
+		0,
+		window_ref,
+		terraformer::ui::main::mouse_button_event{
+			.where = terraformer::ui::main::cursor_position{45.0, -5.0},
+			.button = 0,
+			.action = terraformer::ui::main::mouse_button_action::press,
+			.modifiers = terraformer::ui::main::modifier_keys::none
+		}
+	);
+	EXPECT_EQ(root.leaves[2].mbe_count, 1);
+	dispatcher.render(backend_ref);
+	EXPECT_EQ(root.compute_size_count, 2);
+	for(auto const& item : root.leaves)
+	{ EXPECT_EQ(item.compute_size_count, 2); }
+
+	// Resizing the window does not affect size requests
+	dispatcher.handle_event(0, window_ref, terraformer::ui::main::fb_size{.width = 200, .height = 50});
+	dispatcher.render(backend_ref);
+	EXPECT_EQ(root.compute_size_count, 2);
+	for(auto const& item : root.leaves)
+	{ EXPECT_EQ(item.compute_size_count, 2); }
+
+	// After a change made outside of the event handlers, everything is computed again
+	dispatcher.request_full_redraw();
+	dispatcher.render(backend_ref);
+	EXPECT_EQ(root.compute_size_count, 3);
+	for(auto const& item : root.leaves)
+	{ EXPECT_EQ(item.compute_size_count, 3); }
+}
+
+TESTCASE(terraformer_ui_main_event_dispatcher_click_redraws_siblings_only)
+{
+	recording_renderer renderer;
+	auto dispatcher = make_dispatcher(renderer);
+	form_widget root{dispatcher};
+	dispatcher.set_root_widget(std::ref(root));
+	dummy_backend backend;
+	terraformer::ui::main::graphics_backend_ref backend_ref{backend};
+	dummy_window window;
+	terraformer::ui::main::window_ref window_ref{window};
+
+	dispatcher.handle_event(0, window_ref, terraformer::ui::main::fb_size{.width = 200, .height = 50});
+	dispatcher.render(backend_ref);
+
+	// Clicking on the third leaf of the second group does not change the layout, so only the
+	// second group, and its leaves, are redrawn
+	dispatcher.handle_event(
+		0,
+		window_ref,
+		terraformer::ui::main::mouse_button_event{
+			.where = terraformer::ui::main::cursor_position{135.0, -5.0},
+			.button = 0,
+			.action = terraformer::ui::main::mouse_button_action::press,
+			.modifiers = terraformer::ui::main::modifier_keys::none
+		}
+	);
+	dispatcher.render(backend_ref);
+	REQUIRE_EQ(std::size(renderer.regions), 1);
+	EXPECT_EQ(
+		renderer.regions[0],
+		(terraformer::ui::main::damaged_region{
+			.left = 90.0f,
+			.bottom = -10.0f,
+			.right = 170.0f,
+			.top = 0.0f
+		})
+	);
+
+	EXPECT_EQ(root.prepare_count, 1);
+	EXPECT_EQ(root.groups[0].prepare_count, 1);
+	for(auto const& item : root.groups[0].leaves)
+	{ EXPECT_EQ(item.prepare_count, 1); }
+	EXPECT_EQ(root.groups[1].prepare_count, 2);
+	for(auto const& item : root.groups[1].leaves)
+	{ EXPECT_EQ(item.prepare_count, 2); }
+
+	// The size requests of the other group are still valid
+	EXPECT_EQ(root.compute_size_count, 2);
+	EXPECT_EQ(root.groups[0].compute_size_count, 1);
+	EXPECT_EQ(root.groups[1].compute_size_count, 2);
+}
+
+TESTCASE(terraformer_ui_main_event_dispatcher_handler_changes_size_of_sibling)
+{
+	recording_renderer renderer;
+	auto dispatcher = make_dispatcher(renderer);
+	form_widget root{dispatcher};
+	auto& group = root.groups[1];
+	group.leaves[2].linked_widget = &group.leaves[3];
+	dispatcher.set_root_widget(std::ref(root));
+	dummy_backend backend;
+	terraformer::ui::main::graphics_backend_ref backend_ref{backend};
+	dummy_window window;
+	terraformer::ui::main::window_ref window_ref{window};
+
+	dispatcher.handle_event(0, window_ref, terraformer::ui::main::fb_size{.width = 200, .height = 50});
+	dispatcher.render(backend_ref);
+	EXPECT_EQ(group.children.get_attributes().size_requests().back().value, (terraformer::box_size{10.0f, 10.0f, 0.0f}));
+
+	// Clicking on the third leaf of the second group makes the fourth leaf wider
+	dispatcher.handle_event(
+		0,
+		window_ref,
+		terraformer::ui::main::mouse_button_event{
+			.where = terraformer::ui::main::cursor_position{135.0, -5.0},
+			.button = 0,
+			.action = terraformer::ui::main::mouse_button_action::press,
+			.modifiers = terraformer::ui::main::modifier_keys::none
+		}
+	);
+	EXPECT_EQ(group.leaves[2].mbe_count, 1);
+	dispatcher.render(backend_ref);
+	EXPECT_EQ(group.children.get_attributes().size_requests().back().value, (terraformer::box_size{20.0f, 10.0f, 0.0f}));
+
+	// Since the layout changed, everything is redrawn
+	REQUIRE_EQ(std::size(renderer.regions), 1);
+	EXPECT_EQ(renderer.regions[0], terraformer::ui::main::whole_window(terraformer::ui::main::fb_size{200, 50}));
+	EXPECT_EQ(root.prepare_count, 2);
+	EXPECT_EQ(root.groups[0].prepare_count, 2);
+
+	EXPECT_EQ(root.compute_size_count, 2);
+	EXPECT_EQ(group.compute_size_count, 2);
+	for(auto const& item : group.leaves)
+	{ EXPECT_EQ(item.compute_size_count, 2); }
+
+	// The other group is not affected
+	EXPECT_EQ(root.groups[0].compute_size_count, 1);
+	for(auto const& item : root.groups[0].leaves)
+	{ EXPECT_EQ(item.compute_size_count, 1); }
+}
@@ -0,0 +1,171 @@
+//@	{"target":{"name":"glyph_atlas.o"}}
+
+#include "./glyph_atlas.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+	bool try_make_glyph_quads(
+		terraformer::ui::font_handling::glyph_sequence const& seq,
+		terraformer::ui::font_handling::glyph_atlas& atlas,
+		std::vector<terraformer::ui::font_handling::glyph_quad>& output
+	)
+	{
+		output.clear();
+		output.reserve(seq.glyph_count());
+
+		auto const locations = seq.locations();
+		auto const glyph_indices = seq.glyph_indices();
+		auto const& renderer = *seq.renderer();
+		auto const reset_count = atlas.reset_count();
+		for(auto item : seq.element_indices())
+		{
+			auto const atlas_loc = atlas.get_location(renderer, glyph_indices[item]);
+			if(atlas.reset_count() != reset_count) [[unlikely]]
+			{ return false; }
+
+			if(atlas_loc.width == 0 || atlas_loc.height == 0)
+			{ continue; }
+
+			// NOTE: Round the same way as render does
+			auto const loc = locations[item];
+			output.push_back(
+				terraformer::ui::font_handling::glyph_quad{
+					.x = static_cast<float>(static_cast<uint32_t>(loc[0] + 0.5f)),
+					.y = static_cast<float>(static_cast<uint32_t>(loc[1] + 0.5f)),
+					.width = static_cast<float>(atlas_loc.width),
+					.height = static_cast<float>(atlas_loc.height),
+					.atlas_x = static_cast<float>(atlas_loc.x),
+					.atlas_y = static_cast<float>(atlas_loc.y)
+				}
+			);
+		}
+		return true;
+	}
+}
+
+size_t terraformer::ui::font_handling::glyph_atlas::key_hash::operator()(key_type const& key) const
+{
+	auto ret = std::hash<uint64_t>{}(key.renderer_id);
+	auto const combine = [&ret](size_t value) {
+		ret ^= value + 0x9e3779b97f4a7c15 + (ret << 6) + (ret >> 2);
+	};
+	combine(std::hash<int>{}(key.font_size));
+	combine(std::hash<FT_UInt>{}(static_cast<FT_UInt>(key.index)));
+	return ret;
+}
+
+terraformer::ui::font_handling::glyph_atlas_location
+terraformer::ui::font_handling::glyph_atlas::allocate(uint32_t width, uint32_t height)
+{
+	// Leave one pixel between glyphs, so they do not bleed into each other when the atlas is
+	// sampled with filtering
+	auto const padded_width = width + 1;
+	auto const padded_height = height + 1;
+	if(padded_width > m_pixels.width())
+	{ throw std::runtime_error{"Glyph is wider than the glyph atlas"}; }
+
+	if(m_row_x + padded_width > m_pixels.width())
+	{
+		m_row_y += m_row_height;
+		m_row_x = 0;
+		m_row_height = 0;
+	}
+
+	if(m_row_y + padded_height > m_max_height)
+	{
+		if(m_row_y == 0)
+		{ throw std::runtime_error{"Glyph is taller than the glyph atlas"}; }
+		reset();
+		return allocate(width, height);
+	}
+
+	if(m_row_y + padded_height > m_pixels.height())
+	{
+		auto new_height = std::max(m_pixels.height(), 1u);
+		while(m_row_y + padded_height > new_height)
+		{ new_height *= 2; }
+		new_height = std::min(new_height, m_max_height);
+
+		grayscale_image new_pixels{m_pixels.width(), new_height};
+		auto const old_pixels = m_pixels.pixels();
+		for(uint32_t y = 0; y != old_pixels.height(); ++y)
+		{
+			for(uint32_t x = 0; x != old_pixels.width(); ++x)
+			{ new_pixels(x, y) = old_pixels(x, y); }
+		}
+		m_pixels = std::move(new_pixels);
+	}
+
+	glyph_atlas_location const ret{
+		.x = m_row_x,
+		.y = m_row_y,
+		.width = width,
+		.height = height
+	};
+	m_row_x += padded_width;
+	m_row_height = std::max(m_row_height, padded_height);
+	return ret;
+}
+
+void terraformer::ui::font_handling::glyph_atlas::reset()
+{
+	// Clear the pixels too, since the padding between new glyphs is not written
+	std::ranges::fill(m_pixels.pixels(), 0.0f);
+	m_locations.clear();
+	m_row_x = 0;
+	m_row_y = 0;
+	m_row_height = 0;
+	++m_generation;
+	++m_reset_count;
+}
+
+terraformer::ui::font_handling::glyph_atlas_location
+terraformer::ui::font_handling::glyph_atlas::get_location(
+	glyph_renderer const& renderer,
+	glyph_index index
+)
+{
+	key_type const key{
+		.renderer_id = renderer.get_global_id(),
+		.font_size = renderer.get_font_size(),
+		.index = index
+	};
+
+	if(auto const i = m_locations.find(key); i != std::end(m_locations))
+	{ return i->second; }
+
+	auto const& glyph = renderer.get_glyph(index);
+	auto const glyph_pixels = glyph.image.pixels();
+	auto const ret = allocate(glyph_pixels.width(), glyph_pixels.height());
+	for(uint32_t y = 0; y != ret.height; ++y)
+	{
+		for(uint32_t x = 0; x != ret.width; ++x)
+		{
+			// Apply the same gamma as render, so text looks the same regardless of how it is drawn
+			auto const input = static_cast<float>(glyph_pixels(x, y))/255.0f;
+			m_pixels(ret.x + x, ret.y + y) = 2.0f*input*(1.0f - 0.5f*input);
+		}
+	}
+
+	m_locations.emplace(key, ret);
+	++m_generation;
+	return ret;
+}
+
+void terraformer::ui::font_handling::make_glyph_quads(
+	glyph_sequence const& seq,
+	glyph_atlas& atlas,
+	std::vector<glyph_quad>& output
+)
+{
+	if(try_make_glyph_quads(seq, atlas, output))
+	{ return; }
+
+	// Quads generated before the reset refer to glyphs that have been removed from the atlas.
+	// Since the atlas is now empty, it can only be reset again if the text itself does not fit.
+	if(!try_make_glyph_quads(seq, atlas, output))
+	{ throw std::runtime_error{"Text does not fit in the glyph atlas"}; }
+}
@@ -0,0 +1,126 @@
+//@	{"dependencies_extra":[{"ref":"./glyph_atlas.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_UI_FONT_HANDLING_GLYPH_ATLAS_HPP
+#define TERRAFORMER_UI_FONT_HANDLING_GLYPH_ATLAS_HPP
+
+#include "./text_shaper.hpp"
+
+#include "lib/pixel_store/image.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace terraformer::ui::font_handling
+{
+	/**
+	 * A rectangle within a glyph atlas, in pixels
+	 */
+	struct glyph_atlas_location
+	{
+		uint32_t x;
+		uint32_t y;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	/**
+	 * Stores rendered glyphs of all fonts in a single image, so text can be drawn with one
+	 * texture. Glyphs are packed row by row, and the image grows vertically when it is full.
+	 * Already assigned locations remain valid when the image grows. When the image cannot grow
+	 * beyond max_height, the atlas is reset: all glyphs are removed, and reset_count is
+	 * incremented, so users know that their locations are no longer valid. Pixel values are
+	 * coverage, with the same gamma as used by render.
+	 */
+	class glyph_atlas
+	{
+	public:
+		explicit glyph_atlas(uint32_t width, uint32_t initial_height, uint32_t max_height):
+			m_pixels{width, initial_height},
+			m_max_height{std::max(initial_height, max_height)}
+		{}
+
+		/**
+		 * Returns the location of the glyph with index, as rendered by renderer at its current
+		 * font size. The glyph is added to the atlas if it is not already there.
+		 */
+		glyph_atlas_location get_location(glyph_renderer const& renderer, glyph_index index);
+
+		grayscale_image const& image() const
+		{ return m_pixels; }
+
+		span_2d<float const> pixels() const
+		{ return m_pixels.pixels(); }
+
+		/**
+		 * A number that changes whenever pixels are modified
+		 */
+		size_t generation() const
+		{ return m_generation; }
+
+		size_t glyph_count() const
+		{ return std::size(m_locations); }
+
+		/**
+		 * The number of times the atlas has been reset. Locations obtained before the most recent
+		 * reset must not be used.
+		 */
+		size_t reset_count() const
+		{ return m_reset_count; }
+
+		uint32_t max_height() const
+		{ return m_max_height; }
+
+	private:
+		struct key_type
+		{
+			uint64_t renderer_id;
+			int font_size;
+			glyph_index index;
+
+			bool operator==(key_type const&) const = default;
+		};
+
+		struct key_hash
+		{
+			size_t operator()(key_type const& key) const;
+		};
+
+		glyph_atlas_location allocate(uint32_t width, uint32_t height);
+
+		void reset();
+
+		grayscale_image m_pixels;
+		uint32_t m_max_height;
+		std::unordered_map<key_type, glyph_atlas_location, key_hash> m_locations;
+		uint32_t m_row_x{0};
+		uint32_t m_row_y{0};
+		uint32_t m_row_height{0};
+		size_t m_generation{0};
+		size_t m_reset_count{0};
+	};
+
+	/**
+	 * Describes where to draw one glyph, and where to find it in a glyph_atlas. All values are in
+	 * pixels, and the glyph location is relative to the upper left corner of the text.
+	 */
+	struct glyph_quad
+	{
+		float x;
+		float y;
+		float width;
+		float height;
+		float atlas_x;
+		float atlas_y;
+	};
+
+	/**
+	 * Replaces the contents of output with one quad for every visible glyph in seq, adding the
+	 * glyphs to atlas as needed. Quads are placed at the same pixels as render(seq) would put the
+	 * glyphs. If the atlas is reset while the quads are generated, they are generated again, so
+	 * all quads refer to the current contents of the atlas.
+	 */
+	void make_glyph_quads(glyph_sequence const& seq, glyph_atlas& atlas, std::vector<glyph_quad>& output);
+}
+
+#endif
@@ -0,0 +1,237 @@
+//@	{"target":{"name":"glyph_atlas.test"}}
+
+#include "./glyph_atlas.hpp"
+
+#include "./font_mapper.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <span>
+#include <stdexcept>
+
+namespace
+{
+	auto load_test_font()
+	{
+		terraformer::ui::font_handling::font_mapper fonts;
+		auto const fontfile = fonts.get_path("serif");
+		terraformer::ui::font_handling::font ret{fontfile};
+		ret.set_font_size(16);
+		return ret;
+	}
+
+	terraformer::ui::font_handling::glyph_index get_glyph_index(
+		terraformer::ui::font_handling::font const& the_font,
+		char32_t c
+	)
+	{
+		return terraformer::ui::font_handling::glyph_index{
+			FT_Get_Char_Index(the_font.get_renderer().get_face(), c)
+		};
+	}
+
+	// Draws the quads using the pixels of the atlas, and compares the result with what render
+	// produces
+	void check_quads_match_rendered_text(
+		terraformer::ui::font_handling::glyph_sequence const& seq,
+		terraformer::ui::font_handling::glyph_atlas const& atlas,
+		std::span<terraformer::ui::font_handling::glyph_quad const> quads
+	)
+	{
+		auto const expected = render(seq);
+		terraformer::grayscale_image result{expected.width(), expected.height()};
+		auto const atlas_pixels = atlas.pixels();
+		for(auto const& quad : quads)
+		{
+			for(uint32_t y = 0; y != static_cast<uint32_t>(quad.height); ++y)
+			{
+				for(uint32_t x = 0; x != static_cast<uint32_t>(quad.width); ++x)
+				{
+					auto const x_out = std::min(static_cast<uint32_t>(quad.x) + x, result.width() - 1);
+					auto const y_out = std::min(static_cast<uint32_t>(quad.y) + y, result.height() - 1);
+					auto const val = atlas_pixels(
+						static_cast<uint32_t>(quad.atlas_x) + x,
+						static_cast<uint32_t>(quad.atlas_y) + y
+					);
+					result(x_out, y_out) = std::max(result(x_out, y_out), val);
+				}
+			}
+		}
+
+		for(uint32_t y = 0; y != expected.height(); ++y)
+		{
+			for(uint32_t x = 0; x != expected.width(); ++x)
+			{ EXPECT_LE(std::abs(result(x, y) - static_cast<float>(expected(x, y))/255.0f), 1.0f/255.0f); }
+		}
+	}
+}
+
+TESTCASE(terraformer_ui_font_handling_glyph_atlas_add_glyphs)
+{
+	auto the_font = load_test_font();
+	auto const& renderer = the_font.get_renderer();
+	terraformer::ui::font_handling::glyph_atlas atlas{64, 16, 1024};
+
+	auto const a = renderer.get_glyph(terraformer::ui::font_handling::codepoint{'a'});
+	auto const index_a = terraformer::ui::font_handling::glyph_index{
+		FT_Get_Char_Index(the_font.get_renderer().get_face(), 'a')
+	};
+
+	auto const loc = atlas.get_location(renderer, index_a);
+	EXPECT_EQ(loc.width, a.image.width());
+	EXPECT_EQ(loc.height, a.image.height());
+	EXPECT_EQ(atlas.glyph_count(), 1);
+	auto const generation = atlas.generation();
+
+	auto const loc_again = atlas.get_location(renderer, index_a);
+	EXPECT_EQ(loc_again.x, loc.x);
+	EXPECT_EQ(loc_again.y, loc.y);
+	EXPECT_EQ(atlas.glyph_count(), 1);
+	EXPECT_EQ(atlas.generation(), generation);
+
+	// Add enough glyphs to make the atlas grow
+	for(char32_t c = U'A'; c != U'Z' + 1; ++c)
+	{
+		auto const index = terraformer::ui::font_handling::glyph_index{
+			FT_Get_Char_Index(the_font.get_renderer().get_face(), c)
+		};
+		std::ignore = atlas.get_location(renderer, index);
+	}
+	EXPECT_GT(atlas.pixels().height(), 16);
+	EXPECT_EQ(atlas.pixels().width(), 64);
+
+	// Pixels of the first glyph are kept
+	auto const atlas_pixels = atlas.pixels();
+	for(uint32_t y = 0; y != loc.height; ++y)
+	{
+		for(uint32_t x = 0; x != loc.width; ++x)
+		{
+			auto const input = static_cast<float>(a.image(x, y))/255.0f;
+			EXPECT_EQ(atlas_pixels(loc.x + x, loc.y + y), 2.0f*input*(1.0f - 0.5f*input));
+		}
+	}
+}
+
+TESTCASE(terraformer_ui_font_handling_glyph_atlas_reset_at_max_height)
+{
+	auto the_font = load_test_font();
+	auto const& renderer = the_font.get_renderer();
+	terraformer::ui::font_handling::glyph_atlas atlas{64, 16, 48};
+	EXPECT_EQ(atlas.max_height(), 48);
+
+	auto const index_a = get_glyph_index(the_font, 'a');
+	std::ignore = atlas.get_location(renderer, index_a);
+
+	// There is not room for all of these glyphs within the maximum height
+	auto prev_generation = atlas.generation();
+	for(char32_t c = U'A'; c != U'Z' + 1 && atlas.reset_count() == 0; ++c)
+	{
+		std::ignore = atlas.get_location(renderer, get_glyph_index(the_font, c));
+		EXPECT_LE(atlas.pixels().height(), 48);
+		EXPECT_EQ(atlas.pixels().width(), 64);
+		EXPECT_NE(atlas.generation(), prev_generation);
+		prev_generation = atlas.generation();
+	}
+	EXPECT_EQ(atlas.reset_count(), 1);
+	EXPECT_EQ(atlas.pixels().height(), 48);
+
+	// Only the glyph that did not fit remains
+	EXPECT_EQ(atlas.glyph_count(), 1);
+
+	// The glyph added before the reset is added again
+	auto const loc = atlas.get_location(renderer, index_a);
+	EXPECT_EQ(atlas.glyph_count(), 2);
+	EXPECT_NE(atlas.generation(), prev_generation);
+
+	auto const a = renderer.get_glyph(terraformer::ui::font_handling::codepoint{'a'});
+	auto const atlas_pixels = atlas.pixels();
+	for(uint32_t y = 0; y != loc.height; ++y)
+	{
+		for(uint32_t x = 0; x != loc.width; ++x)
+		{
+			auto const input = static_cast<float>(a.image(x, y))/255.0f;
+			EXPECT_EQ(atlas_pixels(loc.x + x, loc.y + y), 2.0f*input*(1.0f - 0.5f*input));
+		}
+	}
+}
+
+TESTCASE(terraformer_ui_font_handling_glyph_atlas_glyph_taller_than_max_height)
+{
+	auto the_font = load_test_font();
+	terraformer::ui::font_handling::glyph_atlas atlas{64, 4, 8};
+	try
+	{
+		std::ignore = atlas.get_location(the_font.get_renderer(), get_glyph_index(the_font, 'A'));
+		abort();
+	}
+	catch(std::runtime_error const&)
+	{}
+}
+
+TESTCASE(terraformer_ui_font_handling_glyph_atlas_quads_match_rendered_text)
+{
+	auto the_font = load_test_font();
+	terraformer::ui::font_handling::glyph_atlas atlas{256, 16, 1024};
+
+	auto const seq = terraformer::ui::font_handling::text_shaper{}
+		.with(terraformer::ui::font_handling::text_shaping_options{})
+		.append(U"Hello, glyph atlas 12.75")
+		.run(the_font);
+
+	std::vector<terraformer::ui::font_handling::glyph_quad> quads;
+	make_glyph_quads(seq, atlas, quads);
+	EXPECT_EQ(std::size(quads), seq.glyph_count() - 3);
+	check_quads_match_rendered_text(seq, atlas, quads);
+}
+
+TESTCASE(terraformer_ui_font_handling_glyph_atlas_quads_after_reset)
+{
+	auto the_font = load_test_font();
+	auto other_font = load_test_font();
+	other_font.set_font_size(24);
+
+	auto const seq = terraformer::ui::font_handling::text_shaper{}
+		.with(terraformer::ui::font_handling::text_shaping_options{})
+		.append(U"Hello, glyph atlas 12.75")
+		.run(the_font);
+
+	// Fill the atlas with a varying number of other glyphs, so it is reset at different places
+	// within the text
+	size_t resets_within_text = 0;
+	for(char32_t last = U'A'; last != U'Z' + 1; ++last)
+	{
+		terraformer::ui::font_handling::glyph_atlas atlas{128, 16, 64};
+		for(char32_t c = U'A'; c != last + 1; ++c)
+		{ std::ignore = atlas.get_location(other_font.get_renderer(), get_glyph_index(other_font, c)); }
+
+		auto const reset_count = atlas.reset_count();
+		std::vector<terraformer::ui::font_handling::glyph_quad> quads;
+		make_glyph_quads(seq, atlas, quads);
+		EXPECT_EQ(std::size(quads), seq.glyph_count() - 3);
+		check_quads_match_rendered_text(seq, atlas, quads);
+		resets_within_text += atlas.reset_count() != reset_count? 1 : 0;
+	}
+	EXPECT_GT(resets_within_text, 0);
+}
+
+TESTCASE(terraformer_ui_font_handling_glyph_atlas_text_does_not_fit)
+{
+	auto the_font = load_test_font();
+	terraformer::ui::font_handling::glyph_atlas atlas{64, 16, 24};
+
+	auto const seq = terraformer::ui::font_handling::text_shaper{}
+		.with(terraformer::ui::font_handling::text_shaping_options{})
+		.append(U"Hello, glyph atlas 12.75")
+		.run(the_font);
+
+	std::vector<terraformer::ui::font_handling::glyph_quad> quads;
+	try
+	{
+		make_glyph_quads(seq, atlas, quads);
+		abort();
+	}
+	catch(std::runtime_error const&)
+	{}
+}
@@ -7,6 +7,7 @@
 #define TERRAFORMER_UI_FONT_HANDLING_GLYPH_RENDERER_HPP
 
 #include "lib/common/flat_map.hpp"
+#include "lib/common/global_instance_counter.hpp"
 #include "lib/pixel_store/image.hpp"
 
 #include <ft2build.h>
@@ -55,7 +56,7 @@ namespace terraformer::ui::font_handling
 
 	void render(glyph const& glyph, span_2d<uint8_t> output_image, uint32_t x_offset, uint32_t y_offset);
 
-	class glyph_renderer
+	class glyph_renderer:public global_instance_counter
 	{
 	public:
 		glyph_renderer():m_face{nullptr}
@@ -0,0 +1,110 @@
+//@	{"target":{"name":"shaped_text_cache.o"}}
+
+#include "./shaped_text_cache.hpp"
+
+size_t terraformer::ui::font_handling::shaped_text_cache::key_hash::operator()(key_type const& key) const
+{
+	auto ret = std::hash<decltype(key.text)>{}(key.text);
+	auto const combine = [&ret](size_t value) {
+		ret ^= value + 0x9e3779b97f4a7c15 + (ret << 6) + (ret >> 2);
+	};
+	combine(std::hash<font const*>{}(key.font_instance));
+	combine(std::hash<int>{}(key.font_size));
+	combine(std::hash<int>{}(static_cast<int>(key.options.direction)));
+	combine(std::hash<int>{}(static_cast<int>(key.options.script)));
+	combine(std::hash<void const*>{}(key.options.language));
+	return ret;
+}
+
+template<class CharType>
+std::shared_ptr<terraformer::ui::font_handling::shaped_text const>
+terraformer::ui::font_handling::shaped_text_cache::get_impl(
+	std::shared_ptr<font const> const& font,
+	std::basic_string_view<CharType> text,
+	text_shaping_options const& options
+)
+{
+	key_type key{
+		.font_instance = font.get(),
+		.font_size = font->get_font_size(),
+		.text = std::basic_string<CharType>{text},
+		.options = options
+	};
+
+	std::lock_guard lock{m_mutex};
+	if(auto const i = m_index.find(key); i != std::end(m_index))
+	{
+		m_entries.splice(std::begin(m_entries), m_entries, i->second);
+		return i->second->value;
+	}
+
+	// NOTE: Shaping and rendering is done while holding the lock, since the glyph renderer of
+	//       the font is not thread safe
+	auto glyphs = text_shaper{}.with(options).append(text).run(*font);
+	auto mask = render(glyphs);
+	auto const size_in_bytes = sizeof(entry)
+		+ std::size(text)*sizeof(CharType)
+		+ glyphs.glyph_count()*(
+			sizeof(location) + sizeof(size_t) + sizeof(glyph_index)
+			+ sizeof(hb_glyph_position_t) + sizeof(hb_glyph_flags_t)
+		)
+		+ static_cast<size_t>(mask.width())*static_cast<size_t>(mask.height());
+
+	auto value = std::make_shared<shaped_text const>(std::move(glyphs), std::move(mask));
+	m_entries.push_front(
+		entry{
+			.key = key,
+			.font_owner = font,
+			.value = value,
+			.size_in_bytes = size_in_bytes
+		}
+	);
+	m_index.emplace(std::move(key), std::begin(m_entries));
+	m_size_in_bytes += size_in_bytes;
+	evict_entries();
+	return value;
+}
+
+std::shared_ptr<terraformer::ui::font_handling::shaped_text const>
+terraformer::ui::font_handling::shaped_text_cache::get(
+	std::shared_ptr<font const> const& font,
+	std::u8string_view text,
+	text_shaping_options const& options
+)
+{ return get_impl(font, text, options); }
+
+std::shared_ptr<terraformer::ui::font_handling::shaped_text const>
+terraformer::ui::font_handling::shaped_text_cache::get(
+	std::shared_ptr<font const> const& font,
+	std::u32string_view text,
+	text_shaping_options const& options
+)
+{ return get_impl(font, text, options); }
+
+void terraformer::ui::font_handling::shaped_text_cache::clear()
+{
+	std::lock_guard lock{m_mutex};
+	m_index.clear();
+	m_entries.clear();
+	m_size_in_bytes = 0;
+}
+
+void terraformer::ui::font_handling::shaped_text_cache::evict_entries()
+{
+	// Always keep the most recently used entry, even if it is larger than the budget, so the
+	// caller can use it
+	while(m_size_in_bytes > m_max_size_in_bytes && std::size(m_entries) > 1)
+	{
+		auto& last = m_entries.back();
+		m_size_in_bytes -= last.size_in_bytes;
+		m_index.erase(last.key);
+		m_entries.pop_back();
+	}
+}
+
+terraformer::ui::font_handling::shaped_text_cache&
+terraformer::ui::font_handling::get_shaped_text_cache()
+{
+	static shaped_text_cache cache{16*1024*1024};
+	return cache;
+}
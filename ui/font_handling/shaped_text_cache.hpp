@@ -0,0 +1,114 @@
+//@	{"dependencies_extra":[{"ref":"./shaped_text_cache.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_UI_FONT_HANDLING_SHAPED_TEXT_CACHE_HPP
+#define TERRAFORMER_UI_FONT_HANDLING_SHAPED_TEXT_CACHE_HPP
+
+#include "./text_shaper.hpp"
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <variant>
+
+namespace terraformer::ui::font_handling
+{
+	/**
+	 * The glyphs of a shaped string, together with the rendered glyphs
+	 */
+	struct shaped_text
+	{
+		glyph_sequence glyphs;
+		basic_image<uint8_t> mask;
+	};
+
+	/**
+	 * An LRU cache of shaped and rendered strings, keyed by font, font size, string, and shaping
+	 * options. Entries are shared, so widgets that show the same string only shape and render it
+	 * once.
+	 *
+	 * NOTE: The cache keeps fonts alive as long as there are entries that refer to them.
+	 */
+	class shaped_text_cache
+	{
+	public:
+		explicit shaped_text_cache(size_t max_size_in_bytes):m_max_size_in_bytes{max_size_in_bytes}
+		{}
+
+		std::shared_ptr<shaped_text const> get(
+			std::shared_ptr<font const> const& font,
+			std::u8string_view text,
+			text_shaping_options const& options = text_shaping_options{}
+		);
+
+		std::shared_ptr<shaped_text const> get(
+			std::shared_ptr<font const> const& font,
+			std::u32string_view text,
+			text_shaping_options const& options = text_shaping_options{}
+		);
+
+		size_t size() const
+		{
+			std::lock_guard lock{m_mutex};
+			return std::size(m_entries);
+		}
+
+		size_t size_in_bytes() const
+		{
+			std::lock_guard lock{m_mutex};
+			return m_size_in_bytes;
+		}
+
+		size_t max_size_in_bytes() const
+		{ return m_max_size_in_bytes; }
+
+		void clear();
+
+	private:
+		struct key_type
+		{
+			font const* font_instance;
+			int font_size;
+			std::variant<std::u8string, std::u32string> text;
+			text_shaping_options options;
+
+			bool operator==(key_type const&) const = default;
+		};
+
+		struct key_hash
+		{
+			size_t operator()(key_type const& key) const;
+		};
+
+		struct entry
+		{
+			key_type key;
+			std::shared_ptr<font const> font_owner;
+			std::shared_ptr<shaped_text const> value;
+			size_t size_in_bytes;
+		};
+
+		template<class CharType>
+		std::shared_ptr<shaped_text const> get_impl(
+			std::shared_ptr<font const> const& font,
+			std::basic_string_view<CharType> text,
+			text_shaping_options const& options
+		);
+
+		void evict_entries();
+
+		mutable std::mutex m_mutex;
+		std::list<entry> m_entries;
+		std::unordered_map<key_type, std::list<entry>::iterator, key_hash> m_index;
+		size_t m_size_in_bytes{0};
+		size_t m_max_size_in_bytes;
+	};
+
+	/**
+	 * Returns the cache shared by all widgets in the process
+	 */
+	shaped_text_cache& get_shaped_text_cache();
+}
+
+#endif
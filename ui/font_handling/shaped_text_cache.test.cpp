@@ -0,0 +1,79 @@
+//@	{"target":{"name":"shaped_text_cache.test"}}
+
+#include "./shaped_text_cache.hpp"
+
+#include "./font_mapper.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+namespace
+{
+	auto load_test_font()
+	{
+		terraformer::ui::font_handling::font_mapper fonts;
+		auto const fontfile = fonts.get_path("serif");
+		auto ret = std::make_shared<terraformer::ui::font_handling::font>(fontfile);
+		ret->set_font_size(16);
+		return std::shared_ptr<terraformer::ui::font_handling::font const>{std::move(ret)};
+	}
+}
+
+TESTCASE(terraformer_ui_font_handling_shaped_text_cache_reuse_entries)
+{
+	auto const font = load_test_font();
+	terraformer::ui::font_handling::shaped_text_cache cache{1024*1024};
+
+	auto const a = cache.get(font, u8"12.5");
+	auto const b = cache.get(font, u8"12.5");
+	auto const c = cache.get(font, u8"12.75");
+	auto const d = cache.get(font, U"12.5");
+
+	EXPECT_EQ(a, b);
+	EXPECT_NE(a, c);
+	EXPECT_NE(a, d);
+	EXPECT_EQ(cache.size(), 3);
+	EXPECT_EQ(a->glyphs.glyph_count(), 4);
+	EXPECT_EQ(a->mask.width(), a->glyphs.extents().width);
+	EXPECT_EQ(a->mask.height(), a->glyphs.extents().height);
+
+	auto const e = cache.get(
+		font,
+		u8"12.5",
+		terraformer::ui::font_handling::text_shaping_options{
+			.direction = HB_DIRECTION_RTL
+		}
+	);
+	EXPECT_NE(a, e);
+	EXPECT_EQ(cache.size(), 4);
+
+	cache.clear();
+	EXPECT_EQ(cache.size(), 0);
+	EXPECT_EQ(cache.size_in_bytes(), 0);
+
+	// Entries that are in use are still valid after clear
+	EXPECT_EQ(a->glyphs.glyph_count(), 4);
+}
+
+TESTCASE(terraformer_ui_font_handling_shaped_text_cache_evict_least_recently_used)
+{
+	auto const font = load_test_font();
+	terraformer::ui::font_handling::shaped_text_cache cache{4096};
+
+	auto const first = cache.get(font, u8"0");
+	for(int k = 1; k != 100; ++k)
+	{
+		auto const str = std::to_string(k);
+		cache.get(font, std::u8string_view{reinterpret_cast<char8_t const*>(str.c_str()), std::size(str)});
+		EXPECT_LE(cache.size_in_bytes(), cache.max_size_in_bytes());
+	}
+
+	EXPECT_LT(cache.size(), 99);
+	EXPECT_GT(cache.size(), 0);
+
+	// The first entry has been evicted, so a new one is created
+	EXPECT_NE(cache.get(font, u8"0"), first);
+
+	// The most recently used entry is still there
+	auto const last = cache.get(font, u8"99");
+	EXPECT_EQ(cache.get(font, u8"99"), last);
+}
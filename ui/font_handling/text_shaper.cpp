@@ -37,39 +37,81 @@ terraformer::ui::font_handling::compute_extents(shaping_result const& result)
 }
 
 terraformer::ui::font_handling::glyph_sequence::glyph_sequence(shaping_result const& result):
-	m_extents{compute_extents(result)}
+	m_renderer{&result.renderer.get()}
 {
-	// TODO: Fix vertical rendering
-
 	m_content.resize(static_cast<size_type>(result.glyph_count));
 	auto const glyph_info = result.glyph_info;
 	auto const glyph_pos = result.glyph_pos;
-	auto const ascender = result.renderer.get().get_ascender();
-	uint64_t cursor_x = 0;
-	uint64_t cursor_y = 0;
 
-	auto const locs = m_content.get<0>();
 	auto const indices = m_content.get<1>();
-	auto const glyph_ptrs = m_content.get<2>();
+	auto const glyph_indices = m_content.get<2>();
+	auto const positions = m_content.get<3>();
+	auto const flags = m_content.get<4>();
 
 	for(auto item : m_content.element_indices())
 	{
 		auto const i = item.get();
-		auto const& glyph = get_glyph(result, glyph_index{glyph_info[i].codepoint});
-		auto const x_offset  = -glyph_pos[i].x_offset;
-		auto const y_offset  = glyph_pos[i].y_offset;
+		indices[item] = glyph_info[i].cluster;
+		glyph_indices[item] = glyph_index{glyph_info[i].codepoint};
+		positions[item] = glyph_pos[i];
+		flags[item] = hb_glyph_info_get_glyph_flags(glyph_info + i);
+	}
+
+	update_layout();
+}
+
+terraformer::ui::font_handling::glyph_sequence::glyph_sequence(
+	glyph_renderer const& renderer,
+	storage_type&& content
+):
+	m_renderer{&renderer},
+	m_content{std::move(content)}
+{ update_layout(); }
+
+void terraformer::ui::font_handling::glyph_sequence::update_layout()
+{
+	// TODO: Fix vertical rendering
+
+	auto const locs = m_content.get<0>();
+	auto const glyph_indices = m_content.get<2>();
+	auto const positions = m_content.get<3>();
+	auto const& renderer = *m_renderer;
+	auto const ascender = renderer.get_ascender();
+	auto const n = glyph_count();
+	int64_t cursor_x = 0;
+	int64_t cursor_y = 0;
+	int64_t width = 0;
+	int64_t height = 0;
+
+	for(auto item : m_content.element_indices())
+	{
+		auto const i = item.get();
+		auto const& glyph = renderer.get_glyph(glyph_indices[item]);
+		auto const& pos = positions[item];
 
 		locs[item] = location{
-			static_cast<float>(cursor_x + x_offset)/64.0f + static_cast<float>(glyph.x_offset),
-			static_cast<float>(cursor_y + y_offset + ascender)/64.0f - static_cast<float>(glyph.y_offset),
+			static_cast<float>(cursor_x - pos.x_offset)/64.0f + static_cast<float>(glyph.x_offset),
+			static_cast<float>(cursor_y + pos.y_offset + ascender)/64.0f - static_cast<float>(glyph.y_offset),
 			0.0f
 		};
-		indices[item] = glyph_info[i].cluster;
-		glyph_ptrs[item] = &glyph;
 
-		cursor_x += glyph_pos[i].x_advance;
-		cursor_y -= glyph_pos[i].y_advance;
+		width += (i != n - 1)?
+			pos.x_advance :
+			std::max(static_cast<int64_t>(glyph.image.width())*64, static_cast<int64_t>(pos.x_advance));
+		height += (i != n - 1)? -pos.y_advance : static_cast<int64_t>(glyph.image.height())*64;
+
+		cursor_x += pos.x_advance;
+		cursor_y -= pos.y_advance;
 	}
+
+	// FIXME: only if horizontal
+	height = std::max(static_cast<int64_t>(renderer.get_global_glyph_height()), height);
+	width = std::max(int64_t{1}, width);
+
+	m_extents = span_2d_extents{
+		.width = static_cast<uint32_t>((width + 63)/64),
+		.height = static_cast<uint32_t>((height + 63)/64)
+	};
 }
 
 terraformer::basic_image<uint8_t>
@@ -79,15 +121,13 @@ terraformer::ui::font_handling::render(glyph_sequence const& seq)
 	terraformer::basic_image<uint8_t> ret{size.width, size.height};
 
 	auto const locations = seq.locations();
-	auto const glyph_ptrs = seq.glyph_pointers();
 
 	for(auto item : seq.element_indices())
 	{
-		auto const& glyph = *glyph_ptrs[item];
 		auto const loc = locations[item];
 
 		render(
-			glyph,
+			get_glyph(seq, item),
 			ret.pixels(),
 			static_cast<uint32_t>(loc[0] + 0.5f),
 			static_cast<uint32_t>(loc[1] + 0.5f)
@@ -148,3 +188,163 @@ float terraformer::ui::font_handling::horz_offset_from_index(glyph_sequence cons
 
 	return 0.0f;
 }
+
+namespace
+{
+	bool is_safe_break(terraformer::ui::font_handling::glyph_sequence const& seq, size_t k)
+	{
+		using index_type = terraformer::ui::font_handling::glyph_sequence::index_type;
+		auto const clusters = seq.input_indices();
+		auto const flags = seq.glyph_flags();
+		if(k == 0)
+		{ return true; }
+
+		return clusters[index_type{k}] != clusters[index_type{k - 1}]
+			&& (flags[index_type{k}] & HB_GLYPH_FLAG_UNSAFE_TO_BREAK) == 0;
+	}
+
+	void append_glyphs(
+		terraformer::ui::font_handling::glyph_sequence::storage_type& output,
+		terraformer::ui::font_handling::glyph_sequence const& seq,
+		size_t begin,
+		size_t end,
+		ptrdiff_t cluster_offset
+	)
+	{
+		using index_type = terraformer::ui::font_handling::glyph_sequence::index_type;
+		auto const clusters = seq.input_indices();
+		auto const glyph_indices = seq.glyph_indices();
+		auto const positions = seq.glyph_positions();
+		auto const flags = seq.glyph_flags();
+		for(auto k = begin; k != end; ++k)
+		{
+			auto const i = index_type{k};
+			output.push_back(
+				terraformer::location{},
+				static_cast<size_t>(static_cast<ptrdiff_t>(clusters[i]) + cluster_offset),
+				glyph_indices[i],
+				positions[i],
+				flags[i]
+			);
+		}
+	}
+}
+
+terraformer::ui::font_handling::glyph_sequence
+terraformer::ui::font_handling::reshape(
+	glyph_sequence const& prev,
+	std::u32string_view prev_text,
+	std::u32string_view text,
+	font const& font,
+	text_shaping_options const& options
+)
+{
+	auto const shape_all = [&](){
+		return text_shaper{}.with(options).append(text).run(font);
+	};
+
+	if(prev.empty() || prev.renderer() != &font.get_renderer() || HB_DIRECTION_IS_BACKWARD(options.direction))
+	{ return shape_all(); }
+
+	auto const n_old = std::size(prev_text);
+	auto const n_new = std::size(text);
+	auto const prefix_length = static_cast<size_t>(
+		std::ranges::mismatch(prev_text, text).in1 - std::begin(prev_text)
+	);
+	if(prefix_length == n_old && prefix_length == n_new)
+	{ return prev; }
+
+	auto const suffix_length = std::min(
+		static_cast<size_t>(
+			std::ranges::mismatch(
+				std::ranges::reverse_view{prev_text},
+				std::ranges::reverse_view{text}
+			).in1 - std::rbegin(prev_text)
+		),
+		std::min(n_old, n_new) - prefix_length
+	);
+
+	// Keep glyphs up to the last safe break before the last unchanged character in the prefix.
+	// That character is shaped again, since it may interact with the changed characters.
+	auto const clusters = prev.input_indices();
+	auto const glyph_count = prev.glyph_count();
+	size_t head_end = 0;
+	for(size_t k = 0; k != glyph_count && clusters[glyph_sequence::index_type{k}] < prefix_length; ++k)
+	{
+		if(is_safe_break(prev, k))
+		{ head_end = k; }
+	}
+
+	// Likewise, keep glyphs from the first safe break after the first unchanged character in the
+	// suffix
+	auto tail_begin = head_end;
+	while(tail_begin != glyph_count
+		&& (clusters[glyph_sequence::index_type{tail_begin}] <= n_old - suffix_length
+			|| !is_safe_break(prev, tail_begin)))
+	{ ++tail_begin; }
+
+	auto const item_begin = head_end != 0? clusters[glyph_sequence::index_type{head_end}] : 0;
+	auto const item_end_old = tail_begin != glyph_count?
+		clusters[glyph_sequence::index_type{tail_begin}] : n_old;
+	auto const item_end = item_end_old + n_new - n_old;
+
+	// The breaks before and after the item were safe in the old text, but the characters on one
+	// side have changed. HarfBuzz only reports whether a break is safe between glyphs within the
+	// buffer, so the last cluster of the head, and the first cluster of the tail, are shaped
+	// together with the item.
+	auto overlap_begin = head_end;
+	while(overlap_begin != 0
+		&& clusters[glyph_sequence::index_type{overlap_begin - 1}] == clusters[glyph_sequence::index_type{head_end - 1}])
+	{ --overlap_begin; }
+	auto const shape_begin = clusters[glyph_sequence::index_type{overlap_begin}];
+
+	auto overlap_end = tail_begin;
+	while(overlap_end != glyph_count
+		&& clusters[glyph_sequence::index_type{overlap_end}] == item_end_old)
+	{ ++overlap_end; }
+	auto const overlap_length = (overlap_end != glyph_count?
+		clusters[glyph_sequence::index_type{overlap_end}] : n_old) - item_end_old;
+
+	text_shaper shaper;
+	auto const item = shaper.with(options)
+		.append(text, shape_begin, item_end + overlap_length - shape_begin)
+		.run(font);
+
+	// Find the glyphs that belong to the item. If a break is not safe in the new text, the kept
+	// glyphs are not what shaping the entire text would give.
+	auto const item_clusters = item.input_indices();
+	auto const find_break = [&item, &item_clusters](size_t cluster) {
+		size_t k = 0;
+		while(k != item.glyph_count() && item_clusters[glyph_sequence::index_type{k}] < cluster)
+		{ ++k; }
+		return k;
+	};
+	auto const is_safe_break_at = [&item, &item_clusters](size_t k, size_t cluster) {
+		return k != item.glyph_count()
+			&& item_clusters[glyph_sequence::index_type{k}] == cluster
+			&& is_safe_break(item, k);
+	};
+
+	auto const item_glyphs_begin = find_break(item_begin);
+	if(head_end != 0 && !is_safe_break_at(item_glyphs_begin, item_begin))
+	{ return shape_all(); }
+
+	auto const item_glyphs_end = find_break(item_end);
+	if(tail_begin != glyph_count && !is_safe_break_at(item_glyphs_end, item_end))
+	{ return shape_all(); }
+
+	glyph_sequence::storage_type ret;
+	ret.reserve(
+		glyph_sequence::size_type{head_end + (item_glyphs_end - item_glyphs_begin) + (glyph_count - tail_begin)}
+	);
+	append_glyphs(ret, prev, 0, head_end, 0);
+	append_glyphs(ret, item, item_glyphs_begin, item_glyphs_end, 0);
+	append_glyphs(
+		ret,
+		prev,
+		tail_begin,
+		glyph_count,
+		static_cast<ptrdiff_t>(n_new) - static_cast<ptrdiff_t>(n_old)
+	);
+	return glyph_sequence{font.get_renderer(), std::move(ret)};
+}
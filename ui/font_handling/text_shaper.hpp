@@ -87,7 +87,7 @@ namespace terraformer::ui::font_handling
 	public:
 		glyph_sequence() = default;
 
-		using storage_type = multi_array<location, size_t, glyph const*>;
+		using storage_type = multi_array<location, size_t, glyph_index, hb_glyph_position_t, hb_glyph_flags_t>;
 		using size_type = storage_type::size_type;
 		using index_type = storage_type::index_type;
 
@@ -95,6 +95,12 @@ namespace terraformer::ui::font_handling
 
 		explicit glyph_sequence(shaping_result const&);
 
+		/**
+		 * Creates a glyph sequence from glyphs that have already been shaped. Locations are
+		 * ignored, and recomputed from the glyph positions.
+		 */
+		explicit glyph_sequence(glyph_renderer const& renderer, storage_type&& content);
+
 		auto element_indices() const
 		{ return m_content.element_indices(); }
 
@@ -104,9 +110,15 @@ namespace terraformer::ui::font_handling
 		auto input_indices() const
 		{ return m_content.get<1>(); }
 
-		auto glyph_pointers() const
+		auto glyph_indices() const
 		{ return m_content.get<2>(); }
 
+		auto glyph_positions() const
+		{ return m_content.get<3>(); }
+
+		auto glyph_flags() const
+		{ return m_content.get<4>(); }
+
 		auto extents() const
 		{ return m_extents; }
 
@@ -116,11 +128,30 @@ namespace terraformer::ui::font_handling
 		[[nodiscard]] bool empty() const
 		{ return m_content.empty(); }
 
+		/**
+		 * The renderer used to shape this sequence, or nullptr if the sequence is default
+		 * constructed
+		 */
+		glyph_renderer const* renderer() const
+		{ return m_renderer; }
+
 	private:
+		void update_layout();
+
+		glyph_renderer const* m_renderer{nullptr};
 		storage_type m_content;
 		span_2d_extents m_extents;
 	};
 
+	/**
+	 * Returns the glyph at index in seq.
+	 *
+	 * NOTE: The returned reference is invalidated when the renderer loads a new glyph. Glyph
+	 *       sequences store glyph indices rather than references for that reason.
+	 */
+	inline auto& get_glyph(glyph_sequence const& seq, glyph_sequence::index_type index)
+	{ return seq.renderer()->get_glyph(seq.glyph_indices()[index]); }
+
 	terraformer::basic_image<uint8_t> render(glyph_sequence const& seq);
 
 	struct glyph_geometry
@@ -140,6 +171,18 @@ namespace terraformer::ui::font_handling
 
 	float horz_offset_from_index(glyph_sequence const& seq,size_t index);
 
+	/**
+	 * Properties of the text that affect shaping, besides the font
+	 */
+	struct text_shaping_options
+	{
+		hb_direction_t direction = hb_direction_t::HB_DIRECTION_LTR;
+		hb_script_t script = hb_script_t::HB_SCRIPT_LATIN;
+		hb_language_t language = hb_language_from_string("en-UE", -1);
+
+		bool operator==(text_shaping_options const&) const = default;
+	};
+
 	class text_shaper
 	{
 	public:
@@ -176,6 +219,30 @@ namespace terraformer::ui::font_handling
 			return *this;
 		}
 
+		/**
+		 * Appends the characters [item_offset, item_offset + item_length) of buffer. The
+		 * surrounding characters are used as context, and input indices refer to buffer.
+		 */
+		text_shaper& append(std::basic_string_view<char32_t> buffer, size_t item_offset, size_t item_length)
+		{
+			auto const text = reinterpret_cast<uint32_t const*>(std::data(buffer));
+
+			if(m_clear_before_append)
+			{
+				hb_buffer_clear_contents(m_handle.get());
+				m_clear_before_append = false;
+			}
+
+			hb_buffer_add_utf32(
+				m_handle.get(),
+				text,
+				narrowing_cast<int>(std::size(buffer)),
+				narrowing_cast<unsigned int>(item_offset),
+				narrowing_cast<int>(item_length)
+			);
+			return *this;
+		}
+
 		text_shaper& with(hb_direction_t direction)
 		{
 			hb_buffer_set_direction(m_handle.get(), direction);
@@ -194,6 +261,13 @@ namespace terraformer::ui::font_handling
 			return *this;
 		}
 
+		text_shaper& with(text_shaping_options const& options)
+		{
+			return with(options.direction)
+				.with(options.script)
+				.with(options.language);
+		}
+
 		[[nodiscard]] auto run(font const& font)
 		{
 			hb_shape(font.get_hb_font(), m_handle.get(), nullptr, 0);
@@ -215,6 +289,20 @@ namespace terraformer::ui::font_handling
 		bool m_clear_before_append{false};
 	};
 
+	/**
+	 * Shapes text, reusing glyphs from prev, which is the result of shaping prev_text with the
+	 * same font and options. Glyphs before the first, and after the last, changed character are
+	 * kept, as long as HarfBuzz reports that it is safe to break the text there. Only the
+	 * clusters in between are shaped again, with the rest of the text as context.
+	 */
+	glyph_sequence reshape(
+		glyph_sequence const& prev,
+		std::u32string_view prev_text,
+		std::u32string_view text,
+		font const& font,
+		text_shaping_options const& options
+	);
+
 }
 
 #endif
\ No newline at end of file
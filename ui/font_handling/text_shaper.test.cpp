@@ -6,6 +6,8 @@
 
 #include <testfwk/testfwk.hpp>
 
+#include <span>
+
 TESTCASE(terraformer_ui_font_handling_shape_text)
 {
 	terraformer::ui::font_handling::font_mapper fonts;
@@ -27,4 +29,91 @@ TESTCASE(terraformer_ui_font_handling_shape_text)
 	printf("%u %u\n", img.width(), img.height());
 	fwrite(std::data(img.pixels()), 1, img.width()*img.height(), dump);
 	fclose(dump);
-}
\ No newline at end of file
+}
+
+namespace
+{
+	void expect_same_glyphs(
+		terraformer::ui::font_handling::glyph_sequence const& a,
+		terraformer::ui::font_handling::glyph_sequence const& b
+	)
+	{
+		REQUIRE_EQ(a.glyph_count(), b.glyph_count());
+		EXPECT_EQ(a.extents().width, b.extents().width);
+		EXPECT_EQ(a.extents().height, b.extents().height);
+		for(auto item : a.element_indices())
+		{
+			EXPECT_EQ(a.input_indices()[item], b.input_indices()[item]);
+			EXPECT_EQ(
+				static_cast<FT_UInt>(a.glyph_indices()[item]),
+				static_cast<FT_UInt>(b.glyph_indices()[item])
+			);
+			EXPECT_EQ(a.glyph_positions()[item].x_advance, b.glyph_positions()[item].x_advance);
+			EXPECT_EQ(a.locations()[item][0], b.locations()[item][0]);
+			EXPECT_EQ(a.locations()[item][1], b.locations()[item][1]);
+		}
+	}
+
+	// Applies each edit in turn, and compares the result with shaping the entire text
+	void check_reshape(char const* font_name, std::span<std::u32string_view const> edits)
+	{
+		terraformer::ui::font_handling::font_mapper fonts;
+		auto const fontfile = fonts.get_path(font_name);
+		terraformer::ui::font_handling::font the_font{fontfile.c_str()};
+		the_font.set_font_size(16);
+
+		terraformer::ui::font_handling::text_shaping_options const options{};
+		terraformer::ui::font_handling::glyph_sequence current;
+		std::u32string_view prev_text;
+		for(auto const text : edits)
+		{
+			auto next = reshape(current, prev_text, text, the_font, options);
+			auto const expected = terraformer::ui::font_handling::text_shaper{}
+				.with(options)
+				.append(text)
+				.run(the_font);
+			expect_same_glyphs(next, expected);
+			current = std::move(next);
+			prev_text = text;
+		}
+	}
+}
+
+TESTCASE(terraformer_ui_font_handling_reshape_matches_full_shaping)
+{
+	std::u32string_view const edits[]{
+		U"",
+		U"1",
+		U"12",
+		U"12.5",
+		U"12.75",
+		U"112.75",
+		U"affine",
+		U"affline",
+		U"afline",
+		U"Waffle office",
+		U"Waffle ofice",
+		U"W office",
+		U"office",
+		U"",
+		U"fff",
+		U"of fice",
+		U"office",
+		U"oice",
+		U"offfice",
+		U"fi",
+		// A ligature is formed across the break before the kept tail
+		U"ffi",
+		U".fi",
+		U"AffiT",
+		U"A.fiT",
+		// Kerning is applied across the break after the kept head
+		U"iAff",
+		U"iAfVf",
+		U"TLW-f,-Afi",
+		U"TLW-f,-Af Vi"
+	};
+
+	check_reshape("serif", edits);
+	check_reshape("sans", edits);
+}
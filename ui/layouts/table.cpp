@@ -93,6 +93,116 @@ void terraformer::ui::layouts::table::set_default_cell_sizes_to(span<box_size co
 			m_cols = set_default_cell_sizes_to(sizes_in, m_rows);
 			break;
 	}
+
+	m_default_rows = row_array<float>{m_rows};
+	m_default_cols = column_array<float>{m_cols};
+	m_cell_count = std::size(sizes_in).get();
+}
+
+void terraformer::ui::layouts::table::update_default_cell_sizes(
+	span<box_size const> sizes_in,
+	span<array_index<box_size> const> changed_cells,
+	row_array<float>& row_heights,
+	column_array<float>& col_widths
+)
+{
+	auto const colcount = std::size(col_widths);
+	auto const cellcount = std::size(sizes_in).get();
+	for(auto const index : changed_cells)
+	{
+		auto const row = index.get()/colcount;
+		auto const col = index.get()%colcount;
+		auto const cell = sizes_in[index];
+
+		// A cell that has grown can only make its row or column larger. Otherwise, it may have been
+		// the largest cell, and the size must be recomputed from all cells in the row or column.
+		if(cell[0] >= col_widths[col])
+		{ col_widths[col] = cell[0]; }
+		else
+		{
+			auto width = 0.0f;
+			for(auto k = col; k < cellcount; k += colcount)
+			{ width = std::max(width, sizes_in[array_index<box_size>{k}][0]); }
+			col_widths[col] = width;
+		}
+
+		if(cell[1] >= row_heights[row])
+		{ row_heights[row] = cell[1]; }
+		else
+		{
+			auto height = 0.0f;
+			for(auto k = row*colcount; k != std::min((row + 1)*colcount, cellcount); ++k)
+			{ height = std::max(height, sizes_in[array_index<box_size>{k}][1]); }
+			row_heights[row] = height;
+		}
+	}
+}
+
+void terraformer::ui::layouts::table::update_default_cell_sizes(
+	span<box_size const> sizes_in,
+	span<array_index<box_size> const> changed_cells,
+	column_array<float>& col_widths,
+	row_array<float>& row_heights
+)
+{
+	auto const rowcount = std::size(row_heights);
+	auto const cellcount = std::size(sizes_in).get();
+	for(auto const index : changed_cells)
+	{
+		auto const row = index.get()%rowcount;
+		auto const col = index.get()/rowcount;
+		auto const cell = sizes_in[index];
+
+		if(cell[1] >= row_heights[row])
+		{ row_heights[row] = cell[1]; }
+		else
+		{
+			auto height = 0.0f;
+			for(auto k = row; k < cellcount; k += rowcount)
+			{ height = std::max(height, sizes_in[array_index<box_size>{k}][1]); }
+			row_heights[row] = height;
+		}
+
+		if(cell[0] >= col_widths[col])
+		{ col_widths[col] = cell[0]; }
+		else
+		{
+			auto width = 0.0f;
+			for(auto k = col*rowcount; k != std::min((col + 1)*rowcount, cellcount); ++k)
+			{ width = std::max(width, sizes_in[array_index<box_size>{k}][0]); }
+			col_widths[col] = width;
+		}
+	}
+}
+
+void terraformer::ui::layouts::table::update_default_cell_sizes(
+	span<box_size const> sizes_in,
+	span<array_index<box_size> const> changed_cells
+)
+{
+	auto const cellcount = std::size(sizes_in).get();
+	auto const cost_per_cell = std::size(m_default_rows) + std::size(m_default_cols);
+	if(cellcount != m_cell_count || std::size(changed_cells).get()*cost_per_cell >= cellcount)
+	{
+		// The shape of the table has changed, or it is cheaper to start over
+		set_default_cell_sizes_to(sizes_in);
+		return;
+	}
+
+	switch(m_cell_order)
+	{
+		case cell_order::row_major:
+			update_default_cell_sizes(sizes_in, changed_cells, m_default_rows, m_default_cols);
+			break;
+
+		case cell_order::column_major:
+			update_default_cell_sizes(sizes_in, changed_cells, m_default_cols, m_default_rows);
+			break;
+	}
+
+	// Cell sizes may have been adjusted to the available space since the previous call
+	std::ranges::copy(m_default_rows, std::begin(m_rows));
+	std::ranges::copy(m_default_cols, std::begin(m_cols));
 }
 
 void terraformer::ui::layouts::table::adjust_cell_sizes_regular(
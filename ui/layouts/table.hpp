@@ -182,6 +182,28 @@ namespace terraformer::ui::layouts
 			row_array<float>& row_heights
 		);
 
+		/**
+		 * Updates the row and column sizes affected by changed_cells. The result is the same as
+		 * from set_default_cell_sizes_to, given that no other cells have changed since the
+		 * previous call.
+		 */
+		void update_default_cell_sizes(
+			span<box_size const> sizes_in,
+			span<array_index<box_size> const> changed_cells
+		);
+		static void update_default_cell_sizes(
+			span<box_size const> sizes_in,
+			span<array_index<box_size> const> changed_cells,
+			row_array<float>& row_heights,
+			column_array<float>& col_widths
+		);
+		static void update_default_cell_sizes(
+			span<box_size const> sizes_in,
+			span<array_index<box_size> const> changed_cells,
+			column_array<float>& col_widths,
+			row_array<float>& row_heights
+		);
+
 		/**
 		 * Adjusts cell widths given available_width
 		 */
@@ -321,6 +343,13 @@ namespace terraformer::ui::layouts
 		cell_order m_cell_order;
 		row_array<float> m_rows;
 		column_array<float> m_cols;
+
+		// Row and column sizes before they are adjusted to the available space. These are kept so
+		// that they can be updated incrementally.
+		row_array<float> m_default_rows;
+		column_array<float> m_default_cols;
+		size_t m_cell_count{0};
+
 		single_array<cell_size> m_cell_sizes;
 		common_params m_params{};
 	};
@@ -0,0 +1,95 @@
+//@	{"target":{"name":"table.test"}}
+
+#include "./table.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <random>
+
+namespace
+{
+	terraformer::single_array<terraformer::box_size> make_cells(std::mt19937& rng, size_t count)
+	{
+		std::uniform_real_distribution<float> size{1.0f, 100.0f};
+		terraformer::single_array<terraformer::box_size> ret{terraformer::array_size<terraformer::box_size>{count}};
+		for(auto& item : ret)
+		{ item = terraformer::box_size{size(rng), size(rng), 1.0f}; }
+		return ret;
+	}
+
+	void expect_same_cell_sizes(
+		terraformer::ui::layouts::table const& a,
+		terraformer::ui::layouts::table const& b,
+		size_t cell_count
+	)
+	{
+		terraformer::single_array<terraformer::box_size> sizes_a{terraformer::array_size<terraformer::box_size>{cell_count}};
+		terraformer::single_array<terraformer::box_size> sizes_b{terraformer::array_size<terraformer::box_size>{cell_count}};
+		a.get_cell_sizes_into(sizes_a);
+		b.get_cell_sizes_into(sizes_b);
+		for(auto k : sizes_a.element_indices())
+		{ EXPECT_EQ(sizes_a[k], sizes_b[k]); }
+		EXPECT_EQ(a.get_dimensions(), b.get_dimensions());
+	}
+
+	void test_update_default_cell_sizes(terraformer::ui::layouts::table::cell_order order)
+	{
+		std::mt19937 rng;
+		// The last row or column is not filled
+		size_t const cell_count = 1001;
+		auto cells = make_cells(rng, cell_count);
+
+		terraformer::ui::layouts::table incremental{10, order};
+		incremental.set_cell_size(3, terraformer::ui::layouts::table::cell_size::expand{});
+		incremental.set_default_cell_sizes_to(cells);
+
+		std::uniform_int_distribution<size_t> cell_index{0, cell_count - 1};
+		std::uniform_real_distribution<float> scale{0.25f, 2.0f};
+		for(size_t round = 0; round != 200; ++round)
+		{
+			// Expanding cells changes the actual cell sizes, but not the default ones
+			terraformer::single_array size_overrides{terraformer::array_size<float>{cell_count}};
+			std::ranges::fill(size_overrides, -1.0f);
+			incremental.adjust_cell_widths(10000.0f, size_overrides);
+			incremental.adjust_cell_heights(10000.0f, size_overrides);
+
+			terraformer::single_array<terraformer::array_index<terraformer::box_size>> changed_cells;
+			for(size_t k = 0; k != 3; ++k)
+			{
+				terraformer::array_index<terraformer::box_size> const index{cell_index(rng)};
+				cells[index] = terraformer::box_size{
+					cells[index][0]*scale(rng),
+					cells[index][1]*scale(rng),
+					1.0f
+				};
+				changed_cells.push_back(index);
+			}
+			incremental.update_default_cell_sizes(cells, changed_cells);
+
+			terraformer::ui::layouts::table reference{10, order};
+			reference.set_default_cell_sizes_to(cells);
+			expect_same_cell_sizes(incremental, reference, cell_count);
+		}
+	}
+}
+
+TESTCASE(terraformer_ui_layouts_table_update_default_cell_sizes_row_major)
+{ test_update_default_cell_sizes(terraformer::ui::layouts::table::cell_order::row_major); }
+
+TESTCASE(terraformer_ui_layouts_table_update_default_cell_sizes_column_major)
+{ test_update_default_cell_sizes(terraformer::ui::layouts::table::cell_order::column_major); }
+
+TESTCASE(terraformer_ui_layouts_table_update_default_cell_sizes_new_shape)
+{
+	std::mt19937 rng;
+	auto const cells = make_cells(rng, 20);
+	terraformer::ui::layouts::table incremental{4, terraformer::ui::layouts::table::cell_order::row_major};
+	incremental.set_default_cell_sizes_to(terraformer::span{std::begin(cells), std::begin(cells) + 12});
+
+	// When cells have been added, everything is recomputed
+	incremental.update_default_cell_sizes(cells, terraformer::span<terraformer::array_index<terraformer::box_size> const>{});
+
+	terraformer::ui::layouts::table reference{4, terraformer::ui::layouts::table::cell_order::row_major};
+	reference.set_default_cell_sizes_to(cells);
+	expect_same_cell_sizes(incremental, reference, 20);
+}
@@ -2,6 +2,7 @@
 #define TERRAFORMER_UI_MAIN_CONFIG_HPP
 
 #include "./texture_types.hpp"
+#include "./glyph_atlas_texture.hpp"
 
 #include "lib/pixel_store/rgba_pixel.hpp"
 #include "ui/font_handling/text_shaper.hpp"
@@ -102,6 +103,11 @@ namespace terraformer::ui::main
 		immutable_shared_texture vertical_handle;
 		immutable_shared_texture small_knob;
 		immutable_shared_texture small_hand;
+
+		/**
+		 * Glyphs of all text that is presented as glyph quads
+		 */
+		std::shared_ptr<glyph_atlas_texture> glyph_atlas;
 	};
 
 	struct config
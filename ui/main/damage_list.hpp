@@ -0,0 +1,130 @@
+#ifndef TERRAFORMER_UI_MAIN_DAMAGE_LIST_HPP
+#define TERRAFORMER_UI_MAIN_DAMAGE_LIST_HPP
+
+#include "./widget_geometry.hpp"
+#include "./events.hpp"
+
+#include <algorithm>
+#include <array>
+#include <span>
+
+namespace terraformer::ui::main
+{
+	/**
+	 * An axis-aligned rectangle in window coordinates. Like widget locations, y is zero at the top
+	 * of the window, and decreases downwards.
+	 */
+	struct damaged_region
+	{
+		float left;
+		float bottom;
+		float right;
+		float top;
+
+		[[nodiscard]] constexpr bool operator==(damaged_region const&) const = default;
+		[[nodiscard]] constexpr bool operator!=(damaged_region const&) const = default;
+	};
+
+	[[nodiscard]] constexpr bool is_empty(damaged_region const& region)
+	{ return !(region.left < region.right && region.bottom < region.top); }
+
+	[[nodiscard]] constexpr bool intersects(damaged_region const& a, damaged_region const& b)
+	{
+		return a.left < b.right && b.left < a.right
+			&& a.bottom < b.top && b.bottom < a.top;
+	}
+
+	[[nodiscard]] constexpr damaged_region bounding_region(damaged_region const& a, damaged_region const& b)
+	{
+		return damaged_region{
+			.left = std::min(a.left, b.left),
+			.bottom = std::min(a.bottom, b.bottom),
+			.right = std::max(a.right, b.right),
+			.top = std::max(a.top, b.top)
+		};
+	}
+
+	[[nodiscard]] inline damaged_region bounding_region(widget_geometry const& box, displacement offset)
+	{
+		auto const r = to_scaling(0.5*box.size);
+		auto const offset_to_origin = (location{0.0f, 0.0f, 0.0f} - box.origin).apply(r);
+		auto const object_midpoint = box.where + offset + offset_to_origin;
+		return damaged_region{
+			.left = object_midpoint[0] - r[0],
+			.bottom = object_midpoint[1] - r[1],
+			.right = object_midpoint[0] + r[0],
+			.top = object_midpoint[1] + r[1]
+		};
+	}
+
+	[[nodiscard]] constexpr damaged_region whole_window(fb_size size)
+	{
+		return damaged_region{
+			.left = 0.0f,
+			.bottom = -static_cast<float>(size.height),
+			.right = static_cast<float>(size.width),
+			.top = 0.0f
+		};
+	}
+
+	/**
+	 * Collects the regions of a window that must be redrawn. Overlapping regions are merged. Since
+	 * each region is drawn separately, the number of regions is limited. When the limit is
+	 * reached, all regions are replaced by their bounding region.
+	 */
+	class damage_list
+	{
+	public:
+		static constexpr size_t max_region_count = 8;
+
+		damage_list& add(damaged_region region)
+		{
+			if(is_empty(region))
+			{ return *this; }
+
+			auto k = size_t{0};
+			while(k != m_region_count)
+			{
+				if(intersects(region, m_regions[k]))
+				{
+					region = bounding_region(region, m_regions[k]);
+					m_regions[k] = m_regions[m_region_count - 1];
+					--m_region_count;
+					// The grown region may now intersect regions that have already been tested
+					k = 0;
+				}
+				else
+				{ ++k; }
+			}
+
+			if(m_region_count == max_region_count)
+			{
+				for(auto const& item : regions())
+				{ region = bounding_region(region, item); }
+				m_region_count = 0;
+			}
+
+			m_regions[m_region_count] = region;
+			++m_region_count;
+			return *this;
+		}
+
+		damage_list& clear()
+		{
+			m_region_count = 0;
+			return *this;
+		}
+
+		[[nodiscard]] bool empty() const
+		{ return m_region_count == 0; }
+
+		[[nodiscard]] std::span<damaged_region const> regions() const
+		{ return std::span{std::data(m_regions), m_region_count}; }
+
+	private:
+		std::array<damaged_region, max_region_count> m_regions;
+		size_t m_region_count{0};
+	};
+}
+
+#endif
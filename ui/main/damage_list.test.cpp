@@ -0,0 +1,120 @@
+//@	{"target":{"name":"damage_list.test"}}
+
+#include "./damage_list.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+TESTCASE(terraformer_ui_main_damaged_region_from_widget_geometry)
+{
+	auto const region = terraformer::ui::main::bounding_region(
+		terraformer::ui::main::widget_geometry{
+			.where = terraformer::location{10.0f, -20.0f, 0.0f},
+			.origin = terraformer::location{-1.0f, 1.0f, 0.0f},
+			.size = terraformer::box_size{30.0f, 40.0f, 0.0f}
+		},
+		terraformer::displacement{5.0f, -5.0f, 0.0f}
+	);
+
+	EXPECT_EQ(region.left, 15.0f);
+	EXPECT_EQ(region.right, 45.0f);
+	EXPECT_EQ(region.top, -25.0f);
+	EXPECT_EQ(region.bottom, -65.0f);
+}
+
+TESTCASE(terraformer_ui_main_damage_list_add_empty_region)
+{
+	terraformer::ui::main::damage_list damage;
+	damage.add(terraformer::ui::main::damaged_region{
+		.left = 1.0f,
+		.bottom = -1.0f,
+		.right = 1.0f,
+		.top = 0.0f
+	});
+	EXPECT_EQ(damage.empty(), true);
+}
+
+TESTCASE(terraformer_ui_main_damage_list_add_disjoint_regions)
+{
+	terraformer::ui::main::damage_list damage;
+	terraformer::ui::main::damaged_region const a{
+		.left = 0.0f,
+		.bottom = -10.0f,
+		.right = 10.0f,
+		.top = 0.0f
+	};
+	terraformer::ui::main::damaged_region const b{
+		.left = 10.0f,
+		.bottom = -10.0f,
+		.right = 20.0f,
+		.top = 0.0f
+	};
+	damage.add(a).add(b);
+
+	REQUIRE_EQ(std::size(damage.regions()), 2);
+	EXPECT_EQ(damage.regions()[0], a);
+	EXPECT_EQ(damage.regions()[1], b);
+
+	damage.clear();
+	EXPECT_EQ(damage.empty(), true);
+}
+
+TESTCASE(terraformer_ui_main_damage_list_add_merges_overlapping_regions)
+{
+	terraformer::ui::main::damage_list damage;
+	damage.add(terraformer::ui::main::damaged_region{
+			.left = 0.0f,
+			.bottom = -10.0f,
+			.right = 10.0f,
+			.top = 0.0f
+		})
+		.add(terraformer::ui::main::damaged_region{
+			.left = 20.0f,
+			.bottom = -10.0f,
+			.right = 30.0f,
+			.top = 0.0f
+		})
+		// Overlaps both of the previous regions
+		.add(terraformer::ui::main::damaged_region{
+			.left = 5.0f,
+			.bottom = -20.0f,
+			.right = 25.0f,
+			.top = -5.0f
+		});
+
+	REQUIRE_EQ(std::size(damage.regions()), 1);
+	EXPECT_EQ(
+		damage.regions()[0],
+		(terraformer::ui::main::damaged_region{
+			.left = 0.0f,
+			.bottom = -20.0f,
+			.right = 30.0f,
+			.top = 0.0f
+		})
+	);
+}
+
+TESTCASE(terraformer_ui_main_damage_list_add_too_many_regions)
+{
+	terraformer::ui::main::damage_list damage;
+	for(size_t k = 0; k != terraformer::ui::main::damage_list::max_region_count + 1; ++k)
+	{
+		auto const x = 10.0f*static_cast<float>(k);
+		damage.add(terraformer::ui::main::damaged_region{
+			.left = x,
+			.bottom = -5.0f,
+			.right = x + 5.0f,
+			.top = 0.0f
+		});
+	}
+
+	REQUIRE_EQ(std::size(damage.regions()), 1);
+	EXPECT_EQ(
+		damage.regions()[0],
+		(terraformer::ui::main::damaged_region{
+			.left = 0.0f,
+			.bottom = -5.0f,
+			.right = 85.0f,
+			.top = 0.0f
+		})
+	);
+}
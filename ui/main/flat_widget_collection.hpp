@@ -7,6 +7,8 @@
 
 #include "lib/array_classes/single_array.hpp"
 
+#include <unordered_map>
+
 namespace terraformer::ui::main
 {
 	template<class WidgetCollection>
@@ -177,12 +179,22 @@ namespace terraformer::ui::main
 		static constexpr index_type npos{static_cast<size_t>(-1)};
 
 		template<class ... Args>
-		flat_widget_collection& append(Args&&... args)
+		flat_widget_collection& append(void* widget, Args&&... args)
 		{
-			m_array.push_back(std::forward<Args>(args)...);
+			m_array.push_back(widget, std::forward<Args>(args)...);
+			m_index_of.insert_or_assign(widget, m_array.element_indices().back());
 			return *this;
 		}
 
+		/**
+		 * Returns the index of widget, or npos if widget is not part of the collection
+		 */
+		index_type find(void const* widget) const
+		{
+			auto const i = m_index_of.find(widget);
+			return i != std::end(m_index_of)? i->second : npos;
+		}
+
 		auto attributes() const
 		{ return flat_widget_collection_view{m_array.attributes()}; }
 
@@ -194,6 +206,7 @@ namespace terraformer::ui::main
 
 	private:
 		widget_array m_array;
+		std::unordered_map<void const*, index_type> m_index_of;
 	};
 
 	void flatten(widget_tree_address const& widget, flat_widget_collection& ret);
@@ -212,7 +225,7 @@ namespace terraformer::ui::main
 	}
 
 	inline auto find(find_recursive_result const& res, flat_widget_collection const& widgets)
-	{ return find(res, widgets.attributes()); }
+	{ return res.empty()? flat_widget_collection::npos : widgets.find(res.pointer()); }
 }
 
 #endif
\ No newline at end of file
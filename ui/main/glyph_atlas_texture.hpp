@@ -0,0 +1,52 @@
+#ifndef TERRAFORMER_UI_MAIN_GLYPH_ATLAS_TEXTURE_HPP
+#define TERRAFORMER_UI_MAIN_GLYPH_ATLAS_TEXTURE_HPP
+
+#include "./texture.hpp"
+
+#include "ui/font_handling/glyph_atlas.hpp"
+
+namespace terraformer::ui::main
+{
+	/**
+	 * A glyph atlas, together with a texture that is updated whenever new glyphs have been added
+	 * to the atlas. The atlas is shared between all widgets that present text through glyph quads.
+	 */
+	class glyph_atlas_texture
+	{
+	public:
+		explicit glyph_atlas_texture(uint32_t width, uint32_t initial_height, uint32_t max_height):
+			m_atlas{width, initial_height, max_height}
+		{}
+
+		font_handling::glyph_atlas& atlas()
+		{ return m_atlas; }
+
+		font_handling::glyph_atlas const& atlas() const
+		{ return m_atlas; }
+
+		template<class GraphicsBackend>
+		texture& get_backend_resource(GraphicsBackend& backend) const
+		{
+			if(!m_texture.belongs_to_backend(backend.get_global_id())) [[unlikely]]
+			{
+				m_texture = backend.create(std::type_identity<texture>{}, m_atlas.image());
+				m_uploaded_generation = m_atlas.generation();
+				return m_texture;
+			}
+
+			if(m_uploaded_generation != m_atlas.generation()) [[unlikely]]
+			{
+				m_texture.upload(m_atlas.pixels());
+				m_uploaded_generation = m_atlas.generation();
+			}
+			return m_texture;
+		}
+
+	private:
+		font_handling::glyph_atlas m_atlas;
+		mutable texture m_texture;
+		mutable size_t m_uploaded_generation{0};
+	};
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef TERRAFORMER_UI_MAIN_GLYPH_QUAD_BUFFER_HPP
+#define TERRAFORMER_UI_MAIN_GLYPH_QUAD_BUFFER_HPP
+
+#include "./staged_resource.hpp"
+
+#include "ui/font_handling/glyph_atlas.hpp"
+#include "lib/common/unique_resource.hpp"
+
+#include <span>
+#include <vector>
+
+namespace terraformer::ui::main
+{
+	struct glyph_quad_buffer_vtable
+	{
+		template<class RealBuffer>
+		explicit constexpr glyph_quad_buffer_vtable(std::type_identity<RealBuffer>):
+			upload{
+				[](void* handle, std::span<font_handling::glyph_quad const> quads){
+					static_cast<RealBuffer*>(handle)->upload(quads);
+				}
+			},
+			bind{
+				[](void* handle){
+					static_cast<RealBuffer*>(handle)->bind();
+				}
+			},
+			size{
+				[](void const* handle){
+					return static_cast<RealBuffer const*>(handle)->size();
+				}
+			}
+		{}
+
+		void (*upload)(void*, std::span<font_handling::glyph_quad const>);
+		void (*bind)(void*);
+		size_t (*size)(void const*);
+	};
+
+	class glyph_quad_buffer_ref
+	{
+	public:
+		glyph_quad_buffer_ref() = default;
+
+		explicit glyph_quad_buffer_ref(resource_reference<glyph_quad_buffer_vtable> reference):
+			m_reference{reference}
+		{}
+
+		void upload(std::span<font_handling::glyph_quad const> quads) const
+		{ m_reference.get_vtable().upload(m_reference.get_pointer(), quads); }
+
+		void bind() const
+		{ m_reference.get_vtable().bind(m_reference.get_pointer()); }
+
+		size_t size() const
+		{ return m_reference.get_vtable().size(m_reference.get_pointer()); }
+
+		operator bool() const
+		{ return static_cast<bool>(m_reference); }
+
+	private:
+		resource_reference<glyph_quad_buffer_vtable> m_reference;
+	};
+
+	/**
+	 * A buffer of glyph quads owned by a graphics backend. The backend draws one instance of a
+	 * textured quad for every glyph quad.
+	 */
+	class glyph_quad_buffer
+	{
+	public:
+		glyph_quad_buffer() = default;
+
+		template<class RealBuffer, class... Args>
+		explicit glyph_quad_buffer(std::in_place_type_t<RealBuffer>, uint64_t backend_id, Args&&... args):
+			m_handle{std::in_place_type_t<RealBuffer>{}, std::forward<Args>(args)...},
+			m_backend_id{backend_id}
+		{}
+
+		void upload(std::span<font_handling::glyph_quad const> quads)
+		{ m_handle.get().get_vtable().upload(m_handle.get().get_pointer(), quads); }
+
+		bool belongs_to_backend(uint64_t backend) const
+		{ return static_cast<bool>(m_handle) && m_backend_id == backend; }
+
+		glyph_quad_buffer_ref get()
+		{ return glyph_quad_buffer_ref{m_handle.get()}; }
+
+	private:
+		unique_resource<glyph_quad_buffer_vtable> m_handle;
+		uint64_t m_backend_id{};
+	};
+
+	using staged_glyph_quads = staged_resource<glyph_quad_buffer, std::vector<font_handling::glyph_quad>>;
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define TERRAFORMER_UI_MAIN_GRAPHICS_RESOURCE_FACTORY_REF_HPP
 
 #include "./texture.hpp"
+#include "./glyph_quad_buffer.hpp"
 
 namespace terraformer::ui::main
 {
@@ -18,6 +19,15 @@ namespace terraformer::ui::main
 		texture create(std::type_identity<texture>, image const& src)
 		{ return m_vtable_pointer->create_texture_from_image(m_handle, m_global_id, src);}
 
+		texture create(std::type_identity<texture>, grayscale_image const& src)
+		{ return m_vtable_pointer->create_texture_from_grayscale_image(m_handle, m_global_id, src);}
+
+		glyph_quad_buffer create(
+			std::type_identity<glyph_quad_buffer>,
+			std::span<font_handling::glyph_quad const> quads
+		)
+		{ return m_vtable_pointer->create_glyph_quad_buffer(m_handle, m_global_id, quads);}
+
 		uint64_t get_global_id() const
 		{ return m_global_id; }
 
@@ -25,6 +35,12 @@ namespace terraformer::ui::main
 		struct vtable
 		{
 			texture (*create_texture_from_image)(void*, uint64_t, image const&);
+			texture (*create_texture_from_grayscale_image)(void*, uint64_t, grayscale_image const&);
+			glyph_quad_buffer (*create_glyph_quad_buffer)(
+				void*,
+				uint64_t,
+				std::span<font_handling::glyph_quad const>
+			);
 		};
 
 		template<class BackendType>
@@ -32,6 +48,18 @@ namespace terraformer::ui::main
 			.create_texture_from_image = [](void* object, uint64_t global_id, image const& img) {
 				return static_cast<BackendType*>(object)
 					->create(std::type_identity<texture>{}, global_id, img);
+			},
+			.create_texture_from_grayscale_image = [](void* object, uint64_t global_id, grayscale_image const& img) {
+				return static_cast<BackendType*>(object)
+					->create(std::type_identity<texture>{}, global_id, img);
+			},
+			.create_glyph_quad_buffer = [](
+				void* object,
+				uint64_t global_id,
+				std::span<font_handling::glyph_quad const> quads
+			) {
+				return static_cast<BackendType*>(object)
+					->create(std::type_identity<glyph_quad_buffer>{}, global_id, quads);
 			}
 		};
 
@@ -10,10 +10,30 @@ namespace
 	{
 		explicit dummy_texture(terraformer::span_2d<terraformer::rgba_pixel const>){}
 
+		explicit dummy_texture(terraformer::span_2d<float const>){}
+
 		void upload(terraformer::span_2d<terraformer::rgba_pixel const>) {}
+		void upload(terraformer::span_2d<float const>) {}
 		void bind(int){};
 	};
 
+	struct dummy_glyph_quad_buffer
+	{
+		explicit dummy_glyph_quad_buffer(std::span<terraformer::ui::font_handling::glyph_quad const> quads):
+			quad_count{std::size(quads)}
+		{}
+
+		void upload(std::span<terraformer::ui::font_handling::glyph_quad const> quads)
+		{ quad_count = std::size(quads); }
+
+		void bind(){}
+
+		size_t size() const
+		{ return quad_count; }
+
+		size_t quad_count;
+	};
+
 	struct dummy_backend
 	{
 		constexpr uint64_t get_global_id() const
@@ -27,6 +47,28 @@ namespace
 		{
 			return terraformer::ui::main::texture{std::in_place_type_t<dummy_texture>{}, backend_id, img};
 		}
+
+		auto create(
+			std::type_identity<terraformer::ui::main::texture>,
+			uint64_t backend_id,
+			terraformer::grayscale_image const& img
+		)
+		{
+			return terraformer::ui::main::texture{std::in_place_type_t<dummy_texture>{}, backend_id, img};
+		}
+
+		auto create(
+			std::type_identity<terraformer::ui::main::glyph_quad_buffer>,
+			uint64_t backend_id,
+			std::span<terraformer::ui::font_handling::glyph_quad const> quads
+		)
+		{
+			return terraformer::ui::main::glyph_quad_buffer{
+				std::in_place_type_t<dummy_glyph_quad_buffer>{},
+				backend_id,
+				quads
+			};
+		}
 	};
 }
 
@@ -44,3 +86,22 @@ TESTCASE(terraformer_resource_backend_ref_create_texture)
 	EXPECT_EQ(texture.belongs_to_backend(3), false);
 }
 
+
+TESTCASE(terraformer_resource_backend_ref_create_glyph_quad_buffer)
+{
+	dummy_backend my_backend;
+	terraformer::ui::main::graphics_backend_ref resource_factroy{my_backend};
+	std::vector<terraformer::ui::font_handling::glyph_quad> quads(3);
+	auto buffer = resource_factroy.create(
+		std::type_identity<terraformer::ui::main::glyph_quad_buffer>{},
+		quads
+	);
+
+	EXPECT_EQ(buffer.belongs_to_backend(my_backend.get_global_id()), true);
+	EXPECT_EQ(buffer.belongs_to_backend(3), false);
+	EXPECT_EQ(buffer.get().size(), 3);
+
+	quads.resize(5);
+	buffer.upload(quads);
+	EXPECT_EQ(buffer.get().size(), 5);
+}
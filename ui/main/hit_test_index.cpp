@@ -0,0 +1,166 @@
+//@	{"target":{"name":"hit_test_index.o"}}
+
+#include "./hit_test_index.hpp"
+#include "./damage_list.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+terraformer::ui::main::hit_test_index::hit_test_index(
+	widget_collection_ref const& widgets,
+	displacement offset
+):
+	m_offset{offset}
+{
+	m_collections.push_back(
+		collection_info{
+			.widgets = widgets,
+			.offset = offset,
+			.parent = static_cast<size_t>(-1)
+		}
+	);
+
+	// Collect all widgets, together with their bounding regions
+	std::vector<damaged_region> regions;
+	auto bounding_box = damaged_region{
+		.left = INFINITY,
+		.bottom = INFINITY,
+		.right = -INFINITY,
+		.top = -INFINITY
+	};
+	for(size_t collection = 0; collection != std::size(m_collections); ++collection)
+	{
+		// NOTE: m_collections grows within the loop, so current must be a copy
+		auto const current = m_collections[collection];
+		auto const widget_pointers = current.widgets.widget_pointers();
+		auto const widget_geometries = current.widgets.widget_geometries();
+		auto const get_children_callbacks = current.widgets.get_children_callbacks();
+		for(auto k : current.widgets.element_indices())
+		{
+			auto const region = bounding_region(widget_geometries[k], current.offset);
+			auto const widget = std::size(m_widgets);
+			m_widgets.push_back(widget_info{.collection = collection, .index = k});
+			regions.push_back(region);
+			if(!is_empty(region))
+			{ bounding_box = bounding_region(bounding_box, region); }
+
+			auto const children = get_children_callbacks[k](widget_pointers[k]);
+			if(!children.element_indices().empty())
+			{
+				m_collections.push_back(
+					collection_info{
+						.widgets = children,
+						.offset = widget_geometries[k].where + current.offset - location{0.0f, 0.0f, 0.0f},
+						.parent = widget
+					}
+				);
+			}
+		}
+	}
+
+	if(is_empty(bounding_box))
+	{ return; }
+
+	// Aim for a constant number of widgets per cell
+	auto const grid_size = std::clamp(
+		static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(std::size(m_widgets))))),
+		size_t{1},
+		size_t{256}
+	);
+	m_grid_width = grid_size;
+	m_grid_height = grid_size;
+	m_grid_origin = location{bounding_box.left, bounding_box.bottom, 0.0f};
+	m_cell_width = (bounding_box.right - bounding_box.left)/static_cast<float>(m_grid_width);
+	m_cell_height = (bounding_box.top - bounding_box.bottom)/static_cast<float>(m_grid_height);
+
+	// Count the number of widgets in each cell, and then fill the cells. Widgets that cannot
+	// contain any point are left out.
+	m_cell_start.resize(m_grid_width*m_grid_height + 1);
+	auto const for_each_cell = [this](damaged_region const& region, auto&& func) {
+		auto const col_end = column_of(region.right) + 1;
+		auto const row_end = row_of(region.top) + 1;
+		for(auto row = row_of(region.bottom); row != row_end; ++row)
+		{
+			for(auto col = column_of(region.left); col != col_end; ++col)
+			{ func(row*m_grid_width + col); }
+		}
+	};
+
+	for(auto const& region : regions)
+	{
+		if(!is_empty(region))
+		{ for_each_cell(region, [this](size_t cell){ ++m_cell_start[cell + 1]; }); }
+	}
+
+	for(size_t k = 1; k != std::size(m_cell_start); ++k)
+	{ m_cell_start[k] += m_cell_start[k - 1]; }
+
+	m_cell_content.resize(m_cell_start.back());
+	std::vector<size_t> cell_fill(std::begin(m_cell_start), std::end(m_cell_start) - 1);
+	for(size_t widget = 0; widget != std::size(regions); ++widget)
+	{
+		if(!is_empty(regions[widget]))
+		{
+			for_each_cell(regions[widget], [this, &cell_fill, widget](size_t cell){
+				m_cell_content[cell_fill[cell]] = widget;
+				++cell_fill[cell];
+			});
+		}
+	}
+}
+
+size_t terraformer::ui::main::hit_test_index::column_of(float x) const
+{
+	auto const col = std::floor((x - m_grid_origin[0])/m_cell_width);
+	return static_cast<size_t>(std::clamp(col, 0.0f, static_cast<float>(m_grid_width - 1)));
+}
+
+size_t terraformer::ui::main::hit_test_index::row_of(float y) const
+{
+	auto const row = std::floor((y - m_grid_origin[1])/m_cell_height);
+	return static_cast<size_t>(std::clamp(row, 0.0f, static_cast<float>(m_grid_height - 1)));
+}
+
+terraformer::ui::main::find_recursive_result
+terraformer::ui::main::hit_test_index::find(cursor_position pos) const
+{
+	find_recursive_result ret{widget_collection_ref{}, widget_collection_ref::npos, m_offset};
+	if(m_cell_content.empty())
+	{ return ret; }
+
+	auto const loc = location{static_cast<float>(pos.x), static_cast<float>(pos.y), 0.0f};
+	if(std::isnan(loc[0]) || std::isnan(loc[1])) [[unlikely]]
+	{ return ret; }
+
+	auto const cell = row_of(loc[1])*m_grid_width + column_of(loc[0]);
+	auto const first = std::begin(m_cell_content) + static_cast<ptrdiff_t>(m_cell_start[cell]);
+	auto const last = std::begin(m_cell_content) + static_cast<ptrdiff_t>(m_cell_start[cell + 1]);
+
+	// Like find_recursive, pick the first widget that contains pos, and continue with its
+	// children, until no child contains pos
+	auto parent = static_cast<size_t>(-1);
+	while(true)
+	{
+		auto found = static_cast<size_t>(-1);
+		for(auto i = first; i != last; ++i)
+		{
+			auto const& widget = m_widgets[*i];
+			auto const& collection = m_collections[widget.collection];
+			if(collection.parent != parent)
+			{ continue; }
+
+			if(found != static_cast<size_t>(-1) && m_widgets[found].index < widget.index)
+			{ continue; }
+
+			if(inside(loc - collection.offset, collection.widgets.widget_geometries()[widget.index]))
+			{ found = *i; }
+		}
+
+		if(found == static_cast<size_t>(-1))
+		{ return ret; }
+
+		auto const& collection = m_collections[m_widgets[found].collection];
+		ret = find_recursive_result{collection.widgets, m_widgets[found].index, collection.offset};
+		parent = found;
+	}
+}
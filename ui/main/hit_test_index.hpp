@@ -0,0 +1,60 @@
+//@	{"dependencies_extra":[{"ref":"./hit_test_index.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_UI_MAIN_HIT_TEST_INDEX_HPP
+#define TERRAFORMER_UI_MAIN_HIT_TEST_INDEX_HPP
+
+#include "./widget_collection_ref.hpp"
+
+#include <vector>
+
+namespace terraformer::ui::main
+{
+	/**
+	 * A uniform grid over the bounding boxes of all widgets in a widget tree, that makes it
+	 * possible to find the widget under the cursor without visiting all widgets in the tree. The
+	 * result is the same as from find_recursive, as long as the layout is the same as when the
+	 * index was built. The index must be rebuilt when the layout, or the widget tree, has changed.
+	 */
+	class hit_test_index
+	{
+	public:
+		hit_test_index() = default;
+
+		explicit hit_test_index(widget_collection_ref const& widgets, displacement offset = displacement{});
+
+		[[nodiscard]] find_recursive_result find(cursor_position pos) const;
+
+	private:
+		struct collection_info
+		{
+			widget_collection_ref widgets;
+			displacement offset;
+			size_t parent;
+		};
+
+		struct widget_info
+		{
+			size_t collection;
+			widget_collection_ref::index_type index;
+		};
+
+		std::vector<collection_info> m_collections;
+		std::vector<widget_info> m_widgets;
+		displacement m_offset;
+
+		// Widgets that overlap grid cell k are stored in m_cell_content, from m_cell_start[k] to
+		// m_cell_start[k + 1]
+		std::vector<size_t> m_cell_start;
+		std::vector<size_t> m_cell_content;
+		location m_grid_origin{0.0f, 0.0f, 0.0f};
+		float m_cell_width{1.0f};
+		float m_cell_height{1.0f};
+		size_t m_grid_width{0};
+		size_t m_grid_height{0};
+
+		size_t column_of(float x) const;
+		size_t row_of(float y) const;
+	};
+}
+
+#endif
@@ -0,0 +1,115 @@
+//@	{"target":{"name":"hit_test_index.test"}}
+
+#include "./hit_test_index.hpp"
+#include "./widget_collection.hpp"
+
+#include <testfwk/testfwk.hpp>
+
+#include <array>
+
+namespace
+{
+	struct null_iterator_invalidation_handler
+	{
+		void iterators_invalidated(terraformer::ui::main::widget_collection const&){}
+	};
+
+	struct leaf_widget : terraformer::ui::main::widget_with_default_actions
+	{};
+
+	struct container_widget : terraformer::ui::main::widget_with_default_actions
+	{
+		explicit container_widget(null_iterator_invalidation_handler& iihr):
+			children{terraformer::ui::main::widget_collection::iterator_invalidation_handler_ref{std::ref(iihr)}}
+		{}
+
+		terraformer::ui::main::widget_collection_ref get_children()
+		{ return children.get_attributes(); }
+
+		terraformer::ui::main::widget_collection_view get_children() const
+		{ return children.get_attributes(); }
+
+		terraformer::ui::main::widget_collection children;
+	};
+
+	terraformer::ui::main::widget_geometry make_geometry(float x, float y, float width, float height)
+	{
+		return terraformer::ui::main::widget_geometry{
+			.where = terraformer::location{x, y, 0.0f},
+			.origin = terraformer::location{-1.0f, 1.0f, 0.0f},
+			.size = terraformer::box_size{width, height, 0.0f}
+		};
+	}
+}
+
+TESTCASE(terraformer_ui_main_hit_test_index_find_same_as_find_recursive)
+{
+	null_iterator_invalidation_handler iihr;
+	std::array<leaf_widget, 8> leaves;
+	std::array<container_widget, 3> containers{
+		container_widget{iihr},
+		container_widget{iihr},
+		container_widget{iihr}
+	};
+
+	// Two sections with two rows of leaves each
+	containers[1].children
+		.append(std::ref(leaves[0]), make_geometry(5.0f, -5.0f, 40.0f, 20.0f))
+		.append(std::ref(leaves[1]), make_geometry(50.0f, -5.0f, 40.0f, 20.0f))
+		.append(std::ref(leaves[2]), make_geometry(5.0f, -30.0f, 40.0f, 20.0f))
+		// Extends beyond the section, and can only be found within it
+		.append(std::ref(leaves[3]), make_geometry(50.0f, -30.0f, 80.0f, 40.0f));
+	containers[2].children
+		.append(std::ref(leaves[4]), make_geometry(5.0f, -5.0f, 40.0f, 20.0f))
+		// Overlaps the previous leaf, so the previous one should be found in the overlap
+		.append(std::ref(leaves[5]), make_geometry(30.0f, -15.0f, 40.0f, 20.0f))
+		// Cannot contain any point
+		.append(std::ref(leaves[6]), make_geometry(5.0f, -40.0f, 0.0f, 20.0f));
+
+	containers[0].children
+		.append(std::ref(containers[1]), make_geometry(10.0f, -10.0f, 100.0f, 60.0f))
+		.append(std::ref(containers[2]), make_geometry(10.0f, -80.0f, 100.0f, 60.0f))
+		.append(std::ref(leaves[7]), make_geometry(120.0f, -10.0f, 30.0f, 130.0f));
+
+	terraformer::ui::main::widget_collection root{
+		terraformer::ui::main::widget_collection::iterator_invalidation_handler_ref{std::ref(iihr)}
+	};
+	root.append(std::ref(containers[0]), make_geometry(0.0f, 0.0f, 160.0f, 150.0f));
+
+	auto const offset = terraformer::displacement{2.0f, -3.0f, 0.0f};
+	terraformer::ui::main::hit_test_index const index{root.get_attributes(), offset};
+
+	size_t found_count = 0;
+	for(int y = -170; y <= 10; ++y)
+	{
+		for(int x = -10; x <= 180; ++x)
+		{
+			terraformer::ui::main::cursor_position const pos{static_cast<double>(x), static_cast<double>(y)};
+			auto const expected = terraformer::ui::main::find_recursive(pos, root.get_attributes(), offset);
+			auto const actual = index.find(pos);
+			EXPECT_EQ(actual == expected, true);
+			EXPECT_EQ(actual.geometric_offset(), expected.geometric_offset());
+			if(!expected.empty())
+			{
+				EXPECT_EQ(actual.pointer(), expected.pointer());
+				found_count += expected.pointer() != &containers[0]? 1 : 0;
+			}
+		}
+	}
+
+	// Make sure that the test actually finds widgets other than the root
+	EXPECT_NE(found_count, 0);
+}
+
+TESTCASE(terraformer_ui_main_hit_test_index_find_in_empty_tree)
+{
+	null_iterator_invalidation_handler iihr;
+	terraformer::ui::main::widget_collection root{
+		terraformer::ui::main::widget_collection::iterator_invalidation_handler_ref{std::ref(iihr)}
+	};
+	terraformer::ui::main::hit_test_index const index{root.get_attributes()};
+	EXPECT_EQ(index.find(terraformer::ui::main::cursor_position{0.0, 0.0}).empty(), true);
+
+	terraformer::ui::main::hit_test_index const default_index;
+	EXPECT_EQ(default_index.find(terraformer::ui::main::cursor_position{0.0, 0.0}).empty(), true);
+}
@@ -73,9 +73,32 @@ namespace terraformer::ui::main
 		{std::as_const(obj).get_dimensions()} -> std::same_as<box_size>;
 	};
 
+	/**
+	 * A layout may also implement
+	 *
+	 *     void update_default_cell_sizes(
+	 *         span<box_size const> sizes_in,
+	 *         span<array_index<box_size> const> changed_cells
+	 *     );
+	 *
+	 * which has the same effect as set_default_cell_sizes_to, given that only the cells in
+	 * changed_cells differ from the previous call. Layouts that do not implement it are updated
+	 * through set_default_cell_sizes_to.
+	 */
+	template<class T>
+	concept incremental_layout = layout<T> && requires(
+		T& obj,
+		span<box_size const> sizes_in,
+		span<array_index<box_size> const> changed_cells
+	)
+	{
+		{obj.update_default_cell_sizes(sizes_in, changed_cells)} -> std::same_as<void>;
+	};
+
 	struct layout_vtable
 	{
 		void (*set_default_cell_sizes_to)(void*, span<box_size const>);
+		void (*update_default_cell_sizes)(void*, span<box_size const>, span<array_index<box_size> const>);
 		void (*adjust_cell_widths)(void*, float, span<float const>);
 		void (*adjust_cell_heights)(void*, float, span<float const>);
 		void (*get_cell_sizes_into)(void const*, span<box_size>);
@@ -88,6 +111,16 @@ namespace terraformer::ui::main
 		.set_default_cell_sizes_to = [](void* obj, span<box_size const> vals) {
 			static_cast<T*>(obj)->set_default_cell_sizes_to(vals);
 		},
+		.update_default_cell_sizes = [](
+			void* obj,
+			span<box_size const> vals,
+			[[maybe_unused]] span<array_index<box_size> const> changed_cells
+		) {
+			if constexpr(incremental_layout<T>)
+			{ static_cast<T*>(obj)->update_default_cell_sizes(vals, changed_cells); }
+			else
+			{ static_cast<T*>(obj)->set_default_cell_sizes_to(vals); }
+		},
 		.adjust_cell_widths = [](void* obj, float available_width, span<float const> size_overrides){
 			static_cast<T*>(obj)->adjust_cell_widths(available_width, size_overrides);
 		},
@@ -119,6 +152,12 @@ namespace terraformer::ui::main
 		void set_default_cell_sizes_to(span<box_size const> vals) const
 		{ m_vtable->set_default_cell_sizes_to(m_object, vals); }
 
+		void update_default_cell_sizes(
+			span<box_size const> vals,
+			span<array_index<box_size> const> changed_cells
+		) const
+		{ m_vtable->update_default_cell_sizes(m_object, vals, changed_cells); }
+
 		void adjust_cell_widths(float available_width, span<float const> size_overrides) const
 		{ m_vtable->adjust_cell_widths(m_object, available_width, size_overrides); }
 
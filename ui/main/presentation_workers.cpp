@@ -0,0 +1,15 @@
+//@	{"target":{"name":"presentation_workers.o"}}
+
+#include "./presentation_workers.hpp"
+
+#include <algorithm>
+#include <thread>
+
+terraformer::thread_pool<terraformer::move_only_function<void()>>&
+terraformer::ui::main::get_presentation_workers()
+{
+	static thread_pool<move_only_function<void()>> workers{
+		std::max(std::thread::hardware_concurrency(), 1u)
+	};
+	return workers;
+}
@@ -0,0 +1,20 @@
+//@	{"dependencies_extra":[{"ref":"./presentation_workers.o", "rel":"implementation"}]}
+
+#ifndef TERRAFORMER_UI_MAIN_PRESENTATION_WORKERS_HPP
+#define TERRAFORMER_UI_MAIN_PRESENTATION_WORKERS_HPP
+
+#include "lib/common/move_only_function.hpp"
+#include "lib/execution/thread_pool.hpp"
+
+namespace terraformer::ui::main
+{
+	/**
+	 * Returns the thread pool that widgets use when preparing their content for presentation.
+	 *
+	 * \note Presentation does not share workers with generators. Otherwise, a redraw would have to
+	 *       wait until all queued generator tasks have completed.
+	 */
+	thread_pool<move_only_function<void()>>& get_presentation_workers();
+}
+
+#endif
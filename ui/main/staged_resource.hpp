@@ -24,6 +24,18 @@ namespace terraformer::ui::main
 			return *this;
 		}
 
+		/**
+		 * Modifies the frontend resource in place, so its storage can be reused. The backend
+		 * resource is updated next time it is requested.
+		 */
+		template<class Callable>
+		staged_resource& update_frontend_resource(Callable&& cb)
+		{
+			std::forward<Callable>(cb)(m_frontend_resource);
+			m_must_update_backend_resource = true;
+			return *this;
+		}
+
 		operator FrontendResource const&() const
 		{ return m_frontend_resource; }
 
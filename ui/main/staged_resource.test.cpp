@@ -150,4 +150,22 @@ TESTCASE(terraformer_ui_main_staged_resource_fetch_cached_value_after_update)
 	EXPECT_EQ(the_backend_resource.backend_id, the_backend_resource_backend.get_global_id());
 	EXPECT_EQ(the_backend_resource_backend.num_objects_created, 1);
 	EXPECT_EQ(the_backend_resource.upload_callcount, 1);
-}
\ No newline at end of file
+}
+
+TESTCASE(terraformer_ui_main_staged_resource_update_frontend_resource_triggers_upload)
+{
+	terraformer::ui::main::staged_resource<backend_resource, int> resource{123};
+	backend_resource_backend the_backend_resource_backend;
+	auto& the_backend_resource = resource.get_backend_resource(the_backend_resource_backend);
+	EXPECT_EQ(the_backend_resource.upload_callcount, 0);
+
+	resource.update_frontend_resource([](int& value){
+		value += 10;
+	});
+	EXPECT_EQ(resource.frontend_resource(), 133);
+
+	resource.get_backend_resource(the_backend_resource_backend);
+	EXPECT_EQ(the_backend_resource.value, 133);
+	EXPECT_EQ(the_backend_resource_backend.num_objects_created, 1);
+	EXPECT_EQ(the_backend_resource.upload_callcount, 1);
+}
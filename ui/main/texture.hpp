@@ -4,6 +4,8 @@
 #include "lib/pixel_store/image.hpp"
 #include "lib/common/unique_resource.hpp"
 
+#include <concepts>
+
 namespace terraformer::ui::main
 {
 	struct texture_vtable
@@ -15,15 +17,35 @@ namespace terraformer::ui::main
 					static_cast<RealTexture*>(handle)->upload(pixels);
 				}
 			},
+			upload_grayscale{
+				[](void* handle, span_2d<float const> pixels){
+					static_cast<RealTexture*>(handle)->upload(pixels);
+				}
+			},
 			bind{
 				[](void* handle, int shader_port){
 					static_cast<RealTexture*>(handle)->bind(shader_port);
 				}
+			},
+			get_bindless_handle{
+				[](void* handle) -> uint64_t {
+					if constexpr(requires(RealTexture& obj){ {obj.bindless_handle()} -> std::convertible_to<uint64_t>; })
+					{ return static_cast<RealTexture*>(handle)->bindless_handle(); }
+					else
+					{ return 0; }
+				}
 			}
 		{}
 
 		void (*upload)(void*, span_2d<rgba_pixel const>);
+		void (*upload_grayscale)(void*, span_2d<float const>);
 		void (*bind)(void*, int);
+
+		/**
+		 * Returns a handle that a shader can use to sample the texture without binding it, or zero
+		 * if the backend does not support that
+		 */
+		uint64_t (*get_bindless_handle)(void*);
 	};
 
 	class texture_ref
@@ -38,12 +60,21 @@ namespace terraformer::ui::main
 		void upload(span_2d<rgba_pixel const> pixels) const
 		{ m_reference.get_vtable().upload(m_reference.get_pointer(), pixels); }
 
+		void upload(span_2d<float const> pixels) const
+		{ m_reference.get_vtable().upload_grayscale(m_reference.get_pointer(), pixels); }
+
 		void bind(int shader_port) const
 		{ m_reference.get_vtable().bind(m_reference.get_pointer(), shader_port); }
 
+		uint64_t bindless_handle() const
+		{ return m_reference.get_vtable().get_bindless_handle(m_reference.get_pointer()); }
+
 		operator bool() const
 		{ return static_cast<bool>(m_reference); }
 
+		bool operator==(texture_ref const& other) const
+		{ return m_reference.get_pointer() == other.m_reference.get_pointer(); }
+
 	private:
 		resource_reference<texture_vtable> m_reference;
 	};
@@ -62,6 +93,9 @@ namespace terraformer::ui::main
 		void upload(span_2d<rgba_pixel const> pixels)
 		{ m_handle.get().get_vtable().upload(m_handle.get().get_pointer(), pixels); }
 
+		void upload(span_2d<float const> pixels)
+		{ m_handle.get().get_vtable().upload_grayscale(m_handle.get().get_pointer(), pixels); }
+
 		void bind(int shader_port)
 		{ m_handle.get().get_vtable().bind(m_handle.get().get_pointer(), shader_port); }
 
@@ -26,6 +26,11 @@ namespace
 		{
 			++(calls_to_upload.get());
 		}
+
+		void upload(terraformer::span_2d<float const>)
+		{
+			calls_to_upload.get() += 16;
+		}
 	};
 }
 
@@ -106,6 +111,17 @@ TESTCASE(terraformer_ui_main_texture_upload)
 	EXPECT_EQ(calls_to_upload, 1);
 }
 
+TESTCASE(terraformer_ui_main_texture_upload_grayscale)
+{
+	size_t calls_to_bind{0};
+	size_t calls_to_upload{0};
+	terraformer::ui::main::texture texture{std::in_place_type_t<dummy_texture>{}, 1, calls_to_bind, calls_to_upload};
+
+	texture.upload(terraformer::span_2d<float const>{});
+	EXPECT_EQ(calls_to_bind, 0);
+	EXPECT_EQ(calls_to_upload, 16);
+}
+
 TESTCASE(terraformer_ui_main_texture_bind)
 {
 	size_t calls_to_bind{0};
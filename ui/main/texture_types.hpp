@@ -13,6 +13,11 @@ namespace terraformer::ui::main
 	using immutable_shared_texture = std::shared_ptr<staged_texture const>;
 	using shared_texture = std::shared_ptr<staged_texture>;
 	using unique_texture = staged_texture;
+
+	/**
+	 * A single channel texture, where the shader is responsible for mapping values to colors
+	 */
+	using unique_grayscale_texture = staged_resource<texture, grayscale_image>;
 }
 
 #endif
\ No newline at end of file
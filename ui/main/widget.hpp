@@ -114,7 +114,10 @@ namespace terraformer::ui::main
 				)
 			),
 			.cursor_focus_indicator_mode = focus_indicator_mode::automatic,
-			.kbd_focus_indicator_mode = focus_indicator_mode::automatic
+			.kbd_focus_indicator_mode = focus_indicator_mode::automatic,
+			.needs_redraw = true,
+			.subtree_needs_redraw = true,
+			.size_request_is_dirty = true
 		};
 	}
 
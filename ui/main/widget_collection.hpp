@@ -52,6 +52,7 @@ namespace terraformer::ui::main
 				&w.get(),
 				initial_state,
 				box_size{},
+				cached_size_request{},
 				initial_geometry,
 				widget_layer_stack{},
 				[](void* obj, graphics_backend_ref backend) {
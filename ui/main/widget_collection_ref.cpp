@@ -14,20 +14,36 @@ terraformer::box_size terraformer::ui::main::run(minimize_cell_size_context cons
 
 	auto& children = ctxt.children();
 	auto const widget_states = children.widget_states();
+	auto const size_requests = children.size_requests();
 	auto const sizes = children.sizes();
+	single_array<array_index<box_size>> changed_cells;
 	for(auto k : children.element_indices())
 	{
-		if(widget_states[k].collapsed) [[unlikely]]
-		{ sizes[k] = box_size{}; }
+		auto& state = widget_states[k];
+		auto const prev_request = size_requests[k].value;
+		if(state.collapsed) [[unlikely]]
+		{
+			size_requests[k].value = box_size{};
+			// The widget may have changed while collapsed
+			state.size_request_is_dirty = true;
+		}
 		else
-		{ sizes[k] = run(minimize_cell_size_context{children, k}); }
+		if(state.size_request_is_dirty)
+		{
+			size_requests[k].value = run(minimize_cell_size_context{children, k});
+			state.size_request_is_dirty = false;
+		}
+
+		sizes[k] = size_requests[k].value;
+		if(sizes[k] != prev_request)
+		{ changed_cells.push_back(array_index<box_size>{k.get()}); }
 	}
 
 	auto const layout = ctxt.get_layout();
 	if(!layout.is_valid())
 	{ return initial_size; }
 
-	layout.set_default_cell_sizes_to(sizes);
+	layout.update_default_cell_sizes(sizes, changed_cells);
 	auto const size_from_layout = layout.get_dimensions();
 
 	return max(initial_size, size_from_layout);
@@ -128,6 +144,26 @@ void terraformer::ui::main::run(update_widget_location_context const& ctxt)
 	}
 }
 
+terraformer::box_size terraformer::ui::main::update_layout(
+	widget_collection_ref const& widgets,
+	widget_collection_ref::index_type index,
+	box_size available_size
+)
+{
+	auto& state = widgets.widget_states()[index];
+	if(state.size_request_is_dirty)
+	{
+		widgets.size_requests()[index].value = run(minimize_cell_size_context{widgets, index});
+		state.size_request_is_dirty = false;
+	}
+	widgets.sizes()[index] = widgets.size_requests()[index].value;
+
+	auto const size = run(adjust_cell_sizes_context{widgets, index}, available_size);
+	auto const new_size = run(confirm_widget_size_context{widgets, index}, size);
+	run(update_widget_location_context{widgets, index});
+	return new_size;
+}
+
 terraformer::ui::main::widget_layer_stack
 terraformer::ui::main::run(
 	prepare_for_presentation_context const& ctxt,
@@ -144,10 +180,210 @@ terraformer::ui::main::run(
 		{ continue; }
 
 		layer_stacks[k] = run(prepare_for_presentation_context{children, k}, backend);
+		widget_states[k].needs_redraw = false;
+		widget_states[k].subtree_needs_redraw = false;
 	}
 	return ret;
 }
 
+void terraformer::ui::main::prepare_dirty_widgets_for_presentation(
+	widget_collection_ref const& widgets,
+	graphics_backend_ref backend
+)
+{
+	auto const widget_pointers = widgets.widget_pointers();
+	auto const widget_states = widgets.widget_states();
+	auto const layer_stacks = widgets.widget_layer_stacks();
+	auto const render_callbacks = widgets.render_callbacks();
+	auto const get_children_callbacks = widgets.get_children_callbacks();
+	for(auto k : widgets.element_indices())
+	{
+		auto& state = widget_states[k];
+		if(state.hidden || state.collapsed) [[unlikely]]
+		{ continue; }
+
+		if(state.needs_redraw)
+		{
+			layer_stacks[k] = render_callbacks[k](widget_pointers[k], backend);
+			state.needs_redraw = false;
+		}
+
+		if(state.subtree_needs_redraw)
+		{
+			prepare_dirty_widgets_for_presentation(get_children_callbacks[k](widget_pointers[k]), backend);
+			state.subtree_needs_redraw = false;
+		}
+	}
+}
+
+namespace
+{
+	template<class TargetAction, class AncestorAction>
+	bool visit_path_to(
+		terraformer::ui::main::widget_collection_ref const& widgets,
+		void const* widget,
+		TargetAction&& on_target,
+		AncestorAction&& on_ancestor
+	)
+	{
+		auto const widget_pointers = widgets.widget_pointers();
+		auto const widget_states = widgets.widget_states();
+		auto const get_children_callbacks = widgets.get_children_callbacks();
+		for(auto k : widgets.element_indices())
+		{
+			if(widget_pointers[k] == widget)
+			{
+				on_target(widget_states[k]);
+				return true;
+			}
+
+			if(visit_path_to(get_children_callbacks[k](widget_pointers[k]), widget, on_target, on_ancestor))
+			{
+				on_ancestor(widget_states[k]);
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+bool terraformer::ui::main::mark_for_redraw(widget_collection_ref const& widgets, void const* widget)
+{
+	return visit_path_to(
+		widgets,
+		widget,
+		[](widget_state& state){ state.needs_redraw = true; },
+		[](widget_state& state){ state.subtree_needs_redraw = true; }
+	);
+}
+
+bool terraformer::ui::main::invalidate_size_request(widget_collection_ref const& widgets, void const* widget)
+{
+	auto const invalidate = [](widget_state& state){ state.size_request_is_dirty = true; };
+	return visit_path_to(widgets, widget, invalidate, invalidate);
+}
+
+void terraformer::ui::main::invalidate_size_requests(widget_collection_ref const& widgets)
+{
+	auto const widget_pointers = widgets.widget_pointers();
+	auto const widget_states = widgets.widget_states();
+	auto const get_children_callbacks = widgets.get_children_callbacks();
+	for(auto k : widgets.element_indices())
+	{
+		widget_states[k].size_request_is_dirty = true;
+		invalidate_size_requests(get_children_callbacks[k](widget_pointers[k]));
+	}
+}
+
+bool terraformer::ui::main::invalidate_size_requests_of_siblings(
+	widget_collection_ref const& widgets,
+	void const* widget
+)
+{
+	auto const widget_pointers = widgets.widget_pointers();
+	auto const widget_states = widgets.widget_states();
+	auto const get_children_callbacks = widgets.get_children_callbacks();
+	for(auto k : widgets.element_indices())
+	{
+		if(widget_pointers[k] == widget)
+		{
+			invalidate_size_requests(widgets);
+			return true;
+		}
+
+		if(invalidate_size_requests_of_siblings(get_children_callbacks[k](widget_pointers[k]), widget))
+		{
+			widget_states[k].size_request_is_dirty = true;
+			return true;
+		}
+	}
+	return false;
+}
+
+namespace
+{
+	void mark_tree_for_redraw(terraformer::ui::main::widget_collection_ref const& widgets)
+	{
+		auto const widget_pointers = widgets.widget_pointers();
+		auto const widget_states = widgets.widget_states();
+		auto const get_children_callbacks = widgets.get_children_callbacks();
+		for(auto k : widgets.element_indices())
+		{
+			widget_states[k].needs_redraw = true;
+			widget_states[k].subtree_needs_redraw = true;
+			mark_tree_for_redraw(get_children_callbacks[k](widget_pointers[k]));
+		}
+	}
+
+	bool contains(terraformer::ui::main::widget_collection_ref const& widgets, void const* widget)
+	{
+		auto const widget_pointers = widgets.widget_pointers();
+		for(auto k : widgets.element_indices())
+		{
+			if(widget_pointers[k] == widget)
+			{ return true; }
+		}
+		return false;
+	}
+}
+
+std::optional<terraformer::ui::main::damaged_region>
+terraformer::ui::main::mark_siblings_for_redraw(
+	widget_collection_ref const& widgets,
+	void const* widget,
+	displacement offset
+)
+{
+	auto const widget_pointers = widgets.widget_pointers();
+	auto const widget_states = widgets.widget_states();
+	auto const widget_geometries = widgets.widget_geometries();
+	auto const get_children_callbacks = widgets.get_children_callbacks();
+	for(auto k : widgets.element_indices())
+	{
+		if(widget_pointers[k] == widget)
+		{
+			// widget has no parent, so damage everything at this level
+			mark_tree_for_redraw(widgets);
+			auto region = bounding_region(widget_geometries[k], offset);
+			for(auto l : widgets.element_indices())
+			{ region = bounding_region(region, bounding_region(widget_geometries[l], offset)); }
+			return region;
+		}
+
+		auto const children = get_children_callbacks[k](widget_pointers[k]);
+		if(contains(children, widget))
+		{
+			mark_tree_for_redraw(children);
+			widget_states[k].needs_redraw = true;
+			widget_states[k].subtree_needs_redraw = true;
+			return bounding_region(widget_geometries[k], offset);
+		}
+
+		auto const child_offset = widget_geometries[k].where + offset - location{0.0f, 0.0f, 0.0f};
+		if(auto const region = mark_siblings_for_redraw(children, widget, child_offset); region.has_value())
+		{
+			widget_states[k].subtree_needs_redraw = true;
+			return region;
+		}
+	}
+	return std::nullopt;
+}
+
+void terraformer::ui::main::collect_geometries(
+	widget_collection_ref const& widgets,
+	single_array<widget_geometry>& output
+)
+{
+	auto const widget_pointers = widgets.widget_pointers();
+	auto const widget_geometries = widgets.widget_geometries();
+	auto const get_children_callbacks = widgets.get_children_callbacks();
+	for(auto k : widgets.element_indices())
+	{
+		output.push_back(widget_geometries[k]);
+		collect_geometries(get_children_callbacks[k](widget_pointers[k]), output);
+	}
+}
+
 terraformer::ui::main::find_recursive_result terraformer::ui::main::find_recursive(
 	cursor_position pos,
 	widget_collection_ref const& widgets,
@@ -5,6 +5,7 @@
 
 #include "./events.hpp"
 #include "./config.hpp"
+#include "./damage_list.hpp"
 #include "./widget_layer_stack.hpp"
 #include "./widget_state.hpp"
 #include "./widget_geometry.hpp"
@@ -15,6 +16,7 @@
 #include "./layout.hpp"
 
 #include "lib/common/value_accessor.hpp"
+#include "lib/array_classes/single_array.hpp"
 
 
 #include <concepts>
@@ -42,6 +44,13 @@ namespace terraformer::ui::main
 	struct widget_height_request
 	{ float width; };
 
+	/**
+	 * The size most recently requested by a widget. It is reused by later layout updates, until
+	 * the size_request_is_dirty flag of the widget is set.
+	 */
+	struct cached_size_request
+	{ box_size value; };
+
 	using cursor_enter_callback = event_callback_t<cursor_enter_event const&, window_ref, ui_controller>;
 	using cursor_leave_callback = event_callback_t<cursor_leave_event const&, window_ref, ui_controller>;
 	using cursor_position_callback = event_callback_t<cursor_motion_event const&, window_ref, ui_controller>;
@@ -68,6 +77,7 @@ namespace terraformer::ui::main
 			void*,
 			widget_state,
 			box_size,
+			cached_size_request,
 			widget_geometry,
 			widget_layer_stack,
 			prepare_for_presentation_callback,
@@ -132,6 +142,9 @@ namespace terraformer::ui::main
 		auto sizes() const
 		{ return m_span.template get_by_type<box_size>(); }
 
+		auto size_requests() const
+		{ return m_span.template get_by_type<cached_size_request>(); }
+
 		auto widget_geometries() const
 		{ return m_span.template get_by_type<widget_geometry>(); }
 
@@ -328,6 +341,35 @@ namespace terraformer::ui::main
 
 	void run(update_widget_location_context const& ctxt);
 
+	/**
+	 * Runs all layout passes, starting from the widget at index. Size requests are only computed
+	 * for widgets with the size_request_is_dirty flag set. Returns the new size of the widget.
+	 */
+	box_size update_layout(
+		widget_collection_ref const& widgets,
+		widget_collection_ref::index_type index,
+		box_size available_size
+	);
+
+	/**
+	 * Marks the size request of widget, and of all its ancestors, as dirty. Returns false if
+	 * widget is not found within widgets.
+	 */
+	bool invalidate_size_request(widget_collection_ref const& widgets, void const* widget);
+
+	/**
+	 * Marks the size requests of all widgets in the tree as dirty
+	 */
+	void invalidate_size_requests(widget_collection_ref const& widgets);
+
+	/**
+	 * Marks the size requests of widget, its siblings, all their descendants, and the ancestors
+	 * of widget as dirty. This is needed when widget has handled an event, since an event handler
+	 * may change other widgets within the same parent, such as the text box of a float_input.
+	 * Returns false if widget is not found within widgets.
+	 */
+	bool invalidate_size_requests_of_siblings(widget_collection_ref const& widgets, void const* widget);
+
 	class prepare_for_presentation_context
 	{
 	public:
@@ -359,6 +401,39 @@ namespace terraformer::ui::main
 
 	widget_layer_stack run(prepare_for_presentation_context const& ctxt, graphics_backend_ref backend);
 
+	/**
+	 * Prepares the widgets that need to be redrawn for presentation. Subtrees without such
+	 * widgets are skipped, so the layer stacks from the previous frame are used for them.
+	 */
+	void prepare_dirty_widgets_for_presentation(
+		widget_collection_ref const& widgets,
+		graphics_backend_ref backend
+	);
+
+	/**
+	 * Marks widget as needing redraw, and all of its ancestors as having a subtree that needs
+	 * redraw. Returns false if widget is not found within widgets.
+	 */
+	bool mark_for_redraw(widget_collection_ref const& widgets, void const* widget);
+
+	/**
+	 * Marks widget, its siblings, all their descendants, and their parent as needing redraw. The
+	 * other ancestors of widget are marked as having a subtree that needs redraw. These are the
+	 * widgets whose size requests are invalidated by invalidate_size_requests_of_siblings.
+	 * Returns the region covered by the parent, or std::nullopt if widget is not found within
+	 * widgets. The ancestors of the parent only need to be redrawn within that region.
+	 */
+	std::optional<damaged_region> mark_siblings_for_redraw(
+		widget_collection_ref const& widgets,
+		void const* widget,
+		displacement offset = displacement{0.0f, 0.0f, 0.0f}
+	);
+
+	/**
+	 * Appends the geometries of all widgets in the tree to output, in depth-first order
+	 */
+	void collect_geometries(widget_collection_ref const& widgets, single_array<widget_geometry>& output);
+
 	class show_widget_context
 	{
 	public:
@@ -412,6 +487,38 @@ namespace terraformer::ui::main
 		}
 	}
 
+	/**
+	 * Shows the widgets that intersect region. Since children are assumed to be within the
+	 * boundaries of their parent, subtrees outside region are skipped.
+	 */
+	template<class Renderer>
+	void run(
+		show_widget_context const& ctxt,
+		Renderer renderer,
+		damaged_region const& region,
+		displacement offset = displacement{0.0f, 0.0f, 0.0f}
+	)
+	{
+		if(!intersects(bounding_region(ctxt.geometry(), offset), region))
+		{ return; }
+
+		ctxt.render(renderer, offset);
+		auto& children = ctxt.children();
+		auto const widget_states = children.widget_states();
+		for(auto k : children.element_indices())
+		{
+			if(widget_states[k].hidden || widget_states[k].collapsed) [[unlikely]]
+			{ continue; }
+
+			run(
+				show_widget_context{children, k},
+				renderer,
+				region,
+				ctxt.geometry().where + offset - location{0.0f, 0.0f, 0.0f}
+			);
+		}
+	}
+
 	inline auto find(cursor_position pos, widget_collection_view const& widgets, displacement offset)
 	{
 		auto const geoms = widgets.widget_geometries();
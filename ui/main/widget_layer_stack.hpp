@@ -2,6 +2,7 @@
 #define TERRAFORMER_UI_MAIN_WIDGET_LAYER_STACK_HPP
 
 #include "./texture.hpp"
+#include "./glyph_quad_buffer.hpp"
 
 namespace terraformer::ui::main
 {
@@ -19,6 +20,49 @@ namespace terraformer::ui::main
 		texture_ref texture;
 	};
 
+	/**
+	 * Describes how the shader maps the values of a single channel background texture to colors.
+	 * Without a color_lut, the background texture is presented as is.
+	 */
+	struct widget_layer_color_mapping
+	{
+		/**
+		 * A texture with one row, where the first pixel is used for min_value, and the last pixel
+		 * for max_value
+		 */
+		texture_ref color_lut;
+		float min_value;
+		float max_value;
+
+		/**
+		 * The size of the presented image, in pixels. The background texture is stretched to fit.
+		 */
+		box_size image_size;
+
+		/**
+		 * The distance between two level curves. Level curves are hidden if the interval is not
+		 * positive.
+		 */
+		float level_curve_interval;
+		rgba_pixel level_curve_color;
+	};
+
+	/**
+	 * Text drawn as one quad per glyph, on top of the other layers. Text is not drawn if there is
+	 * no glyph buffer.
+	 */
+	struct widget_text_layer
+	{
+		displacement offset;
+
+		/**
+		 * Glyph locations are relative to offset. Glyphs are clipped to the widget.
+		 */
+		glyph_quad_buffer_ref glyphs;
+		texture_ref glyph_atlas;
+		rgba_pixel tint;
+	};
+
 	struct widget_layer_stack
 	{
 		widget_layer background;
@@ -27,6 +71,8 @@ namespace terraformer::ui::main
 		widget_layer foreground;
 		widget_layer frame;
 		widget_layer input_marker;
+		widget_layer_color_mapping background_color_mapping{};
+		widget_text_layer text{};
 	};
 }
 
@@ -18,6 +18,22 @@ namespace terraformer::ui::main
 		focus_indicator_mode cursor_focus_indicator_mode:2;
 		focus_indicator_mode kbd_focus_indicator_mode:2;
 
+		/**
+		 * Set when the widget must be prepared for presentation again, before it is redrawn
+		 */
+		uint16_t needs_redraw:1;
+
+		/**
+		 * Set when some widget below this one in the widget tree needs to be redrawn
+		 */
+		uint16_t subtree_needs_redraw:1;
+
+		/**
+		 * Set when the size request of the widget, or of some widget below it, must be computed
+		 * again during the next layout update
+		 */
+		uint16_t size_request_is_dirty:1;
+
 		constexpr bool interaction_is_disabled() const
 		{ return disabled || hidden || collapsed; }
 
@@ -134,6 +134,7 @@ namespace terraformer::ui::theming
 						}
 					)
 				),
+				.glyph_atlas = std::make_shared<main::glyph_atlas_texture>(1024, 256, 4096)
 			}
 		};
 	}
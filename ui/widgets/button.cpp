@@ -6,16 +6,8 @@
 
 void terraformer::ui::widgets::button::regenerate_text_mask()
 {
-	font_handling::text_shaper shaper{};
-
 	// TODO: Add support for different scripts, direction, and languages
-	auto result = shaper.append(m_text)
-		.with(hb_script_t::HB_SCRIPT_LATIN)
-		.with(hb_direction_t::HB_DIRECTION_LTR)
-		.with(hb_language_from_string("en-UE", -1))
-		.run(*m_font);
-
-	m_rendered_text = render(result);
+	m_shaped_text = font_handling::get_shaped_text_cache().get(m_font, m_text);
 	m_dirty_bits &= ~text_dirty;
 	m_dirty_bits |= host_textures_dirty;
 }
@@ -59,7 +51,7 @@ void terraformer::ui::widgets::button::regenerate_textures()
 		}
 	);
 
-	m_foreground = drawing_api::convert_mask(m_rendered_text);
+	m_foreground = drawing_api::convert_mask(m_shaped_text->mask);
 
 	m_dirty_bits &= ~host_textures_dirty;
 }
@@ -121,8 +113,8 @@ terraformer::box_size terraformer::ui::widgets::button::compute_size(main::widge
 	{ regenerate_text_mask(); }
 
 	return box_size{
-		static_cast<float>(m_rendered_text.width()) + 2.0f*m_margin,
-		static_cast<float>(m_rendered_text.height()) + 2.0f*m_margin,
+		static_cast<float>(m_shaped_text->mask.width()) + 2.0f*m_margin,
+		static_cast<float>(m_shaped_text->mask.height()) + 2.0f*m_margin,
 		0.0f
 	};
 }
@@ -134,8 +126,8 @@ terraformer::box_size terraformer::ui::widgets::button::compute_size(main::widge
 	{ regenerate_text_mask(); }
 
 	return box_size{
-		static_cast<float>(m_rendered_text.width()) + 2.0f*m_margin,
-		static_cast<float>(m_rendered_text.height()) + 2.0f*m_margin,
+		static_cast<float>(m_shaped_text->mask.width()) + 2.0f*m_margin,
+		static_cast<float>(m_shaped_text->mask.height()) + 2.0f*m_margin,
 		0.0f
 	};
 }
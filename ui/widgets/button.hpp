@@ -3,7 +3,7 @@
 #ifndef TERRAFORMER_UI_WIDGETS_BUTTON_HPP
 #define TERRAFORMER_UI_WIDGETS_BUTTON_HPP
 
-#include "ui/font_handling/text_shaper.hpp"
+#include "ui/font_handling/shaped_text_cache.hpp"
 #include "ui/main/widget.hpp"
 #include "ui/main/graphics_backend_ref.hpp"
 #include "lib/common/move_only_function.hpp"
@@ -123,7 +123,7 @@ namespace terraformer::ui::widgets
 		main::widget_user_interaction_handler<button> m_on_activated{no_operation_tag{}};
 
 		std::basic_string<char8_t> m_text;
-		basic_image<uint8_t> m_rendered_text;
+		std::shared_ptr<font_handling::shaped_text const> m_shaped_text;
 
 		// TODO: Cleanup flags
 		static constexpr auto text_dirty = 0x1;
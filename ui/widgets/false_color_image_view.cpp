@@ -2,59 +2,119 @@
 
 #include "./false_color_image_view.hpp"
 
-terraformer::image
-terraformer::ui::widgets::false_color_image_view::apply_filter(span_2d<float const> input_image) const
+#include "ui/drawing_api/image_generators.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+void terraformer::ui::widgets::false_color_image_view::show_image(span_2d<float const> pixels)
 {
-	auto const w = input_image.width();
-	auto const h = input_image.height();
+	m_current_box = box_size{
+		static_cast<float>(pixels.width()),
+		static_cast<float>(pixels.height()),
+		0.0f
+	};
+	m_source = grayscale_image{pixels};
 
-	image output_image{w, h};
-	auto const value_map_ptr = m_value_map.get().get_pointer();
-	auto const from_value = m_value_map.get().get_vtable().from_value;
+	auto const minmax = std::ranges::minmax_element(pixels);
+	m_min_value = minmax.min != std::end(pixels)? *minmax.min : 0.0f;
+	m_max_value = minmax.max != std::end(pixels)? *minmax.max : 1.0f;
+	if(!(m_max_value > m_min_value))
+	{ m_max_value = m_min_value + 1.0f; }
 
-	for(uint32_t y = 0; y != h; ++y)
+	// The lookup table is indexed by the values of the image, so the shader can apply both the
+	// value map and the color map with a single texture fetch
+	std::vector<float> values(color_lut_size);
+	for(uint32_t k = 0; k != color_lut_size; ++k)
 	{
-		for(uint32_t x = 0; x != w; ++x)
-		{
-			auto const grayscale_val = std::clamp(from_value(value_map_ptr, input_image(x, y)), 0.0f, 1.0f);
-			output_image(x, y) = m_color_map(grayscale_val);
-		}
+		auto const t = static_cast<float>(k)/static_cast<float>(color_lut_size - 1);
+		values[k] = std::lerp(m_min_value, m_max_value, t);
 	}
-	return output_image;
-}
-
-std::optional<terraformer::image>
-terraformer::ui::widgets::false_color_image_view::create_foreground(span_2d<float const> input_image) const
-{
-	auto const w = input_image.width();
-	auto const h = input_image.height();
 
-	if(!m_show_level_curves || h < 3 || w < 3)
-	{ return std::nullopt; }
+	std::vector<float> intensities(color_lut_size);
+	m_value_map.get().get_vtable().from_values(m_value_map.get().get_pointer(), values, intensities);
 
-	grayscale_image img_posterized{w, h};
-	auto const dz = m_dz;
+	image lut{color_lut_size, 1};
+	for(uint32_t k = 0; k != color_lut_size; ++k)
+	{ lut(k, 0) = m_color_map(std::clamp(intensities[k], 0.0f, 1.0f)); }
+	m_color_lut = std::move(lut);
+	m_frame_dirty = true;
+}
 
-	for(uint32_t y = 0; y != h; ++y)
+terraformer::ui::main::widget_layer_stack
+terraformer::ui::widgets::false_color_image_view::prepare_for_presentation(main::graphics_backend_ref backend)
+{
+	auto& null_texture = m_cfg.null_texture->get_backend_resource(backend);
+	auto const border_displacement = m_cfg.border_thickness*displacement{1.0f, 1.0f, 0.0f};
+	if(m_frame_dirty)
 	{
-		for(uint32_t x = 0; x != w; ++x)
-		{ img_posterized(x, y) = std::floor(input_image(x, y)/dz); }
+		auto const full_box = m_adjusted_box + 2.0f*border_displacement;
+		auto const w = static_cast<uint32_t>(full_box[0]);
+		auto const h = static_cast<uint32_t>(full_box[1]);
+		m_frame =  generate(
+			drawing_api::flat_rectangle{
+				.domain_size = span_2d_extents {
+					.width = w,
+					.height = h
+				},
+				.origin_x = 0u,
+				.origin_y = 0u,
+				.width = w,
+				.height = h,
+				.border_thickness = static_cast<uint32_t>(m_cfg.border_thickness),
+				.border_color = rgba_pixel{1.0f, 1.0f, 1.0f, 1.0f},
+				.fill_color = rgba_pixel{0.0f, 0.0f, 0.0f, 0.0f}
+			}
+		);
+		m_frame_dirty = false;
 	}
 
-	image output_image{w, h};
+	auto const bg_tint = rgba_pixel{1.0f, 1.0f, 1.0f, 1.0f};
+	auto const fg_tint = m_cfg.fg_tint;
 
-	for(uint32_t y = 1; y != h - 1; ++y)
-	{
-		for(uint32_t x = 1; x != w - 1; ++x)
-		{
-			auto const ddx = img_posterized(x + 1, y) - img_posterized(x - 1, y);
-			auto const ddy = img_posterized(x, y + 1) - img_posterized(x, y - 1);
-
-			// NOTE: From the quantization above, the maximum gradient size is known to be sqrt(2)
-			auto const val = std::sqrt(ddx*ddx + ddy*ddy)/std::numbers::sqrt2_v<float>;
-			output_image(x, y) = val*rgba_pixel{1.0f, 1.0f, 1.0f, 1.0f};
+	return main::widget_layer_stack{
+		.background = main::widget_layer{
+			.offset = border_displacement,
+			.rotation = geosimd::turn_angle{},
+			.texture = m_source.get_backend_resource(backend).get(),
+			.tints = std::array<rgba_pixel, 4>{bg_tint, bg_tint, bg_tint, bg_tint}
+		},
+		.sel_bg_mask = main::widget_layer_mask{
+			.offset = displacement{},
+			.texture = null_texture.get()
+		},
+		.selection_background = main::widget_layer{
+			.offset = displacement{},
+			.rotation = geosimd::turn_angle{},
+			.texture = null_texture.get(),
+			.tints = std::array<rgba_pixel, 4>{}
+		},
+		.foreground = main::widget_layer{
+			.offset = border_displacement,
+			.rotation = geosimd::turn_angle{},
+			.texture = null_texture.get(),
+			.tints = std::array<rgba_pixel, 4>{}
+		},
+		.frame = main::widget_layer{
+			.offset = displacement{},
+			.rotation = geosimd::turn_angle{},
+			.texture = m_frame.get_backend_resource(backend).get(),
+			.tints = std::array{fg_tint, fg_tint, fg_tint, fg_tint}
+		},
+		.input_marker{
+			.offset = border_displacement,
+			.rotation = geosimd::turn_angle{},
+			.texture = null_texture.get(),
+			.tints = std::array<rgba_pixel, 4>{}
+		},
+		.background_color_mapping{
+			.color_lut = m_color_lut.get_backend_resource(backend).get(),
+			.min_value = m_min_value,
+			.max_value = m_max_value,
+			.image_size = m_adjusted_box,
+			.level_curve_interval = m_show_level_curves? m_dz : 0.0f,
+			.level_curve_color = fg_tint
 		}
-	}
-
-	return output_image;
-}
\ No newline at end of file
+	};
+}
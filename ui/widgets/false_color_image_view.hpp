@@ -3,54 +3,103 @@
 #ifndef TERRAFORMER_UI_WIDGETS_FALSE_COLOR_IMAGE_VIEW_HPP
 #define TERRAFORMER_UI_WIDGETS_FALSE_COLOR_IMAGE_VIEW_HPP
 
-#include "./basic_image_view.hpp"
+#include "ui/main/texture_types.hpp"
 #include "ui/main/widget.hpp"
 #include "ui/main/graphics_backend_ref.hpp"
 
 #include "lib/value_maps/affine_value_map.hpp"
+#include "lib/common/move_only_function.hpp"
 #include "lib/common/value_map.hpp"
+#include "lib/pixel_store/image.hpp"
 
 namespace terraformer::ui::widgets
 {
-	class false_color_image_view:public basic_image_view<float, false_color_image_view>
+	struct false_color_image_view_config
+	{
+		main::immutable_shared_texture null_texture;
+		rgba_pixel fg_tint;
+		float border_thickness;
+		float min_img_height;
+	};
+
+	/**
+	 * Presents a grayscale image in false colors, with optional level curves.
+	 *
+	 * The image is uploaded once, as a single channel texture. Colors and level curves are
+	 * computed by the shader, using a lookup table that covers the value range of the image. Thus,
+	 * resizing the view, or changing the level curve interval, does not require any work on the
+	 * CPU side.
+	 */
+	class false_color_image_view:public main::widget_with_default_actions
 	{
 	public:
 		false_color_image_view() = default;
 
-		using basic_image_view<float, false_color_image_view>::handle_event;
-		using basic_image_view<float, false_color_image_view>::compute_size;
-		using basic_image_view<float, false_color_image_view>::confirm_size;
-		using basic_image_view<float, false_color_image_view>::show_image;
-		using basic_image_view<float, false_color_image_view>::prepare_for_presentation;
-
 		template<class ValueMap, class ColorMap>
 		explicit false_color_image_view(ValueMap&& vm, ColorMap&& cm):
 			m_value_map{std::forward<ValueMap>(vm)},
 			m_color_map{std::forward<ColorMap>(cm)}
 		{ }
 
-		image apply_filter(span_2d<float const> input) const;
-
-		std::optional<image> create_foreground(span_2d<float const> pixels) const;
+		void show_image(span_2d<float const> pixels);
 
 		void show_level_curves()
+		{ m_show_level_curves = true; }
+
+		void hide_level_curves()
+		{ m_show_level_curves = false; }
+
+		void set_level_curve_interval(float dz)
+		{ m_dz = dz; }
+
+		main::widget_layer_stack prepare_for_presentation(main::graphics_backend_ref backend);
+
+		box_size compute_size(main::widget_width_request wr)
 		{
-			m_show_level_curves = true;
-			schedule_redraw();
+			auto const img_width = m_current_box[0];
+			auto const img_height = m_current_box[1];
+			auto const h = std::max(wr.height, m_cfg.min_img_height);
+			auto const w = h*img_width/img_height;
+			return box_size{w, h, 0.0f} + 2.0f*m_cfg.border_thickness*displacement{1.0f, 1.0f, 0.0f};
 		}
 
-		void hide_level_curves()
+		box_size compute_size(main::widget_height_request hr)
 		{
-			m_show_level_curves = false;
-			schedule_redraw();
+			auto const img_width = m_current_box[0];
+			auto const img_height = m_current_box[1];
+			auto const w_temp = hr.width;
+			auto const h = std::max(w_temp*img_height/img_width, m_cfg.min_img_height);
+			auto const w = h*img_width/img_height;
+			return box_size{w, h, 0.0f} + 2.0f*m_cfg.border_thickness*displacement{1.0f, 1.0f, 0.0f};
 		}
 
-		void set_level_curve_interval(float dz)
+		box_size confirm_size(box_size size)
+		{
+			auto const new_box = max(
+				m_current_box.fit_xy_keep_z(
+					size + 2.0f*m_cfg.border_thickness*displacement{-1.0f, -1.0f, 0.0f}
+				),
+				box_size{1.0f, 1.0f, 0.0f}
+			);
+			m_frame_dirty = (new_box != m_adjusted_box || m_frame_dirty);
+			m_adjusted_box = new_box;
+			return new_box + 2.0f*m_cfg.border_thickness*displacement{1.0f, 1.0f, 0.0f};
+		}
+
+		void theme_updated(main::config const& cfg, main::widget_instance_info)
 		{
-			m_dz = dz;
-			schedule_redraw();
+			m_cfg.null_texture = cfg.misc_textures.null;
+			m_cfg.fg_tint = cfg.output_area.colors.foreground;
+			m_cfg.border_thickness = cfg.output_area.border_thickness;
+			m_cfg.min_img_height = cfg.output_area.min_img_height;
+			m_frame_dirty = true;
 		}
 
+		/**
+		 * Number of entries in the color lookup table
+		 */
+		static constexpr uint32_t color_lut_size = 4096;
+
 	private:
 		type_erased_value_map m_value_map{
 			std::in_place_type_t<terraformer::value_maps::affine_value_map>{}, 0.0f, 1.0f
@@ -61,6 +110,18 @@ namespace terraformer::ui::widgets
 			}
 		};
 
+		main::unique_grayscale_texture m_source{grayscale_image{1, 1}};
+		main::unique_texture m_color_lut{image{1, 1}};
+		float m_min_value{0.0f};
+		float m_max_value{1.0f};
+
+		box_size m_current_box;
+		box_size m_adjusted_box;
+		bool m_frame_dirty = false;
+		main::unique_texture m_frame{image{1 ,1}};
+
+		false_color_image_view_config m_cfg;
+
 		float m_dz{100.0f};
 		bool m_show_level_curves{true};
 	};
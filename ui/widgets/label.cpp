@@ -1,20 +1,11 @@
 //@	{"target":{"name":"label.o"}}
 
 #include "./label.hpp"
-#include "ui/drawing_api/image_generators.hpp"
 
 void terraformer::ui::widgets::label::regenerate_text_mask()
 {
-	font_handling::text_shaper shaper{};
-
 	// TODO: Add support for different scripts, direction, and languages
-	auto result = shaper.append(m_text)
-		.with(hb_script_t::HB_SCRIPT_LATIN)
-		.with(hb_direction_t::HB_DIRECTION_LTR)
-		.with(hb_language_from_string("en-UE", -1))
-		.run(*m_font);
-
-	m_rendered_text = render(result);
+	m_shaped_text = font_handling::get_shaped_text_cache().get(m_font, m_text);
 	m_dirty_bits &= ~text_dirty;
 	m_dirty_bits |= host_textures_dirty;
 }
@@ -24,7 +15,10 @@ void terraformer::ui::widgets::label::regenerate_textures()
 	if(m_dirty_bits & text_dirty)
 	{ regenerate_text_mask(); }
 
-	m_foreground = drawing_api::convert_mask(m_rendered_text);
+	m_glyph_quads.update_frontend_resource([this](auto& quads){
+		make_glyph_quads(m_shaped_text->glyphs, m_glyph_atlas->atlas(), quads);
+	});
+	m_glyph_atlas_reset_count = m_glyph_atlas->atlas().reset_count();
 
 	m_dirty_bits &= ~host_textures_dirty;
 }
@@ -36,8 +30,8 @@ terraformer::box_size terraformer::ui::widgets::label::compute_size(main::widget
 	{ regenerate_text_mask(); }
 
 	return box_size{
-		static_cast<float>(m_rendered_text.width()),
-		static_cast<float>(m_rendered_text.height()),
+		static_cast<float>(text_width()),
+		static_cast<float>(text_height()),
 		0.0f
 	} + m_margin*displacement{2.0f, 2.0f, 0.0f};
 }
@@ -49,8 +43,8 @@ terraformer::box_size terraformer::ui::widgets::label::compute_size(main::widget
 	{ regenerate_text_mask(); }
 
 	return box_size{
-		static_cast<float>(m_rendered_text.width()),
-		static_cast<float>(m_rendered_text.height()),
+		static_cast<float>(text_width()),
+		static_cast<float>(text_height()),
 		0.0f
 	} + m_margin*displacement{2.0f, 2.0f, 0.0f};
 }
@@ -62,11 +56,16 @@ void terraformer::ui::widgets::label::theme_updated(main::config const& cfg, mai
 	m_dirty_bits |= host_textures_dirty | text_dirty;
 	m_fg_tint = cfg.output_area.colors.foreground;
 	m_null_texture = cfg.misc_textures.null;
+	m_glyph_atlas = cfg.misc_textures.glyph_atlas;
 }
 
 terraformer::ui::main::widget_layer_stack
 terraformer::ui::widgets::label::prepare_for_presentation(main::graphics_backend_ref backend)
 {
+	// Quads generated before the glyph atlas was reset refer to removed glyphs
+	if(m_glyph_atlas->atlas().reset_count() != m_glyph_atlas_reset_count) [[unlikely]]
+	{ m_dirty_bits |= host_textures_dirty; }
+
 	if(m_dirty_bits & host_textures_dirty) [[unlikely]]
 	{ regenerate_textures(); }
 
@@ -90,10 +89,10 @@ terraformer::ui::widgets::label::prepare_for_presentation(main::graphics_backend
 			.tints = std::array<rgba_pixel, 4>{}
 		},
 		.foreground = main::widget_layer{
-			.offset = displacement{m_margin, m_margin, 0.0f},
+			.offset = displacement{},
 			.rotation = geosimd::turn_angle{},
-			.texture = m_foreground.get_backend_resource(backend).get(),
-			.tints = std::array<rgba_pixel, 4>{m_fg_tint, m_fg_tint, m_fg_tint, m_fg_tint}
+			.texture = null_texture,
+			.tints = std::array<rgba_pixel, 4>{}
 		},
 		.frame = main::widget_layer{
 			.offset = displacement{},
@@ -106,6 +105,12 @@ terraformer::ui::widgets::label::prepare_for_presentation(main::graphics_backend
 			.rotation = geosimd::turn_angle{},
 			.texture = null_texture,
 			.tints = std::array<rgba_pixel, 4>{}
+		},
+		.text = main::widget_text_layer{
+			.offset = displacement{m_margin, m_margin, 0.0f},
+			.glyphs = m_glyph_quads.get_backend_resource(backend).get(),
+			.glyph_atlas = m_glyph_atlas->get_backend_resource(backend).get(),
+			.tint = m_fg_tint
 		}
 	};
 }
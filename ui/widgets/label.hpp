@@ -3,7 +3,9 @@
 #ifndef TERRAFORMER_UI_WIDGETS_LABEL_HPP
 #define TERRAFORMER_UI_WIDGETS_LABEL_HPP
 
-#include "ui/font_handling/text_shaper.hpp"
+#include "ui/font_handling/shaped_text_cache.hpp"
+#include "ui/main/glyph_atlas_texture.hpp"
+#include "ui/main/glyph_quad_buffer.hpp"
 #include "ui/main/widget.hpp"
 #include "lib/common/object_tree.hpp"
 
@@ -56,14 +58,14 @@ namespace terraformer::ui::widgets
 		{ m_margin = new_val; }
 
 		uint32_t text_height() const
-		{ return m_rendered_text.height(); }
+		{ return m_shaped_text != nullptr? m_shaped_text->mask.height() : 0; }
 
 		uint32_t text_width() const
-		{ return m_rendered_text.width(); }
+		{ return m_shaped_text != nullptr? m_shaped_text->mask.width() : 0; }
 
 	private:
 		std::basic_string<char8_t> m_text;
-		basic_image<uint8_t> m_rendered_text;
+		std::shared_ptr<font_handling::shaped_text const> m_shaped_text;
 
 		// TODO: Cleanup flags
 		static constexpr auto text_dirty = 0x1;
@@ -74,7 +76,10 @@ namespace terraformer::ui::widgets
 		std::shared_ptr<font_handling::font const> m_font;
 		rgba_pixel m_fg_tint;
 
-		main::unique_texture m_foreground;
+		main::staged_glyph_quads m_glyph_quads;
+		std::shared_ptr<main::glyph_atlas_texture> m_glyph_atlas;
+		// The reset count of the glyph atlas when m_glyph_quads was generated
+		size_t m_glyph_atlas_reset_count = 0;
 		main::immutable_shared_texture m_null_texture;
 
 		main::fb_size m_current_size;
@@ -5,17 +5,27 @@
 
 void terraformer::ui::widgets::single_line_text_input::regenerate_text_mask()
 {
-	font_handling::text_shaper shaper{};
-
 	// TODO: Add support for different scripts, direction, and languages
-	m_glyphs = shaper.append(m_value)
-		.with(hb_script_t::HB_SCRIPT_LATIN)
-		.with(hb_direction_t::HB_DIRECTION_LTR)
-		.with(hb_language_from_string("en-UE", -1))
-		.run(*m_font);
-
-	m_rendered_text = render(m_glyphs);
-	m_dirty_bits &= ~text_dirty;
+	font_handling::text_shaping_options const options{};
+
+	if((m_dirty_bits & text_replaced) || m_shaped_text == nullptr)
+	{
+		// A new value is likely to be shown by other widgets as well
+		m_shaped_text = font_handling::get_shaped_text_cache().get(m_font, m_value, options);
+	}
+	else
+	{
+		// The value has been edited. Only shape the clusters around the edit.
+		auto glyphs = reshape(m_shaped_text->glyphs, m_shaped_value, m_value, *m_font, options);
+		auto mask = render(glyphs);
+		m_shaped_text = std::make_shared<font_handling::shaped_text const>(
+			std::move(glyphs),
+			std::move(mask)
+		);
+	}
+
+	m_shaped_value = m_value;
+	m_dirty_bits &= ~(text_dirty | text_replaced);
 	m_dirty_bits |= host_textures_dirty;
 }
 
@@ -40,7 +50,10 @@ void terraformer::ui::widgets::single_line_text_input::regenerate_textures()
 		}
 	);
 
-	m_foreground = drawing_api::convert_mask(m_rendered_text);
+	m_glyph_quads.update_frontend_resource([this](auto& quads){
+		make_glyph_quads(m_shaped_text->glyphs, m_glyph_atlas->atlas(), quads);
+	});
+	m_glyph_atlas_reset_count = m_glyph_atlas->atlas().reset_count();
 
 	m_input_marker = generate(
 		drawing_api::flat_rectangle{
@@ -59,15 +72,15 @@ void terraformer::ui::widgets::single_line_text_input::regenerate_textures()
 	);
 
 	// TODO: Selection mask should be grayscale
-	auto const sel_begin = horz_offset_from_index(m_glyphs, m_sel_range.begin());
+	auto const sel_begin = horz_offset_from_index(m_shaped_text->glyphs, m_sel_range.begin());
 	// Add one to get inclusive boundaries
-	auto const sel_end = horz_offset_from_index(m_glyphs, m_sel_range.end()) + 1.0f;
+	auto const sel_end = horz_offset_from_index(m_shaped_text->glyphs, m_sel_range.end()) + 1.0f;
 
 	m_selection_mask = generate(
 		drawing_api::flat_rectangle{
 			.domain_size = span_2d_extents {
-				.width = static_cast<uint32_t>(m_rendered_text.width()),
-				.height = static_cast<uint32_t>(m_rendered_text.height())
+				.width = static_cast<uint32_t>(m_shaped_text->mask.width()),
+				.height = static_cast<uint32_t>(m_shaped_text->mask.height())
 			},
 			.origin_x = static_cast<uint32_t>(sel_begin),
 			.origin_y = 0u,
@@ -90,11 +103,15 @@ terraformer::ui::widgets::single_line_text_input::prepare_for_presentation(main:
 	if(m_dirty_bits & text_dirty) [[unlikely]]
 	{ regenerate_text_mask(); }
 
+	// Quads generated before the glyph atlas was reset refer to removed glyphs
+	if(m_glyph_atlas->atlas().reset_count() != m_glyph_atlas_reset_count) [[unlikely]]
+	{ m_dirty_bits |= host_textures_dirty; }
+
 	// TODO: Only regenerate relevant host textures (frame only needs to be updated on resize)
 	if(m_dirty_bits & host_textures_dirty) [[unlikely]]
 	{ regenerate_textures(); }
 
-	auto const cursor_loc = horz_offset_from_index(m_glyphs, m_insert_offset);
+	auto const cursor_loc = horz_offset_from_index(m_shaped_text->glyphs, m_insert_offset);
 
 	auto const w_max = static_cast<float>(m_frame.frontend_resource().width()) - 2.0f*m_margin;
 	displacement const input_marker_offset{std::min(cursor_loc, w_max) + m_margin , m_margin, 0.0f};
@@ -131,10 +148,10 @@ terraformer::ui::widgets::single_line_text_input::prepare_for_presentation(main:
 			.tints = std::array{sel_tint, sel_tint, sel_tint, sel_tint}
 		},
 		.foreground = main::widget_layer{
-			.offset = fg_offset,
+			.offset = displacement{},
 			.rotation = geosimd::turn_angle{},
-			.texture = m_foreground.get_backend_resource(backend).get(),
-			.tints = std::array{m_fg_tint, m_fg_tint, m_fg_tint, m_fg_tint}
+			.texture = m_null_texture->get_backend_resource(backend).get(),
+			.tints = std::array<rgba_pixel, 4>{}
 		},
 		.frame = main::widget_layer{
 			.offset = displacement{},
@@ -147,6 +164,12 @@ terraformer::ui::widgets::single_line_text_input::prepare_for_presentation(main:
 			.rotation = geosimd::turn_angle{},
 			.texture = m_input_marker.get_backend_resource(backend).get(),
 			.tints = input_marker_tints
+		},
+		.text = main::widget_text_layer{
+			.offset = fg_offset,
+			.glyphs = m_glyph_quads.get_backend_resource(backend).get(),
+			.glyph_atlas = m_glyph_atlas->get_backend_resource(backend).get(),
+			.tint = m_fg_tint
 		}
 	};
 }
@@ -263,21 +286,11 @@ terraformer::box_size terraformer::ui::widgets::single_line_text_input::compute_
 {
 	if(m_placeholder.has_value())
 	{
-		font_handling::text_shaper shaper{};
-
 		// TODO: Add support for different scripts, direction, and languages
-		// TODO: DRY
-		// TODO: Cache result
-		auto result = shaper.append(*m_placeholder)
-			.with(hb_script_t::HB_SCRIPT_LATIN)
-			.with(hb_direction_t::HB_DIRECTION_LTR)
-			.with(hb_language_from_string("en-UE", -1))
-			.run(*m_font);
-
-		auto const temp = render(result);
+		auto const placeholder = font_handling::get_shaped_text_cache().get(m_font, *m_placeholder);
 		return box_size{
-			static_cast<float>(temp.width()) + 2.0f*m_margin,
-			static_cast<float>(temp.height()) + 2.0f*m_margin,
+			static_cast<float>(placeholder->mask.width()) + 2.0f*m_margin,
+			static_cast<float>(placeholder->mask.height()) + 2.0f*m_margin,
 			1.0f
 		};
 	}
@@ -287,8 +300,8 @@ terraformer::box_size terraformer::ui::widgets::single_line_text_input::compute_
 	{ regenerate_text_mask(); }
 
 	return box_size{
-		static_cast<float>(m_rendered_text.width()) + 2.0f*m_margin,
-		static_cast<float>(m_rendered_text.height()) + 2.0f*m_margin,
+		static_cast<float>(m_shaped_text->mask.width()) + 2.0f*m_margin,
+		static_cast<float>(m_shaped_text->mask.height()) + 2.0f*m_margin,
 		1.0f
 	};
 }
@@ -299,21 +312,12 @@ terraformer::box_size terraformer::ui::widgets::single_line_text_input::compute_
 	{
 		if(m_dirty_bits & recompute_size)
 		{
-			font_handling::text_shaper shaper{};
-
 			// TODO: Add support for different scripts, direction, and languages
-			// TODO: DRY
-			auto result = shaper.append(*m_placeholder)
-				.with(hb_script_t::HB_SCRIPT_LATIN)
-				.with(hb_direction_t::HB_DIRECTION_LTR)
-				.with(hb_language_from_string("en-UE", -1))
-				.run(*m_font);
-
-			auto const temp = render(result);
+			auto const placeholder = font_handling::get_shaped_text_cache().get(m_font, *m_placeholder);
 			m_dirty_bits &= ~recompute_size;
 			m_widget_size = box_size{
-				static_cast<float>(temp.width()),
-				static_cast<float>(temp.height()),
+				static_cast<float>(placeholder->mask.width()),
+				static_cast<float>(placeholder->mask.height()),
 				0.0f
 			} + m_margin*displacement{2.0f, 2.0f, 0.0f};;
 			return m_widget_size;
@@ -325,8 +329,8 @@ terraformer::box_size terraformer::ui::widgets::single_line_text_input::compute_
 	{ regenerate_text_mask(); }
 
 	return box_size{
-		std::max(static_cast<float>(m_rendered_text.width()), value.width),
-		static_cast<float>(m_rendered_text.height()),
+		std::max(static_cast<float>(m_shaped_text->mask.width()), value.width),
+		static_cast<float>(m_shaped_text->mask.height()),
 		0.0f
 	} + m_margin*displacement{2.0f, 2.0f, 0.0f};
 }
@@ -339,6 +343,8 @@ void terraformer::ui::widgets::single_line_text_input::theme_updated(main::confi
 	m_sel_tint = cfg.input_area.colors.selection;
 	m_fg_tint = cfg.input_area.colors.foreground;
 	m_background = cfg.misc_textures.white;
+	m_null_texture = cfg.misc_textures.null;
+	m_glyph_atlas = cfg.misc_textures.glyph_atlas;
 	m_border_thickness = static_cast<uint32_t>(cfg.input_area.border_thickness);
-	m_dirty_bits |= host_textures_dirty | text_dirty | recompute_size;
+	m_dirty_bits |= host_textures_dirty | text_dirty | text_replaced | recompute_size;
 }
\ No newline at end of file
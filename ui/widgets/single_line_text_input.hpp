@@ -4,7 +4,9 @@
 #define TERRAFORMER_UI_WIDGETS_SINGLE_LINE_TEXT_INPUT_HPP
 
 #include "ui/main/texture_types.hpp"
-#include "ui/font_handling/text_shaper.hpp"
+#include "ui/font_handling/shaped_text_cache.hpp"
+#include "ui/main/glyph_atlas_texture.hpp"
+#include "ui/main/glyph_quad_buffer.hpp"
 #include "ui/main/widget.hpp"
 #include "ui/main/graphics_backend_ref.hpp"
 
@@ -121,7 +123,7 @@ namespace terraformer::ui::widgets
 
 			m_insert_offset = std::min(std::size(m_value), m_insert_offset);
 
-			m_dirty_bits |= text_dirty;
+			m_dirty_bits |= text_dirty | text_replaced;
 			return *this;
 		}
 
@@ -283,13 +285,15 @@ namespace terraformer::ui::widgets
 		size_t m_insert_offset = 0;
 		selection_range m_sel_range{};
 
-		font_handling::glyph_sequence m_glyphs;
-		basic_image<uint8_t> m_rendered_text;
+		std::shared_ptr<font_handling::shaped_text const> m_shaped_text;
+		std::u32string m_shaped_value;
 		// TODO: Review flags
 		static constexpr auto text_dirty = 0x1;
 		static constexpr auto host_textures_dirty = 0x2;
 		static constexpr auto recompute_size = 0x4;
-		unsigned int m_dirty_bits = text_dirty | host_textures_dirty;
+		// Set when m_shaped_text cannot be updated incrementally from the edited text
+		static constexpr auto text_replaced = 0x8;
+		unsigned int m_dirty_bits = text_dirty | host_textures_dirty | text_replaced;
 		box_size m_widget_size;
 		float m_margin = 0;
 		unsigned int m_border_thickness = 0;
@@ -300,9 +304,13 @@ namespace terraformer::ui::widgets
 		float m_cursor_intensity = 0.6125f;
 
 		main::immutable_shared_texture m_background;
+		main::immutable_shared_texture m_null_texture;
 		main::unique_texture m_selection_mask;
 		main::immutable_shared_texture m_sel_background;
-		main::unique_texture m_foreground;
+		main::staged_glyph_quads m_glyph_quads;
+		std::shared_ptr<main::glyph_atlas_texture> m_glyph_atlas;
+		// The reset count of the glyph atlas when m_glyph_quads was generated
+		size_t m_glyph_atlas_reset_count = 0;
 		main::unique_texture m_frame;
 		main::unique_texture m_input_marker;
 
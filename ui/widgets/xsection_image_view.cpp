@@ -3,35 +3,71 @@
 #include "./xsection_image_view.hpp"
 
 #include "ui/drawing_api/image_generators.hpp"
+#include "ui/main/presentation_workers.hpp"
 
+#include "lib/common/chunk_by_chunk_count_view.hpp"
 #include "lib/common/function_ref.hpp"
 #include "lib/common/spaces.hpp"
 #include "lib/common/span_2d.hpp"
 #include "lib/common/utils.hpp"
+#include "lib/execution/batch_result.hpp"
 #include "lib/math_utils/boundary_sampling_policies.hpp"
 #include "lib/math_utils/interp.hpp"
 #include "lib/pixel_store/rgba_pixel.hpp"
 #include "lib/value_maps/affine_value_map.hpp"
 
-void terraformer::ui::widgets::xsection_image_view::show_image(span_2d<float const> image)
+#include <algorithm>
+#include <cmath>
+#include <ranges>
+#include <span>
+#include <utility>
+
+namespace
 {
-	m_source_image = grayscale_image{image};
-	m_redraw_required = true;
+	template<class Callable>
+	void run_in_parallel(uint32_t item_count, Callable const& cb)
+	{
+		auto& workers = terraformer::ui::main::get_presentation_workers();
+		auto const n_tasks = std::min(static_cast<size_t>(item_count), workers.max_concurrency());
+		if(n_tasks == 0)
+		{ return; }
+
+		terraformer::batch_result<void> pending_tasks{n_tasks};
+		for(auto chunk : terraformer::chunk_by_chunk_count_view{std::ranges::iota_view{0u, item_count}, n_tasks})
+		{
+			workers.submit(
+				[&cb, begin = chunk.front(), end = chunk.back() + 1, &pending_tasks = pending_tasks.get_state()](){
+					cb(begin, end);
+					pending_tasks.mark_batch_as_completed();
+				}
+			);
+		}
+		pending_tasks.wait();
+	}
+}
 
-	auto const size = static_cast<size_t>(image.width())*static_cast<size_t>(image.height());
-	auto const minmax = std::ranges::minmax_element(image.data(), image.data() + size);
-	auto const min = *minmax.min;
-	auto const max = *minmax.max;
+void terraformer::ui::widgets::xsection_image_view::show_image(std::shared_ptr<grayscale_image const> image)
+{
+	if(image == nullptr)
+	{ return; }
+
+	height_range_pyramid ranges{image->pixels(), main::get_presentation_workers()};
+	auto const min = ranges.min_elevation();
+	auto const max = ranges.max_elevation();
 
 	m_min_val = min > 0.0f? 0.0f : -ceil_to_n_digits(-min, 2);
 	m_max_val = max <= 0.0f? 0.0f : ceil_to_n_digits(max, 2);
 
 	m_src_image_box_xy = box_size{
-		static_cast<float>(m_source_image.width()),
-		static_cast<float>(m_source_image.height()),
+		static_cast<float>(image->width()),
+		static_cast<float>(image->height()),
 		0.0f
 	};
 
+	m_source_ranges = std::move(ranges);
+	m_source_image = std::move(image);
+	m_redraw_required = true;
+
 	update_src_image_box_xz();
 }
 
@@ -49,11 +85,6 @@ namespace
 		terraformer::function_ref<terraformer::rgba_pixel(float)> color_map;
 	};
 
-	struct xsection_point
-	{
-		float z;
-	};
-
 	struct xsection_point_output_params
 	{
 		float z_min;
@@ -62,17 +93,18 @@ namespace
 		float cos_theta;
 		float sin_theta;
 		float rot_scale;
+		float xy_scale;
 	};
 
-	xsection_point get_xsection_point(
-		terraformer::span_2d<float const> input,
+	terraformer::ui::widgets::xsection_column_span get_xsection_span(
+		terraformer::height_range_pyramid const& input,
 		float x_in,
 		float y_in,
 		xsection_point_output_params const& params_out
 	)
 	{
-		auto const w = static_cast<float>(input.width());
-		auto const h = static_cast<float>(input.height());
+		auto const w = static_cast<float>(input.source().width());
+		auto const h = static_cast<float>(input.source().height());
 
 		auto const x_in_centered = x_in - 0.5f*w;
 		auto const y_in_centered = y_in - 0.5f*h;
@@ -83,61 +115,82 @@ namespace
 			- params_out.sin_theta*x_in_centered + params_out.cos_theta*y_in_centered
 		) + 0.5f*h;
 
-		auto const z_in = interp(
-			input,
-			x_rot - 0.5f,
-			y_rot - 0.5f,
-			terraformer::clamp_at_boundary{}
-		);
-		return xsection_point{
-			.z = params_out.image_height*(params_out.z_max - z_in)/(params_out.z_max - params_out.z_min),
+		auto const to_output_row = [&params_out](float z_in) {
+			return params_out.image_height*(params_out.z_max - z_in)/(params_out.z_max - params_out.z_min);
 		};
-	}
 
-	void draw_blob(
-		terraformer::span_2d<terraformer::rgba_pixel> output,
-		int32_t x_0,
-		int32_t y_0,
-		terraformer::rgba_pixel color
-	)
-	{
-		using clamp_tag = terraformer::span_2d_extents::clamp_tag;
-		output(x_0, y_0, clamp_tag{}) = color;
-		output(x_0 + 1, y_0, clamp_tag{}) = color;
-		output(x_0, y_0 + 1, clamp_tag{}) = color;
-		output(x_0 + 1, y_0 + 1,  clamp_tag{}) = color;
+		// Distance between two output columns, measured in input pixels
+		auto const step = params_out.xy_scale*params_out.rot_scale;
+		if(step <= 1.0f)
+		{
+			auto const z_in = interp(
+				input.source(),
+				x_rot - 0.5f,
+				y_rot - 0.5f,
+				terraformer::clamp_at_boundary{}
+			);
+			auto const z_out = to_output_row(z_in);
+			return terraformer::ui::widgets::xsection_column_span{.top = z_out, .bottom = z_out};
+		}
+
+		// The column covers more than one input pixel. Use the range of all values within the
+		// column, so no peaks are lost when the heightmap is larger than the view.
+		auto const half_width_x = 0.5f*step*std::abs(params_out.cos_theta);
+		auto const half_width_y = 0.5f*step*std::abs(params_out.sin_theta);
+		auto const range = input.elevation_range(
+			x_rot - 0.5f - half_width_x,
+			y_rot - 0.5f - half_width_y,
+			x_rot - 0.5f + half_width_x,
+			y_rot - 0.5f + half_width_y
+		);
+		return terraformer::ui::widgets::xsection_column_span{
+			.top = to_output_row(range.max),
+			.bottom = to_output_row(range.min)
+		};
 	}
 
-	void draw_line(
+	void draw_spans(
 		terraformer::span_2d<terraformer::rgba_pixel> output,
-		int32_t x_0,
-		xsection_point p_0,
-		xsection_point p_1,
+		uint32_t row_begin,
+		uint32_t row_end,
+		std::span<terraformer::ui::widgets::xsection_column_span const> spans,
 		terraformer::rgba_pixel color
 	)
 	{
-		auto const dz = p_1.z - p_0.z;
-		constexpr auto dx = 1.0f;
+		auto const w = output.width();
+		auto const last_row = static_cast<float>(output.height() - 1);
+		auto const to_row = [last_row](float val) {
+			return static_cast<uint32_t>(std::clamp(std::floor(val), 0.0f, last_row));
+		};
 
-		if(dx > std::abs(dz))
-		{
-			auto const z_out = p_0.z;
-			draw_blob(output, x_0, static_cast<int32_t>(z_out), color);
-		}
-		else
+		for(uint32_t x = 0; x != w; ++x)
 		{
-			auto step = p_0.z >= p_1.z? -1 : 1;
-			auto const z_0 = static_cast<int32_t>(p_0.z);
-			for(auto z = z_0; z != static_cast<int32_t>(p_1.z); z += step)
+			auto top = spans[x].top;
+			auto bottom = spans[x].bottom;
+			if(x != 0)
 			{
-				auto const x_out = static_cast<float>(x_0) + dx*static_cast<float>(z - z_0)/dz;
-				draw_blob(output, static_cast<int32_t>(x_out), z, color);
+				// Connect to the previous column
+				top = std::min(top, spans[x - 1].bottom);
+				bottom = std::max(bottom, spans[x - 1].top);
+			}
+
+			// NOTE: Lines are two pixels thick in both directions, as if drawn with a 2x2 brush. The
+			//       span is extended one row down, and is drawn in this column and the next one.
+			auto const first = std::max(to_row(top), row_begin);
+			auto const end = std::min(to_row(bottom + 1.0f) + 1, row_end);
+			for(auto col = x; col != std::min(x + 2, w); ++col)
+			{
+				for(auto y = first; y < end; ++y)
+				{ output(col, y) = color; }
 			}
 		}
 	}
 
-	terraformer::image draw_cross_sections(
-		terraformer::span_2d<float const> input,
+	void draw_cross_sections(
+		terraformer::image& output,
+		std::vector<terraformer::ui::widgets::xsection_column_span>& spans,
+		std::vector<terraformer::rgba_pixel>& colors,
+		terraformer::height_range_pyramid const& input,
 		draw_xsections_params const& params
 	)
 	{
@@ -146,9 +199,12 @@ namespace
 		assert(h >= 1);
 		assert(w >= 1);
 
-		terraformer::image ret{w, h};
+		if(output.width() != w || output.height() != h)
+		{ output = terraformer::image{w, h}; }
+
 		auto const slice_count = 16.0f*params.rot_scale;
-		auto const dy = static_cast<float>(input.height())/slice_count;
+		auto const dy = static_cast<float>(input.source().height())/slice_count;
+		auto const n_slices = static_cast<uint32_t>(slice_count + 0.5f);
 
 		xsection_point_output_params const output_params{
 			.z_min = params.z_min,
@@ -156,40 +212,56 @@ namespace
 			.image_height = static_cast<float>(h),
 			.cos_theta = std::cos(params.orientation),
 			.sin_theta = std::sin(params.orientation),
-			.rot_scale = params.rot_scale
+			.rot_scale = params.rot_scale,
+			.xy_scale = params.xy_scale
 		};
 
-		for(size_t k = 0; k != static_cast<size_t>(slice_count + 0.5f); ++k)
+		colors.resize(n_slices);
+		for(uint32_t k = 0; k != n_slices; ++k)
 		{
-			auto const x_in = 0.5f*params.xy_scale;
 			auto const y_in = (static_cast<float>(k) + 0.5f)*dy;
-			auto p_0 = get_xsection_point(
-				input,
-				x_in,
-				y_in,
-				output_params
-			);
-
-			auto const color = params.color_map(
+			colors[k] = params.color_map(
 				std::clamp(1.0f - params.depth_value_map.from_value(y_in), 0.0f, 1.0f)
 			);
+		}
 
-			for(uint32_t x_out = 1; x_out != w; ++x_out)
+		spans.resize(static_cast<size_t>(n_slices)*w);
+		run_in_parallel(n_slices, [&spans, &input, &output_params, w, dy, xy_scale = params.xy_scale](
+			uint32_t slice_begin,
+			uint32_t slice_end
+		){
+			for(auto k = slice_begin; k != slice_end; ++k)
 			{
-				auto const x_in = (static_cast<float>(x_out) + 0.5f)*params.xy_scale;
-				auto const p_1 = get_xsection_point(
-					input,
-					x_in,
-					y_in,
-					output_params
-				);
+				auto const y_in = (static_cast<float>(k) + 0.5f)*dy;
+				auto const slice_spans = std::span{spans}.subspan(static_cast<size_t>(k)*w, w);
+				for(uint32_t x_out = 0; x_out != w; ++x_out)
+				{
+					auto const x_in = (static_cast<float>(x_out) + 0.5f)*xy_scale;
+					slice_spans[x_out] = get_xsection_span(input, x_in, y_in, output_params);
+				}
+			}
+		});
 
-				draw_line(ret, x_out - 1, p_0, p_1, color);
-				p_0 = p_1;
+		// Each task owns a range of rows, and draws all slices in order within that range. Thus,
+		// slices closer to the viewer end up on top, like when drawing them one by one.
+		run_in_parallel(h, [output = output.pixels(), &spans, &colors, w](uint32_t row_begin, uint32_t row_end){
+			for(auto y = row_begin; y != row_end; ++y)
+			{
+				for(uint32_t x = 0; x != w; ++x)
+				{ output(x, y) = terraformer::rgba_pixel{0.0f, 0.0f, 0.0f, 0.0f}; }
 			}
-		}
 
-		return ret;
+			for(size_t k = 0; k != std::size(colors); ++k)
+			{
+				draw_spans(
+					output,
+					row_begin,
+					row_end,
+					std::span{std::as_const(spans)}.subspan(k*w, w),
+					colors[k]
+				);
+			}
+		});
 	}
 }
 
@@ -207,19 +279,29 @@ terraformer::ui::main::widget_layer_stack terraformer::ui::widgets::xsection_ima
 
 	if(m_redraw_required)
 	{
-		m_diagram = draw_cross_sections(
-			m_source_image.pixels(),
-			draw_xsections_params{
-				.output_size = m_adjusted_box,
-				.xy_scale = m_src_image_box_xy[0]/m_adjusted_box[0],
-				.z_min = m_min_val,
-				.z_max = m_max_val,
-				.orientation = m_orientation,
-				.rot_scale = m_rot_scale,
-				.depth_value_map = m_value_map,
-				.color_map = m_color_map.ref()
-			}
-		);
+		if(m_source_image != nullptr)
+		{
+			m_diagram.update_frontend_resource([this](image& output){
+				draw_cross_sections(
+					output,
+					m_xsection_spans,
+					m_xsection_colors,
+					m_source_ranges,
+					draw_xsections_params{
+						.output_size = m_adjusted_box,
+						.xy_scale = m_src_image_box_xy[0]/m_adjusted_box[0],
+						.z_min = m_min_val,
+						.z_max = m_max_val,
+						.orientation = m_orientation,
+						.rot_scale = m_rot_scale,
+						.depth_value_map = m_value_map,
+						.color_map = m_color_map.ref()
+					}
+				);
+			});
+		}
+		else
+		{ m_diagram = image{1, 1}; }
 
 		auto const full_box = m_adjusted_box + 2.0f*border_displacement;
 		auto const w = static_cast<uint32_t>(full_box[0]);
@@ -10,9 +10,14 @@
 
 #include "lib/value_maps/affine_value_map.hpp"
 #include "lib/common/spaces.hpp"
+#include "lib/filters/height_range_pyramid.hpp"
 #include "lib/math_utils/trigfunc.hpp"
+#include "lib/pixel_store/image.hpp"
 #include "lib/pixel_store/rgba_pixel.hpp"
 
+#include <memory>
+#include <vector>
+
 namespace terraformer::ui::widgets
 {
 	struct xsection_image_view_config
@@ -25,6 +30,22 @@ namespace terraformer::ui::widgets
 		float min_img_height;
 	};
 
+	/**
+	 * The rows covered by a cross-section within one column of the output image
+	 */
+	struct xsection_column_span
+	{
+		float top;
+		float bottom;
+	};
+
+	/**
+	 * Presents cross-sections of a heightmap, as seen from the side.
+	 *
+	 * The heightmap is shared with the caller. A height range pyramid is computed once per image,
+	 * so a change of orientation only needs a few lookups per output pixel, regardless of the size
+	 * of the heightmap.
+	 */
 	class xsection_image_view:public main::widget_with_default_actions
 	{
 	public:
@@ -36,7 +57,7 @@ namespace terraformer::ui::widgets
 			m_color_map{std::forward<ColorMap>(cm)}
 		{ }
 
-		void show_image(span_2d<float const> image);
+		void show_image(std::shared_ptr<grayscale_image const> image);
 
 		void theme_updated(main::config const& cfg, main::widget_instance_info)
 		{
@@ -133,7 +154,10 @@ namespace terraformer::ui::widgets
 		box_size m_adjusted_box;
 		main::immutable_shared_texture m_background;
 
-		grayscale_image m_source_image;
+		std::shared_ptr<grayscale_image const> m_source_image;
+		height_range_pyramid m_source_ranges;
+		std::vector<xsection_column_span> m_xsection_spans;
+		std::vector<rgba_pixel> m_xsection_colors;
 		float m_min_val;
 		float m_max_val;
 		box_size m_src_image_box_xy;
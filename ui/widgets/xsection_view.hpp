@@ -10,6 +10,7 @@
 #include "lib/common/utils.hpp"
 #include "lib/value_maps/affine_value_map.hpp"
 
+#include <memory>
 #include <numbers>
 
 namespace terraformer::ui::widgets
@@ -46,8 +47,8 @@ namespace terraformer::ui::widgets
 			m_colorbar.set_label_count(11);
 		}
 
-		void show_image(span_2d<float const> pixels)
-		{ m_img_view.show_image(pixels); }
+		void show_image(std::shared_ptr<grayscale_image const> image)
+		{ m_img_view.show_image(std::move(image)); }
 
 		void set_physical_dimensions(box_size dim)
 		{
@@ -10,6 +10,7 @@
 #include "lib/pixel_store/rgba_pixel.hpp"
 #include "lib/common/span_2d.hpp"
 #include "lib/execution/blocking_queue.hpp"
+#include "lib/common/move_only_function.hpp"
 
 #include <GLFW/glfw3.h>
 #include <GL/glew.h>